@@ -39,8 +39,13 @@ extern uint32_t SystemCoreClock;
 #define configUSE_PORT_OPTIMISED_TASK_SELECTION 0
 
 /* Set configUSE_TICKLESS_IDLE to 1 for low power tickless mode or 0 to keep the
- * periodic tick interrupt running. */
-#define configUSE_TICKLESS_IDLE                 0
+ * periodic tick interrupt running. 2 selects the application supplied
+ * vPortSuppressTicksAndSleep() in low_power.c, which sleeps on the 1 MHz
+ * hardware timer instead of the 24-bit SysTick. */
+#define configUSE_TICKLESS_IDLE                 2
+
+/* Minimum number of idle ticks before the kernel suppresses the tick. */
+#define configEXPECTED_IDLE_TIME_BEFORE_SLEEP   2
 
 /* configCPU_CLOCK_HZ must be set to the frequency of the clock that drives
  * the peripheral used to generate the kernels periodic tick interrupt. */
@@ -105,8 +110,12 @@ extern uint32_t SystemCoreClock;
 /* Sets the length of the queues used by the queue registry. */
 #define configQUEUE_REGISTRY_SIZE               10
 
-/* Enable run time stats gathering. */
-#define configGENERATE_RUN_TIME_STATS           0
+/* Enable run time stats gathering. The counter is the 1 MHz hardware timer,
+ * which runs from boot, so no extra timer configuration is needed. */
+#define configGENERATE_RUN_TIME_STATS           1
+#define configRUN_TIME_COUNTER_TYPE             uint64_t
+#define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS()
+#define portGET_RUN_TIME_COUNTER_VALUE()        task_stats_timer_us()
 
 /* Enable run time stats gathering. */
 #define configUSE_TRACE_FACILITY                1
@@ -125,7 +134,7 @@ extern uint32_t SystemCoreClock;
 #define INCLUDE_vTaskDelay                      1
 #define INCLUDE_xTaskGetSchedulerState          1
 #define INCLUDE_xTaskGetCurrentTaskHandle       1
-#define INCLUDE_uxTaskGetStackHighWaterMark     0
+#define INCLUDE_uxTaskGetStackHighWaterMark     1
 #define INCLUDE_xTaskGetIdleTaskHandle          0
 #define INCLUDE_eTaskGetState                   0
 #define INCLUDE_xEventGroupSetBitFromISR        1
@@ -134,6 +143,34 @@ extern uint32_t SystemCoreClock;
 #define INCLUDE_xTaskGetHandle                  0
 #define INCLUDE_xTaskResumeFromISR              1
 
+/* Set TRACE_RECORDER_ENABLED to 1 to record scheduler and queue events in the
+ * RAM ring buffer of trace_recorder.c, or 0 to compile the hooks out. */
+#ifndef TRACE_RECORDER_ENABLED
+#define TRACE_RECORDER_ENABLED                  1
+#endif
+
+/* Per-task statistics (task_stats.c) and trace recorder (trace_recorder.c) hooks. */
+#ifndef __ASSEMBLER__
+extern uint64_t task_stats_timer_us(void);
+extern void task_stats_switched_in(void);
+extern void trace_task_switched_in(void);
+extern void trace_task_switched_out(void);
+extern void trace_queue_event(uint8_t event, void *queue);
+#endif
+
+#if TRACE_RECORDER_ENABLED
+/* Event codes match trace_event_t in trace_recorder.h. */
+#define traceTASK_SWITCHED_IN()                 do { task_stats_switched_in(); trace_task_switched_in(); } while (0)
+#define traceTASK_SWITCHED_OUT()                trace_task_switched_out()
+#define traceQUEUE_SEND(pxQueue)                trace_queue_event(3, (void *)(pxQueue))
+#define traceQUEUE_SEND_FROM_ISR(pxQueue)       trace_queue_event(3, (void *)(pxQueue))
+#define traceQUEUE_GIVE_FROM_ISR(pxQueue)       trace_queue_event(3, (void *)(pxQueue))
+#define traceQUEUE_RECEIVE(pxQueue)             trace_queue_event(4, (void *)(pxQueue))
+#define traceQUEUE_RECEIVE_FROM_ISR(pxQueue)    trace_queue_event(4, (void *)(pxQueue))
+#else
+#define traceTASK_SWITCHED_IN()                 task_stats_switched_in()
+#endif
+
 /* Normal assert() semantics without relying on the provision of an assert.h
  * header file. */
 #define configASSERT( x ) if( ( x ) == 0 ) { taskDISABLE_INTERRUPTS(); for( ;; ); }
@@ -147,12 +184,29 @@ extern uint32_t SystemCoreClock;
 #define xPortPendSVHandler PendSV_Handler
 #define xPortSysTickHandler SysTick_Handler
 
-/* Heap configuration for access control system with display */
-#define configTOTAL_HEAP_SIZE                   (128 * 1024)
-
-/* Queue sizes for inter-task communication */
-#define configKEYPAD_QUEUE_SIZE                 10
-#define configACCESS_CONTROL_QUEUE_SIZE         5
-#define configDISPLAY_QUEUE_SIZE                5
+/* Memory allocation. RTOS_STATIC_ALLOCATION (set from CMake) gives every task,
+ * queue and semaphore statically reserved storage (see rtos_static.h) and
+ * removes the FreeRTOS heap; otherwise objects come from heap_4. */
+#ifndef RTOS_STATIC_ALLOCATION
+#define RTOS_STATIC_ALLOCATION                  0
+#endif
+
+#if RTOS_STATIC_ALLOCATION
+#define configSUPPORT_STATIC_ALLOCATION         1
+#define configSUPPORT_DYNAMIC_ALLOCATION        0
+#else
+#define configSUPPORT_STATIC_ALLOCATION         0
+#define configSUPPORT_DYNAMIC_ALLOCATION        1
+
+/* Heap sized for what the tasks still allocate dynamically: 15 KB of task
+ * and idle stacks, ~1.7 KB of TCBs, semaphores and heap_4 headers, plus
+ * margin. main_rtos.c checks the stacks against it at compile time; the
+ * "stats" console command reports the minimum ever free heap. */
+#define configTOTAL_HEAP_SIZE                   (20 * 1024)
+#endif
+
+/* Explicit so vApplicationGetIdleTaskMemory() has the same signature on every
+ * V11 kernel revision. */
+#define configSTACK_DEPTH_TYPE                  uint32_t
 
 #endif /* FREERTOS_CONFIG_H */
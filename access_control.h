@@ -15,7 +15,6 @@
 #include <stdint.h>
 #include "database.h"
 #include "FreeRTOS.h"
-#include "queue.h"
 
 /**
  * @brief Estados posibles del sistema de control de acceso
@@ -53,6 +52,20 @@ typedef struct {
     uint32_t timestamp;
 } access_event_t;
 
+/**
+ * @brief Resultado de una autenticación, publicado en BUS_TOPIC_AUTH
+ *
+ * Para observadores del acceso (auditoría, estadísticas); no incluye la
+ * contraseña.
+ */
+typedef struct {
+    char user_id[ID_LENGTH + 1]; /**< ID autenticado */
+    uint8_t result;              /**< auth_result_t */
+    uint8_t limited;             /**< Rechazado por el limitador sin verificar (result = AUTH_USER_BLOCKED) */
+    uint32_t timestamp;          /**< Tick de la decisión */
+    uint32_t session_ms;         /**< Tiempo desde el primer dígito del ID hasta la decisión */
+} auth_event_t;
+
 /** @brief Tiempo máximo para completar el proceso de autenticación */
 #define TIMEOUT_MS 10000    
 
@@ -63,7 +76,7 @@ typedef struct {
  * @brief Inicializa el sistema de control de acceso
  * 
  * Configura el estado inicial del sistema, inicializa variables internas,
- * y crea las colas necesarias para comunicación entre tareas.
+ * y se suscribe a las teclas y eventos del bus de eventos.
  * 
  * @return true Si la inicialización fue exitosa
  * @return false Si hubo error en la inicialización
@@ -85,6 +98,8 @@ void access_control_task(void *pvParameters);
  * 
  * @param type Tipo de evento
  * @param key Tecla presionada (solo para KEY_PRESSED)
+ * Se publica en BUS_TOPIC_ACCESS sin bloquear.
+ * 
  * @return true Si el evento se envió exitosamente
  * @return false Si hubo error al enviar el evento
  */
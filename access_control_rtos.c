@@ -10,12 +10,19 @@
 #include "database.h"
 #include "ssd1306_display.h"
 #include "keypad.h"
+#include "trace_recorder.h"
+#include "rate_limiter.h"
+#include "task_health.h"
+#include "system_bus.h"
+#include "input_recorder.h"
 #include <stdio.h>
 #include <string.h>
 #include <ctype.h>
 #include "FreeRTOS.h"
 #include "task.h"
-#include "queue.h"
+
+#define LOG_MODULE ACCESS
+#include "log.h"
 
 /** @brief Buffer para almacenar el ID del usuario */
 static char user_id[ID_LENGTH + 1];
@@ -38,98 +45,157 @@ static int new_password_count;
 /** @brief Estado actual del sistema */
 static system_state_t current_state;
 
-/** @brief Cola para eventos del control de acceso */
-static QueueHandle_t access_control_queue;
+/** @brief Suscripción a teclas y eventos (en orden de llegada) */
+static int access_sub = -1;
+
+_Static_assert(sizeof(access_event_t) <= EB_PAYLOAD_SIZE, "access_event_t no cabe en una ranura del bus");
+_Static_assert(sizeof(auth_event_t) <= EB_PAYLOAD_SIZE, "auth_event_t no cabe en una ranura del bus");
+
+/** @brief true mientras hay un timeout pendiente */
+static bool timeout_armed;
+
+/** @brief Tick en que vence el timeout pendiente */
+static TickType_t timeout_deadline;
+
+/** @brief Evento que se procesa cuando vence el timeout */
+static access_event_type_t timeout_event;
 
-/** @brief Handle de la tarea de timeout */
-static TaskHandle_t timeout_task_handle = NULL;
+/** @brief Limitador de intentos fallidos (global y por ID) */
+static rate_limiter_t rate_limiter;
+
+/** @brief Tick del primer dígito del ID (duración de la sesión) */
+static TickType_t session_start;
 
 /**
- * @brief Tarea para manejar timeouts del sistema
+ * @brief Programa un evento para dentro de timeout_ms (reemplaza al anterior)
+ *
+ * El plazo lo vigila la propia tarea de control de acceso como tiempo de
+ * espera de bus_receive, sin crear tareas auxiliares.
  */
-static void timeout_task(void *pvParameters) {
-    vTaskDelay(pdMS_TO_TICKS(TIMEOUT_MS));
-    
-    // Enviar evento de timeout si la tarea no fue cancelada
-    access_control_send_event(ACCESS_EVENT_TIMEOUT, 0);
-    
-    // La tarea se elimina a sí misma
-    timeout_task_handle = NULL;
-    vTaskDelete(NULL);
+static void arm_timeout(access_event_type_t event, uint32_t timeout_ms) {
+    timeout_event = event;
+    timeout_deadline = xTaskGetTickCount() + pdMS_TO_TICKS(timeout_ms);
+    timeout_armed = true;
 }
 
 /**
  * @brief Inicia el timeout del sistema
  */
 static void start_timeout(void) {
-    if (timeout_task_handle != NULL) {
-        vTaskDelete(timeout_task_handle);
-        timeout_task_handle = NULL;
-    }
-    
-    xTaskCreate(timeout_task, "Timeout", 128, NULL, tskIDLE_PRIORITY + 1, &timeout_task_handle);
+    arm_timeout(ACCESS_EVENT_TIMEOUT, TIMEOUT_MS);
 }
 
 /**
  * @brief Cancela el timeout del sistema
  */
 static void cancel_timeout(void) {
-    if (timeout_task_handle != NULL) {
-        vTaskDelete(timeout_task_handle);
-        timeout_task_handle = NULL;
-    }
+    timeout_armed = false;
 }
 
 /**
- * @brief Tarea para timeout de acceso concedido
+ * @brief Inicia timeout para acceso concedido
  */
-static void granted_timeout_task(void *pvParameters) {
-    vTaskDelay(pdMS_TO_TICKS(5000)); // 5 segundos para acceso concedido
-    
-    // Enviar evento de reset para volver al estado inicial
-    access_control_send_event(ACCESS_EVENT_RESET, 0);
-    
-    // La tarea se elimina a sí misma
-    timeout_task_handle = NULL;
-    vTaskDelete(NULL);
+static void start_granted_timeout(void) {
+    arm_timeout(ACCESS_EVENT_RESET, 5000); // 5 segundos para acceso concedido
 }
 
 /**
- * @brief Tarea para timeout de acceso denegado
+ * @brief Inicia timeout para acceso denegado
  */
-static void denied_timeout_task(void *pvParameters) {
-    vTaskDelay(pdMS_TO_TICKS(3000)); // 3 segundos para acceso denegado
-    
-    // Enviar evento de reset para volver al estado inicial
-    access_control_send_event(ACCESS_EVENT_RESET, 0);
+static void start_denied_timeout(void) {
+    arm_timeout(ACCESS_EVENT_RESET, 3000); // 3 segundos para acceso denegado
+}
+
+/**
+ * @brief Ticks que faltan para el timeout pendiente (0 si ya venció)
+ */
+static TickType_t timeout_remaining(void) {
+    TickType_t remaining = timeout_deadline - xTaskGetTickCount();
     
-    // La tarea se elimina a sí misma
-    timeout_task_handle = NULL;
-    vTaskDelete(NULL);
+    // Diferencia tolerante a desborde: un plazo vencido queda negativo
+    if ((int32_t)remaining <= 0) {
+        return 0;
+    }
+    return remaining;
 }
 
 /**
- * @brief Inicia timeout para acceso concedido
+ * @brief Tiempo actual en milisegundos para el limitador de intentos
  */
-static void start_granted_timeout(void) {
-    if (timeout_task_handle != NULL) {
-        vTaskDelete(timeout_task_handle);
-        timeout_task_handle = NULL;
+static uint32_t now_ms(void) {
+    return (uint32_t)(xTaskGetTickCount() * portTICK_PERIOD_MS);
+}
+
+/**
+ * @brief Publica el resultado de una autenticación para los observadores
+ *
+ * @param result Resultado de la verificación
+ * @param limited true si el limitador rechazó el intento sin verificarlo
+ */
+static void publish_auth_result(auth_result_t result, bool limited) {
+    eb_msg_t *msg = bus_alloc(BUS_TOPIC_AUTH);
+    if (msg == NULL) {
+        return;
     }
     
-    xTaskCreate(granted_timeout_task, "GrantedTimeout", 128, NULL, tskIDLE_PRIORITY + 1, &timeout_task_handle);
+    auth_event_t *event = EB_PAYLOAD(msg, auth_event_t);
+    memcpy(event->user_id, user_id, sizeof(event->user_id));
+    event->result = (uint8_t)result;
+    event->limited = limited ? 1 : 0;
+    event->timestamp = xTaskGetTickCount();
+    event->session_ms = (uint32_t)((event->timestamp - session_start) * portTICK_PERIOD_MS);
+    bus_publish(msg);
 }
 
 /**
- * @brief Inicia timeout para acceso denegado
+ * @brief Consulta el limitador antes de verificar una contraseña
+ *
+ * Si el intento se rechaza, muestra la espera restante y deja el sistema en
+ * STATE_ACCESS_DENIED sin consultar la base de datos.
+ *
+ * @return true si el intento puede procesarse
  */
-static void start_denied_timeout(void) {
-    if (timeout_task_handle != NULL) {
-        vTaskDelete(timeout_task_handle);
-        timeout_task_handle = NULL;
+static bool attempt_allowed(void) {
+    uint32_t wait_ms = 0;
+    rl_decision_t decision = rate_limiter_check(&rate_limiter, user_id, now_ms(), &wait_ms);
+
+    if (decision == RL_ALLOW) {
+        return true;
     }
-    
-    xTaskCreate(denied_timeout_task, "DeniedTimeout", 128, NULL, tskIDLE_PRIORITY + 1, &timeout_task_handle);
+
+    char message[24];
+    uint32_t wait_s = (wait_ms + 999) / 1000;
+    snprintf(message, sizeof(message), "Espere %lus", (unsigned long)wait_s);
+
+    current_state = STATE_ACCESS_DENIED;
+    signal_acceso_denegado();
+    ssd1306_send_command(DISPLAY_MSG_CUSTOM, message, 0);
+    if (decision == RL_DENY_ID) {
+        LOG_WARN("Intento limitado por ID para usuario: %lu - espera %lu ms",
+                 log_decimal(user_id), wait_ms);
+    } else {
+        LOG_WARN("Intento limitado globalmente para usuario: %lu - espera %lu ms",
+                 log_decimal(user_id), wait_ms);
+    }
+    publish_auth_result(AUTH_USER_BLOCKED, true);
+    start_denied_timeout();
+    return false;
+}
+
+/**
+ * @brief La base está ocupada (pendientes llenos o sincronización): vuelve a pedir '#'
+ *
+ * No es un intento: no se informa al limitador ni a las estadísticas, y la
+ * clave ingresada se conserva para reintentar.
+ *
+ * @param retry_state Estado que espera el '#' de la clave
+ */
+static void database_busy(system_state_t retry_state) {
+    current_state = retry_state;
+    signal_esperando_clave();
+    ssd1306_send_command(DISPLAY_MSG_CUSTOM, "Ocupado: pulse #", 0);
+    LOG_WARN("Base ocupada para usuario: %lu - reintentar", log_decimal(user_id));
+    start_timeout();
 }
 
 /**
@@ -153,14 +219,14 @@ static void reset_system(void) {
     signal_sistema_listo();
     ssd1306_send_command(DISPLAY_MSG_STANDBY, NULL, 0);
     
-    printf("Sistema reseteado - Estado: IDLE\n");
+    LOG_INFO("Sistema reseteado - Estado: IDLE");
 }
 
 /**
  * @brief Procesa una tecla presionada según el estado actual
  */
 static void process_key_input(char key) {
-    printf("Estado: %d, Tecla: %c\n", current_state, key);
+    LOG_DEBUG("Estado: %d, Tecla: %c", current_state, key);
     
     switch (current_state) {
         case STATE_IDLE:
@@ -168,20 +234,21 @@ static void process_key_input(char key) {
                 // Modo de cambio de contraseña
                 current_state = STATE_CHANGE_PASSWORD;
                 ssd1306_send_command(DISPLAY_MSG_CHANGE_USER, NULL, 0);
-                printf("Modo cambio de contraseña activado\n");
+                LOG_INFO("Modo cambio de contraseña activado");
             } else if (isdigit(key)) {
                 // Iniciar ingreso de ID
                 current_state = STATE_ENTERING_ID;
                 id_count = 0;
                 user_id[id_count++] = key;
                 user_id[id_count] = '\0';
+                session_start = xTaskGetTickCount();
                 
                 // Apagar LED amarillo cuando se presiona el primer dígito
                 signal_proceso_iniciado(); // Apaga LED amarillo
                 ssd1306_send_command(DISPLAY_MSG_ENTER_ID, NULL, 0);
                 start_timeout();
                 
-                printf("Iniciando ingreso de ID: %s\n", user_id);
+                LOG_INFO("Iniciando ingreso de ID");
             }
             break;
             
@@ -189,7 +256,7 @@ static void process_key_input(char key) {
             if (isdigit(key) && id_count < ID_LENGTH) {
                 user_id[id_count++] = key;
                 user_id[id_count] = '\0';
-                printf("ID actual: %s\n", user_id);
+                LOG_DEBUG("ID: dígito %d de %d", id_count, ID_LENGTH);
             } else if (key == '#' && id_count > 0) {
                 // Confirmar ID y pasar a contraseña
                 current_state = STATE_ENTERING_PASSWORD;
@@ -200,7 +267,7 @@ static void process_key_input(char key) {
                 signal_esperando_clave(); // LED amarillo titilando a 0.5Hz
                 ssd1306_send_command(DISPLAY_MSG_ENTER_PASSWORD, NULL, 0);
                 
-                printf("ID confirmado: %s - Esperando contraseña\n", user_id);
+                LOG_INFO("ID confirmado: %lu - Esperando contraseña", log_decimal(user_id));
             } else if (key == '*') {
                 // Cancelar y volver al inicio
                 reset_system();
@@ -211,11 +278,7 @@ static void process_key_input(char key) {
             if (isdigit(key) && password_count < PASSWORD_LENGTH) {
                 password[password_count++] = key;
                 password[password_count] = '\0';
-                printf("Contraseña: ");
-                for (int i = 0; i < password_count; i++) {
-                    printf("*");
-                }
-                printf("\n");
+                LOG_DEBUG("Contraseña: %d dígitos", password_count);
             } else if (key == '#' && password_count > 0) {
                 // Procesar autenticación
                 current_state = STATE_PROCESSING;
@@ -224,22 +287,37 @@ static void process_key_input(char key) {
                 // Apagar LED amarillo durante procesamiento
                 led_send_command(LED_CMD_AMARILLO_OFF, 0);
                 
-                printf("Procesando autenticación...\n");
+                LOG_DEBUG("Procesando autenticación...");
+                
+                if (!attempt_allowed()) {
+                    break;
+                }
                 
                 // Verificar credenciales
-                if (authenticate_user(user_id, password) == AUTH_SUCCESS) {
+                auth_result_t auth_result = authenticate_user(user_id, password);
+                if (auth_result == AUTH_BUSY) {
+                    database_busy(STATE_ENTERING_PASSWORD);
+                    break;
+                }
+                rate_limiter_report(&rate_limiter, user_id, auth_result == AUTH_SUCCESS, now_ms());
+                publish_auth_result(auth_result, false);
+                if (auth_result == AUTH_SUCCESS) {
                     current_state = STATE_ACCESS_GRANTED;
                     signal_acceso_concedido();
                     ssd1306_send_command(DISPLAY_MSG_WELCOME, NULL, 0);
-                    printf("Acceso CONCEDIDO para usuario: %s\n", user_id);
+                    LOG_INFO("Acceso CONCEDIDO para usuario: %lu", log_decimal(user_id));
                     
                     // Programar reset con timeout task
                     start_granted_timeout();
                 } else {
                     current_state = STATE_ACCESS_DENIED;
-                    signal_acceso_denegado();
+                    if (auth_result == AUTH_USER_BLOCKED) {
+                        signal_usuario_bloqueado();
+                    } else {
+                        signal_acceso_denegado();
+                    }
                     ssd1306_send_command(DISPLAY_MSG_INVALID, NULL, 0);
-                    printf("Acceso DENEGADO para usuario: %s\n", user_id);
+                    LOG_WARN("Acceso DENEGADO para usuario: %lu", log_decimal(user_id));
                     
                     // Programar reset con timeout task
                     start_denied_timeout();
@@ -259,12 +337,13 @@ static void process_key_input(char key) {
                 id_count = 0;
                 user_id[id_count++] = key;
                 user_id[id_count] = '\0';
+                session_start = xTaskGetTickCount();
                 
                 signal_proceso_iniciado(); // Apagar LED amarillo
                 ssd1306_send_command(DISPLAY_MSG_CUSTOM, "ID Usuario:", 0);
                 start_timeout();
                 
-                printf("Cambio contraseña - Ingresando ID: %s\n", user_id);
+                LOG_INFO("Cambio contraseña - Ingresando ID");
             }
             break;
             
@@ -272,7 +351,7 @@ static void process_key_input(char key) {
             if (isdigit(key) && id_count < ID_LENGTH) {
                 user_id[id_count++] = key;
                 user_id[id_count] = '\0';
-                printf("ID para cambio: %s\n", user_id);
+                LOG_DEBUG("ID para cambio: dígito %d de %d", id_count, ID_LENGTH);
             } else if (key == '#' && id_count == ID_LENGTH) {
                 // ID completo, pedir contraseña actual
                 current_state = STATE_CHANGE_ENTERING_OLD_PASS;
@@ -282,7 +361,7 @@ static void process_key_input(char key) {
                 signal_esperando_clave(); // LED amarillo titilando
                 ssd1306_send_command(DISPLAY_MSG_CUSTOM, "Clave Actual:", 0);
                 
-                printf("ID confirmado para cambio: %s - Esperando contraseña actual\n", user_id);
+                LOG_INFO("ID confirmado para cambio: %lu - Esperando contraseña actual", log_decimal(user_id));
             } else if (key == '*') {
                 reset_system();
             }
@@ -292,26 +371,33 @@ static void process_key_input(char key) {
             if (isdigit(key) && password_count < PASSWORD_LENGTH) {
                 password[password_count++] = key;
                 password[password_count] = '\0';
-                printf("Contraseña actual: ");
-                for (int i = 0; i < password_count; i++) {
-                    printf("*");
-                }
-                printf("\n");
+                LOG_DEBUG("Contraseña actual: %d dígitos", password_count);
             } else if (key == '#' && password_count == PASSWORD_LENGTH) {
                 // Verificar contraseña actual antes de permitir cambio
-                if (authenticate_user(user_id, password) == AUTH_SUCCESS) {
+                if (!attempt_allowed()) {
+                    break;
+                }
+                
+                auth_result_t auth_result = authenticate_user(user_id, password);
+                if (auth_result == AUTH_BUSY) {
+                    database_busy(STATE_CHANGE_ENTERING_OLD_PASS);
+                    break;
+                }
+                rate_limiter_report(&rate_limiter, user_id, auth_result == AUTH_SUCCESS, now_ms());
+                publish_auth_result(auth_result, false);
+                if (auth_result == AUTH_SUCCESS) {
                     current_state = STATE_CHANGE_ENTERING_NEW_PASS;
                     new_password_count = 0;
                     memset(new_password, 0, sizeof(new_password));
                     
                     ssd1306_send_command(DISPLAY_MSG_CUSTOM, "Nueva Clave:", 0);
-                    printf("Contraseña actual correcta - Ingrese nueva contraseña\n");
+                    LOG_INFO("Contraseña actual correcta - Ingrese nueva contraseña");
                 } else {
                     // Contraseña actual incorrecta
                     current_state = STATE_ACCESS_DENIED;
                     signal_acceso_denegado();
                     ssd1306_send_command(DISPLAY_MSG_CUSTOM, "Clave Incorrecta", 0);
-                    printf("Contraseña actual incorrecta - Cambio cancelado\n");
+                    LOG_WARN("Contraseña actual incorrecta - Cambio cancelado");
                     start_denied_timeout();
                 }
             } else if (key == '*') {
@@ -323,11 +409,7 @@ static void process_key_input(char key) {
             if (isdigit(key) && new_password_count < PASSWORD_LENGTH) {
                 new_password[new_password_count++] = key;
                 new_password[new_password_count] = '\0';
-                printf("Nueva contraseña: ");
-                for (int i = 0; i < new_password_count; i++) {
-                    printf("*");
-                }
-                printf("\n");
+                LOG_DEBUG("Nueva contraseña: %d dígitos", new_password_count);
             } else if (key == '#' && new_password_count == PASSWORD_LENGTH) {
                 // Nueva contraseña completa, procesar cambio directamente
                 current_state = STATE_CHANGE_PROCESSING;
@@ -335,20 +417,23 @@ static void process_key_input(char key) {
                 
                 led_send_command(LED_CMD_AMARILLO_OFF, 0);
                 
-                printf("Procesando cambio de contraseña...\n");
+                LOG_DEBUG("Procesando cambio de contraseña...");
                 
                 // Realizar cambio de contraseña directamente
-                if (change_user_password(user_id, password, new_password)) {
+                password_result_t change = change_user_password(user_id, password, new_password);
+                if (change == PASSWORD_BUSY) {
+                    database_busy(STATE_CHANGE_ENTERING_NEW_PASS);
+                } else if (change == PASSWORD_CHANGED) {
                     current_state = STATE_ACCESS_GRANTED;
                     signal_acceso_concedido();
                     ssd1306_send_command(DISPLAY_MSG_CUSTOM, "Clave Cambiada", 0);
-                    printf("Contraseña cambiada exitosamente para usuario: %s\n", user_id);
+                    LOG_INFO("Contraseña cambiada exitosamente para usuario: %lu", log_decimal(user_id));
                     start_granted_timeout();
                 } else {
                     current_state = STATE_ACCESS_DENIED;
                     signal_acceso_denegado();
                     ssd1306_send_command(DISPLAY_MSG_CUSTOM, "Error Cambio", 0);
-                    printf("Error al cambiar contraseña para usuario: %s\n", user_id);
+                    LOG_ERROR("Error al cambiar contraseña para usuario: %lu", log_decimal(user_id));
                     start_denied_timeout();
                 }
             } else if (key == '*') {
@@ -374,11 +459,13 @@ bool access_control_init(void) {
     memset(user_id, 0, sizeof(user_id));
     memset(password, 0, sizeof(password));
     memset(new_password, 0, sizeof(new_password));
-    timeout_task_handle = NULL;
+    timeout_armed = false;
+    rate_limiter_init(&rate_limiter, now_ms());
     
-    // Crear cola para eventos
-    access_control_queue = xQueueCreate(5, sizeof(access_event_t));
-    if (access_control_queue == NULL) {
+    // Esperar teclas y eventos en una sola suscripción, sin sondeo periódico
+    access_sub = bus_subscribe("access", BUS_TOPIC_BIT(BUS_TOPIC_KEY) | BUS_TOPIC_BIT(BUS_TOPIC_ACCESS),
+                               0, TRACE_QUEUE_ACCESS);
+    if (access_sub < 0) {
         return false;
     }
     
@@ -389,41 +476,67 @@ bool access_control_init(void) {
     return true;
 }
 
+/**
+ * @brief Procesa un evento del sistema (bus de eventos o timeout vencido)
+ */
+static void process_system_event(access_event_type_t type) {
+    switch (type) {
+        case ACCESS_EVENT_TIMEOUT:
+            LOG_WARN("Timeout del sistema");
+            // LED rojo por 2 segundos para timeout; las teclas se ignoran
+            // en STATE_TIMEOUT hasta el reinicio
+            current_state = STATE_TIMEOUT;
+            led_send_command(LED_CMD_ROJO_ON, 2000);
+            ssd1306_send_command(DISPLAY_MSG_CUSTOM, "TIMEOUT", 2000);
+            arm_timeout(ACCESS_EVENT_RESET, 2000);
+            break;
+            
+        case ACCESS_EVENT_RESET:
+            reset_system();
+            break;
+            
+        default:
+            break;
+    }
+}
+
 /**
  * @brief Tarea de FreeRTOS para el control de acceso
  */
 void access_control_task(void *pvParameters) {
-    access_event_t event;
-    keypad_event_t keypad_event;
-    
     while (1) {
-        // Verificar eventos del teclado
-        if (keypad_get_event(&keypad_event, 100)) {
-            process_key_input(keypad_event.key);
-        }
+        // Bloquear hasta que haya una tecla, un evento o venza el timeout
+        TickType_t wait = timeout_armed ? timeout_remaining() : portMAX_DELAY;
+        const eb_msg_t *msg = bus_receive(access_sub, wait);
+        task_health_begin(HEALTH_ACCESS);
+        system_state_t previous = current_state;
         
-        // Verificar eventos del sistema de control de acceso
-        if (xQueueReceive(access_control_queue, &event, 0) == pdTRUE) {
-            switch (event.type) {
-                case ACCESS_EVENT_TIMEOUT:
-                    printf("Timeout del sistema\n");
-                    // LED rojo por 2 segundos para timeout
-                    led_send_command(LED_CMD_ROJO_ON, 2000);
-                    ssd1306_send_command(DISPLAY_MSG_CUSTOM, "TIMEOUT", 2000);
-                    vTaskDelay(pdMS_TO_TICKS(2000));
-                    reset_system();
-                    break;
-                    
-                case ACCESS_EVENT_RESET:
-                    reset_system();
-                    break;
-                    
-                default:
-                    break;
+        if (msg == NULL) {
+            if (timeout_armed && timeout_remaining() == 0) {
+                timeout_armed = false;
+                input_record(INPUT_EV_TIMEOUT, (uint8_t)timeout_event);
+                process_system_event(timeout_event);
             }
+        } else if (msg->topic == BUS_TOPIC_KEY) {
+            // Tecla del teclado: soltar la ranura antes de procesar
+            char key = EB_PAYLOAD(msg, const keypad_event_t)->key;
+            bus_release(msg);
+            input_record(INPUT_EV_ACCESS_KEY, (uint8_t)key);
+            process_key_input(key);
+        } else {
+            // Evento del sistema de control de acceso
+            access_event_type_t type = EB_PAYLOAD(msg, const access_event_t)->type;
+            bus_release(msg);
+            input_record(INPUT_EV_ACCESS_EVENT, (uint8_t)type);
+            process_system_event(type);
+        }
+        
+        // Trayectoria para tools/replay
+        if (current_state != previous) {
+            input_record(INPUT_EV_ACCESS_STATE, (uint8_t)current_state);
         }
         
-        vTaskDelay(pdMS_TO_TICKS(50));
+        task_health_end(HEALTH_ACCESS);
     }
 }
 
@@ -431,17 +544,17 @@ void access_control_task(void *pvParameters) {
  * @brief Envía un evento al sistema de control de acceso
  */
 bool access_control_send_event(access_event_type_t type, char key) {
-    if (access_control_queue == NULL) {
+    eb_msg_t *msg = bus_alloc(BUS_TOPIC_ACCESS);
+    if (msg == NULL) {
         return false;
     }
     
-    access_event_t event = {
-        .type = type,
-        .key = key,
-        .timestamp = xTaskGetTickCount()
-    };
+    access_event_t *event = EB_PAYLOAD(msg, access_event_t);
+    event->type = type;
+    event->key = key;
+    event->timestamp = xTaskGetTickCount();
     
-    return xQueueSend(access_control_queue, &event, pdMS_TO_TICKS(100)) == pdTRUE;
+    return bus_publish(msg);
 }
 
 /**
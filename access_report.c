@@ -0,0 +1,240 @@
+/**
+ * @file access_report.c
+ * @brief Implementación de las estadísticas de acceso sobre FreeRTOS
+ * @author Sistema de Control de Acceso
+ * @date 2025
+ */
+
+#include "access_report.h"
+#include "access_stats.h"
+#include "access_control.h"
+#include "database.h"
+#include "keypad.h"
+#include "system_bus.h"
+#include "time_service.h"
+#include <stdio.h>
+#include "FreeRTOS.h"
+#include "task.h"
+
+_Static_assert(AS_ID_LENGTH == ID_LENGTH, "AS_ID_LENGTH debe coincidir con ID_LENGTH");
+
+/** @brief Nombres de los resultados para reportes */
+static const char *const outcome_names[AS_OUTCOMES] = {
+    [AS_GRANTED] = "granted",
+    [AS_DENIED]  = "denied",
+    [AS_BLOCKED] = "blocked",
+    [AS_LIMITED] = "limited",
+};
+
+/** @brief Estadísticas (escritas por la tarea Stats, protegidas por sección crítica) */
+static access_stats_t stats;
+
+/** @brief Copia para imprimir sin mantener la sección crítica */
+static access_stats_t snapshot;
+
+/** @brief Suscriptor de BUS_TOPIC_AUTH */
+static int stats_sub = -1;
+
+/**
+ * @brief Hora absoluta actual según el servicio de tiempo
+ */
+static uint32_t current_abs_hour(void) {
+    datetime_t now;
+    time_service_get(&now);
+    return as_abs_hour(now.year, now.month, now.day, now.hour);
+}
+
+/**
+ * @brief Resultado de las estadísticas para un evento de autenticación
+ */
+static as_outcome_t event_outcome(const auth_event_t *event) {
+    if (event->limited) {
+        return AS_LIMITED;
+    }
+    switch ((auth_result_t)event->result) {
+        case AUTH_SUCCESS:
+            return AS_GRANTED;
+        case AUTH_USER_BLOCKED:
+            return AS_BLOCKED;
+        default:
+            return AS_DENIED;
+    }
+}
+
+/**
+ * @brief Inicializa las estadísticas y se suscribe a los resultados de autenticación
+ */
+bool access_report_init(void) {
+    as_init(&stats);
+
+    stats_sub = bus_subscribe("stats", BUS_TOPIC_BIT(BUS_TOPIC_AUTH), 0, TRACE_QUEUE_NONE);
+    return stats_sub >= 0;
+}
+
+/**
+ * @brief Tarea de FreeRTOS que registra cada resultado de autenticación
+ */
+void access_report_task(void *pvParameters) {
+    (void)pvParameters;
+
+    while (1) {
+        uint32_t due_ms = database_flush_due_ms();
+        TickType_t wait = portMAX_DELAY;
+        if (due_ms != DATABASE_FLUSH_NONE) {
+            wait = pdMS_TO_TICKS(due_ms < ACCESS_REPORT_FLUSH_RETRY_MS ? due_ms
+                                                                       : ACCESS_REPORT_FLUSH_RETRY_MS);
+        }
+        const eb_msg_t *msg = bus_receive(stats_sub, wait);
+
+        if (msg != NULL) {
+            auth_event_t event = *EB_PAYLOAD(msg, const auth_event_t);
+            bus_release(msg);
+
+            uint32_t hour = current_abs_hour();
+            taskENTER_CRITICAL();
+            as_record(&stats, event.user_id, event_outcome(&event), hour, event.session_ms);
+            taskEXIT_CRITICAL();
+        }
+
+        // Escribir fuera del camino de la autenticación: con el teclado en
+        // reposo o, para intentos fallidos y plazos vencidos, enseguida
+        if (database_pending() > 0 && (keypad_is_idle() || database_flush_due_ms() == 0)) {
+            database_flush();
+        }
+    }
+}
+
+/**
+ * @brief Imprime las estadísticas en una línea JSON
+ *
+ * Incluye el histograma de sesiones y el sketch completo para que el host
+ * calcule cuantiles y estimaciones de cualquier ID.
+ */
+static void print_json(uint32_t now_hour) {
+    const as_sessions_t *ss = &snapshot.sessions;
+
+    printf("{\"now_hour\":%lu,\"totals\":{", (unsigned long)now_hour);
+    for (int o = 0; o < AS_OUTCOMES; o++) {
+        printf("%s\"%s\":%lu", (o > 0) ? "," : "", outcome_names[o],
+               (unsigned long)snapshot.totals[o]);
+    }
+
+    // Horas del anillo de la más antigua a la actual: [hora, g, d, b, l]
+    printf("},\"hours\":[");
+    bool first = true;
+    for (uint32_t h = now_hour - (AS_HOURS - 1); h != now_hour + 1; h++) {
+        const as_hour_t *bucket = as_hour(&snapshot, h);
+        if (bucket == NULL) {
+            continue;
+        }
+        printf("%s[%lu", first ? "" : ",", (unsigned long)h);
+        for (int o = 0; o < AS_OUTCOMES; o++) {
+            printf(",%u", bucket->count[o]);
+        }
+        printf("]");
+        first = false;
+    }
+
+    printf("],\"hour_of_day\":[");
+    for (int h = 0; h < 24; h++) {
+        printf("%s%lu", (h > 0) ? "," : "", (unsigned long)snapshot.hour_of_day[h]);
+    }
+
+    printf("],\"top_denied\":[");
+    first = true;
+    for (int i = 0; i < AS_TOP_IDS; i++) {
+        if (snapshot.top[i].id[0] == '\0') {
+            continue;
+        }
+        printf("%s{\"id\":\"%s\",\"estimate\":%u}", first ? "" : ",",
+               snapshot.top[i].id, as_cms_estimate(&snapshot, snapshot.top[i].id));
+        first = false;
+    }
+
+    printf("],\"sessions\":{\"count\":%lu,\"sum_ms\":%llu,\"min_ms\":%lu,\"max_ms\":%lu,\"floors_ms\":[",
+           (unsigned long)ss->count, (unsigned long long)ss->sum_ms,
+           (unsigned long)ss->min_ms, (unsigned long)ss->max_ms);
+    for (int b = 0; b < AS_SESSION_BUCKETS; b++) {
+        printf("%s%lu", (b > 0) ? "," : "", (unsigned long)as_session_bucket_floor(b));
+    }
+    printf("],\"hist\":[");
+    for (int b = 0; b < AS_SESSION_BUCKETS; b++) {
+        printf("%s%lu", (b > 0) ? "," : "", (unsigned long)ss->hist[b]);
+    }
+
+    printf("]},\"cms\":[");
+    for (int row = 0; row < AS_CMS_DEPTH; row++) {
+        printf("%s[", (row > 0) ? "," : "");
+        for (int col = 0; col < AS_CMS_WIDTH; col++) {
+            printf("%s%u", (col > 0) ? "," : "", snapshot.cms[row][col]);
+        }
+        printf("]");
+    }
+    printf("]}\n");
+}
+
+/**
+ * @brief Imprime un resumen legible de las estadísticas
+ */
+static void print_text(uint32_t now_hour) {
+    const as_sessions_t *ss = &snapshot.sessions;
+
+    printf("\n=== ESTADÍSTICAS DE ACCESO ===\n");
+    printf("Totales: %lu concedidos, %lu denegados, %lu bloqueados, %lu limitados\n",
+           (unsigned long)snapshot.totals[AS_GRANTED], (unsigned long)snapshot.totals[AS_DENIED],
+           (unsigned long)snapshot.totals[AS_BLOCKED], (unsigned long)snapshot.totals[AS_LIMITED]);
+
+    printf("Últimas 24 horas:\n");
+    printf("%-6s %10s %10s %10s %10s\n", "Hora", "Concedidos", "Denegados", "Bloqueados", "Limitados");
+    for (uint32_t h = now_hour - 23; h != now_hour + 1; h++) {
+        const as_hour_t *bucket = as_hour(&snapshot, h);
+        if (bucket == NULL) {
+            continue;
+        }
+        printf("%02lu:00  %10u %10u %10u %10u\n", (unsigned long)(h % 24),
+               bucket->count[AS_GRANTED], bucket->count[AS_DENIED],
+               bucket->count[AS_BLOCKED], bucket->count[AS_LIMITED]);
+    }
+
+    int peak = as_peak_hour_of_day(&snapshot);
+    if (peak >= 0) {
+        printf("Hora pico: %02d:00 (%lu intentos)\n", peak, (unsigned long)snapshot.hour_of_day[peak]);
+    }
+
+    printf("IDs más negados (estimación):");
+    for (int i = 0; i < AS_TOP_IDS; i++) {
+        if (snapshot.top[i].id[0] != '\0') {
+            printf(" %s=%u", snapshot.top[i].id, as_cms_estimate(&snapshot, snapshot.top[i].id));
+        }
+    }
+    printf("\n");
+
+    if (ss->count > 0) {
+        printf("Sesiones: %lu, promedio %lu ms, p50 %lu ms, p90 %lu ms, p99 %lu ms, máx. %lu ms\n",
+               (unsigned long)ss->count, (unsigned long)(ss->sum_ms / ss->count),
+               (unsigned long)as_session_quantile(&snapshot, 500),
+               (unsigned long)as_session_quantile(&snapshot, 900),
+               (unsigned long)as_session_quantile(&snapshot, 990),
+               (unsigned long)ss->max_ms);
+    } else {
+        printf("Sesiones: sin datos\n");
+    }
+    printf("\n");
+}
+
+/**
+ * @brief Imprime las estadísticas de acceso
+ */
+void access_report_print(bool json) {
+    uint32_t now_hour = current_abs_hour();
+
+    taskENTER_CRITICAL();
+    snapshot = stats;
+    taskEXIT_CRITICAL();
+
+    if (json) {
+        print_json(now_hour);
+    } else {
+        print_text(now_hour);
+    }
+}
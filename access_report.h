@@ -0,0 +1,49 @@
+/**
+ * @file access_report.h
+ * @brief Estadísticas de acceso del sistema sobre FreeRTOS
+ * @author Sistema de Control de Acceso
+ * @date 2025
+ *
+ * La tarea "Stats" observa BUS_TOPIC_AUTH y actualiza las estadísticas de
+ * access_stats.h con la hora del servicio de tiempo, fuera del camino del
+ * control de acceso. El comando "access [json]" de la consola las exporta;
+ * tools/access_stats.py las consulta en el host sin reprocesar el log.
+ *
+ * Después de cada resultado la misma tarea escribe en la flash los cambios
+ * que dejó la autenticación (database_flush). Los intentos fallidos y los
+ * bloqueos se escriben enseguida, para que un corte de energía no reinicie
+ * los contadores; el resto espera al teclado en reposo, porque el borrado
+ * de un sector deshabilita las interrupciones y no debe caer en medio de
+ * una tecla, pero nunca más de DATABASE_FLUSH_DEADLINE_MS.
+ */
+
+#ifndef ACCESS_REPORT_H
+#define ACCESS_REPORT_H
+
+#include <stdbool.h>
+
+/** @brief Revisión de la escritura pendiente mientras el teclado está activo */
+#define ACCESS_REPORT_FLUSH_RETRY_MS 200
+
+/**
+ * @brief Inicializa las estadísticas y se suscribe a los resultados de autenticación
+ *
+ * @return true si la inicialización fue exitosa
+ */
+bool access_report_init(void);
+
+/**
+ * @brief Tarea de FreeRTOS que registra cada resultado de autenticación
+ *
+ * @param pvParameters Parámetros de la tarea (no utilizados)
+ */
+void access_report_task(void *pvParameters);
+
+/**
+ * @brief Imprime las estadísticas de acceso
+ *
+ * @param json true para una línea JSON completa (con el sketch), false para un resumen legible
+ */
+void access_report_print(bool json);
+
+#endif // ACCESS_REPORT_H
@@ -0,0 +1,289 @@
+/**
+ * @file access_stats.c
+ * @brief Implementación de las estadísticas incrementales de acceso
+ * @author Sistema de Control de Acceso
+ * @date 2025
+ */
+
+#include "access_stats.h"
+#include <string.h>
+
+_Static_assert((AS_CMS_WIDTH & (AS_CMS_WIDTH - 1)) == 0, "AS_CMS_WIDTH debe ser potencia de 2");
+_Static_assert(AS_HOURS >= 24, "El anillo debe cubrir al menos un día");
+
+/**
+ * @brief Límite inferior de cada cubeta de sesión en milisegundos
+ *
+ * Dos cubetas por cada duplicación (x1 y x1,5): el error relativo de un
+ * cuantil queda acotado a la mitad del ancho de la cubeta.
+ */
+static const uint32_t session_floor_ms[AS_SESSION_BUCKETS] = {
+    0, 500, 1000, 1500, 2000, 3000, 4000, 6000,
+    8000, 12000, 16000, 24000, 32000, 48000, 64000, 96000,
+};
+
+/**
+ * @brief Suma saturada de contadores de 16 bits
+ */
+static inline void inc16(uint16_t *counter) {
+    if (*counter < UINT16_MAX) {
+        (*counter)++;
+    }
+}
+
+/**
+ * @brief Hash FNV-1a del ID (el mismo que usa tools/access_stats.py)
+ */
+static uint32_t id_hash(const char *id) {
+    uint32_t h = 2166136261u;
+    while (*id) {
+        h ^= (uint8_t)*id++;
+        h *= 16777619u;
+    }
+    return h;
+}
+
+/**
+ * @brief Columna de cada fila del sketch (doble hash: h1 + fila * h2)
+ */
+static void cms_columns(const char *id, uint32_t cols[AS_CMS_DEPTH]) {
+    uint32_t h = id_hash(id);
+    uint32_t h2 = (h >> 16) | 1u;
+
+    for (int row = 0; row < AS_CMS_DEPTH; row++) {
+        cols[row] = (h + (uint32_t)row * h2) & (AS_CMS_WIDTH - 1);
+    }
+}
+
+/**
+ * @brief Suma una negación al sketch con actualización conservadora
+ *
+ * Solo se incrementan los contadores que están en el mínimo: la
+ * estimación sigue siendo una cota superior y crece menos por colisiones.
+ *
+ * @return Nueva estimación del ID
+ */
+static uint16_t cms_add(access_stats_t *s, const char *id) {
+    uint32_t cols[AS_CMS_DEPTH];
+    uint16_t min = UINT16_MAX;
+
+    cms_columns(id, cols);
+    for (int row = 0; row < AS_CMS_DEPTH; row++) {
+        if (s->cms[row][cols[row]] < min) {
+            min = s->cms[row][cols[row]];
+        }
+    }
+    for (int row = 0; row < AS_CMS_DEPTH; row++) {
+        if (s->cms[row][cols[row]] == min) {
+            inc16(&s->cms[row][cols[row]]);
+        }
+    }
+    return (min < UINT16_MAX) ? (uint16_t)(min + 1) : min;
+}
+
+/**
+ * @brief Actualiza la lista de IDs más negados
+ *
+ * Si el ID ya está se actualiza su estimación; si no, reemplaza al de
+ * menor estimación cuando lo supera (las entradas libres valen 0).
+ */
+static void top_update(access_stats_t *s, const char *id, uint16_t estimate) {
+    int lowest = 0;
+
+    for (int i = 0; i < AS_TOP_IDS; i++) {
+        if (strcmp(s->top[i].id, id) == 0) {
+            s->top[i].estimate = estimate;
+            return;
+        }
+        if (s->top[i].estimate < s->top[lowest].estimate) {
+            lowest = i;
+        }
+    }
+
+    if (estimate > s->top[lowest].estimate) {
+        strncpy(s->top[lowest].id, id, AS_ID_LENGTH);
+        s->top[lowest].id[AS_ID_LENGTH] = '\0';
+        s->top[lowest].estimate = estimate;
+    }
+}
+
+/**
+ * @brief Suma una sesión a la distribución
+ */
+static void session_add(as_sessions_t *ss, uint32_t session_ms) {
+    if (ss->count == 0 || session_ms < ss->min_ms) {
+        ss->min_ms = session_ms;
+    }
+    if (session_ms > ss->max_ms) {
+        ss->max_ms = session_ms;
+    }
+    ss->count++;
+    ss->sum_ms += session_ms;
+    ss->hist[as_session_bucket(session_ms)]++;
+}
+
+/**
+ * @brief Inicializa las estadísticas vacías
+ */
+void as_init(access_stats_t *s) {
+    memset(s, 0, sizeof(*s));
+    for (int i = 0; i < AS_HOURS; i++) {
+        s->hours[i].hour = AS_HOUR_NONE;
+    }
+}
+
+/**
+ * @brief Hora absoluta (horas desde 2000-01-01 00:00) de una fecha
+ *
+ * Días desde la época civil sin tablas: el año se corre a marzo para que
+ * el día bisiesto quede al final.
+ */
+uint32_t as_abs_hour(int year, int month, int day, int hour) {
+    int y = year - (month <= 2);
+    int era = y / 400;
+    int yoe = y - era * 400;
+    int doy = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    int doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    int32_t days = era * 146097 + doe - 730425;     // días desde 2000-01-01
+
+    if (days < 0) {
+        return 0;
+    }
+    return (uint32_t)days * 24u + (uint32_t)hour;
+}
+
+/**
+ * @brief Registra un intento
+ */
+void as_record(access_stats_t *s, const char *id, as_outcome_t outcome,
+               uint32_t abs_hour, uint32_t session_ms) {
+    if (outcome >= AS_OUTCOMES) {
+        return;
+    }
+
+    // Cubeta horaria: se reutiliza cuando el anillo da la vuelta
+    as_hour_t *bucket = &s->hours[abs_hour % AS_HOURS];
+    if (bucket->hour != abs_hour) {
+        memset(bucket, 0, sizeof(*bucket));
+        bucket->hour = abs_hour;
+    }
+    inc16(&bucket->count[outcome]);
+
+    s->hour_of_day[abs_hour % 24]++;
+    s->totals[outcome]++;
+
+    if (outcome != AS_GRANTED && id != NULL && id[0] != '\0') {
+        top_update(s, id, cms_add(s, id));
+    }
+
+    if (session_ms > 0) {
+        session_add(&s->sessions, session_ms);
+    }
+}
+
+/**
+ * @brief Cubeta horaria de una hora absoluta
+ */
+const as_hour_t *as_hour(const access_stats_t *s, uint32_t abs_hour) {
+    const as_hour_t *bucket = &s->hours[abs_hour % AS_HOURS];
+    return (abs_hour != AS_HOUR_NONE && bucket->hour == abs_hour) ? bucket : NULL;
+}
+
+/**
+ * @brief Hora del día con más intentos, o -1 si no hubo ninguno
+ */
+int as_peak_hour_of_day(const access_stats_t *s) {
+    int peak = -1;
+    uint32_t best = 0;
+
+    for (int h = 0; h < 24; h++) {
+        if (s->hour_of_day[h] > best) {
+            best = s->hour_of_day[h];
+            peak = h;
+        }
+    }
+    return peak;
+}
+
+/**
+ * @brief Negaciones estimadas de un ID (cota superior)
+ */
+uint16_t as_cms_estimate(const access_stats_t *s, const char *id) {
+    uint32_t cols[AS_CMS_DEPTH];
+    uint16_t min = UINT16_MAX;
+
+    cms_columns(id, cols);
+    for (int row = 0; row < AS_CMS_DEPTH; row++) {
+        if (s->cms[row][cols[row]] < min) {
+            min = s->cms[row][cols[row]];
+        }
+    }
+    return min;
+}
+
+/**
+ * @brief Límite inferior en milisegundos de una cubeta de sesión
+ */
+uint32_t as_session_bucket_floor(int bucket) {
+    if (bucket < 0 || bucket >= AS_SESSION_BUCKETS) {
+        return 0;
+    }
+    return session_floor_ms[bucket];
+}
+
+/**
+ * @brief Cubeta de sesión para una duración en milisegundos
+ */
+int as_session_bucket(uint32_t session_ms) {
+    int bucket = AS_SESSION_BUCKETS - 1;
+    while (bucket > 0 && session_ms < session_floor_ms[bucket]) {
+        bucket--;
+    }
+    return bucket;
+}
+
+/**
+ * @brief Cuantil de la duración de sesión
+ *
+ * Ubica la cubeta que contiene el rango pedido e interpola linealmente
+ * entre sus límites; la última cubeta es abierta y usa el máximo
+ * observado. El resultado se acota al mínimo y máximo exactos.
+ */
+uint32_t as_session_quantile(const access_stats_t *s, uint32_t permille) {
+    const as_sessions_t *ss = &s->sessions;
+
+    if (ss->count == 0) {
+        return 0;
+    }
+    if (permille > 1000) {
+        permille = 1000;
+    }
+
+    // Rango (1..count) de la sesión buscada
+    uint64_t rank = ((uint64_t)ss->count * permille + 999) / 1000;
+    if (rank == 0) {
+        rank = 1;
+    }
+
+    uint64_t seen = 0;
+    for (int b = 0; b < AS_SESSION_BUCKETS; b++) {
+        if (ss->hist[b] == 0 || seen + ss->hist[b] < rank) {
+            seen += ss->hist[b];
+            continue;
+        }
+
+        uint32_t lo = session_floor_ms[b];
+        uint32_t hi = (b + 1 < AS_SESSION_BUCKETS) ? session_floor_ms[b + 1] : ss->max_ms;
+        if (lo < ss->min_ms) {
+            lo = ss->min_ms;
+        }
+        if (hi > ss->max_ms) {
+            hi = ss->max_ms;
+        }
+        if (hi < lo) {
+            hi = lo;
+        }
+        return lo + (uint32_t)((uint64_t)(hi - lo) * (rank - seen) / ss->hist[b]);
+    }
+    return ss->max_ms;
+}
@@ -0,0 +1,168 @@
+/**
+ * @file access_stats.h
+ * @brief Estadísticas incrementales de acceso en memoria fija
+ * @author Sistema de Control de Acceso
+ * @date 2025
+ *
+ * Cada decisión de acceso actualiza en tiempo constante tres estructuras de
+ * tamaño fijo, sin guardar los eventos:
+ *
+ * - Un anillo de AS_HOURS cubetas horarias con concesiones, rechazos,
+ *   bloqueos e intentos limitados. Cada cubeta lleva la hora absoluta que
+ *   contiene y se reutiliza al llegar una hora nueva, así que las horas
+ *   sin tráfico no cuestan nada. Además se acumula el total por hora del
+ *   día para obtener la hora pico.
+ * - Un count-min sketch (AS_CMS_DEPTH x AS_CMS_WIDTH contadores) con las
+ *   negaciones por ID, con actualización conservadora, y una lista de los
+ *   AS_TOP_IDS IDs con mayor estimación. La estimación nunca es menor que
+ *   el valor real.
+ * - Un histograma de duración de sesión (del primer dígito a la decisión)
+ *   con cubetas de crecimiento geométrico, más cantidad, suma, mínimo y
+ *   máximo exactos; los cuantiles se interpolan dentro de la cubeta.
+ *
+ * El módulo no depende de FreeRTOS ni del SDK: el llamador entrega la hora
+ * absoluta (as_abs_hour) y la duración en milisegundos, y serializa el
+ * acceso. tools/access_stats.py reproduce el hash y los cuantiles a partir
+ * del volcado JSON de la consola.
+ */
+
+#ifndef ACCESS_STATS_H
+#define ACCESS_STATS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/** @brief Horas conservadas en el anillo */
+#define AS_HOURS            48
+
+/** @brief Filas del count-min sketch (funciones de hash) */
+#define AS_CMS_DEPTH        4
+
+/** @brief Contadores por fila (potencia de 2) */
+#define AS_CMS_WIDTH        64
+
+/** @brief IDs más negados que se conservan */
+#define AS_TOP_IDS          5
+
+/** @brief Longitud máxima de un ID (igual a ID_LENGTH del control de acceso) */
+#define AS_ID_LENGTH        6
+
+/** @brief Cubetas del histograma de duración de sesión */
+#define AS_SESSION_BUCKETS  16
+
+/** @brief Hora absoluta de una cubeta sin usar */
+#define AS_HOUR_NONE        UINT32_MAX
+
+/**
+ * @brief Resultado de un intento
+ */
+typedef enum {
+    AS_GRANTED,         /**< Acceso concedido */
+    AS_DENIED,          /**< Credenciales inválidas */
+    AS_BLOCKED,         /**< Usuario bloqueado */
+    AS_LIMITED,         /**< Rechazado por el limitador sin verificar la contraseña */
+    AS_OUTCOMES
+} as_outcome_t;
+
+/**
+ * @brief Cubeta horaria del anillo
+ */
+typedef struct {
+    uint32_t hour;                      /**< Hora absoluta (AS_HOUR_NONE = libre) */
+    uint16_t count[AS_OUTCOMES];        /**< Intentos por resultado */
+} as_hour_t;
+
+/**
+ * @brief Candidato a ID más negado
+ */
+typedef struct {
+    char id[AS_ID_LENGTH + 1];          /**< ID ("" = libre) */
+    uint16_t estimate;                  /**< Estimación del sketch al actualizarlo */
+} as_top_t;
+
+/**
+ * @brief Duración de las sesiones
+ */
+typedef struct {
+    uint32_t count;                     /**< Sesiones medidas */
+    uint32_t min_ms;                    /**< Sesión más corta */
+    uint32_t max_ms;                    /**< Sesión más larga */
+    uint64_t sum_ms;                    /**< Suma para el promedio */
+    uint32_t hist[AS_SESSION_BUCKETS];  /**< Sesiones por cubeta (as_session_bucket) */
+} as_sessions_t;
+
+/**
+ * @brief Estado completo de las estadísticas
+ */
+typedef struct {
+    as_hour_t hours[AS_HOURS];          /**< Anillo indexado por hora % AS_HOURS */
+    uint32_t hour_of_day[24];           /**< Intentos por hora del día desde el arranque */
+    uint32_t totals[AS_OUTCOMES];       /**< Intentos por resultado desde el arranque */
+    uint16_t cms[AS_CMS_DEPTH][AS_CMS_WIDTH]; /**< Negaciones por ID (count-min) */
+    as_top_t top[AS_TOP_IDS];           /**< IDs con mayor estimación */
+    as_sessions_t sessions;
+} access_stats_t;
+
+/**
+ * @brief Inicializa las estadísticas vacías
+ */
+void as_init(access_stats_t *s);
+
+/**
+ * @brief Hora absoluta (horas desde 2000-01-01 00:00) de una fecha
+ *
+ * @param year Año (2000 en adelante)
+ * @param month Mes (1-12)
+ * @param day Día (1-31)
+ * @param hour Hora (0-23)
+ */
+uint32_t as_abs_hour(int year, int month, int day, int hour);
+
+/**
+ * @brief Registra un intento
+ *
+ * @param s Estadísticas
+ * @param id ID ingresado (terminado en '\0')
+ * @param outcome Resultado
+ * @param abs_hour Hora absoluta del intento (as_abs_hour)
+ * @param session_ms Duración de la sesión (0 = no medida)
+ */
+void as_record(access_stats_t *s, const char *id, as_outcome_t outcome,
+               uint32_t abs_hour, uint32_t session_ms);
+
+/**
+ * @brief Cubeta horaria de una hora absoluta
+ *
+ * @return Cubeta, o NULL si esa hora ya salió del anillo o no tuvo intentos
+ */
+const as_hour_t *as_hour(const access_stats_t *s, uint32_t abs_hour);
+
+/**
+ * @brief Hora del día con más intentos, o -1 si no hubo ninguno
+ */
+int as_peak_hour_of_day(const access_stats_t *s);
+
+/**
+ * @brief Negaciones estimadas de un ID (cota superior)
+ */
+uint16_t as_cms_estimate(const access_stats_t *s, const char *id);
+
+/**
+ * @brief Límite inferior en milisegundos de una cubeta de sesión
+ */
+uint32_t as_session_bucket_floor(int bucket);
+
+/**
+ * @brief Cubeta de sesión para una duración en milisegundos
+ */
+int as_session_bucket(uint32_t session_ms);
+
+/**
+ * @brief Cuantil de la duración de sesión
+ *
+ * @param permille Cuantil en milésimas (500 = mediana)
+ * @return Duración estimada en milisegundos (0 si no hay sesiones)
+ */
+uint32_t as_session_quantile(const access_stats_t *s, uint32_t permille);
+
+#endif // ACCESS_STATS_H
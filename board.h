@@ -0,0 +1,165 @@
+/**
+ * @file board.h
+ * @brief Descripción de la placa: asignación de pines y máscaras GPIO
+ * @author Sistema de Control de Acceso
+ * @date 2025
+ *
+ * Único lugar donde se asignan los pines del teclado, los LEDs y el I2C
+ * del display. A partir de esa asignación se calculan en tiempo de
+ * compilación las máscaras de cada grupo y las tablas de conversión que
+ * usan la ISR del teclado y las escrituras enmascaradas de columnas y
+ * LEDs. Un pin repetido, fuera de rango o incompatible con el periférico
+ * detiene la compilación.
+ *
+ * Solo contiene expresiones constantes: no depende del SDK.
+ */
+
+#ifndef BOARD_H
+#define BOARD_H
+
+#include <stdint.h>
+
+/** @brief GPIO disponibles en el banco 0 del RP2040 */
+#define BOARD_NUM_GPIOS             30
+
+/* ---- Asignación de pines -------------------------------------------- */
+
+/** @brief Filas del teclado (entradas con pull-up e IRQ por flanco) */
+#define BOARD_KEYPAD_ROW0_PIN       6
+#define BOARD_KEYPAD_ROW1_PIN       7
+#define BOARD_KEYPAD_ROW2_PIN       8
+#define BOARD_KEYPAD_ROW3_PIN       9
+
+/** @brief Columnas del teclado (salidas, en bajo en reposo) */
+#define BOARD_KEYPAD_COL0_PIN       10
+#define BOARD_KEYPAD_COL1_PIN       11
+#define BOARD_KEYPAD_COL2_PIN       12
+#define BOARD_KEYPAD_COL3_PIN       13
+
+/** @brief LEDs de señalización (en el orden de los bits LED_BIT_*) */
+#define BOARD_LED_VERDE_PIN         15
+#define BOARD_LED_ROJO_PIN          16
+#define BOARD_LED_AMARILLO_PIN      17
+
+/** @brief Bus I2C compartido (display SSD1306 y demás clientes de i2c_bus.c) */
+#define BOARD_I2C                   i2c0
+#define BOARD_I2C_INDEX             0
+#define BOARD_I2C_SDA_PIN           4
+#define BOARD_I2C_SCL_PIN           5
+#define BOARD_I2C_KHZ               400
+
+/* ---- Máscaras derivadas ---------------------------------------------- */
+
+#define BOARD_BIT(pin)              (1u << (pin))
+
+#define BOARD_KEYPAD_ROWS           4
+#define BOARD_KEYPAD_COLS           4
+#define BOARD_NUM_LEDS              3
+
+#define BOARD_KEYPAD_ROW_MASK (BOARD_BIT(BOARD_KEYPAD_ROW0_PIN) | BOARD_BIT(BOARD_KEYPAD_ROW1_PIN) | \
+                               BOARD_BIT(BOARD_KEYPAD_ROW2_PIN) | BOARD_BIT(BOARD_KEYPAD_ROW3_PIN))
+
+#define BOARD_KEYPAD_COL_MASK (BOARD_BIT(BOARD_KEYPAD_COL0_PIN) | BOARD_BIT(BOARD_KEYPAD_COL1_PIN) | \
+                               BOARD_BIT(BOARD_KEYPAD_COL2_PIN) | BOARD_BIT(BOARD_KEYPAD_COL3_PIN))
+
+#define BOARD_LED_MASK        (BOARD_BIT(BOARD_LED_VERDE_PIN) | BOARD_BIT(BOARD_LED_ROJO_PIN) | \
+                               BOARD_BIT(BOARD_LED_AMARILLO_PIN))
+
+#define BOARD_I2C_MASK        (BOARD_BIT(BOARD_I2C_SDA_PIN) | BOARD_BIT(BOARD_I2C_SCL_PIN))
+
+/* ---- Tablas de conversión (expresiones constantes) ------------------- */
+
+/** @brief Fila conectada a un GPIO, o -1 si no es una fila */
+#define BOARD_GPIO_TO_ROW(g)                            \
+    ((g) == BOARD_KEYPAD_ROW0_PIN ? 0 :                 \
+     (g) == BOARD_KEYPAD_ROW1_PIN ? 1 :                 \
+     (g) == BOARD_KEYPAD_ROW2_PIN ? 2 :                 \
+     (g) == BOARD_KEYPAD_ROW3_PIN ? 3 : -1)
+
+/** @brief Pin de una fila o columna por índice */
+#define BOARD_ROW_PIN(r)                                \
+    ((r) == 0 ? BOARD_KEYPAD_ROW0_PIN : (r) == 1 ? BOARD_KEYPAD_ROW1_PIN : \
+     (r) == 2 ? BOARD_KEYPAD_ROW2_PIN : BOARD_KEYPAD_ROW3_PIN)
+#define BOARD_COL_PIN(c)                                \
+    ((c) == 0 ? BOARD_KEYPAD_COL0_PIN : (c) == 1 ? BOARD_KEYPAD_COL1_PIN : \
+     (c) == 2 ? BOARD_KEYPAD_COL2_PIN : BOARD_KEYPAD_COL3_PIN)
+
+/** @brief Valor GPIO de los LEDs para una máscara LED_BIT_* (bit 0 = verde) */
+#define BOARD_LED_BITS_TO_GPIO(b)                                   \
+    ((((b) & 1u) ? BOARD_BIT(BOARD_LED_VERDE_PIN) : 0u) |           \
+     (((b) & 2u) ? BOARD_BIT(BOARD_LED_ROJO_PIN) : 0u) |            \
+     (((b) & 4u) ? BOARD_BIT(BOARD_LED_AMARILLO_PIN) : 0u))
+
+/** @brief Repite una expresión para cada GPIO del banco 0 */
+#define BOARD_FOR_EACH_GPIO(X)                                      \
+    X(0),  X(1),  X(2),  X(3),  X(4),  X(5),  X(6),  X(7),          \
+    X(8),  X(9),  X(10), X(11), X(12), X(13), X(14), X(15),         \
+    X(16), X(17), X(18), X(19), X(20), X(21), X(22), X(23),         \
+    X(24), X(25), X(26), X(27), X(28), X(29)
+
+/**
+ * @brief Fila de cada GPIO (-1 si no es fila): una lectura en la ISR
+ */
+static const int8_t board_gpio_row[BOARD_NUM_GPIOS] = {
+    BOARD_FOR_EACH_GPIO(BOARD_GPIO_TO_ROW)
+};
+
+/** @brief Pines de las filas por índice */
+static const uint8_t board_row_pins[BOARD_KEYPAD_ROWS] = {
+    BOARD_ROW_PIN(0), BOARD_ROW_PIN(1), BOARD_ROW_PIN(2), BOARD_ROW_PIN(3)
+};
+
+/**
+ * @brief Valor de las columnas con solo la columna c en alto
+ *
+ * Con gpio_put_masked(BOARD_KEYPAD_COL_MASK, ...) se pasa de una columna
+ * a la siguiente en una sola escritura.
+ */
+static const uint32_t board_col_select[BOARD_KEYPAD_COLS] = {
+    BOARD_BIT(BOARD_COL_PIN(0)), BOARD_BIT(BOARD_COL_PIN(1)),
+    BOARD_BIT(BOARD_COL_PIN(2)), BOARD_BIT(BOARD_COL_PIN(3))
+};
+
+/** @brief Valor GPIO para cada combinación de LED_BIT_* */
+static const uint32_t board_led_gpio[1u << BOARD_NUM_LEDS] = {
+    BOARD_LED_BITS_TO_GPIO(0), BOARD_LED_BITS_TO_GPIO(1),
+    BOARD_LED_BITS_TO_GPIO(2), BOARD_LED_BITS_TO_GPIO(3),
+    BOARD_LED_BITS_TO_GPIO(4), BOARD_LED_BITS_TO_GPIO(5),
+    BOARD_LED_BITS_TO_GPIO(6), BOARD_LED_BITS_TO_GPIO(7)
+};
+
+/* ---- Verificaciones en tiempo de compilación ------------------------- */
+
+/** @brief Cantidad de bits en 1 de una constante de 32 bits */
+#define BOARD_POPCOUNT2(x)  ((x) - (((x) >> 1) & 0x55555555u))
+#define BOARD_POPCOUNT4(x)  ((BOARD_POPCOUNT2(x) & 0x33333333u) + ((BOARD_POPCOUNT2(x) >> 2) & 0x33333333u))
+#define BOARD_POPCOUNT(x)   ((((BOARD_POPCOUNT4(x) + (BOARD_POPCOUNT4(x) >> 4)) & 0x0F0F0F0Fu) * 0x01010101u) >> 24)
+
+#define BOARD_VALID_PIN(p)  ((p) >= 0 && (p) < BOARD_NUM_GPIOS)
+
+_Static_assert(BOARD_VALID_PIN(BOARD_KEYPAD_ROW0_PIN) && BOARD_VALID_PIN(BOARD_KEYPAD_ROW1_PIN) &&
+               BOARD_VALID_PIN(BOARD_KEYPAD_ROW2_PIN) && BOARD_VALID_PIN(BOARD_KEYPAD_ROW3_PIN) &&
+               BOARD_VALID_PIN(BOARD_KEYPAD_COL0_PIN) && BOARD_VALID_PIN(BOARD_KEYPAD_COL1_PIN) &&
+               BOARD_VALID_PIN(BOARD_KEYPAD_COL2_PIN) && BOARD_VALID_PIN(BOARD_KEYPAD_COL3_PIN) &&
+               BOARD_VALID_PIN(BOARD_LED_VERDE_PIN) && BOARD_VALID_PIN(BOARD_LED_ROJO_PIN) &&
+               BOARD_VALID_PIN(BOARD_LED_AMARILLO_PIN) &&
+               BOARD_VALID_PIN(BOARD_I2C_SDA_PIN) && BOARD_VALID_PIN(BOARD_I2C_SCL_PIN),
+               "Pin fuera del banco 0 del RP2040");
+
+_Static_assert(BOARD_POPCOUNT(BOARD_KEYPAD_ROW_MASK) == BOARD_KEYPAD_ROWS, "Fila del teclado repetida");
+_Static_assert(BOARD_POPCOUNT(BOARD_KEYPAD_COL_MASK) == BOARD_KEYPAD_COLS, "Columna del teclado repetida");
+_Static_assert(BOARD_POPCOUNT(BOARD_LED_MASK) == BOARD_NUM_LEDS, "Pin de LED repetido");
+_Static_assert(BOARD_POPCOUNT(BOARD_I2C_MASK) == 2, "SDA y SCL usan el mismo pin");
+
+_Static_assert((BOARD_KEYPAD_ROW_MASK & BOARD_KEYPAD_COL_MASK) == 0, "Pin compartido entre filas y columnas");
+_Static_assert(((BOARD_KEYPAD_ROW_MASK | BOARD_KEYPAD_COL_MASK) & BOARD_LED_MASK) == 0,
+               "Pin compartido entre el teclado y los LEDs");
+_Static_assert(((BOARD_KEYPAD_ROW_MASK | BOARD_KEYPAD_COL_MASK | BOARD_LED_MASK) & BOARD_I2C_MASK) == 0,
+               "Pin compartido con el bus I2C");
+
+/* Función I2C del RP2040: SDA en GPIO 4n+2k, SCL en 4n+2k+1 (k = bloque) */
+_Static_assert(BOARD_I2C_INDEX == 0 || BOARD_I2C_INDEX == 1, "El RP2040 tiene I2C0 e I2C1");
+_Static_assert(BOARD_I2C_SDA_PIN % 4 == 2 * BOARD_I2C_INDEX, "SDA no disponible en ese pin para el bloque I2C");
+_Static_assert(BOARD_I2C_SCL_PIN % 4 == 2 * BOARD_I2C_INDEX + 1, "SCL no disponible en ese pin para el bloque I2C");
+
+#endif // BOARD_H
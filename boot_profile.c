@@ -0,0 +1,82 @@
+/**
+ * @file boot_profile.c
+ * @brief Implementación de la medición de tiempos de arranque
+ * @author Sistema de Control de Acceso
+ * @date 2025
+ */
+
+#include "boot_profile.h"
+#include <stdio.h>
+#include "pico/stdlib.h"
+
+/** @brief Nombre de cada fase para el reporte */
+static const char *const boot_phase_names[BOOT_PHASE_COUNT] = {
+    [BOOT_PHASE_MAIN]          = "main",
+    [BOOT_PHASE_STDIO]         = "stdio",
+    [BOOT_PHASE_OUTPUTS]       = "salidas",
+    [BOOT_PHASE_KEYPAD]        = "teclado",
+    [BOOT_PHASE_ACCESS]        = "acceso",
+    [BOOT_PHASE_SERVICES]      = "servicios",
+    [BOOT_PHASE_SCHEDULER]     = "scheduler",
+    [BOOT_PHASE_INPUT_READY]   = "acepta_teclas",
+    [BOOT_PHASE_DISPLAY_READY] = "display",
+    [BOOT_PHASE_USB_CONNECTED] = "usb",
+};
+
+/** @brief Instante de cada fase en microsegundos desde el reset (0 = pendiente) */
+static uint64_t boot_phase_time[BOOT_PHASE_COUNT];
+
+/**
+ * @brief Registra el instante de una fase (solo la primera vez)
+ */
+void boot_mark(boot_phase_t phase) {
+    if (phase < BOOT_PHASE_COUNT && boot_phase_time[phase] == 0) {
+        boot_phase_time[phase] = time_us_64();
+    }
+}
+
+/**
+ * @brief Microsegundos desde el reset hasta la fase
+ */
+uint64_t boot_phase_us(boot_phase_t phase) {
+    return (phase < BOOT_PHASE_COUNT) ? boot_phase_time[phase] : 0;
+}
+
+/**
+ * @brief Imprime el reporte de arranque
+ */
+void boot_profile_print(bool json) {
+    uint64_t previous = 0;
+    bool first = true;
+    
+    if (json) {
+        printf("{\"fast_boot\":%d,\"phases_us\":{", FAST_BOOT);
+    } else {
+        printf("\n=== ARRANQUE (%s) ===\n", FAST_BOOT ? "rápido" : "normal");
+        printf("%-14s %12s %12s\n", "Fase", "Desde reset", "Delta");
+    }
+    
+    for (int i = 0; i < BOOT_PHASE_COUNT; i++) {
+        uint64_t t = boot_phase_time[i];
+        
+        if (json) {
+            if (t != 0) {
+                printf("%s\"%s\":%llu", first ? "" : ",", boot_phase_names[i], (unsigned long long)t);
+                first = false;
+            }
+        } else if (t == 0) {
+            printf("%-14s %12s\n", boot_phase_names[i], "pendiente");
+        } else {
+            // Las fases asíncronas pueden terminar fuera de orden
+            uint64_t delta = (t > previous) ? t - previous : 0;
+            printf("%-14s %8llu.%03u %8llu.%03u ms\n", boot_phase_names[i],
+                   (unsigned long long)(t / 1000), (unsigned)(t % 1000),
+                   (unsigned long long)(delta / 1000), (unsigned)(delta % 1000));
+            if (t > previous) {
+                previous = t;
+            }
+        }
+    }
+    
+    printf(json ? "}}\n" : "\n");
+}
@@ -0,0 +1,65 @@
+/**
+ * @file boot_profile.h
+ * @brief Medición de tiempos de las fases de arranque
+ * @author Sistema de Control de Acceso
+ * @date 2025
+ *
+ * Cada fase del arranque se marca con el temporizador de 1 MHz (que cuenta
+ * desde el reset). Las fases asíncronas (display, USB) se marcan desde sus
+ * tareas, por lo que el reporte muestra cuándo el equipo acepta teclas y
+ * cuándo termina cada periférico lento.
+ */
+
+#ifndef BOOT_PROFILE_H
+#define BOOT_PROFILE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * @brief Arranque rápido: sin espera de USB y con el display en segundo plano
+ *
+ * Con FAST_BOOT = 0 se conserva el arranque original (espera de 3 s para
+ * la conexión USB y banner impreso antes de inicializar los módulos).
+ */
+#ifndef FAST_BOOT
+#define FAST_BOOT 1
+#endif
+
+/**
+ * @brief Fases del arranque, en el orden esperado
+ */
+typedef enum {
+    BOOT_PHASE_MAIN,            /**< Entrada a main() */
+    BOOT_PHASE_STDIO,           /**< stdio/USB inicializado (sin esperar conexión) */
+    BOOT_PHASE_OUTPUTS,         /**< Log, base de datos, LEDs y cola del display */
+    BOOT_PHASE_KEYPAD,          /**< Teclado inicializado (IRQs activas) */
+    BOOT_PHASE_ACCESS,          /**< Máquina de estados de acceso inicializada */
+    BOOT_PHASE_SERVICES,        /**< RTC, consola y bajo consumo */
+    BOOT_PHASE_SCHEDULER,       /**< Llamada a vTaskStartScheduler() */
+    BOOT_PHASE_INPUT_READY,     /**< Tarea del teclado en ejecución: acepta teclas */
+    BOOT_PHASE_DISPLAY_READY,   /**< Display configurado por I2C (asíncrono) */
+    BOOT_PHASE_USB_CONNECTED,   /**< Terminal USB conectada (asíncrono) */
+    BOOT_PHASE_COUNT
+} boot_phase_t;
+
+/**
+ * @brief Registra el instante de una fase (solo la primera vez)
+ *
+ * @param phase Fase alcanzada
+ */
+void boot_mark(boot_phase_t phase);
+
+/**
+ * @brief Microsegundos desde el reset hasta la fase, o 0 si no ocurrió
+ */
+uint64_t boot_phase_us(boot_phase_t phase);
+
+/**
+ * @brief Imprime el reporte de arranque
+ *
+ * @param json true para una línea JSON, false para tabla legible
+ */
+void boot_profile_print(bool json);
+
+#endif // BOOT_PROFILE_H
@@ -0,0 +1,353 @@
+/**
+ * @file console.c
+ * @brief Implementación de la consola de comandos por USB
+ * @author Sistema de Control de Acceso
+ * @date 2025
+ */
+
+#include "console.h"
+#include "time_service.h"
+#include "task_stats.h"
+#include "task_health.h"
+#include "trace_recorder.h"
+#include "input_recorder.h"
+#include "boot_profile.h"
+#include "system_bus.h"
+#include "i2c_bus.h"
+#include "executor.h"
+#include "access_report.h"
+#include "database.h"
+#include "db_sync.h"
+#include "ssd1306_display.h"
+#include "low_power.h"
+#include "log.h"
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include "pico/stdlib.h"
+#include "pico/stdio_usb.h"
+#include "FreeRTOS.h"
+#include "task.h"
+
+/** @brief Handle de la tarea de consola (para notificarla desde la IRQ USB) */
+static TaskHandle_t console_task_handle = NULL;
+
+/** @brief Función a ejecutar al conectarse la terminal USB */
+static void (*console_connect_hook)(void) = NULL;
+
+static void cmd_help(const char *args);
+static void cmd_time(const char *args);
+static void cmd_stats(const char *args);
+static void cmd_trace(const char *args);
+static void cmd_input(const char *args);
+static void cmd_boot(const char *args);
+static void cmd_health(const char *args);
+static void cmd_bus(const char *args);
+static void cmd_i2c(const char *args);
+static void cmd_exec(const char *args);
+static void cmd_access(const char *args);
+static void cmd_users(const char *args);
+static void cmd_sync(const char *args);
+
+/** @brief Tabla de comandos disponibles */
+static const console_command_t commands[] = {
+    {"help", "Lista los comandos disponibles", cmd_help},
+    {"time", "time [AAAA-MM-DD HH:MM:SS] - muestra o fija la fecha/hora", cmd_time},
+    {"stats", "stats [json] - CPU, cambios de contexto, stack y heap por tarea; display, bajo consumo y log", cmd_stats},
+    {"trace", "trace start|stop|dump - registro de eventos del scheduler", cmd_trace},
+    {"input", "input start|stop|dump - entradas del teclado para tools/replay", cmd_input},
+    {"boot", "boot [json] - tiempos de las fases de arranque", cmd_boot},
+    {"health", "health [json] - plazos incumplidos y jitter por tarea", cmd_health},
+    {"bus", "bus [json] - eventos, contrapresión y pérdidas por tópico", cmd_bus},
+    {"i2c", "i2c [json] - ocupación del bus I2C, cola y latencia por cliente", cmd_i2c},
+    {"exec", "exec [json] - turnos, atraso y duración por corrutina del ejecutor", cmd_exec},
+    {"access", "access [json] - accesos por hora, IDs más negados y sesiones", cmd_access},
+    {"users", "users [desde [hasta]] - usuarios por rango de ID", cmd_users},
+    {"sync", "sync root|hash|list|begin|ops|commit - para tools/db_sync", cmd_sync},
+};
+
+#define NUM_COMMANDS (sizeof(commands) / sizeof(commands[0]))
+
+/**
+ * @brief Comando "help": lista los comandos
+ */
+static void cmd_help(const char *args) {
+    for (size_t i = 0; i < NUM_COMMANDS; i++) {
+        printf("  %-8s %s\n", commands[i].name, commands[i].help);
+    }
+}
+
+/**
+ * @brief Comando "time": muestra o fija la fecha y hora
+ */
+static void cmd_time(const char *args) {
+    if (*args == '\0') {
+        printf("%s %s\n", time_service_date_str(), time_service_time_str());
+        return;
+    }
+    
+    int year, month, day, hour, min, sec;
+    if (sscanf(args, "%d-%d-%d %d:%d:%d", &year, &month, &day, &hour, &min, &sec) != 6) {
+        printf("Formato: time AAAA-MM-DD HH:MM:SS\n");
+        return;
+    }
+    
+    datetime_t dt = {
+        .year = year, .month = month, .day = day,
+        .dotw = time_service_day_of_week(year, month, day),
+        .hour = hour, .min = min, .sec = sec
+    };
+    
+    if (time_service_set(&dt)) {
+        printf("Hora fijada: %s %s\n", time_service_date_str(), time_service_time_str());
+    } else {
+        printf("Fecha u hora fuera de rango\n");
+    }
+}
+
+/**
+ * @brief Comando "stats": estadísticas de ejecución por tarea
+ *
+ * Después de la tabla de tareas muestra los contadores del display, del
+ * idle sin tick y del log diferido; en JSON van en una segunda línea para
+ * no cambiar la de tareas que lee tools/sched_analysis.py.
+ */
+static void cmd_stats(const char *args) {
+    bool json = (strcmp(args, "json") == 0);
+    display_stats_t display;
+    low_power_stats_t power;
+
+    task_stats_print(json);
+    ssd1306_get_stats(&display);
+    low_power_get_stats(&power);
+    uint64_t uptime_us = time_us_64();
+
+    if (json) {
+        printf("{\"display\":{\"received\":%lu,\"rendered\":%lu,\"merged\":%lu,\"dropped\":%lu},"
+               "\"low_power\":{\"sleeps\":%lu,\"aborted\":%lu,\"early_wakeups\":%lu,"
+               "\"slept_ms\":%llu,\"uptime_ms\":%llu},\"log\":{\"dropped\":%lu}}\n",
+               (unsigned long)display.received, (unsigned long)display.rendered,
+               (unsigned long)display.merged, (unsigned long)display.dropped,
+               (unsigned long)power.sleeps, (unsigned long)power.aborted,
+               (unsigned long)power.early_wakeups, (unsigned long long)(power.slept_us / 1000),
+               (unsigned long long)(uptime_us / 1000), (unsigned long)log_get_dropped());
+    } else {
+        printf("Display: %lu comandos, %lu cuadros, %lu reemplazados, %lu descartados por el bus\n",
+               (unsigned long)display.received, (unsigned long)display.rendered,
+               (unsigned long)display.merged, (unsigned long)display.dropped);
+        printf("Bajo consumo: %lu suspensiones, %lu canceladas, %lu cortadas por IRQ, "
+               "dormido %llu de %llu ms\n",
+               (unsigned long)power.sleeps, (unsigned long)power.aborted,
+               (unsigned long)power.early_wakeups, (unsigned long long)(power.slept_us / 1000),
+               (unsigned long long)(uptime_us / 1000));
+        printf("Log: %lu mensajes descartados (buffer lleno)\n\n", (unsigned long)log_get_dropped());
+    }
+}
+
+/**
+ * @brief Comando "trace": controla el registro de eventos del scheduler
+ */
+static void cmd_trace(const char *args) {
+    if (strcmp(args, "start") == 0) {
+        trace_recorder_enable(true);
+        printf("Traza iniciada\n");
+    } else if (strcmp(args, "stop") == 0) {
+        trace_recorder_enable(false);
+        printf("Traza detenida\n");
+    } else if (strcmp(args, "dump") == 0) {
+        trace_recorder_dump();
+    } else {
+        printf("Uso: trace start|stop|dump\n");
+    }
+}
+
+/**
+ * @brief Comando "input": controla el registro de entradas para reproducción
+ */
+static void cmd_input(const char *args) {
+    if (strcmp(args, "start") == 0) {
+        input_recorder_enable(true);
+        printf("Grabación de entradas iniciada\n");
+    } else if (strcmp(args, "stop") == 0) {
+        input_recorder_enable(false);
+        printf("Grabación de entradas detenida\n");
+    } else if (strcmp(args, "dump") == 0) {
+        input_recorder_dump();
+    } else {
+        printf("Uso: input start|stop|dump\n");
+    }
+}
+
+/**
+ * @brief Comando "boot": reporte de tiempos de arranque
+ */
+static void cmd_boot(const char *args) {
+    boot_profile_print(strcmp(args, "json") == 0);
+}
+
+/**
+ * @brief Comando "health": contratos temporales de las tareas
+ */
+static void cmd_health(const char *args) {
+    task_health_print(strcmp(args, "json") == 0);
+}
+
+/**
+ * @brief Comando "bus": contadores del bus de eventos
+ */
+static void cmd_bus(const char *args) {
+    bus_print(strcmp(args, "json") == 0);
+}
+
+/**
+ * @brief Comando "i2c": estadísticas del gestor del bus I2C
+ */
+static void cmd_i2c(const char *args) {
+    i2c_bus_print(strcmp(args, "json") == 0);
+}
+
+/**
+ * @brief Comando "exec": contadores del ejecutor de corrutinas
+ */
+static void cmd_exec(const char *args) {
+    executor_print(strcmp(args, "json") == 0);
+}
+
+/**
+ * @brief Comando "access": estadísticas de acceso
+ */
+static void cmd_access(const char *args) {
+    access_report_print(strcmp(args, "json") == 0);
+}
+
+/**
+ * @brief Comando "users": lista usuarios por rango de ID
+ */
+static void cmd_users(const char *args) {
+    if (args[0] == '\0') {
+        print_database_status();
+        return;
+    }
+
+    char *end;
+    unsigned long from = strtoul(args, &end, 10);
+    unsigned long to = (*end == ' ') ? strtoul(end + 1, &end, 10) : from;
+    if (*end != '\0' || to < from) {
+        printf("Uso: users [desde [hasta]]\n");
+        return;
+    }
+    database_print_users((uint32_t)from, (uint32_t)to);
+}
+
+static void sync_emit(const char *line) {
+    printf("%s\n", line);
+}
+
+/**
+ * @brief Comando "sync": sincronización incremental de usuarios desde el host
+ */
+static void cmd_sync(const char *args) {
+    db_sync_command(args, sync_emit);
+}
+
+/**
+ * @brief Busca y ejecuta el comando de una línea
+ */
+static void execute_line(char *line) {
+    char *args = line;
+    
+    // Separar nombre del comando y argumentos
+    while (*args != '\0' && *args != ' ') {
+        args++;
+    }
+    if (*args == ' ') {
+        *args++ = '\0';
+    }
+    
+    if (line[0] == '\0') {
+        return;
+    }
+    
+    for (size_t i = 0; i < NUM_COMMANDS; i++) {
+        if (strcmp(line, commands[i].name) == 0) {
+            commands[i].handler(args);
+            return;
+        }
+    }
+    
+    printf("Comando desconocido: %s (use 'help')\n", line);
+}
+
+/**
+ * @brief Callback de stdio: hay caracteres disponibles (contexto IRQ)
+ */
+static void console_chars_available(void *param) {
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+    
+    trace_isr_enter(TRACE_ISR_USB_RX);
+    if (console_task_handle != NULL) {
+        vTaskNotifyGiveFromISR(console_task_handle, &xHigherPriorityTaskWoken);
+    }
+    trace_isr_exit(TRACE_ISR_USB_RX);
+    portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+}
+
+/**
+ * @brief Inicializa la consola USB
+ */
+bool console_init(void) {
+    stdio_set_chars_available_callback(console_chars_available, NULL);
+    return true;
+}
+
+/**
+ * @brief Registra una función a ejecutar cuando se conecta la terminal USB
+ */
+void console_set_connect_hook(void (*hook)(void)) {
+    console_connect_hook = hook;
+}
+
+/**
+ * @brief Tarea de FreeRTOS que lee y ejecuta comandos de la consola
+ */
+void console_task(void *pvParameters) {
+    char line[CONSOLE_LINE_LEN];
+    size_t len = 0;
+    uint32_t poll_ms = CONSOLE_USB_POLL_MS;
+    
+    console_task_handle = xTaskGetCurrentTaskHandle();
+    
+    // El USB se enumera en segundo plano; esperar a que abran la terminal.
+    // El SDK no avisa la conexión, así que la consulta se espacia hasta
+    // CONSOLE_USB_POLL_MAX_MS; una tecla en la terminal despierta antes
+    while (!stdio_usb_connected()) {
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(poll_ms));
+        if (poll_ms < CONSOLE_USB_POLL_MAX_MS) {
+            poll_ms *= 2;
+        }
+    }
+    boot_mark(BOOT_PHASE_USB_CONNECTED);
+    
+    if (console_connect_hook != NULL) {
+        console_connect_hook();
+    }
+    boot_profile_print(false);
+    
+    while (1) {
+        // Vaciar primero: el aviso que despertó la espera de conexión ya
+        // se consumió
+        int c;
+        while ((c = getchar_timeout_us(0)) != PICO_ERROR_TIMEOUT) {
+            if (c == '\r' || c == '\n') {
+                line[len] = '\0';
+                execute_line(line);
+                len = 0;
+            } else if (len < sizeof(line) - 1) {
+                line[len++] = (char)c;
+            }
+        }
+        
+        // Bloquear hasta que la IRQ USB avise que llegaron caracteres
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    }
+}
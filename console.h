@@ -0,0 +1,61 @@
+/**
+ * @file console.h
+ * @brief Consola de comandos por USB para el sistema de control de acceso
+ * @author Sistema de Control de Acceso
+ * @date 2025
+ * 
+ * Intérprete de comandos de texto de una línea sobre la salida estándar
+ * USB. La tarea permanece bloqueada hasta que llegan caracteres, por lo que
+ * no agrega despertares periódicos al sistema; mientras la terminal no está
+ * abierta consulta la conexión cada vez menos, hasta una vez cada
+ * CONSOLE_USB_POLL_MAX_MS.
+ */
+
+#ifndef CONSOLE_H
+#define CONSOLE_H
+
+#include <stdbool.h>
+
+/** @brief Longitud máxima de una línea de comando (los cambios de "sync" van de a varios) */
+#define CONSOLE_LINE_LEN 128
+
+/** @brief Primera consulta de la conexión USB; el período se duplica en cada una */
+#define CONSOLE_USB_POLL_MS 250
+
+/** @brief Período máximo de consulta de la conexión USB */
+#define CONSOLE_USB_POLL_MAX_MS 8000
+
+/**
+ * @brief Comando de consola
+ */
+typedef struct {
+    const char *name;                   /**< Nombre del comando */
+    const char *help;                   /**< Descripción breve para "help" */
+    void (*handler)(const char *args);  /**< Función que ejecuta el comando */
+} console_command_t;
+
+/**
+ * @brief Inicializa la consola USB
+ * 
+ * @return true Si la inicialización fue exitosa
+ * @return false Si hubo error en la inicialización
+ */
+bool console_init(void);
+
+/**
+ * @brief Registra una función a ejecutar cuando se conecta la terminal USB
+ * 
+ * Se llama una sola vez, antes de imprimir el reporte de arranque.
+ * 
+ * @param hook Función a ejecutar (NULL para ninguna)
+ */
+void console_set_connect_hook(void (*hook)(void));
+
+/**
+ * @brief Tarea de FreeRTOS que lee y ejecuta comandos de la consola
+ * 
+ * @param pvParameters Parámetros de la tarea (no utilizados)
+ */
+void console_task(void *pvParameters);
+
+#endif // CONSOLE_H
@@ -0,0 +1,152 @@
+/**
+ * @file coop.c
+ * @brief Implementación del planificador cooperativo de corrutinas sin pila
+ * @author Sistema de Control de Acceso
+ * @date 2025
+ */
+
+#include "coop.h"
+#include <string.h>
+
+_Static_assert(CO_MAX_TASKS <= 32, "Las señales son bits de un uint32_t");
+
+/**
+ * @brief Indica si la corrutina debe correr en esta ronda
+ */
+static bool co_ready(const co_t *co, uint32_t now_ms) {
+    switch (co->state) {
+        case CO_READY:
+            return true;
+        case CO_WAITING:
+            return co->signaled;
+        case CO_WAITING_TIMED:
+            return co->signaled || (int32_t)(now_ms - co->wake_ms) >= 0;
+        default:
+            return false;
+    }
+}
+
+/**
+ * @brief Inicializa el planificador sin corrutinas
+ */
+void co_exec_init(co_exec_t *x, uint32_t (*clock_us)(void)) {
+    memset(x, 0, sizeof(*x));
+    x->clock_us = clock_us;
+}
+
+/**
+ * @brief Registra una corrutina
+ */
+int co_add(co_exec_t *x, co_t *co, const char *name, co_fn fn) {
+    if (x->count >= CO_MAX_TASKS || fn == NULL) {
+        return -1;
+    }
+
+    memset(co, 0, sizeof(*co));
+    co->fn = fn;
+    co->name = name;
+    co->state = CO_READY;
+
+    int id = x->count++;
+    x->tasks[id] = co;
+    return id;
+}
+
+/**
+ * @brief Prepara la espera de CO_WAIT
+ */
+void co_wait(co_t *co, uint32_t timeout_ms) {
+    if (timeout_ms == CO_FOREVER) {
+        co->state = CO_WAITING;
+    } else {
+        co->state = CO_WAITING_TIMED;
+        co->wake_ms = co->now_ms + timeout_ms;
+    }
+}
+
+/**
+ * @brief Prepara la espera de CO_WAIT_UNTIL
+ */
+void co_wait_until(co_t *co, uint32_t deadline_ms) {
+    co->state = CO_WAITING_TIMED;
+    co->wake_ms = deadline_ms;
+}
+
+/**
+ * @brief Señala una corrutina desde otra del mismo planificador
+ */
+void co_signal(co_exec_t *x, int id) {
+    if (id >= 0 && id < x->count) {
+        x->tasks[id]->signaled = true;
+        x->tasks[id]->signals++;
+    }
+}
+
+/**
+ * @brief Ejecuta una ronda
+ *
+ * Cada corrutina lista al comenzar la ronda corre exactamente una vez; las
+ * que quedan listas durante la ronda (CO_YIELD, una señal de otra
+ * corrutina) corren en la siguiente.
+ */
+uint32_t co_run(co_exec_t *x, uint32_t now_ms, uint32_t signals) {
+    bool ready[CO_MAX_TASKS];
+    bool ran = false;
+
+    for (int id = 0; id < x->count; id++) {
+        if (signals & (1u << id)) {
+            co_signal(x, id);
+        }
+        ready[id] = co_ready(x->tasks[id], now_ms);
+    }
+
+    for (int i = 0; i < x->count; i++) {
+        int id = (x->cursor + i) % x->count;
+        co_t *co = x->tasks[id];
+        if (!ready[id]) {
+            continue;
+        }
+
+        if (co->state == CO_WAITING_TIMED && !co->signaled) {
+            uint32_t late = now_ms - co->wake_ms;
+            if (late > co->late_max_ms) {
+                co->late_max_ms = late;
+            }
+        }
+        co->signaled = false;
+        co->state = CO_READY;
+        co->now_ms = now_ms;
+        uint32_t start = x->clock_us ? x->clock_us() : 0;
+        co->fn(co);
+        if (x->clock_us) {
+            uint32_t elapsed = x->clock_us() - start;
+            co->run_sum_us += elapsed;
+            if (elapsed > co->run_max_us) {
+                co->run_max_us = elapsed;
+            }
+        }
+        co->runs++;
+        ran = true;
+    }
+
+    if (ran) {
+        x->rounds++;
+        x->cursor = (uint8_t)((x->cursor + 1) % x->count);
+    }
+
+    // Próxima corrutina lista
+    uint32_t wait = CO_FOREVER;
+    for (int id = 0; id < x->count; id++) {
+        const co_t *co = x->tasks[id];
+        if (co_ready(co, now_ms)) {
+            return 0;
+        }
+        if (co->state == CO_WAITING_TIMED) {
+            uint32_t remaining = co->wake_ms - now_ms;
+            if (remaining < wait) {
+                wait = remaining;
+            }
+        }
+    }
+    return wait;
+}
@@ -0,0 +1,174 @@
+/**
+ * @file coop.h
+ * @brief Corrutinas sin pila y planificador cooperativo
+ * @author Sistema de Control de Acceso
+ * @date 2025
+ *
+ * Varias actividades livianas (LEDs, display) comparten una sola tarea de
+ * FreeRTOS (executor.c) en lugar de tener cada una su pila y su TCB. Cada
+ * actividad es una corrutina al estilo protothreads: una función que el
+ * planificador vuelve a llamar en cada turno y que retoma donde quedó con
+ * un switch sobre el número de línea:
+ *
+ *     static void blink_run(co_t *co) {
+ *         CO_BEGIN(co);
+ *         while (1) {
+ *             toggle();
+ *             CO_WAIT(co, 500);   // hasta una señal o 500 ms
+ *         }
+ *         CO_END(co);
+ *     }
+ *
+ * Como no tiene pila propia, las variables locales no sobreviven a
+ * CO_WAIT/CO_YIELD: el estado que cruza una espera vive en variables
+ * static del módulo. Tampoco se puede usar CO_WAIT dentro de un switch
+ * propio ni dos macros CO_* en la misma línea.
+ *
+ * En cada ronda (co_run) se ejecuta una vez, en orden circular, cada
+ * corrutina lista: con una señal pendiente, con su plazo cumplido o que
+ * cedió el turno con CO_YIELD. La ronda siguiente empieza por la corrutina
+ * siguiente, así que una corrutina que siempre está lista no posterga a las
+ * demás más de una ronda.
+ *
+ * El módulo no depende de FreeRTOS ni del SDK y no es reentrante: el
+ * llamador entrega el tiempo y las señales acumuladas desde otras tareas,
+ * lo que permite simularlo en el host (tools/coop_sim.c).
+ */
+
+#ifndef COOP_H
+#define COOP_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/** @brief Corrutinas por planificador (una señal por bit) */
+#define CO_MAX_TASKS            8
+
+/** @brief Espera sin plazo (solo una señal la despierta) */
+#define CO_FOREVER              0xFFFFFFFFu
+
+/**
+ * @brief Estado de una corrutina
+ */
+typedef enum {
+    CO_READY,                   /**< Cedió el turno: corre en la próxima ronda */
+    CO_WAITING,                 /**< Espera una señal */
+    CO_WAITING_TIMED,           /**< Espera una señal o su plazo */
+    CO_DONE                     /**< Llegó a CO_END */
+} co_state_t;
+
+typedef struct co co_t;
+
+/**
+ * @brief Cuerpo de una corrutina (retorna en cada espera)
+ */
+typedef void (*co_fn)(co_t *co);
+
+/**
+ * @brief Corrutina y sus contadores
+ */
+struct co {
+    co_fn fn;
+    const char *name;           /**< Nombre para reportes */
+    uint16_t lc;                /**< Línea donde continuar (0 = inicio) */
+    uint8_t state;              /**< co_state_t */
+    bool signaled;              /**< Señal pendiente */
+    uint32_t now_ms;            /**< Instante de la ronda en curso */
+    uint32_t wake_ms;           /**< Plazo de CO_WAITING_TIMED */
+    uint32_t runs;              /**< Turnos ejecutados */
+    uint32_t signals;           /**< Señales recibidas */
+    uint32_t late_max_ms;       /**< Mayor atraso respecto del plazo de una espera */
+    uint32_t run_max_us;        /**< Turno más largo */
+    uint64_t run_sum_us;
+};
+
+/**
+ * @brief Planificador
+ */
+typedef struct {
+    co_t *tasks[CO_MAX_TASKS];
+    uint8_t count;
+    uint8_t cursor;             /**< Primera corrutina de la próxima ronda */
+    uint32_t rounds;            /**< Rondas que ejecutaron al menos un turno */
+    uint32_t (*clock_us)(void); /**< Reloj para medir los turnos, o NULL */
+} co_exec_t;
+
+/** @brief Comienzo del cuerpo de la corrutina */
+#define CO_BEGIN(co)        switch ((co)->lc) { case 0:
+
+/** @brief Fin del cuerpo: la corrutina no vuelve a correr */
+#define CO_END(co)          } (co)->state = CO_DONE; return
+
+/**
+ * @brief Suspende hasta una señal o hasta timeout_ms (CO_FOREVER = sin plazo)
+ *
+ * El plazo se cuenta desde el comienzo de la ronda (co->now_ms), no desde
+ * que se llama: si el turno ya bloqueó un rato, la espera se acorta en ese
+ * tanto. Para esperar hasta un instante medido dentro del turno, usar
+ * CO_WAIT_UNTIL.
+ */
+#define CO_WAIT(co, timeout_ms)                                               \
+    do {                                                                      \
+        co_wait((co), (timeout_ms));                                          \
+        (co)->lc = __LINE__; return; case __LINE__:;                          \
+    } while (0)
+
+/**
+ * @brief Suspende hasta una señal o hasta el instante deadline_ms, en el
+ * mismo reloj que recibe co_run
+ */
+#define CO_WAIT_UNTIL(co, deadline_ms)                                        \
+    do {                                                                      \
+        co_wait_until((co), (deadline_ms));                                   \
+        (co)->lc = __LINE__; return; case __LINE__:;                          \
+    } while (0)
+
+/**
+ * @brief Cede el turno: corre de nuevo en la próxima ronda, después de las demás
+ */
+#define CO_YIELD(co)                                                          \
+    do {                                                                      \
+        (co)->state = CO_READY;                                               \
+        (co)->lc = __LINE__; return; case __LINE__:;                          \
+    } while (0)
+
+/**
+ * @brief Inicializa el planificador sin corrutinas
+ *
+ * @param clock_us Reloj en microsegundos para los contadores (NULL = no medir)
+ */
+void co_exec_init(co_exec_t *x, uint32_t (*clock_us)(void));
+
+/**
+ * @brief Registra una corrutina; corre por primera vez en la próxima ronda
+ *
+ * @return Identificador (bit de señal), o -1 si no hay lugar
+ */
+int co_add(co_exec_t *x, co_t *co, const char *name, co_fn fn);
+
+/**
+ * @brief Prepara la espera de CO_WAIT (no llamar directamente)
+ */
+void co_wait(co_t *co, uint32_t timeout_ms);
+
+/**
+ * @brief Prepara la espera de CO_WAIT_UNTIL (no llamar directamente)
+ */
+void co_wait_until(co_t *co, uint32_t deadline_ms);
+
+/**
+ * @brief Señala una corrutina desde otra del mismo planificador
+ */
+void co_signal(co_exec_t *x, int id);
+
+/**
+ * @brief Ejecuta una ronda
+ *
+ * @param now_ms Instante actual
+ * @param signals Señales recibidas desde la ronda anterior (bit = identificador)
+ * @return Milisegundos hasta la próxima corrutina lista: 0 si alguna ya lo
+ *         está, CO_FOREVER si todas esperan una señal
+ */
+uint32_t co_run(co_exec_t *x, uint32_t now_ms, uint32_t signals);
+
+#endif // COOP_H
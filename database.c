@@ -2,45 +2,114 @@
 #include <stdio.h>
 #include <string.h>
 
+#define LOG_MODULE DATABASE
+#include "log.h"
+#include "merkle_sync.h"
+#include "rtos_static.h"
+#include "hardware/timer.h"
+
+#if DATABASE_FLASH_INDEX
+#include "flash_btree.h"
+#include "user_flash.h"
+#endif
+
+// Usuarios predeterminados (ordenados por ID para la carga masiva en flash)
+static const struct {
+    const char *id;
+    const char *password;
+} default_users[] = {
+    { "123456", "1234" },
+    { "345678", "9012" },
+    { "567890", "7890" },
+    { "789012", "5678" },
+    { "901234", "3456" },
+};
+
+#define NUM_DEFAULT_USERS (sizeof(default_users) / sizeof(default_users[0]))
+
+/** @brief Hashes de la base para la sincronización (8 KB) */
+static ms_tree_t merkle;
+
+/** @brief Serializa la base entre la tarea de acceso, la consola y la tarea Stats */
+static SemaphoreHandle_t database_mutex;
+RTOS_MUTEX_DEFINE(database_mutex);
+
+#define DATABASE_LOCK()     xSemaphoreTake(database_mutex, portMAX_DELAY)
+#define DATABASE_UNLOCK()   xSemaphoreGive(database_mutex)
+
+/** @brief Toma la base desde la tarea de acceso: false si sigue ocupada */
+#define DATABASE_LOCK_AUTH() \
+    (xSemaphoreTake(database_mutex, pdMS_TO_TICKS(DATABASE_AUTH_WAIT_MS)) == pdTRUE)
+
+static void print_user(uint32_t n, const user_t* user) {
+    printf("Usuario %lu: ID=%s, Intentos fallidos=%d, Bloqueado=%s\n",
+           (unsigned long)n, user->id, user->failed_attempts,
+           user->blocked ? "SÍ" : "NO");
+}
+
+static bool pack_id(const char* id, uint32_t* key) {
+    *key = 0;
+    for (int i = 0; i < ID_LENGTH; i++) {
+        if (id[i] < '0' || id[i] > '9') {
+            return false;
+        }
+        *key = *key * 10 + (uint32_t)(id[i] - '0');
+    }
+    return id[ID_LENGTH] == '\0';
+}
+
+static bool pack_user(const user_t* user, uint32_t* record) {
+    *record = 0;
+    for (int i = 0; i < PASSWORD_LENGTH; i++) {
+        char c = user->password[i];
+        if (c < '0' || c > '9') {
+            return false;
+        }
+        *record = (*record << 4) | (uint32_t)(c - '0');
+    }
+    *record |= (uint32_t)user->failed_attempts << DATABASE_RECORD_FAILED_SHIFT;
+    if (user->blocked) {
+        *record |= DATABASE_RECORD_BLOCKED;
+    }
+    return true;
+}
+
+static void unpack_user(uint32_t key, uint32_t record, user_t* user) {
+    snprintf(user->id, sizeof(user->id), "%06lu", (unsigned long)(key % 1000000u));
+    for (int i = 0; i < PASSWORD_LENGTH; i++) {
+        user->password[i] = (char)('0' + ((record >> (4 * (PASSWORD_LENGTH - 1 - i))) & 0xF));
+    }
+    user->password[PASSWORD_LENGTH] = '\0';
+    user->failed_attempts = (uint8_t)(record >> DATABASE_RECORD_FAILED_SHIFT);
+    user->blocked = (record & DATABASE_RECORD_BLOCKED) != 0;
+}
+
+/** @brief Función que recibe cada registro de un recorrido (false = detener) */
+typedef bool (*record_fn_t)(uint32_t key, uint32_t record, void* ctx);
+
+#if !DATABASE_FLASH_INDEX
+
 // Base de datos de usuarios
 static user_t users[MAX_USERS];
 static uint8_t user_count = 0;
 
-void database_init(void) {
+// Copia para descartar una sincronización incompleta
+static user_t saved_users[MAX_USERS];
+static uint8_t saved_count = 0;
+
+static bool storage_init(void) {
     // Inicializar base de datos con usuarios predefinidos
-    user_count = 5;
-    
-    // Usuario 1
-    strcpy(users[0].id, "123456");
-    strcpy(users[0].password, "1234");
-    users[0].failed_attempts = 0;
-    users[0].blocked = false;
-    
-    // Usuario 2
-    strcpy(users[1].id, "789012");
-    strcpy(users[1].password, "5678");
-    users[1].failed_attempts = 0;
-    users[1].blocked = false;
-    
-    // Usuario 3
-    strcpy(users[2].id, "345678");
-    strcpy(users[2].password, "9012");
-    users[2].failed_attempts = 0;
-    users[2].blocked = false;
-    
-    // Usuario 4
-    strcpy(users[3].id, "901234");
-    strcpy(users[3].password, "3456");
-    users[3].failed_attempts = 0;
-    users[3].blocked = false;
-    
-    // Usuario 5
-    strcpy(users[4].id, "567890");
-    strcpy(users[4].password, "7890");
-    users[4].failed_attempts = 0;
-    users[4].blocked = false;
-    
+    user_count = NUM_DEFAULT_USERS;
+
+    for (int i = 0; i < user_count; i++) {
+        strcpy(users[i].id, default_users[i].id);
+        strcpy(users[i].password, default_users[i].password);
+        users[i].failed_attempts = 0;
+        users[i].blocked = false;
+    }
+
     printf("Base de datos inicializada con %d usuarios\n", user_count);
+    return true;
 }
 
 // Buscar usuario por ID
@@ -53,67 +122,598 @@ static int find_user_by_id(const char* id) {
     return -1; // Usuario no encontrado
 }
 
-auth_result_t authenticate_user(const char* id, const char* password) {
+static int find_user_by_key(uint32_t key) {
+    char id[ID_LENGTH + 1];
+    snprintf(id, sizeof(id), "%06lu", (unsigned long)(key % 1000000u));
+    return find_user_by_id(id);
+}
+
+static bool user_load(const char* id, user_t* user) {
     int user_index = find_user_by_id(id);
-    
-    // Usuario no encontrado
     if (user_index == -1) {
-        printf("Usuario %s no encontrado\n", id);
-        return AUTH_USER_NOT_FOUND;
-    }
-    
-    // Usuario bloqueado
-    if (users[user_index].blocked) {
-        printf("Usuario %s está bloqueado\n", id);
-        return AUTH_USER_BLOCKED;
-    }
-    
-    // Verificar contraseña
-    if (strcmp(users[user_index].password, password) == 0) {
-        // Contraseña correcta - resetear contador de intentos fallidos
-        users[user_index].failed_attempts = 0;
-        printf("Acceso concedido para usuario %s\n", id);
-        return AUTH_SUCCESS;
-    } else {
-        // Contraseña incorrecta - incrementar contador
-        users[user_index].failed_attempts++;
-        printf("Contraseña incorrecta para usuario %s (intento %d/%d)\n", 
-               id, users[user_index].failed_attempts, MAX_FAILED_ATTEMPTS);
-        
-        // Bloquear usuario si supera el límite
-        if (users[user_index].failed_attempts >= MAX_FAILED_ATTEMPTS) {
-            users[user_index].blocked = true;
-            printf("Usuario %s ha sido BLOQUEADO permanentemente\n", id);
-            return AUTH_USER_BLOCKED;
+        return false;
+    }
+    *user = users[user_index];
+    return true;
+}
+
+static bool record_load(uint32_t key, uint32_t* record) {
+    int user_index = find_user_by_key(key);
+    return user_index != -1 && pack_user(&users[user_index], record);
+}
+
+static bool record_store(uint32_t key, uint32_t record) {
+    int user_index = find_user_by_key(key);
+    if (user_index == -1) {
+        if (user_count == MAX_USERS) {
+            return false;
         }
-        
-        return AUTH_WRONG_PASSWORD;
+        user_index = user_count++;
     }
+    unpack_user(key, record, &users[user_index]);
+    return true;
 }
 
-bool change_user_password(const char* id, const char* old_password, const char* new_password) {
-    int user_index = find_user_by_id(id);
-    
-    if (user_index == -1 || users[user_index].blocked) {
+static bool record_remove(uint32_t key) {
+    int user_index = find_user_by_key(key);
+    if (user_index == -1) {
         return false;
     }
-    
-    // Verificar contraseña actual
-    if (strcmp(users[user_index].password, old_password) == 0) {
-        strcpy(users[user_index].password, new_password);
-        printf("Contraseña cambiada exitosamente para usuario %s\n", id);
+    users[user_index] = users[--user_count];
+    return true;
+}
+
+/**
+ * @brief Recorre en orden de ID los usuarios de [from, to]
+ *
+ * El arreglo no está ordenado; con MAX_USERS entradas basta buscar el
+ * siguiente mínimo en cada paso.
+ */
+static uint32_t scan_range(uint32_t from, uint32_t to, record_fn_t fn, void* ctx) {
+    uint32_t visited = 0;
+    uint64_t next = from;
+
+    while (next <= to) {
+        int best = -1;
+        uint32_t best_key = 0;
+        for (int i = 0; i < user_count; i++) {
+            uint32_t key;
+            pack_id(users[i].id, &key);
+            if (key >= next && key <= to && (best < 0 || key < best_key)) {
+                best = i;
+                best_key = key;
+            }
+        }
+        if (best < 0) {
+            break;
+        }
+
+        uint32_t record;
+        pack_user(&users[best], &record);
+        visited++;
+        if (!fn(best_key, record, ctx)) {
+            break;
+        }
+        next = (uint64_t)best_key + 1;
+    }
+    return visited;
+}
+
+static uint32_t stored_count(void) {
+    return user_count;
+}
+
+static void changes_begin(void) {
+    memcpy(saved_users, users, sizeof(users));
+    saved_count = user_count;
+}
+
+static bool changes_commit(void) {
+    return true;
+}
+
+static void changes_abort(void) {
+    memcpy(users, saved_users, sizeof(users));
+    user_count = saved_count;
+}
+
+#else
+
+/** @brief Índice montado (~21 KB con la caché de 4 páginas) */
+static bt_tree_t user_index;
+
+static bool next_default_user(uint32_t* key, uint32_t* value, void* ctx) {
+    size_t* next = ctx;
+    if (*next >= NUM_DEFAULT_USERS) {
+        return false;
+    }
+
+    user_t user = { .failed_attempts = 0, .blocked = false };
+    strcpy(user.password, default_users[*next].password);
+    pack_id(default_users[*next].id, key);
+    pack_user(&user, value);
+    (*next)++;
+    return true;
+}
+
+static bool storage_init(void) {
+    const bt_flash_t* flash = user_flash_region();
+    if (flash == NULL) {
+        printf("ERROR: Región del índice de usuarios no disponible\n");
+        return false;
+    }
+
+    if (bt_mount(&user_index, flash)) {
+        printf("Índice de usuarios montado: %lu usuarios, %u niveles\n",
+               (unsigned long)user_index.count, user_index.height);
         return true;
     }
-    
+
+    // Primer arranque: formatear la región y cargar los usuarios predefinidos
+    size_t next = 0;
+    if (!bt_format(&user_index, flash) || !bt_bulk_load(&user_index, next_default_user, &next)) {
+        printf("ERROR: No se pudo crear el índice de usuarios en flash\n");
+        return false;
+    }
+    printf("Índice de usuarios creado con %lu usuarios\n", (unsigned long)user_index.count);
+    return true;
+}
+
+static bool user_load(const char* id, user_t* user) {
+    uint32_t key, record;
+    if (!pack_id(id, &key) || !bt_lookup(&user_index, key, &record)) {
+        return false;
+    }
+    unpack_user(key, record, user);
+    return true;
+}
+
+static bool record_load(uint32_t key, uint32_t* record) {
+    return bt_lookup(&user_index, key, record);
+}
+
+static bool record_store(uint32_t key, uint32_t record) {
+    // Sin cambios bt_put no escribe la flash
+    return bt_put(&user_index, key, record);
+}
+
+static bool record_remove(uint32_t key) {
+    return bt_delete(&user_index, key);
+}
+
+static uint32_t scan_range(uint32_t from, uint32_t to, record_fn_t fn, void* ctx) {
+    return bt_scan(&user_index, from, to, fn, ctx);
+}
+
+static uint32_t stored_count(void) {
+    return user_index.count;
+}
+
+// Una sincronización se publica con un solo superbloque del índice
+static void changes_begin(void) {
+    bt_batch_begin(&user_index);
+}
+
+static bool changes_commit(void) {
+    return bt_batch_commit(&user_index);
+}
+
+static void changes_abort(void) {
+    bt_batch_abort(&user_index);
+}
+
+#endif // DATABASE_FLASH_INDEX
+
+/** @brief Estados de usuario que esperan su escritura (database_flush) */
+static user_record_t pending[DATABASE_PENDING_MAX];
+static uint32_t pending_count;
+static TickType_t pending_since;    /**< Tick del estado pendiente más antiguo */
+static bool pending_urgent;         /**< Intentos fallidos o lista llena: escribir ya */
+
+static int pending_find(uint32_t key) {
+    for (uint32_t i = 0; i < pending_count; i++) {
+        if (pending[i].id == key) {
+            return (int)i;
+        }
+    }
+    return -1;
+}
+
+static void merkle_load(void);
+
+/**
+ * @brief Escribe los estados pendientes en un lote y actualiza sus hashes
+ *
+ * Si falla, los estados quedan pendientes para el próximo intento.
+ */
+static bool pending_flush(void) {
+    if (pending_count == 0) {
+        return true;
+    }
+
+    bool ok = true;
+    changes_begin();
+    for (uint32_t i = 0; i < pending_count && ok; i++) {
+        uint32_t old;
+        ok = record_load(pending[i].id, &old) && record_store(pending[i].id, pending[i].record);
+        if (ok) {
+            ms_update(&merkle, pending[i].id, &old, &pending[i].record);
+        }
+    }
+    if (ok && !changes_commit()) {
+        ok = false;
+    }
+    if (!ok) {
+        changes_abort();
+        merkle_load();
+        return false;
+    }
+    pending_count = 0;
+    pending_urgent = false;
+    return true;
+}
+
+/**
+ * @brief Hay lugar para un estado pendiente del usuario
+ *
+ * Si la lista está llena pide la escritura inmediata: quien llama responde
+ * "ocupado" y reintenta después de database_flush().
+ */
+static bool pending_room(const char* id) {
+    uint32_t key;
+    if (!pack_id(id, &key) || pending_find(key) >= 0 || pending_count < DATABASE_PENDING_MAX) {
+        return true;
+    }
+    pending_urgent = true;
     return false;
 }
 
+/**
+ * @brief Deja el nuevo estado del usuario pendiente de escritura
+ *
+ * Escribir en la flash borra sectores con las interrupciones deshabilitadas
+ * (hasta 400 ms cada uno), así que la autenticación nunca escribe: lo hace
+ * database_flush() desde una tarea de fondo. Requiere pending_room().
+ *
+ * @param urgent El cambio protege contra la fuerza bruta (intentos
+ *        fallidos, bloqueo) y no espera a que el teclado quede inactivo
+ */
+static bool user_store(const user_t* user, bool urgent) {
+    uint32_t key, record;
+    if (!pack_id(user->id, &key) || !pack_user(user, &record)) {
+        return false;
+    }
+    int i = pending_find(key);
+    if (i < 0) {
+        if (pending_count == DATABASE_PENDING_MAX) {
+            return false;
+        }
+        if (pending_count == 0) {
+            pending_since = xTaskGetTickCount();
+        }
+        i = (int)pending_count++;
+    }
+    pending[i] = (user_record_t){ key, record };
+    pending_urgent |= urgent;
+    return true;
+}
+
+/**
+ * @brief Lee un usuario con su estado pendiente de escritura, si lo tiene
+ */
+static bool user_get(const char* id, user_t* user) {
+    uint32_t key;
+    if (pack_id(id, &key)) {
+        int i = pending_find(key);
+        if (i >= 0) {
+            unpack_user(key, pending[i].record, user);
+            return true;
+        }
+    }
+    return user_load(id, user);
+}
+
+static bool merkle_add(uint32_t key, uint32_t record, void* ctx) {
+    (void)ctx;
+    ms_leaf_add(&merkle, key, record);
+    return true;
+}
+
+/**
+ * @brief Recalcula los hashes recorriendo toda la base
+ */
+static void merkle_load(void) {
+    ms_clear(&merkle);
+    scan_range(0, UINT32_MAX, merkle_add, NULL);
+    ms_rebuild(&merkle);
+}
+
+static bool print_scanned(uint32_t key, uint32_t record, void* ctx) {
+    uint32_t* total = ctx;
+    if (++*total <= DATABASE_PRINT_MAX) {
+        user_t user;
+        unpack_user(key, record, &user);
+        print_user(*total, &user);
+    }
+    return true;
+}
+
+static uint32_t print_range(uint32_t from, uint32_t to) {
+    uint32_t total = 0;
+    scan_range(from, to, print_scanned, &total);
+    return total;
+}
+
+bool database_init(void) {
+    database_mutex = RTOS_MUTEX_CREATE(database_mutex);
+    if (database_mutex == NULL || !storage_init()) {
+        return false;
+    }
+    merkle_load();
+    return true;
+}
+
+auth_result_t authenticate_user(const char* id, const char* password) {
+    user_t user;
+    auth_result_t result;
+
+    if (!DATABASE_LOCK_AUTH()) {
+        LOG_WARN("Base ocupada: autenticación de %lu sin verificar", log_decimal(id));
+        return AUTH_BUSY;
+    }
+
+    if (!user_get(id, &user)) {
+        // Usuario no encontrado
+        LOG_WARN("Usuario %lu no encontrado", log_decimal(id));
+        result = AUTH_USER_NOT_FOUND;
+    } else if (user.blocked) {
+        // Usuario bloqueado
+        LOG_WARN("Usuario %lu está bloqueado", log_decimal(id));
+        result = AUTH_USER_BLOCKED;
+    } else if (!pending_room(id)) {
+        // Sin lugar para guardar el resultado: no se verifica
+        LOG_WARN("Escrituras pendientes llenas: autenticación de %lu sin verificar",
+                 log_decimal(id));
+        result = AUTH_BUSY;
+    } else {
+        bool changed = true;
+        if (strcmp(user.password, password) == 0) {
+            // Contraseña correcta - resetear contador de intentos fallidos
+            changed = (user.failed_attempts != 0);
+            user.failed_attempts = 0;
+            LOG_INFO("Acceso concedido para usuario %lu", log_decimal(id));
+            result = AUTH_SUCCESS;
+        } else {
+            // Contraseña incorrecta - incrementar contador
+            user.failed_attempts++;
+            LOG_WARN("Contraseña incorrecta para usuario %lu (intento %d/%d)",
+                     log_decimal(id), user.failed_attempts, MAX_FAILED_ATTEMPTS);
+            result = AUTH_WRONG_PASSWORD;
+
+            // Bloquear usuario si supera el límite
+            if (user.failed_attempts >= MAX_FAILED_ATTEMPTS) {
+                user.blocked = true;
+                LOG_ERROR("Usuario %lu ha sido BLOQUEADO permanentemente", log_decimal(id));
+                result = AUTH_USER_BLOCKED;
+            }
+        }
+
+        if (changed && !user_store(&user, result != AUTH_SUCCESS)) {
+            LOG_ERROR("No se pudo guardar el estado del usuario %lu", log_decimal(id));
+        }
+    }
+
+    DATABASE_UNLOCK();
+    return result;
+}
+
+password_result_t change_user_password(const char* id, const char* old_password,
+                                       const char* new_password) {
+    user_t user;
+    password_result_t result = PASSWORD_REJECTED;
+
+    if (!DATABASE_LOCK_AUTH()) {
+        LOG_WARN("Base ocupada: cambio de contraseña de %lu sin aplicar", log_decimal(id));
+        return PASSWORD_BUSY;
+    }
+
+    // Verificar contraseña actual
+    if (user_get(id, &user) && !user.blocked && strcmp(user.password, old_password) == 0) {
+        if (!pending_room(id)) {
+            LOG_WARN("Escrituras pendientes llenas: cambio de contraseña de %lu sin aplicar",
+                     log_decimal(id));
+            result = PASSWORD_BUSY;
+        } else {
+            strcpy(user.password, new_password);
+            if (user_store(&user, false)) {
+                LOG_INFO("Contraseña cambiada exitosamente para usuario %lu", log_decimal(id));
+                result = PASSWORD_CHANGED;
+            }
+        }
+    }
+
+    DATABASE_UNLOCK();
+    return result;
+}
+
+bool database_flush(void) {
+    DATABASE_LOCK();
+    bool ok = pending_flush();
+    DATABASE_UNLOCK();
+
+    if (!ok) {
+        LOG_ERROR("No se pudieron escribir %lu usuarios pendientes", (unsigned long)pending_count);
+    }
+    return ok;
+}
+
+uint32_t database_pending(void) {
+    return pending_count;
+}
+
+uint32_t database_flush_due_ms(void) {
+    if (pending_count == 0) {
+        return DATABASE_FLUSH_NONE;
+    }
+    uint32_t age_ms = (uint32_t)((xTaskGetTickCount() - pending_since) * portTICK_PERIOD_MS);
+    if (pending_urgent || age_ms >= DATABASE_FLUSH_DEADLINE_MS) {
+        return 0;
+    }
+    return DATABASE_FLUSH_DEADLINE_MS - age_ms;
+}
+
+void database_print_users(uint32_t from, uint32_t to) {
+    DATABASE_LOCK();
+    uint32_t total = print_range(from, to);
+    DATABASE_UNLOCK();
+
+    if (total > DATABASE_PRINT_MAX) {
+        printf("... y %lu más\n", (unsigned long)(total - DATABASE_PRINT_MAX));
+    }
+    printf("%lu usuarios entre %06lu y %06lu\n", (unsigned long)total,
+           (unsigned long)from, (unsigned long)to);
+}
+
+uint64_t database_sync_hash(uint32_t node, uint32_t* count) {
+    DATABASE_LOCK();
+    uint64_t hash = ms_hash(&merkle, node);
+    if (count != NULL) {
+        *count = stored_count();
+    }
+    DATABASE_UNLOCK();
+    return hash;
+}
+
+/**
+ * @brief Suma de un rango para database_sync_range()
+ */
+typedef struct {
+    uint64_t hash;
+    uint32_t count;
+} range_ctx_t;
+
+static bool range_add(uint32_t key, uint32_t record, void* ctx) {
+    range_ctx_t* range = ctx;
+    range->hash += ms_entry_hash(key, record);
+    range->count++;
+    return true;
+}
+
+uint64_t database_sync_range(uint32_t from, uint32_t to, uint32_t* count) {
+    range_ctx_t range = { 0, 0 };
+    DATABASE_LOCK();
+    scan_range(from, to, range_add, &range);
+    DATABASE_UNLOCK();
+    *count = range.count;
+    return range.hash;
+}
+
+/**
+ * @brief Registros copiados por database_sync_list()
+ */
+typedef struct {
+    user_record_t* out;
+    uint32_t max;
+    uint32_t total;
+} list_ctx_t;
+
+static bool list_record(uint32_t key, uint32_t record, void* ctx) {
+    list_ctx_t* list = ctx;
+    if (list->total < list->max) {
+        list->out[list->total] = (user_record_t){ key, record };
+    }
+    list->total++;
+    return true;
+}
+
+uint32_t database_sync_list(uint32_t from, uint32_t to, user_record_t* out, uint32_t max) {
+    list_ctx_t list = { out, max, 0 };
+    DATABASE_LOCK();
+    scan_range(from, to, list_record, &list);
+    DATABASE_UNLOCK();
+    return list.total;
+}
+
+/**
+ * @brief Aplica un lote con la base tomada; si falla no cambia nada
+ */
+static sync_result_t apply_changes(const user_change_t* changes, uint32_t n,
+                                   const uint64_t* expected_root) {
+    sync_result_t result = SYNC_OK;
+
+    changes_begin();
+
+    for (uint32_t c = 0; c < n; c++) {
+        const user_change_t* change = &changes[c];
+        uint32_t old;
+        bool existed = record_load(change->id, &old);
+        bool ok = change->remove ? (!existed || record_remove(change->id))
+                                 : record_store(change->id, change->record);
+        if (!ok) {
+            LOG_ERROR("No se pudo sincronizar el usuario %lu", (unsigned long)change->id);
+            result = SYNC_FAILED;
+            break;
+        }
+        ms_update(&merkle, change->id, existed ? &old : NULL,
+                  change->remove ? NULL : &change->record);
+    }
+
+    // La raíz esperada detecta cambios hechos en el dispositivo durante la sincronización
+    if (result == SYNC_OK && expected_root != NULL &&
+        ms_hash(&merkle, MS_ROOT) != *expected_root) {
+        result = SYNC_ROOT_MISMATCH;
+    }
+    if (result == SYNC_OK && !changes_commit()) {
+        result = SYNC_FAILED;
+    }
+    if (result != SYNC_OK) {
+        changes_abort();
+        merkle_load();
+    }
+    return result;
+}
+
+sync_result_t database_sync_apply(const user_change_t* changes, uint32_t n,
+                                  const uint64_t* expected_root, uint32_t* elapsed_us) {
+    sync_result_t result = SYNC_FAILED;
+
+    DATABASE_LOCK();
+    uint64_t start_us = time_us_64();
+
+    // Los estados pendientes van antes y por separado: un lote descartado
+    // no debe perderlos
+    if (pending_flush()) {
+        result = apply_changes(changes, n, expected_root);
+    }
+    uint32_t count = stored_count();
+    uint32_t held_us = (uint32_t)(time_us_64() - start_us);
+
+    DATABASE_UNLOCK();
+
+    if (elapsed_us != NULL) {
+        *elapsed_us = held_us;
+    }
+    if (result == SYNC_OK) {
+        LOG_INFO("Sincronización aplicada: %lu cambios, %lu usuarios, %lu ms",
+                 (unsigned long)n, (unsigned long)count, (unsigned long)(held_us / 1000));
+    } else {
+        LOG_WARN("Sincronización descartada (%lu cambios, %lu ms)",
+                 (unsigned long)n, (unsigned long)(held_us / 1000));
+    }
+    return result;
+}
+
 void print_database_status(void) {
     printf("\n=== ESTADO DE LA BASE DE DATOS ===\n");
-    for (int i = 0; i < user_count; i++) {
-        printf("Usuario %d: ID=%s, Intentos fallidos=%d, Bloqueado=%s\n",
-               i+1, users[i].id, users[i].failed_attempts,
-               users[i].blocked ? "SÍ" : "NO");
-    }
+    database_print_users(0, 999999);
+#if DATABASE_FLASH_INDEX
+    DATABASE_LOCK();
+    bt_stats_t stats = user_index.stats;
+    printf("Índice en flash: %u niveles, %lu páginas libres, caché %lu aciertos / %lu lecturas, "
+           "%lu borrados\n", user_index.height, (unsigned long)user_index.free_pages,
+           (unsigned long)stats.cache_hits, (unsigned long)stats.cache_misses,
+           (unsigned long)stats.erases);
+    DATABASE_UNLOCK();
+#endif
     printf("================================\n\n");
 }
@@ -8,6 +8,17 @@
  * autenticación, bloqueo por intentos fallidos y cambio de contraseñas.
  * La base de datos se almacena en memoria RAM y se inicializa con usuarios
  * predeterminados.
+ *
+ * Con DATABASE_FLASH_INDEX = 1 los usuarios se guardan en un árbol B+ en la
+ * flash (flash_btree.c sobre user_flash.c), con lugar para más de 100 mil
+ * IDs: cada búsqueda lee a lo sumo dos páginas y los cambios de clave o de
+ * intentos fallidos se escriben con copia en escritura. Los usuarios
+ * predeterminados se cargan solo si la región no tiene un índice válido.
+ *
+ * La base mantiene un árbol de Merkle (merkle_sync.h) sobre sus registros
+ * para que el host sincronice solo las diferencias: compara hashes, lista
+ * las cubetas que difieren y aplica los cambios con database_sync_apply()
+ * de forma atómica (protocolo en db_sync.h).
  */
 
 #ifndef DATABASE_H
@@ -16,7 +27,12 @@
 #include <stdbool.h>
 #include <stdint.h>
 
-/** @brief Número máximo de usuarios en la base de datos */
+/** @brief Índice de usuarios en flash en lugar del arreglo en RAM */
+#ifndef DATABASE_FLASH_INDEX
+#define DATABASE_FLASH_INDEX 0
+#endif
+
+/** @brief Número máximo de usuarios en la base de datos (en RAM) */
 #define MAX_USERS 10
 
 /** @brief Longitud del ID de usuario (6 dígitos) */
@@ -25,9 +41,39 @@
 /** @brief Longitud de la contraseña (4 dígitos) */
 #define PASSWORD_LENGTH 4
 
+/** @brief Usuarios que lista database_print_users() */
+#define DATABASE_PRINT_MAX 50
+
 /** @brief Número máximo de intentos fallidos antes de bloqueo */
 #define MAX_FAILED_ATTEMPTS 3
 
+/** @brief Usuarios con cambios en RAM a la espera de database_flush() */
+#ifndef DATABASE_PENDING_MAX
+#define DATABASE_PENDING_MAX 8
+#endif
+
+/** @brief Plazo máximo de un cambio pendiente, esté o no activo el teclado (ms) */
+#define DATABASE_FLUSH_DEADLINE_MS 5000
+
+/** @brief database_flush_due_ms() sin nada pendiente */
+#define DATABASE_FLUSH_NONE UINT32_MAX
+
+/**
+ * @brief Espera máxima de la autenticación por la base (ms)
+ *
+ * Una sincronización retiene la base durante sus borrados de flash; la
+ * tarea de acceso no debe pasarse de su contrato (task_health.c) esperándola.
+ */
+#define DATABASE_AUTH_WAIT_MS 50
+
+/*
+ * Registro de 32 bits de un usuario, usado por el índice en flash y por la
+ * sincronización: contraseña en BCD en los bits 0-15, intentos fallidos en
+ * 16-23 y bloqueo en el bit 24. La clave es el valor numérico del ID.
+ */
+#define DATABASE_RECORD_FAILED_SHIFT    16
+#define DATABASE_RECORD_BLOCKED         (1u << 24)
+
 /**
  * @brief Estructura que representa un usuario en la base de datos
  */
@@ -38,6 +84,32 @@ typedef struct {
     bool blocked;                  /**< Estado de bloqueo del usuario */
 } user_t;
 
+/**
+ * @brief Usuario en forma de registro
+ */
+typedef struct {
+    uint32_t id;                   /**< Valor numérico del ID */
+    uint32_t record;               /**< Registro empaquetado */
+} user_record_t;
+
+/**
+ * @brief Alta, modificación o baja de una sincronización
+ */
+typedef struct {
+    uint32_t id;                   /**< Valor numérico del ID */
+    uint32_t record;               /**< Registro nuevo (ignorado en una baja) */
+    bool remove;                   /**< Eliminar el usuario */
+} user_change_t;
+
+/**
+ * @brief Resultado de aplicar una sincronización
+ */
+typedef enum {
+    SYNC_OK,                /**< Cambios publicados */
+    SYNC_ROOT_MISMATCH,     /**< La raíz resultante no es la esperada; nada cambió */
+    SYNC_FAILED             /**< Sin espacio o falla de la flash; nada cambió */
+} sync_result_t;
+
 /**
  * @brief Resultados posibles de la autenticación de usuario
  */
@@ -45,9 +117,19 @@ typedef enum {
     AUTH_SUCCESS,           /**< Autenticación exitosa */
     AUTH_USER_NOT_FOUND,    /**< ID de usuario no encontrado en la base de datos */
     AUTH_WRONG_PASSWORD,    /**< Contraseña incorrecta */
-    AUTH_USER_BLOCKED       /**< Usuario bloqueado por intentos fallidos */
+    AUTH_USER_BLOCKED,      /**< Usuario bloqueado por intentos fallidos */
+    AUTH_BUSY               /**< Base ocupada; no se verificó nada, reintentar */
 } auth_result_t;
 
+/**
+ * @brief Resultados posibles del cambio de contraseña
+ */
+typedef enum {
+    PASSWORD_CHANGED,       /**< Contraseña reemplazada */
+    PASSWORD_REJECTED,      /**< Usuario inexistente, bloqueado o clave actual incorrecta */
+    PASSWORD_BUSY           /**< Base ocupada; no se verificó nada, reintentar */
+} password_result_t;
+
 /**
  * @brief Inicializa la base de datos con usuarios predeterminados
  * 
@@ -58,9 +140,13 @@ typedef enum {
  * - ID: "901234", Password: "3456"
  * - ID: "567890", Password: "7890"
  * 
- * Todos los usuarios inician sin bloqueos ni intentos fallidos.
+ * Todos los usuarios inician sin bloqueos ni intentos fallidos. Con el
+ * índice en flash se monta el índice existente y los usuarios
+ * predeterminados se cargan solo si la región está vacía.
+ *
+ * @return true Si la base de datos quedó disponible
  */
-void database_init(void);
+bool database_init(void);
 
 /**
  * @brief Autentica un usuario con ID y contraseña
@@ -75,6 +161,14 @@ void database_init(void);
  * 
  * @note Si la autenticación es exitosa, se resetea el contador de intentos fallidos
  * @note Al superar MAX_FAILED_ATTEMPTS, el usuario se bloquea permanentemente
+ * @note El nuevo contador queda en RAM hasta database_flush(): la
+ *       autenticación no escribe la flash. Un intento fallido o un bloqueo
+ *       se escribe sin esperar a que el teclado quede inactivo; un corte de
+ *       energía en ese intervalo (la espera de la tarea Stats más la
+ *       escritura, a lo sumo ~1,3 s) lo pierde
+ * @note Si la base sigue ocupada tras DATABASE_AUTH_WAIT_MS, o no hay lugar
+ *       entre los DATABASE_PENDING_MAX pendientes, devuelve AUTH_BUSY sin
+ *       tocar el contador
  */
 auth_result_t authenticate_user(const char* id, const char* password);
 
@@ -89,10 +183,46 @@ auth_result_t authenticate_user(const char* id, const char* password);
  * @param old_password Contraseña actual del usuario
  * @param new_password Nueva contraseña a establecer
  * 
- * @return true Si el cambio fue exitoso
- * @return false Si el cambio falló (usuario no encontrado, bloqueado, o contraseña incorrecta)
+ * @return PASSWORD_CHANGED si el cambio fue exitoso
+ * @return PASSWORD_REJECTED si el usuario no existe, está bloqueado o la
+ *         contraseña actual es incorrecta
+ * @return PASSWORD_BUSY si la base siguió ocupada DATABASE_AUTH_WAIT_MS o no
+ *         hay lugar para un cambio pendiente (reintentar)
+ *
+ * @note Como en authenticate_user(), la clave nueva se escribe en
+ *       database_flush(), a lo sumo DATABASE_FLUSH_DEADLINE_MS después;
+ *       un corte de energía antes la pierde
+ */
+password_result_t change_user_password(const char* id, const char* old_password,
+                                       const char* new_password);
+
+/**
+ * @brief Escribe los intentos fallidos, bloqueos y claves pendientes
+ *
+ * Con el índice en flash cada escritura borra sectores con las
+ * interrupciones deshabilitadas; debe llamarse desde una tarea de fondo y
+ * no desde el camino de la autenticación. Un corte de energía antes de
+ * llamarla pierde los cambios pendientes; database_flush_due_ms() acota esa
+ * ventana (inmediata para intentos fallidos y bloqueos,
+ * DATABASE_FLUSH_DEADLINE_MS para el resto).
+ *
+ * @return true si no quedó nada pendiente
+ */
+bool database_flush(void);
+
+/**
+ * @brief Usuarios con cambios pendientes de database_flush()
  */
-bool change_user_password(const char* id, const char* old_password, const char* new_password);
+uint32_t database_pending(void);
+
+/**
+ * @brief Tiempo hasta que los cambios pendientes deben escribirse
+ *
+ * 0 si hay un intento fallido o bloqueo pendiente, si la lista está llena o
+ * si el más antiguo cumplió DATABASE_FLUSH_DEADLINE_MS: entonces se escriben
+ * aunque el teclado esté activo. Sin pendientes devuelve DATABASE_FLUSH_NONE.
+ */
+uint32_t database_flush_due_ms(void);
 
 /**
  * @brief Imprime el estado actual de todos los usuarios en la base de datos
@@ -104,4 +234,53 @@ bool change_user_password(const char* id, const char* old_password, const char*
  */
 void print_database_status(void);
 
+/**
+ * @brief Lista los usuarios con ID en [from, to] (administración)
+ *
+ * Muestra los primeros DATABASE_PRINT_MAX y cuenta el resto. Con el índice
+ * en flash el recorrido lee solo las hojas del rango.
+ *
+ * @param from Primer ID (valor numérico de los 6 dígitos)
+ * @param to Último ID
+ */
+void database_print_users(uint32_t from, uint32_t to);
+
+/**
+ * @brief Hash de un nodo del árbol de Merkle de la base
+ *
+ * @param node Nodo (MS_ROOT para la raíz)
+ * @param count Si no es NULL, recibe la cantidad de usuarios
+ */
+uint64_t database_sync_hash(uint32_t node, uint32_t* count);
+
+/**
+ * @brief Hash del conjunto de registros de [from, to] (suma de ms_entry_hash)
+ *
+ * @param count Recibe la cantidad de registros del rango
+ */
+uint64_t database_sync_range(uint32_t from, uint32_t to, uint32_t* count);
+
+/**
+ * @brief Copia en orden de ID los registros de [from, to]
+ *
+ * @param out Destino de los primeros max registros
+ * @return Registros del rango (puede superar max)
+ */
+uint32_t database_sync_list(uint32_t from, uint32_t to, user_record_t* out, uint32_t max);
+
+/**
+ * @brief Aplica un grupo de cambios de forma atómica
+ *
+ * Con el índice en flash los cambios se escriben en un lote que se publica
+ * con un solo superbloque; en RAM se descartan restaurando una copia. La
+ * base queda tomada mientras se aplican: la autenticación espera hasta
+ * DATABASE_AUTH_WAIT_MS y responde AUTH_BUSY.
+ *
+ * @param expected_root Raíz que debe quedar tras aplicarlos, o NULL para no
+ *        verificarla
+ * @param elapsed_us Si no es NULL, recibe el tiempo con la base tomada (µs)
+ */
+sync_result_t database_sync_apply(const user_change_t* changes, uint32_t n,
+                                  const uint64_t* expected_root, uint32_t* elapsed_us);
+
 #endif // DATABASE_H
@@ -0,0 +1,250 @@
+/**
+ * @file db_sync.c
+ * @brief Implementación del protocolo de sincronización incremental
+ * @author Sistema de Control de Acceso
+ * @date 2025
+ */
+
+#include "db_sync.h"
+#include "database.h"
+#include "merkle_sync.h"
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+
+/** @brief Cambios recibidos desde "sync begin" */
+static user_change_t staged[DB_SYNC_MAX_CHANGES];
+static uint32_t staged_count = 0;
+static bool staging = false;
+
+/** @brief Línea de respuesta en construcción */
+static char reply[DB_SYNC_REPLY_LEN];
+static size_t reply_len = 0;
+
+static void reply_start(const char *head) {
+    reply_len = (size_t)snprintf(reply, sizeof(reply), "SYNC %s", head);
+}
+
+static void reply_add(const char *fmt, unsigned long a, unsigned long b) {
+    if (reply_len < sizeof(reply)) {
+        reply_len += (size_t)snprintf(&reply[reply_len], sizeof(reply) - reply_len, fmt, a, b);
+    }
+}
+
+static void reply_hash(uint64_t hash) {
+    reply_add(" %08lx%08lx", (unsigned long)(hash >> 32), (unsigned long)(uint32_t)hash);
+}
+
+static void reply_error(const char *reason, db_sync_emit_t emit) {
+    staging = false;
+    snprintf(reply, sizeof(reply), "SYNC ERR %s", reason);
+    emit(reply);
+}
+
+/**
+ * @brief Lee n dígitos en la base indicada
+ */
+static bool parse_digits(const char *s, int n, int base, uint32_t *value) {
+    *value = 0;
+    for (int i = 0; i < n; i++) {
+        char c = s[i];
+        uint32_t d;
+        if (c >= '0' && c <= '9') {
+            d = (uint32_t)(c - '0');
+        } else if (base == 16 && c >= 'a' && c <= 'f') {
+            d = (uint32_t)(c - 'a' + 10);
+        } else if (base == 16 && c >= 'A' && c <= 'F') {
+            d = (uint32_t)(c - 'A' + 10);
+        } else {
+            return false;
+        }
+        *value = *value * (uint32_t)base + d;
+    }
+    return true;
+}
+
+/**
+ * @brief Registro con contraseña en BCD y sin bits fuera del formato
+ */
+static bool record_valid(uint32_t record) {
+    if (record & ~(DATABASE_RECORD_BLOCKED | (0xFFu << DATABASE_RECORD_FAILED_SHIFT) | 0xFFFFu)) {
+        return false;
+    }
+    for (int i = 0; i < PASSWORD_LENGTH; i++) {
+        if (((record >> (4 * i)) & 0xFu) > 9) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Interpreta un cambio "+IIIIIIRRRRRRRR" o "-IIIIII"
+ */
+static bool parse_change(const char *tok, size_t len, user_change_t *change) {
+    change->remove = (tok[0] == '-');
+    change->record = 0;
+    if (change->remove) {
+        return len == 1 + ID_LENGTH && parse_digits(tok + 1, ID_LENGTH, 10, &change->id);
+    }
+    return tok[0] == '+' && len == 1 + ID_LENGTH + 8 &&
+           parse_digits(tok + 1, ID_LENGTH, 10, &change->id) &&
+           parse_digits(tok + 1 + ID_LENGTH, 8, 16, &change->record) &&
+           record_valid(change->record);
+}
+
+static void cmd_root(db_sync_emit_t emit) {
+    uint32_t count;
+    uint64_t hash = database_sync_hash(MS_ROOT, &count);
+    reply_start("ROOT");
+    reply_add(" %lu %lu", (unsigned long)count, (unsigned long)MS_LEAVES);
+    reply_hash(hash);
+    emit(reply);
+}
+
+static void cmd_hash(const char *args, db_sync_emit_t emit) {
+    uint32_t nodes = 0;
+    reply_start("HASH");
+    while (*args != '\0') {
+        char *end;
+        unsigned long node = strtoul(args, &end, 10);
+        if (end == args || (*end != ' ' && *end != '\0') || ++nodes > DB_SYNC_HASH_MAX) {
+            reply_error("nodo", emit);
+            return;
+        }
+        reply_hash(database_sync_hash((uint32_t)node, NULL));
+        args = (*end == ' ') ? end + 1 : end;
+    }
+    emit(reply);
+}
+
+static void cmd_split(const char *args, db_sync_emit_t emit) {
+    char *end;
+    unsigned long from = strtoul(args, &end, 10);
+    unsigned long to = (*end == ' ') ? strtoul(end + 1, &end, 10) : 0;
+    unsigned long parts = (*end == ' ') ? strtoul(end + 1, &end, 10) : 0;
+    if (*end != '\0' || to < from || parts == 0 || parts > DB_SYNC_SPLIT_MAX ||
+        parts > to - from + 1) {
+        reply_error("rango", emit);
+        return;
+    }
+
+    reply_start("SPLIT");
+    for (uint32_t part = 0; part < parts; part++) {
+        uint32_t part_from, part_to, count;
+        ms_split_range((uint32_t)from, (uint32_t)to, (uint32_t)parts, part, &part_from, &part_to);
+        uint64_t hash = database_sync_range(part_from, part_to, &count);
+        reply_add(" %lu", (unsigned long)count, 0);
+        reply_hash(hash);
+    }
+    emit(reply);
+}
+
+static void cmd_list(const char *args, db_sync_emit_t emit) {
+    static user_record_t page[DB_SYNC_LIST_PAGE];
+    char *end;
+    unsigned long from = strtoul(args, &end, 10);
+    unsigned long to = (*end == ' ') ? strtoul(end + 1, &end, 10) : 0;
+    if (*end != '\0' || to < from) {
+        reply_error("rango", emit);
+        return;
+    }
+
+    uint32_t total = database_sync_list((uint32_t)from, (uint32_t)to, page, DB_SYNC_LIST_PAGE);
+    reply_start("LIST");
+    reply_add(" %lu", (unsigned long)total, 0);
+    for (uint32_t i = 0; i < total && i < DB_SYNC_LIST_PAGE; i++) {
+        reply_add(" %06lu%08lx", (unsigned long)page[i].id, (unsigned long)page[i].record);
+    }
+    emit(reply);
+}
+
+static void cmd_ops(const char *args, db_sync_emit_t emit) {
+    if (!staging) {
+        reply_error("sin begin", emit);
+        return;
+    }
+
+    while (*args != '\0') {
+        size_t len = strcspn(args, " ");
+        if (staged_count == DB_SYNC_MAX_CHANGES) {
+            reply_error("lleno", emit);
+            return;
+        }
+        if (!parse_change(args, len, &staged[staged_count])) {
+            reply_error("cambio", emit);
+            return;
+        }
+        staged_count++;
+        args += len;
+        args += (*args == ' ');
+    }
+
+    reply_start("OK");
+    reply_add(" %lu", (unsigned long)staged_count, 0);
+    emit(reply);
+}
+
+static void cmd_commit(const char *args, db_sync_emit_t emit) {
+    uint32_t hi, lo;
+    uint64_t expected;
+    bool check = args[0] != '\0';
+
+    if (!staging) {
+        reply_error("sin begin", emit);
+        return;
+    }
+    if (check) {
+        if (strlen(args) != 16 || !parse_digits(args, 8, 16, &hi) ||
+            !parse_digits(args + 8, 8, 16, &lo)) {
+            reply_error("hash", emit);
+            return;
+        }
+        expected = ((uint64_t)hi << 32) | lo;
+    }
+
+    staging = false;
+    uint32_t elapsed_us;
+    sync_result_t result = database_sync_apply(staged, staged_count, check ? &expected : NULL,
+                                               &elapsed_us);
+    uint32_t count;
+    uint64_t root = database_sync_hash(MS_ROOT, &count);
+
+    if (result == SYNC_OK) {
+        reply_start("DONE");
+        reply_add(" %lu", (unsigned long)count, 0);
+    } else if (result == SYNC_ROOT_MISMATCH) {
+        reply_start("MISMATCH");
+    } else {
+        reply_error("aplicar", emit);
+        return;
+    }
+    reply_hash(root);
+    reply_add(" %lu", (unsigned long)elapsed_us, 0);
+    emit(reply);
+}
+
+void db_sync_command(const char *args, db_sync_emit_t emit) {
+    size_t len = strcspn(args, " ");
+    const char *rest = args + len + (args[len] == ' ');
+
+    if (len == 4 && strncmp(args, "root", 4) == 0) {
+        cmd_root(emit);
+    } else if (len == 4 && strncmp(args, "hash", 4) == 0) {
+        cmd_hash(rest, emit);
+    } else if (len == 5 && strncmp(args, "split", 5) == 0) {
+        cmd_split(rest, emit);
+    } else if (len == 4 && strncmp(args, "list", 4) == 0) {
+        cmd_list(rest, emit);
+    } else if (len == 3 && strncmp(args, "ops", 3) == 0) {
+        cmd_ops(rest, emit);
+    } else if (len == 6 && strncmp(args, "commit", 6) == 0) {
+        cmd_commit(rest, emit);
+    } else if (len == 5 && (strncmp(args, "begin", 5) == 0 || strncmp(args, "abort", 5) == 0)) {
+        staging = (args[0] == 'b');
+        staged_count = 0;
+        emit("SYNC OK 0");
+    } else {
+        reply_error("comando", emit);
+    }
+}
@@ -0,0 +1,73 @@
+/**
+ * @file db_sync.h
+ * @brief Protocolo de sincronización incremental de la base de usuarios
+ * @author Sistema de Control de Acceso
+ * @date 2025
+ *
+ * Comando "sync" de la consola. El host (tools/db_sync.c) recorre el árbol
+ * de Merkle de la base desde la raíz pidiendo solo los nodos que difieren
+ * de los suyos, lista las cubetas distintas y envía únicamente las altas,
+ * cambios y bajas, que el dispositivo aplica de forma atómica. Cada línea
+ * de respuesta empieza con "SYNC " para separarla de los mensajes del log:
+ *
+ *   sync root                 -> SYNC ROOT <usuarios> <cubetas> <hash>
+ *   sync hash <nodo>...       -> SYNC HASH <hash>...  (hasta DB_SYNC_HASH_MAX)
+ *   sync split <desde> <hasta> <partes>
+ *                             -> SYNC SPLIT <usuarios> <hash>...  (por parte)
+ *   sync list <desde> <hasta> -> SYNC LIST <total> <IIIIIIRRRRRRRR>...
+ *   sync begin                -> SYNC OK 0
+ *   sync ops <cambio>...      -> SYNC OK <cambios acumulados>
+ *   sync commit [<hash>]      -> SYNC DONE <usuarios> <hash> <µs>
+ *                                | SYNC MISMATCH <hash> <µs>
+ *   sync abort                -> SYNC OK 0
+ *
+ * Los hashes van en 16 dígitos hexadecimales y los registros como el ID de
+ * 6 dígitos seguido del registro de 32 bits en 8 dígitos hexadecimales
+ * (ver database.h). "sync split" divide un rango (una cubeta distinta) en
+ * hasta DB_SYNC_SPLIT_MAX partes con ms_split_range() y entrega la suma de
+ * cada una, calculada recorriendo el rango: el host lista solo las partes
+ * que difieren y no la cubeta entera. Un cambio es "+IIIIIIRRRRRRRR" (alta o modificación) o
+ * "-IIIIII" (baja). "sync list" entrega a lo sumo DB_SYNC_LIST_PAGE
+ * registros: si el total es mayor, el host continúa desde el último ID + 1.
+ * commit verifica que la raíz resultante sea la indicada; si la base cambió
+ * en el medio (un intento fallido, por ejemplo) no se aplica nada. Cualquier
+ * error responde "SYNC ERR <motivo>" y descarta los cambios acumulados.
+ *
+ * La transferencia de los cambios no bloquea la base: solo commit la toma,
+ * durante la escritura de las hojas afectadas, y responde cuánto tiempo la
+ * retuvo (<µs>). Mientras tanto la autenticación responde AUTH_BUSY pasados
+ * DATABASE_AUTH_WAIT_MS.
+ */
+
+#ifndef DB_SYNC_H
+#define DB_SYNC_H
+
+/** @brief Cambios que se pueden acumular antes de commit */
+#define DB_SYNC_MAX_CHANGES     256
+
+/** @brief Nodos por pedido de "sync hash" */
+#define DB_SYNC_HASH_MAX        24
+
+/** @brief Partes por pedido de "sync split" */
+#define DB_SYNC_SPLIT_MAX       16
+
+/** @brief Registros por respuesta de "sync list" */
+#define DB_SYNC_LIST_PAGE       32
+
+/** @brief Longitud máxima de una línea de respuesta */
+#define DB_SYNC_REPLY_LEN       (16 + DB_SYNC_LIST_PAGE * 15)
+
+/**
+ * @brief Salida de una línea de respuesta (sin el fin de línea)
+ */
+typedef void (*db_sync_emit_t)(const char *line);
+
+/**
+ * @brief Ejecuta un subcomando de "sync"
+ *
+ * @param args Texto después de "sync "
+ * @param emit Salida de las respuestas
+ */
+void db_sync_command(const char *args, db_sync_emit_t emit);
+
+#endif // DB_SYNC_H
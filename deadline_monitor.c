@@ -0,0 +1,196 @@
+/**
+ * @file deadline_monitor.c
+ * @brief Implementación del monitor de plazos y latidos de tareas
+ * @author Sistema de Control de Acceso
+ * @date 2025
+ */
+
+#include "deadline_monitor.h"
+#include <string.h>
+
+_Static_assert(DM_MAX_TASKS <= 32, "dm_check devuelve una máscara de 32 bits");
+
+/**
+ * @brief true si el instante t ya fue superado en now (tolerante a desborde)
+ */
+static inline bool time_passed(uint32_t now, uint32_t t) {
+    return (int32_t)(now - t) > 0;
+}
+
+/**
+ * @brief Contrato válido o NULL
+ */
+static dm_task_t *task_at(dm_monitor_t *m, int id) {
+    if (id < 0 || id >= m->count) {
+        return NULL;
+    }
+    return &m->tasks[id];
+}
+
+/**
+ * @brief Registra un atraso de late_ms sobre el plazo (0 = a tiempo)
+ *
+ * Si el plazo ya había sido contado como vencido por dm_check, solo se
+ * actualiza el peor atraso.
+ */
+static void record_lateness(dm_task_t *t, uint32_t late_ms) {
+    if (late_ms > t->tolerance_ms && !t->overdue) {
+        t->misses++;
+    }
+    if (late_ms > t->worst_late_ms) {
+        t->worst_late_ms = late_ms;
+    }
+    t->overdue = false;
+}
+
+/**
+ * @brief Cubeta del histograma para un valor en milisegundos
+ */
+uint8_t dm_hist_bucket(uint32_t value_ms) {
+    uint8_t bucket = 0;
+
+    while (value_ms > 0 && bucket < DM_HIST_BUCKETS - 1) {
+        value_ms >>= 1;
+        bucket++;
+    }
+    return bucket;
+}
+
+/**
+ * @brief Inicializa el monitor sin contratos
+ */
+void dm_init(dm_monitor_t *m) {
+    memset(m, 0, sizeof(*m));
+}
+
+/**
+ * @brief Registra un contrato
+ */
+int dm_register(dm_monitor_t *m, const char *name, dm_kind_t kind,
+                uint32_t period_ms, uint32_t tolerance_ms) {
+    if (m->count >= DM_MAX_TASKS) {
+        return -1;
+    }
+
+    dm_task_t *t = &m->tasks[m->count];
+    memset(t, 0, sizeof(*t));
+    t->name = name;
+    t->kind = (uint8_t)kind;
+    t->period_ms = period_ms;
+    t->tolerance_ms = tolerance_ms;
+    return m->count++;
+}
+
+/**
+ * @brief Arma el plazo del próximo latido
+ */
+static void arm_next_beat(dm_task_t *t, uint32_t now_ms) {
+    t->last_ms = now_ms;
+    t->due_ms = now_ms + t->period_ms + t->tolerance_ms;
+    t->armed = true;
+}
+
+/**
+ * @brief Inicio (o reinicio) de la actividad periódica
+ */
+void dm_start(dm_monitor_t *m, int id, uint32_t now_ms) {
+    dm_task_t *t = task_at(m, id);
+    if (t == NULL) {
+        return;
+    }
+
+    t->overdue = false;
+    arm_next_beat(t, now_ms);
+}
+
+/**
+ * @brief Latido de una tarea periódica
+ */
+void dm_heartbeat(dm_monitor_t *m, int id, uint32_t now_ms) {
+    dm_task_t *t = task_at(m, id);
+    if (t == NULL) {
+        return;
+    }
+
+    // Sin dm_start previo el latido solo fija la referencia
+    if (t->armed) {
+        uint32_t interval = now_ms - t->last_ms;
+        uint32_t jitter = (interval > t->period_ms) ? interval - t->period_ms
+                                                    : t->period_ms - interval;
+        t->count++;
+        t->hist[dm_hist_bucket(jitter)]++;
+        record_lateness(t, (interval > t->period_ms) ? interval - t->period_ms : 0);
+    }
+
+    arm_next_beat(t, now_ms);
+}
+
+/**
+ * @brief La tarea periódica va a bloquearse sin plazo
+ */
+void dm_idle(dm_monitor_t *m, int id) {
+    dm_task_t *t = task_at(m, id);
+    if (t == NULL) {
+        return;
+    }
+
+    t->armed = false;
+    t->overdue = false;
+}
+
+/**
+ * @brief Comienzo de un trabajo
+ */
+void dm_begin(dm_monitor_t *m, int id, uint32_t now_ms) {
+    dm_task_t *t = task_at(m, id);
+    if (t == NULL) {
+        return;
+    }
+
+    t->last_ms = now_ms;
+    t->due_ms = now_ms + t->period_ms + t->tolerance_ms;
+    t->armed = true;
+    t->overdue = false;
+}
+
+/**
+ * @brief Fin del trabajo en curso
+ */
+void dm_end(dm_monitor_t *m, int id, uint32_t now_ms) {
+    dm_task_t *t = task_at(m, id);
+    if (t == NULL || !t->armed) {
+        return;
+    }
+
+    uint32_t response = now_ms - t->last_ms;
+    t->count++;
+    t->hist[dm_hist_bucket(response)]++;
+    record_lateness(t, (response > t->period_ms) ? response - t->period_ms : 0);
+    t->armed = false;
+}
+
+/**
+ * @brief Revisa los plazos vigentes
+ */
+uint32_t dm_check(dm_monitor_t *m, uint32_t now_ms) {
+    uint32_t unhealthy = 0;
+
+    for (int i = 0; i < m->count; i++) {
+        dm_task_t *t = &m->tasks[i];
+        if (!t->armed || !time_passed(now_ms, t->due_ms)) {
+            continue;
+        }
+
+        if (!t->overdue) {
+            t->overdue = true;
+            t->misses++;
+        }
+
+        uint32_t late = now_ms - t->due_ms + t->tolerance_ms;
+        if (late > t->worst_late_ms) {
+            t->worst_late_ms = late;
+        }
+        unhealthy |= 1u << i;
+    }
+    return unhealthy;
+}
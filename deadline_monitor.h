@@ -0,0 +1,134 @@
+/**
+ * @file deadline_monitor.h
+ * @brief Monitor de plazos y latidos de tareas
+ * @author Sistema de Control de Acceso
+ * @date 2025
+ *
+ * Cada tarea vigilada declara un contrato temporal de uno de dos tipos:
+ *
+ * - Periódico: la tarea marca el comienzo de su actividad (dm_start), late
+ *   (dm_heartbeat) cada period_ms mientras está activa y avisa con dm_idle
+ *   antes de bloquearse indefinidamente. Se mide el jitter del intervalo
+ *   entre latidos.
+ * - Trabajo: la tarea marca el inicio (dm_begin) y el fin (dm_end) de cada
+ *   trabajo, que debe completarse en deadline_ms. Se mide el tiempo de
+ *   respuesta.
+ *
+ * Un latido o fin de trabajo tardío cuenta como incumplimiento. Además,
+ * dm_check detecta tareas que siguen sin responder después de su plazo
+ * (bloqueadas, por ejemplo, en una transferencia I2C) y devuelve la máscara
+ * de tareas no saludables, que decide si se alimenta el watchdog.
+ *
+ * El módulo no depende de FreeRTOS ni del SDK: trabaja con tiempos en
+ * milisegundos entregados por el llamador, lo que permite simular bloqueos
+ * en el host.
+ */
+
+#ifndef DEADLINE_MONITOR_H
+#define DEADLINE_MONITOR_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/** @brief Número máximo de contratos vigilados */
+#define DM_MAX_TASKS        8
+
+/** @brief Cubetas del histograma: <1, <2, <4, ... ms y la última >= 2^(N-2) ms */
+#define DM_HIST_BUCKETS     8
+
+/**
+ * @brief Tipo de contrato temporal
+ */
+typedef enum {
+    DM_KIND_PERIODIC,   /**< Latido cada period_ms */
+    DM_KIND_JOB         /**< Trabajo completado en deadline_ms */
+} dm_kind_t;
+
+/**
+ * @brief Contrato y estadísticas de una tarea
+ */
+typedef struct {
+    const char *name;           /**< Nombre para reportes */
+    uint8_t kind;               /**< dm_kind_t */
+    bool armed;                 /**< Hay un plazo vigente en due_ms */
+    bool overdue;               /**< El plazo vigente ya venció */
+    uint32_t period_ms;         /**< Período o plazo declarado */
+    uint32_t tolerance_ms;      /**< Margen antes de considerar incumplido */
+    uint32_t last_ms;           /**< Último latido o inicio de trabajo */
+    uint32_t due_ms;            /**< Instante límite del plazo vigente */
+    uint32_t count;             /**< Latidos o trabajos medidos */
+    uint32_t misses;            /**< Incumplimientos (tardíos o vencidos) */
+    uint32_t worst_late_ms;     /**< Mayor atraso respecto al plazo */
+    uint32_t hist[DM_HIST_BUCKETS]; /**< Jitter (periódico) o respuesta (trabajo) */
+} dm_task_t;
+
+/**
+ * @brief Estado del monitor
+ */
+typedef struct {
+    dm_task_t tasks[DM_MAX_TASKS];
+    uint8_t count;              /**< Contratos registrados */
+} dm_monitor_t;
+
+/**
+ * @brief Inicializa el monitor sin contratos
+ */
+void dm_init(dm_monitor_t *m);
+
+/**
+ * @brief Registra un contrato
+ *
+ * @param m Monitor
+ * @param name Nombre de la tarea (debe permanecer válido)
+ * @param kind Tipo de contrato
+ * @param period_ms Período entre latidos o plazo de cada trabajo
+ * @param tolerance_ms Margen sobre period_ms antes de contar un incumplimiento
+ * @return int Índice del contrato, o -1 si no hay lugar
+ */
+int dm_register(dm_monitor_t *m, const char *name, dm_kind_t kind,
+                uint32_t period_ms, uint32_t tolerance_ms);
+
+/**
+ * @brief Inicio (o reinicio) de la actividad periódica
+ *
+ * Fija la referencia del próximo latido sin medir un intervalo.
+ */
+void dm_start(dm_monitor_t *m, int id, uint32_t now_ms);
+
+/**
+ * @brief Latido de una tarea periódica
+ */
+void dm_heartbeat(dm_monitor_t *m, int id, uint32_t now_ms);
+
+/**
+ * @brief La tarea periódica va a bloquearse sin plazo (deja de vigilarse)
+ */
+void dm_idle(dm_monitor_t *m, int id);
+
+/**
+ * @brief Comienzo de un trabajo
+ */
+void dm_begin(dm_monitor_t *m, int id, uint32_t now_ms);
+
+/**
+ * @brief Fin del trabajo en curso
+ */
+void dm_end(dm_monitor_t *m, int id, uint32_t now_ms);
+
+/**
+ * @brief Revisa los plazos vigentes
+ *
+ * Un plazo vencido cuenta una sola vez como incumplimiento y mantiene a la
+ * tarea como no saludable hasta su próximo latido o fin de trabajo.
+ *
+ * @return uint32_t Máscara (bit = índice) de tareas con el plazo vencido;
+ *                  0 si todas están sanas
+ */
+uint32_t dm_check(dm_monitor_t *m, uint32_t now_ms);
+
+/**
+ * @brief Cubeta del histograma para un valor en milisegundos
+ */
+uint8_t dm_hist_bucket(uint32_t value_ms);
+
+#endif // DEADLINE_MONITOR_H
@@ -0,0 +1,187 @@
+/**
+ * @file event_bus.c
+ * @brief Implementación del bus de eventos publicar/suscribir sin copias
+ * @author Sistema de Control de Acceso
+ * @date 2025
+ */
+
+#include "event_bus.h"
+#include <string.h>
+
+_Static_assert(EB_POOL_SLOTS <= 255, "Los índices de ranura son de 8 bits");
+_Static_assert(EB_MAX_SUBSCRIBERS + 1 <= 255, "Las referencias de una ranura son de 8 bits");
+_Static_assert(EB_MAX_SUBSCRIBERS <= 32, "Los suscriptores de un tópico son una máscara de 32 bits");
+_Static_assert((EB_SUB_DEPTH & (EB_SUB_DEPTH - 1)) == 0 && EB_SUB_DEPTH <= 128,
+               "EB_SUB_DEPTH debe ser potencia de 2 y caber en los índices de 8 bits");
+_Static_assert(EB_PAYLOAD_SIZE % 4 == 0, "EB_PAYLOAD_SIZE debe ser múltiplo de 4");
+_Static_assert(sizeof(eb_msg_t) == EB_PAYLOAD_SIZE + 4, "la cabecera de eb_msg_t ocupa 4 bytes");
+_Static_assert(EB_RESERVED_SLOTS < EB_POOL_SLOTS, "La reserva debe dejar ranuras para todos");
+
+/**
+ * @brief Devuelve una ranura al pool
+ */
+static void slot_free(eb_bus_t *bus, eb_msg_t *msg) {
+    bus->free_list[bus->free_count++] = msg->index;
+}
+
+/**
+ * @brief Suelta una referencia de una ranura
+ */
+static void slot_unref(eb_bus_t *bus, eb_msg_t *msg) {
+    if (msg->refs > 0 && --msg->refs == 0) {
+        slot_free(bus, msg);
+    }
+}
+
+/**
+ * @brief Inicializa el bus con todas las ranuras libres y sin suscriptores
+ */
+void eb_init(eb_bus_t *bus) {
+    memset(bus, 0, sizeof(*bus));
+
+    for (int i = 0; i < EB_POOL_SLOTS; i++) {
+        bus->slots[i].index = (uint8_t)i;
+        // Pila invertida: la primera ranura entregada es la 0
+        bus->free_list[i] = (uint8_t)(EB_POOL_SLOTS - 1 - i);
+    }
+    bus->free_count = EB_POOL_SLOTS;
+}
+
+/**
+ * @brief Registra un suscriptor
+ */
+int eb_subscribe(eb_bus_t *bus, const char *name, uint32_t topics, uint8_t flags) {
+    if (bus->sub_count >= EB_MAX_SUBSCRIBERS || topics == 0 ||
+        (topics >> EB_MAX_TOPICS) != 0) {
+        return -1;
+    }
+
+    int id = bus->sub_count++;
+    eb_sub_t *s = &bus->subs[id];
+    s->name = name;
+    s->topics = topics;
+    s->flags = flags;
+
+    for (int t = 0; t < EB_MAX_TOPICS; t++) {
+        if (topics & (1u << t)) {
+            bus->topic_subs[t] |= 1u << id;
+        }
+    }
+    return id;
+}
+
+/**
+ * @brief Reserva las últimas ranuras para unos tópicos
+ */
+void eb_reserve(eb_bus_t *bus, uint32_t topics) {
+    bus->reserved_topics = topics;
+}
+
+/**
+ * @brief Reserva una ranura para publicar en un tópico
+ */
+eb_msg_t *eb_alloc(eb_bus_t *bus, uint8_t topic) {
+    if (topic >= EB_MAX_TOPICS) {
+        return NULL;
+    }
+
+    // Sin suscriptores no se ocupa el pool
+    if (bus->topic_subs[topic] == 0) {
+        bus->stats[topic].unrouted++;
+        return NULL;
+    }
+
+    bool reserved = (bus->reserved_topics & (1u << topic)) != 0;
+    if (bus->free_count == 0 || (bus->free_count <= EB_RESERVED_SLOTS && !reserved)) {
+        bus->stats[topic].no_slot++;
+        return NULL;
+    }
+
+    eb_msg_t *msg = &bus->slots[bus->free_list[--bus->free_count]];
+    msg->topic = topic;
+    msg->refs = 1;
+
+    uint8_t in_use = (uint8_t)(EB_POOL_SLOTS - bus->free_count);
+    if (in_use > bus->peak_in_use) {
+        bus->peak_in_use = in_use;
+    }
+    return msg;
+}
+
+/**
+ * @brief Entrega la ranura a los suscriptores de su tópico
+ */
+uint32_t eb_publish(eb_bus_t *bus, eb_msg_t *msg) {
+    eb_topic_stats_t *st = &bus->stats[msg->topic];
+    uint32_t targets = bus->topic_subs[msg->topic];
+    uint32_t delivered = 0;
+
+    for (int id = 0; targets != 0; id++, targets >>= 1) {
+        if (!(targets & 1u)) {
+            continue;
+        }
+
+        eb_sub_t *s = &bus->subs[id];
+        if ((uint8_t)(s->tail - s->head) >= EB_SUB_DEPTH) {
+            st->dropped++;
+            if (!(s->flags & EB_SUB_KEEP_LATEST)) {
+                continue;
+            }
+            // Gana el último: se suelta la referencia más antigua
+            slot_unref(bus, &bus->slots[s->ring[s->head++ % EB_SUB_DEPTH]]);
+        }
+
+        s->ring[s->tail++ % EB_SUB_DEPTH] = msg->index;
+        msg->refs++;
+        delivered |= 1u << id;
+        st->delivered++;
+
+        uint8_t pending = (uint8_t)(s->tail - s->head);
+        if (pending > s->peak) {
+            s->peak = pending;
+        }
+    }
+
+    if (delivered != 0) {
+        st->published++;
+    }
+
+    // Referencia del productor
+    slot_unref(bus, msg);
+    return delivered;
+}
+
+/**
+ * @brief Toma la próxima referencia pendiente de un suscriptor
+ */
+const eb_msg_t *eb_pop(eb_bus_t *bus, int sub) {
+    if (sub < 0 || sub >= bus->sub_count) {
+        return NULL;
+    }
+
+    eb_sub_t *s = &bus->subs[sub];
+    if (s->head == s->tail) {
+        return NULL;
+    }
+    return &bus->slots[s->ring[s->head++ % EB_SUB_DEPTH]];
+}
+
+/**
+ * @brief Suelta una referencia; la ranura vuelve al pool con la última
+ */
+void eb_release(eb_bus_t *bus, const eb_msg_t *msg) {
+    if (msg == NULL) {
+        return;
+    }
+    slot_unref(bus, &bus->slots[msg->index]);
+}
+
+/**
+ * @brief Referencias pendientes de un suscriptor
+ */
+uint8_t eb_pending(const eb_bus_t *bus, int sub) {
+    if (sub < 0 || sub >= bus->sub_count) {
+        return 0;
+    }
+    return (uint8_t)(bus->subs[sub].tail - bus->subs[sub].head);
+}
@@ -0,0 +1,177 @@
+/**
+ * @file event_bus.h
+ * @brief Bus de eventos publicar/suscribir sin copias
+ * @author Sistema de Control de Acceso
+ * @date 2025
+ *
+ * Los eventos viven en ranuras de tamaño fijo de un pool estático. El
+ * productor pide una ranura (eb_alloc), escribe el contenido en su lugar y
+ * la publica (eb_publish): cada suscriptor del tópico recibe en su anillo
+ * solo el índice de la ranura, no una copia. La ranura vuelve al pool
+ * cuando el último suscriptor la libera (eb_release), por lo que varios
+ * observadores pueden leer el mismo evento sin costo adicional.
+ *
+ * Nadie se bloquea al publicar:
+ *
+ * - Pool agotado: eb_alloc devuelve NULL y el evento se cuenta como
+ *   rechazado por contrapresión (no_slot) en su tópico.
+ * - Anillo de un suscriptor lleno: ese suscriptor pierde el evento nuevo
+ *   (o el más antiguo con EB_SUB_KEEP_LATEST) y se cuenta como descartado.
+ *
+ * El módulo no depende de FreeRTOS ni del SDK y no es reentrante: el
+ * llamador serializa el acceso (system_bus.c usa secciones críticas), lo
+ * que permite medirlo y simularlo en el host.
+ */
+
+#ifndef EVENT_BUS_H
+#define EVENT_BUS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/** @brief Ranuras del pool compartido por todos los tópicos */
+#ifndef EB_POOL_SLOTS
+#define EB_POOL_SLOTS       16
+#endif
+
+/** @brief Bytes de contenido por ranura (el evento más grande debe caber) */
+#ifndef EB_PAYLOAD_SIZE
+#define EB_PAYLOAD_SIZE     40
+#endif
+
+/** @brief Ranuras que solo pueden ocupar los tópicos reservados (eb_reserve) */
+#ifndef EB_RESERVED_SLOTS
+#define EB_RESERVED_SLOTS   2
+#endif
+
+/** @brief Tópicos posibles */
+#define EB_MAX_TOPICS       8
+
+/** @brief Suscriptores posibles */
+#define EB_MAX_SUBSCRIBERS  8
+
+/** @brief Referencias pendientes por suscriptor (potencia de 2) */
+#define EB_SUB_DEPTH        8
+
+/** @brief Opción de suscripción: con el anillo lleno se descarta el evento más antiguo */
+#define EB_SUB_KEEP_LATEST  0x01u
+
+/** @brief Acceso tipado al contenido de una ranura */
+#define EB_PAYLOAD(msg, type)   ((type *)(void *)(msg)->data)
+
+/**
+ * @brief Ranura del pool: 4 bytes de cabecera más EB_PAYLOAD_SIZE (44 bytes)
+ */
+typedef struct {
+    uint8_t topic;              /**< Tópico publicado */
+    uint8_t index;              /**< Posición en el pool */
+    uint8_t refs;               /**< Referencias vivas (productor y suscriptores) */
+    uint8_t reserved;
+    uint32_t data[EB_PAYLOAD_SIZE / 4]; /**< Contenido (alineado a 4 bytes) */
+} eb_msg_t;
+
+/**
+ * @brief Suscriptor: anillo de índices de ranuras pendientes
+ */
+typedef struct {
+    const char *name;           /**< Nombre para reportes */
+    uint32_t topics;            /**< Máscara de tópicos suscritos */
+    uint8_t flags;              /**< EB_SUB_* */
+    uint8_t head;               /**< Próxima referencia a entregar */
+    uint8_t tail;               /**< Próxima posición libre */
+    uint8_t peak;               /**< Máximo de referencias pendientes */
+    uint8_t ring[EB_SUB_DEPTH];
+} eb_sub_t;
+
+/**
+ * @brief Contadores de un tópico
+ */
+typedef struct {
+    uint32_t published;         /**< Eventos publicados con al menos un destino */
+    uint32_t delivered;         /**< Referencias entregadas a suscriptores */
+    uint32_t no_slot;           /**< Rechazados por pool agotado (contrapresión) */
+    uint32_t dropped;           /**< Referencias perdidas por anillos llenos */
+    uint32_t unrouted;          /**< Publicaciones sin suscriptores */
+} eb_topic_stats_t;
+
+/**
+ * @brief Estado del bus
+ */
+typedef struct {
+    eb_msg_t slots[EB_POOL_SLOTS];
+    uint8_t free_list[EB_POOL_SLOTS];   /**< Pila de ranuras libres */
+    uint8_t free_count;
+    uint8_t peak_in_use;                /**< Máximo de ranuras ocupadas a la vez */
+    uint8_t sub_count;
+    eb_sub_t subs[EB_MAX_SUBSCRIBERS];
+    uint32_t topic_subs[EB_MAX_TOPICS]; /**< Suscriptores de cada tópico (máscara) */
+    uint32_t reserved_topics;           /**< Tópicos con acceso a las EB_RESERVED_SLOTS */
+    eb_topic_stats_t stats[EB_MAX_TOPICS];
+} eb_bus_t;
+
+/**
+ * @brief Inicializa el bus con todas las ranuras libres y sin suscriptores
+ */
+void eb_init(eb_bus_t *bus);
+
+/**
+ * @brief Registra un suscriptor
+ *
+ * @param bus Bus
+ * @param name Nombre para reportes
+ * @param topics Máscara de tópicos (bit = número de tópico)
+ * @param flags EB_SUB_* (0 = descartar el evento nuevo con el anillo lleno)
+ * @return Identificador del suscriptor, o -1 si no hay lugar
+ */
+int eb_subscribe(eb_bus_t *bus, const char *name, uint32_t topics, uint8_t flags);
+
+/**
+ * @brief Reserva una ranura para publicar en un tópico
+ *
+ * La ranura queda con una referencia del productor hasta eb_publish o
+ * eb_release.
+ *
+ * @return Ranura a completar, o NULL si el tópico no tiene suscriptores o
+ *         el pool está agotado (las últimas EB_RESERVED_SLOTS ranuras
+ *         cuentan como agotadas para los tópicos no reservados)
+ */
+eb_msg_t *eb_alloc(eb_bus_t *bus, uint8_t topic);
+
+/**
+ * @brief Reserva las últimas EB_RESERVED_SLOTS ranuras para unos tópicos
+ *
+ * Los suscriptores que retienen eventos (EB_SUB_KEEP_LATEST, anillos sin
+ * vaciar) no pueden dejar sin ranura a un tópico crítico.
+ *
+ * @param topics Máscara de tópicos reservados
+ */
+void eb_reserve(eb_bus_t *bus, uint32_t topics);
+
+/**
+ * @brief Entrega la ranura a los suscriptores de su tópico
+ *
+ * Consume la referencia del productor; si ningún suscriptor pudo recibirla
+ * la ranura vuelve al pool.
+ *
+ * @return Máscara de suscriptores que recibieron el evento
+ */
+uint32_t eb_publish(eb_bus_t *bus, eb_msg_t *msg);
+
+/**
+ * @brief Toma la próxima referencia pendiente de un suscriptor
+ *
+ * @return Ranura (de solo lectura para el suscriptor), o NULL si no hay eventos
+ */
+const eb_msg_t *eb_pop(eb_bus_t *bus, int sub);
+
+/**
+ * @brief Suelta una referencia; la ranura vuelve al pool con la última
+ */
+void eb_release(eb_bus_t *bus, const eb_msg_t *msg);
+
+/**
+ * @brief Referencias pendientes de un suscriptor
+ */
+uint8_t eb_pending(const eb_bus_t *bus, int sub);
+
+#endif // EVENT_BUS_H
@@ -0,0 +1,168 @@
+/**
+ * @file executor.c
+ * @brief Implementación de la tarea que ejecuta las corrutinas
+ * @author Sistema de Control de Acceso
+ * @date 2025
+ */
+
+#include "executor.h"
+#include <stdio.h>
+#include <stdint.h>
+#include "pico/stdlib.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "semphr.h"
+#include "rtos_static.h"
+#include "system_bus.h"
+#include "trace_recorder.h"
+
+/** @brief Planificador (solo lo usa executor_task, salvo los reportes) */
+static co_exec_t exec;
+
+/** @brief Señales entregadas desde otras tareas (protegidas por sección crítica) */
+static uint32_t pending;
+
+/** @brief Despierta a la tarea con una señal nueva */
+static SemaphoreHandle_t exec_wake;
+RTOS_BINARY_SEMAPHORE_DEFINE(exec_wake);
+
+/** @brief Veces que la tarea despertó (señal o plazo) */
+static uint32_t wakeups;
+
+/** @brief Copia para imprimir sin mantener la sección crítica */
+static co_t snapshot[CO_MAX_TASKS];
+
+/**
+ * @brief Reloj de los contadores de duración de turno
+ */
+static uint32_t exec_clock_us(void) {
+    return time_us_32();
+}
+
+/**
+ * @brief Inicializa el planificador
+ */
+bool executor_init(void) {
+    co_exec_init(&exec, exec_clock_us);
+    exec_wake = RTOS_BINARY_SEMAPHORE_CREATE(exec_wake);
+    if (exec_wake == NULL) {
+        return false;
+    }
+    trace_register_queue(exec_wake, TRACE_QUEUE_EXECUTOR, "executor");
+    return true;
+}
+
+/**
+ * @brief Registra una corrutina
+ */
+int executor_add(co_t *co, const char *name, co_fn fn) {
+    taskENTER_CRITICAL();
+    int id = co_add(&exec, co, name, fn);
+    taskEXIT_CRITICAL();
+    return id;
+}
+
+/**
+ * @brief Señala una corrutina desde cualquier tarea
+ */
+void executor_signal(int id) {
+    if (id < 0 || id >= CO_MAX_TASKS) {
+        return;
+    }
+
+    taskENTER_CRITICAL();
+    pending |= 1u << id;
+    taskEXIT_CRITICAL();
+    xSemaphoreGive(exec_wake);
+}
+
+/**
+ * @brief Entrega de un evento del bus: señala la corrutina suscripta
+ */
+static void bus_notify(void *ctx) {
+    executor_signal((int)(intptr_t)ctx);
+}
+
+/**
+ * @brief Suscribe una corrutina al bus de eventos
+ */
+int executor_subscribe(int id, const char *name, uint32_t topics, uint8_t flags) {
+    if (id < 0) {
+        return -1;
+    }
+    return bus_subscribe_notify(name, topics, flags, bus_notify, (void *)(intptr_t)id);
+}
+
+/**
+ * @brief Tarea que ejecuta las corrutinas
+ *
+ * Una ronda por despertar: las corrutinas listas corren una vez cada una y
+ * la tarea duerme hasta la próxima señal o el plazo más cercano.
+ */
+void executor_task(void *pvParameters) {
+    printf("Ejecutor de corrutinas iniciado (%u corrutinas)\n", exec.count);
+
+    while (1) {
+        taskENTER_CRITICAL();
+        uint32_t signals = pending;
+        pending = 0;
+        taskEXIT_CRITICAL();
+
+        uint32_t wait_ms = co_run(&exec, (uint32_t)xTaskGetTickCount() * portTICK_PERIOD_MS, signals);
+        if (wait_ms == 0) {
+            continue;
+        }
+
+        TickType_t wait = (wait_ms == CO_FOREVER) ? portMAX_DELAY : pdMS_TO_TICKS(wait_ms);
+        xSemaphoreTake(exec_wake, wait);
+        wakeups++;
+    }
+}
+
+/**
+ * @brief Imprime los contadores por corrutina
+ */
+void executor_print(bool json) {
+    taskENTER_CRITICAL();
+    uint8_t count = exec.count;
+    uint32_t rounds = exec.rounds;
+    uint32_t woke = wakeups;
+    for (int i = 0; i < count; i++) {
+        snapshot[i] = *exec.tasks[i];
+    }
+    taskEXIT_CRITICAL();
+
+    if (json) {
+        printf("{\"rounds\":%lu,\"wakeups\":%lu,\"coroutines\":[",
+               (unsigned long)rounds, (unsigned long)woke);
+    } else {
+        printf("\n=== EJECUTOR DE CORRUTINAS ===\n");
+        printf("Rondas: %lu, despertares de la tarea: %lu\n",
+               (unsigned long)rounds, (unsigned long)woke);
+        printf("%-10s %8s %8s %10s %9s %9s\n",
+               "Corrutina", "Turnos", "Señales", "Atraso(ms)", "Prom(us)", "Máx(us)");
+    }
+
+    for (int i = 0; i < count; i++) {
+        const co_t *co = &snapshot[i];
+        unsigned long avg = co->runs ? (unsigned long)(co->run_sum_us / co->runs) : 0;
+
+        if (json) {
+            printf("%s{\"name\":\"%s\",\"runs\":%lu,\"signals\":%lu,\"late_max_ms\":%lu,"
+                   "\"run_avg_us\":%lu,\"run_max_us\":%lu}",
+                   (i > 0) ? "," : "", co->name, (unsigned long)co->runs,
+                   (unsigned long)co->signals, (unsigned long)co->late_max_ms, avg,
+                   (unsigned long)co->run_max_us);
+        } else {
+            printf("%-10s %8lu %8lu %10lu %9lu %9lu\n", co->name,
+                   (unsigned long)co->runs, (unsigned long)co->signals,
+                   (unsigned long)co->late_max_ms, avg, (unsigned long)co->run_max_us);
+        }
+    }
+
+    if (json) {
+        printf("]}\n");
+    } else {
+        printf("\n");
+    }
+}
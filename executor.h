@@ -0,0 +1,73 @@
+/**
+ * @file executor.h
+ * @brief Tarea única que ejecuta las corrutinas de las actividades livianas
+ * @author Sistema de Control de Acceso
+ * @date 2025
+ *
+ * Los LEDs y el display pasan casi todo el tiempo esperando un comando o un
+ * plazo. En lugar de una tarea de FreeRTOS con pila y TCB propios cada uno,
+ * corren como corrutinas sin pila (coop.h) dentro de executor_task, que
+ * duerme en un solo semáforo hasta la próxima señal o el plazo más cercano.
+ *
+ * - Los módulos registran su corrutina con executor_add y se suscriben al
+ *   bus con executor_subscribe: cada evento entregado señala la corrutina
+ *   (sin semáforo por suscriptor) y ella lo lee con bus_poll.
+ * - Una corrutina no debe bloquearse en FreeRTOS salvo brevemente: mientras
+ *   lo hace las demás no corren. La única excepción es la espera de las
+ *   transferencias I2C del display (a lo sumo un cuadro, ~14 ms).
+ *
+ * "exec [json]" en la consola muestra turnos, señales, atraso y duración
+ * de turno por corrutina, y cuántas veces despertó la tarea.
+ */
+
+#ifndef EXECUTOR_H
+#define EXECUTOR_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "coop.h"
+
+/**
+ * @brief Inicializa el planificador (antes de que los módulos registren corrutinas)
+ *
+ * @return true si la inicialización fue exitosa
+ */
+bool executor_init(void);
+
+/**
+ * @brief Registra una corrutina (antes de iniciar el scheduler)
+ *
+ * @param co Corrutina (static del módulo)
+ * @param name Nombre para reportes
+ * @param fn Cuerpo de la corrutina
+ * @return Identificador para executor_signal/executor_subscribe, o -1 si hubo error
+ */
+int executor_add(co_t *co, const char *name, co_fn fn);
+
+/**
+ * @brief Señala una corrutina desde cualquier tarea
+ */
+void executor_signal(int id);
+
+/**
+ * @brief Suscribe una corrutina al bus de eventos
+ *
+ * Cada evento entregado señala la corrutina; se leen con bus_poll.
+ *
+ * @return Identificador del suscriptor, o -1 si hubo error
+ */
+int executor_subscribe(int id, const char *name, uint32_t topics, uint8_t flags);
+
+/**
+ * @brief Tarea que ejecuta las corrutinas
+ */
+void executor_task(void *pvParameters);
+
+/**
+ * @brief Imprime los contadores por corrutina
+ *
+ * @param json true para una línea JSON
+ */
+void executor_print(bool json);
+
+#endif // EXECUTOR_H
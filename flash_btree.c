@@ -0,0 +1,1022 @@
+/**
+ * @file flash_btree.c
+ * @brief Implementación del árbol B+ en flash con copia en escritura
+ * @author Sistema de Control de Acceso
+ * @date 2025
+ *
+ * Una modificación recorre el camino de la raíz a la hoja y lo reescribe de
+ * abajo hacia arriba: cada nivel produce cero (nodo vacío), una o dos
+ * (división) páginas nuevas, que se convierten en la edición del padre.
+ * Las hojas no se fusionan: una hoja que queda vacía se quita del padre.
+ *
+ * Dentro de un lote la raíz y la última hoja modificada no se escriben en
+ * cada cambio: se editan en ranuras fijas de la caché con una página ya
+ * asignada. La hoja se graba cuando el lote pasa a otra hoja y la raíz al
+ * confirmar; como el padre conserva su separador, editar una hoja
+ * pendiente no cambia al padre.
+ */
+
+#include "flash_btree.h"
+#include <stddef.h>
+#include <string.h>
+
+/** @brief Marca de un nodo válido ("BN") */
+#define BT_NODE_MAGIC           0x4E42u
+
+/** @brief Marca de un registro de superbloque ("BTSB") */
+#define BT_SUPER_MAGIC          0x42535442u
+
+/** @brief Versión del formato */
+#define BT_SUPER_VERSION        1u
+
+/** @brief Registros de superbloque por página y en total */
+#define BT_SLOTS_PER_PAGE       (BT_PAGE_SIZE / BT_PROGRAM_SIZE)
+#define BT_SUPER_SLOTS          (BT_SUPER_PAGES * BT_SLOTS_PER_PAGE)
+
+/** @brief Entradas por hoja en la carga masiva: deja lugar para altas sin dividir */
+#define BT_BULK_LEAF_FILL       (BT_FANOUT * 9u / 10u)
+
+/** @brief Páginas que puede escribir una modificación (dos por nivel y una raíz nueva) */
+#define BT_OP_PAGES             (2 * BT_MAX_HEIGHT + 1)
+
+_Static_assert(sizeof(bt_node_t) == BT_PAGE_SIZE, "bt_node_t debe ocupar una página");
+_Static_assert(BT_CACHE_PAGES >= 4,
+               "la caché necesita una página fija, la hoja y la raíz de un lote y una libre");
+_Static_assert(BT_CACHE_PAGES >= BT_MAX_HEIGHT - 1,
+               "la carga masiva usa la caché para los niveles internos");
+_Static_assert(BT_MAX_PAGES % 8 == 0, "BT_MAX_PAGES debe ser múltiplo de 8");
+
+/**
+ * @brief Registro de superbloque (al inicio de una ranura de 256 bytes)
+ */
+typedef struct {
+    uint32_t magic;
+    uint32_t seq;
+    uint32_t root;
+    uint32_t count;
+    uint32_t pages;
+    uint16_t height;
+    uint16_t version;
+    uint32_t crc;               /**< CRC-32 de los campos anteriores */
+} bt_super_t;
+
+/**
+ * @brief Cambio sobre un nodo: en pos se quitan remove entradas y se agregan add
+ */
+typedef struct {
+    uint16_t pos;
+    uint8_t remove;
+    uint8_t add_count;
+    bt_entry_t add[2];
+} bt_edit_t;
+
+/**
+ * @brief Páginas escritas y reemplazadas por una modificación en curso
+ */
+typedef struct {
+    uint32_t written[BT_OP_PAGES];
+    uint8_t written_count;
+    uint32_t replaced[BT_MAX_HEIGHT];
+    uint8_t replaced_count;
+} bt_op_t;
+
+static uint32_t crc32(const void *data, size_t len) {
+    const uint8_t *p = data;
+    uint32_t crc = 0xFFFFFFFFu;
+
+    while (len--) {
+        crc ^= *p++;
+        for (int k = 0; k < 8; k++) {
+            crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1u)));
+        }
+    }
+    return ~crc;
+}
+
+/* ---- Mapa de páginas ----------------------------------------------------- */
+
+static bool page_used(const bt_tree_t *t, uint32_t page) {
+    return (t->used[page / 8] >> (page % 8)) & 1u;
+}
+
+static bool page_bit(const uint8_t *map, uint32_t page) {
+    return (map[page / 8] >> (page % 8)) & 1u;
+}
+
+static void page_bit_set(uint8_t *map, uint32_t page) {
+    map[page / 8] |= (uint8_t)(1u << (page % 8));
+}
+
+static void page_mark(bt_tree_t *t, uint32_t page, bool used) {
+    if (page_used(t, page) == used) {
+        return;
+    }
+    t->used[page / 8] ^= (uint8_t)(1u << (page % 8));
+    if (used) {
+        t->free_pages--;
+    } else {
+        t->free_pages++;
+    }
+}
+
+/**
+ * @brief Asigna la próxima página libre en ronda
+ */
+static uint32_t page_alloc(bt_tree_t *t) {
+    if (t->free_pages == 0) {
+        return BT_NO_PAGE;
+    }
+    for (uint32_t n = 0; n < t->pages; n++) {
+        uint32_t page = t->alloc_cursor;
+        t->alloc_cursor = (page + 1 < t->pages) ? page + 1 : BT_SUPER_PAGES;
+        if (page >= BT_SUPER_PAGES && !page_used(t, page)) {
+            page_mark(t, page, true);
+            return page;
+        }
+    }
+    return BT_NO_PAGE;
+}
+
+/* ---- Caché --------------------------------------------------------------- */
+
+static void cache_reset(bt_tree_t *t) {
+    for (int i = 0; i < BT_CACHE_PAGES; i++) {
+        t->cache_page[i] = BT_NO_PAGE;
+    }
+    t->cache_pinned = -1;
+    t->dirty_slot[0] = -1;
+    t->dirty_slot[1] = -1;
+}
+
+static void cache_forget(bt_tree_t *t, uint32_t page) {
+    for (int i = 0; i < BT_CACHE_PAGES; i++) {
+        if (t->cache_page[i] == page) {
+            t->cache_page[i] = BT_NO_PAGE;
+            for (int k = 0; k < 2; k++) {
+                if (i == t->dirty_slot[k]) {
+                    t->dirty_slot[k] = -1;
+                }
+            }
+        }
+    }
+}
+
+/**
+ * @brief Ranura libre o la usada hace más tiempo (salvo la fija y las pendientes)
+ */
+static int cache_victim(const bt_tree_t *t) {
+    int best = -1;
+    for (int i = 0; i < BT_CACHE_PAGES; i++) {
+        if (i == t->cache_pinned || i == t->dirty_slot[0] || i == t->dirty_slot[1]) {
+            continue;
+        }
+        if (t->cache_page[i] == BT_NO_PAGE) {
+            return i;
+        }
+        if (best < 0 || (int32_t)(t->cache_stamp[i] - t->cache_stamp[best]) < 0) {
+            best = i;
+        }
+    }
+    return best;
+}
+
+/**
+ * @brief Nodo de una página, desde la caché o leído de la flash
+ *
+ * @return NULL si la página no es un nodo válido o falló la lectura
+ */
+static const bt_node_t *node_get(bt_tree_t *t, uint32_t page, int *slot_out) {
+    if (page < BT_SUPER_PAGES || page >= t->pages) {
+        return NULL;
+    }
+
+    for (int i = 0; i < BT_CACHE_PAGES; i++) {
+        if (t->cache_page[i] == page) {
+            t->cache_stamp[i] = ++t->cache_clock;
+            t->stats.cache_hits++;
+            if (slot_out != NULL) {
+                *slot_out = i;
+            }
+            return &t->cache[i];
+        }
+    }
+
+    int slot = cache_victim(t);
+    bt_node_t *node = &t->cache[slot];
+    t->cache_page[slot] = BT_NO_PAGE;
+    t->stats.cache_misses++;
+    if (!t->flash->read(t->flash->ctx, page * BT_PAGE_SIZE, node, BT_PAGE_SIZE) ||
+        node->magic != BT_NODE_MAGIC || node->count > BT_FANOUT) {
+        return NULL;
+    }
+
+    t->cache_page[slot] = page;
+    t->cache_stamp[slot] = ++t->cache_clock;
+    if (slot_out != NULL) {
+        *slot_out = slot;
+    }
+    return node;
+}
+
+/**
+ * @brief Borra una página ya asignada y graba el nodo
+ */
+static bool page_program(bt_tree_t *t, uint32_t page, const bt_node_t *node) {
+    uint32_t addr = page * BT_PAGE_SIZE;
+    if (!t->flash->erase(t->flash->ctx, addr) ||
+        !t->flash->program(t->flash->ctx, addr, node, BT_PAGE_SIZE)) {
+        return false;
+    }
+    t->stats.erases++;
+    t->stats.page_writes++;
+    return true;
+}
+
+/**
+ * @brief Escribe un nodo en una página libre
+ *
+ * @param cache Copiar el nodo a la caché (no durante la carga masiva)
+ * @return Página escrita o BT_NO_PAGE
+ */
+static uint32_t node_write(bt_tree_t *t, const bt_node_t *node, bool cache) {
+    uint32_t page = page_alloc(t);
+    if (page == BT_NO_PAGE) {
+        return BT_NO_PAGE;
+    }
+    if (!page_program(t, page, node)) {
+        page_mark(t, page, false);
+        return BT_NO_PAGE;
+    }
+
+    if (cache) {
+        int slot = cache_victim(t);
+        memcpy(&t->cache[slot], node, sizeof(bt_node_t));
+        t->cache_page[slot] = page;
+        t->cache_stamp[slot] = ++t->cache_clock;
+    }
+    return page;
+}
+
+/* ---- Búsqueda dentro de un nodo ------------------------------------------ */
+
+/**
+ * @brief Primera entrada con clave >= key
+ */
+static uint32_t lower_bound(const bt_node_t *node, uint32_t key) {
+    uint32_t lo = 0, hi = node->count;
+    while (lo < hi) {
+        uint32_t mid = (lo + hi) / 2;
+        if (node->entries[mid].key < key) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+/**
+ * @brief Hijo que cubre key: la última entrada con clave <= key (la 0 si ninguna)
+ */
+static uint32_t child_index(const bt_node_t *node, uint32_t key) {
+    uint32_t i = lower_bound(node, key);
+    if (i < node->count && node->entries[i].key == key) {
+        return i;
+    }
+    return (i > 0) ? i - 1 : 0;
+}
+
+/* ---- Superbloque --------------------------------------------------------- */
+
+/**
+ * @brief Publica una raíz con un registro nuevo en el log del superbloque
+ */
+static bool super_commit(bt_tree_t *t, uint32_t root, uint8_t height, uint32_t count) {
+    bt_super_t s = {
+        .magic = BT_SUPER_MAGIC,
+        .seq = t->seq + 1,
+        .root = root,
+        .count = count,
+        .pages = t->pages,
+        .height = height,
+        .version = BT_SUPER_VERSION,
+    };
+    s.crc = crc32(&s, offsetof(bt_super_t, crc));
+
+    // El nodo en construcción ya no se necesita: sirve de buffer de la ranura
+    uint8_t *slot_buf = (uint8_t *)&t->scratch;
+
+    for (uint32_t tries = 0; tries < BT_SUPER_SLOTS; tries++) {
+        uint32_t slot = t->super_slot;
+        uint32_t addr = slot * BT_PROGRAM_SIZE;
+        t->super_slot = (slot + 1) % BT_SUPER_SLOTS;
+
+        if (slot % BT_SLOTS_PER_PAGE == 0) {
+            // Primera ranura del sector: el registro vigente está en el otro
+            if (!t->flash->erase(t->flash->ctx, addr)) {
+                return false;
+            }
+            t->stats.erases++;
+        } else {
+            // Saltar una ranura escrita a medias por un corte de energía
+            if (!t->flash->read(t->flash->ctx, addr, slot_buf, BT_PROGRAM_SIZE)) {
+                return false;
+            }
+            bool blank = true;
+            for (uint32_t i = 0; i < BT_PROGRAM_SIZE; i++) {
+                blank = blank && (slot_buf[i] == 0xFF);
+            }
+            if (!blank) {
+                continue;
+            }
+        }
+
+        memset(slot_buf, 0xFF, BT_PROGRAM_SIZE);
+        memcpy(slot_buf, &s, sizeof(s));
+        if (!t->flash->program(t->flash->ctx, addr, slot_buf, BT_PROGRAM_SIZE)) {
+            return false;
+        }
+
+        t->seq = s.seq;
+        t->root = root;
+        t->height = height;
+        t->count = count;
+        t->stats.commits++;
+        return true;
+    }
+    return false;
+}
+
+/**
+ * @brief Publica una raíz, o solo la adopta si hay un lote en curso
+ */
+static bool publish(bt_tree_t *t, uint32_t root, uint8_t height, uint32_t count) {
+    if (!t->batch) {
+        return super_commit(t, root, height, count);
+    }
+    t->root = root;
+    t->height = height;
+    t->count = count;
+    t->batch_dirty = true;
+    return true;
+}
+
+/**
+ * @brief Libera una página que dejó de estar en el árbol de trabajo
+ *
+ * Fuera de un lote, y para las páginas escritas dentro del lote, la página
+ * queda libre enseguida; las publicadas siguen en uso hasta confirmar el
+ * lote porque un corte de energía vuelve a ellas.
+ */
+static void page_release(bt_tree_t *t, uint32_t page) {
+    if (t->batch && !page_bit(t->fresh, page)) {
+        page_bit_set(t->retired, page);
+        return;
+    }
+    cache_forget(t, page);
+    page_mark(t, page, false);
+    t->fresh[page / 8] &= (uint8_t)~(1u << (page % 8));
+}
+
+/**
+ * @brief Marca las páginas alcanzables desde la raíz (solo lee nodos internos)
+ */
+static bool mark_subtree(bt_tree_t *t, uint32_t page, uint8_t level) {
+    if (level == 0) {
+        return true;
+    }
+
+    for (uint32_t i = 0; ; i++) {
+        // Releer en cada vuelta: la recursión puede desalojar el nodo
+        const bt_node_t *node = node_get(t, page, NULL);
+        if (node == NULL || node->level != level) {
+            return false;
+        }
+        if (i >= node->count) {
+            return true;
+        }
+
+        uint32_t child = node->entries[i].value;
+        if (child < BT_SUPER_PAGES || child >= t->pages || page_used(t, child)) {
+            return false;
+        }
+        page_mark(t, child, true);
+        if (!mark_subtree(t, child, level - 1)) {
+            return false;
+        }
+    }
+}
+
+static bool rebuild_used(bt_tree_t *t) {
+    memset(t->used, 0, sizeof(t->used));
+    t->free_pages = t->pages;
+    for (uint32_t p = 0; p < BT_SUPER_PAGES; p++) {
+        page_mark(t, p, true);
+    }
+    if (t->root == BT_NO_PAGE) {
+        return true;
+    }
+    if (t->root < BT_SUPER_PAGES || t->root >= t->pages) {
+        return false;
+    }
+    page_mark(t, t->root, true);
+    return mark_subtree(t, t->root, t->height - 1);
+}
+
+static bool tree_init(bt_tree_t *t, const bt_flash_t *flash) {
+    memset(t, 0, sizeof(*t));
+    t->flash = flash;
+    t->pages = flash->size / BT_PAGE_SIZE;
+    t->root = BT_NO_PAGE;
+    cache_reset(t);
+    return t->pages > BT_SUPER_PAGES + 1 && t->pages <= BT_MAX_PAGES;
+}
+
+bool bt_format(bt_tree_t *t, const bt_flash_t *flash) {
+    if (!tree_init(t, flash)) {
+        return false;
+    }
+    for (uint32_t p = 0; p < BT_SUPER_PAGES; p++) {
+        if (!flash->erase(flash->ctx, p * BT_PAGE_SIZE)) {
+            return false;
+        }
+        t->stats.erases++;
+    }
+    // Las páginas de nodos se borran al asignarlas
+    t->alloc_cursor = BT_SUPER_PAGES;
+    return rebuild_used(t) && super_commit(t, BT_NO_PAGE, 0, 0);
+}
+
+bool bt_mount(bt_tree_t *t, const bt_flash_t *flash) {
+    if (!tree_init(t, flash)) {
+        return false;
+    }
+
+    bt_super_t best = { 0 };
+    uint32_t best_slot = BT_SUPER_SLOTS;
+    for (uint32_t slot = 0; slot < BT_SUPER_SLOTS; slot++) {
+        bt_super_t s;
+        if (!flash->read(flash->ctx, slot * BT_PROGRAM_SIZE, &s, sizeof(s))) {
+            return false;
+        }
+        if (s.magic != BT_SUPER_MAGIC || s.version != BT_SUPER_VERSION || s.pages != t->pages ||
+            s.height > BT_MAX_HEIGHT || s.crc != crc32(&s, offsetof(bt_super_t, crc))) {
+            continue;
+        }
+        if (best_slot == BT_SUPER_SLOTS || (int32_t)(s.seq - best.seq) > 0) {
+            best = s;
+            best_slot = slot;
+        }
+    }
+    if (best_slot == BT_SUPER_SLOTS) {
+        return false;
+    }
+
+    t->seq = best.seq;
+    t->root = best.root;
+    t->height = (uint8_t)best.height;
+    t->count = best.count;
+    t->super_slot = (best_slot + 1) % BT_SUPER_SLOTS;
+    // Empezar en otro punto en cada montaje para repartir el desgaste
+    t->alloc_cursor = BT_SUPER_PAGES + best.seq % (t->pages - BT_SUPER_PAGES);
+    return rebuild_used(t);
+}
+
+/* ---- Consultas ----------------------------------------------------------- */
+
+bool bt_lookup(bt_tree_t *t, uint32_t key, uint32_t *value) {
+    uint32_t misses = t->stats.cache_misses;
+    bool found = false;
+
+    t->stats.lookups++;
+    uint32_t page = t->root;
+    for (int level = t->height - 1; level >= 0 && page != BT_NO_PAGE; level--) {
+        const bt_node_t *node = node_get(t, page, NULL);
+        if (node == NULL || node->level != level) {
+            break;
+        }
+        if (level > 0) {
+            page = node->entries[child_index(node, key)].value;
+        } else {
+            uint32_t i = lower_bound(node, key);
+            if (i < node->count && node->entries[i].key == key) {
+                *value = node->entries[i].value;
+                found = true;
+            }
+        }
+    }
+
+    uint32_t reads = t->stats.cache_misses - misses;
+    if (reads > t->stats.max_lookup_reads) {
+        t->stats.max_lookup_reads = reads;
+    }
+    return found;
+}
+
+/**
+ * @brief Recorre un subárbol; devuelve false cuando hay que detenerse
+ */
+static bool scan_node(bt_tree_t *t, uint32_t page, uint8_t level, uint32_t from, uint32_t to,
+                      bt_scan_fn fn, void *ctx, uint32_t *visited) {
+    const bt_node_t *node = node_get(t, page, NULL);
+    if (node == NULL || node->level != level) {
+        return false;
+    }
+
+    if (level == 0) {
+        for (uint32_t i = lower_bound(node, from); i < node->count; i++) {
+            const bt_entry_t *e = &node->entries[i];
+            if (e->key > to) {
+                return false;
+            }
+            (*visited)++;
+            if (!fn(e->key, e->value, ctx)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    for (uint32_t i = child_index(node, from); ; i++) {
+        node = node_get(t, page, NULL);
+        if (node == NULL || i >= node->count) {
+            return node != NULL;
+        }
+        if (i > 0 && node->entries[i].key > to) {
+            return false;
+        }
+        if (!scan_node(t, node->entries[i].value, level - 1, from, to, fn, ctx, visited)) {
+            return false;
+        }
+    }
+}
+
+uint32_t bt_scan(bt_tree_t *t, uint32_t from, uint32_t to, bt_scan_fn fn, void *ctx) {
+    uint32_t visited = 0;
+    if (t->root != BT_NO_PAGE && from <= to) {
+        scan_node(t, t->root, t->height - 1, from, to, fn, ctx, &visited);
+    }
+    return visited;
+}
+
+/* ---- Modificaciones ------------------------------------------------------ */
+
+static uint32_t edit_count(const bt_node_t *node, const bt_edit_t *e) {
+    return node->count - e->remove + e->add_count;
+}
+
+/**
+ * @brief Entrada i del nodo con la edición aplicada
+ */
+static bt_entry_t edit_entry(const bt_node_t *node, const bt_edit_t *e, uint32_t i) {
+    if (i < e->pos) {
+        return node->entries[i];
+    }
+    if (i < (uint32_t)e->pos + e->add_count) {
+        return e->add[i - e->pos];
+    }
+    return node->entries[i - e->add_count + e->remove];
+}
+
+/**
+ * @brief Escribe el nodo editado en una página, o en dos si no entra
+ *
+ * @param out Entradas para el padre: {menor clave, página}
+ * @return Páginas escritas (0 si el nodo quedó vacío) o -1 si falló
+ */
+static int write_edited(bt_tree_t *t, const bt_node_t *node, const bt_edit_t *e,
+                        bt_entry_t out[2], bt_op_t *op) {
+    uint32_t n = edit_count(node, e);
+    int parts = (n > BT_FANOUT) ? 2 : (n > 0) ? 1 : 0;
+    uint32_t first = 0;
+
+    for (int k = 0; k < parts; k++) {
+        uint32_t len = (parts == 1) ? n : (k == 0) ? n / 2 : n - n / 2;
+
+        t->scratch.magic = BT_NODE_MAGIC;
+        t->scratch.level = node->level;
+        t->scratch.count = (uint16_t)len;
+        t->scratch.seq = t->seq + 1;
+        for (uint32_t i = 0; i < len; i++) {
+            t->scratch.entries[i] = edit_entry(node, e, first + i);
+        }
+        memset(&t->scratch.entries[len], 0xFF, (BT_FANOUT - len) * sizeof(bt_entry_t));
+
+        uint32_t page = node_write(t, &t->scratch, true);
+        if (page == BT_NO_PAGE) {
+            return -1;
+        }
+        op->written[op->written_count++] = page;
+        out[k] = (bt_entry_t){ t->scratch.entries[0].key, page };
+        first += len;
+    }
+    return parts;
+}
+
+/**
+ * @brief Graba un nodo pendiente del lote (0 = hoja, 1 = raíz) en su página ya asignada
+ */
+static bool dirty_flush(bt_tree_t *t, int kind) {
+    int slot = t->dirty_slot[kind];
+    if (slot < 0) {
+        return true;
+    }
+    if (!page_program(t, t->cache_page[slot], &t->cache[slot])) {
+        return false;
+    }
+    t->dirty_slot[kind] = -1;
+    return true;
+}
+
+/**
+ * @brief Descarta las páginas escritas por una modificación que no se publicó
+ */
+static void op_rollback(bt_tree_t *t, const bt_op_t *op) {
+    for (int i = 0; i < op->written_count; i++) {
+        cache_forget(t, op->written[i]);
+        page_mark(t, op->written[i], false);
+    }
+    t->cache_pinned = -1;
+}
+
+/**
+ * @brief Aplica una edición a la hoja del camino y la propaga hasta la raíz
+ *
+ * @param path Páginas del camino por nivel (0 = hoja)
+ * @param index Posición dentro de cada nodo del camino
+ */
+static bool apply_path(bt_tree_t *t, const uint32_t *path, const uint16_t *index,
+                       bt_edit_t edit, int32_t count_delta) {
+    bt_op_t op = { 0 };
+    bt_entry_t out[2];
+    uint32_t root = BT_NO_PAGE;
+    uint8_t height = 0;
+
+    for (uint8_t level = 0; level < t->height; level++) {
+        int slot;
+        const bt_node_t *node = node_get(t, path[level], &slot);
+        if (node == NULL) {
+            op_rollback(t, &op);
+            return false;
+        }
+        bool is_root = (level + 1 == t->height);
+
+        // El padre conserva su clave separadora para la primera página
+        if (level > 0 && edit.add_count > 0) {
+            edit.add[0].key = node->entries[edit.pos].key;
+        }
+
+        // En un lote la hoja y la raíz se editan en la caché sin dividirse ni vaciarse
+        uint32_t n = edit_count(node, &edit);
+        int kind = (level == 0) ? 0 : is_root ? 1 : -1;
+        if (t->batch && kind >= 0 && n > (level > 0 ? 1u : 0u) && n <= BT_FANOUT) {
+            bool moved = (slot != t->dirty_slot[kind]);
+            if (moved) {
+                // Grabar la hoja pendiente anterior y asignar página a esta
+                uint32_t page = dirty_flush(t, kind) ? page_alloc(t) : BT_NO_PAGE;
+                if (page == BT_NO_PAGE) {
+                    op_rollback(t, &op);
+                    return false;
+                }
+                op.replaced[op.replaced_count++] = path[level];
+                op.written[op.written_count++] = page;
+                t->cache_page[slot] = page;
+                t->dirty_slot[kind] = slot;
+            }
+            for (uint32_t i = 0; i < n; i++) {
+                t->scratch.entries[i] = edit_entry(node, &edit, i);
+            }
+            bt_node_t *dirty = &t->cache[slot];
+            memcpy(dirty->entries, t->scratch.entries, n * sizeof(bt_entry_t));
+            memset(&dirty->entries[n], 0xFF, (BT_FANOUT - n) * sizeof(bt_entry_t));
+            dirty->count = (uint16_t)n;
+            dirty->seq = t->seq + 1;
+
+            if (is_root || !moved) {
+                root = is_root ? t->cache_page[slot] : t->root;
+                height = t->height;
+                break;
+            }
+            // La hoja cambió de página: el padre debe apuntar a la nueva
+            edit = (bt_edit_t){ .pos = index[level + 1], .remove = 1, .add_count = 1 };
+            edit.add[0] = (bt_entry_t){ dirty->entries[0].key, t->cache_page[slot] };
+            continue;
+        }
+        op.replaced[op.replaced_count++] = path[level];
+
+        // Raíz interna con un solo hijo: el hijo pasa a ser la raíz
+        if (is_root && level > 0 && n == 1) {
+            root = edit_entry(node, &edit, 0).value;
+            height = level;
+            break;
+        }
+
+        t->cache_pinned = slot;
+        int parts = write_edited(t, node, &edit, out, &op);
+        t->cache_pinned = -1;
+        if (parts < 0) {
+            op_rollback(t, &op);
+            return false;
+        }
+
+        if (is_root) {
+            if (parts == 0) {
+                root = BT_NO_PAGE;
+                height = 0;
+            } else if (parts == 1) {
+                root = out[0].value;
+                height = t->height;
+            } else {
+                // La raíz se dividió: nueva raíz con las dos mitades
+                if (t->height >= BT_MAX_HEIGHT) {
+                    op_rollback(t, &op);
+                    return false;
+                }
+                t->scratch.magic = BT_NODE_MAGIC;
+                t->scratch.level = level + 1;
+                t->scratch.count = 2;
+                t->scratch.seq = t->seq + 1;
+                t->scratch.entries[0] = out[0];
+                t->scratch.entries[1] = out[1];
+                memset(&t->scratch.entries[2], 0xFF, (BT_FANOUT - 2) * sizeof(bt_entry_t));
+                root = node_write(t, &t->scratch, true);
+                if (root == BT_NO_PAGE) {
+                    op_rollback(t, &op);
+                    return false;
+                }
+                op.written[op.written_count++] = root;
+                height = t->height + 1;
+            }
+            break;
+        }
+
+        edit = (bt_edit_t){ .pos = index[level + 1], .remove = 1, .add_count = (uint8_t)parts };
+        edit.add[0] = out[0];
+        edit.add[1] = out[1];
+    }
+
+    if (!publish(t, root, height, (uint32_t)((int32_t)t->count + count_delta))) {
+        op_rollback(t, &op);
+        return false;
+    }
+
+    // Recién ahora las páginas viejas dejan de estar publicadas
+    for (int i = 0; i < op.written_count && t->batch; i++) {
+        page_bit_set(t->fresh, op.written[i]);
+    }
+    for (int i = 0; i < op.replaced_count; i++) {
+        page_release(t, op.replaced[i]);
+    }
+    return true;
+}
+
+/**
+ * @brief Baja de la raíz a la hoja de key guardando el camino
+ *
+ * @return Posición de key en la hoja (o donde iría), -1 si el árbol es inválido
+ */
+static int32_t descend(bt_tree_t *t, uint32_t key, uint32_t *path, uint16_t *index, bool *exists) {
+    uint32_t page = t->root;
+
+    for (int level = t->height - 1; level >= 0; level--) {
+        const bt_node_t *node = node_get(t, page, NULL);
+        if (node == NULL || node->level != level) {
+            return -1;
+        }
+        path[level] = page;
+        if (level > 0) {
+            index[level] = (uint16_t)child_index(node, key);
+            page = node->entries[index[level]].value;
+        } else {
+            index[0] = (uint16_t)lower_bound(node, key);
+            *exists = index[0] < node->count && node->entries[index[0]].key == key;
+            return index[0];
+        }
+    }
+    return -1;
+}
+
+bool bt_put(bt_tree_t *t, uint32_t key, uint32_t value) {
+    if (t->root == BT_NO_PAGE) {
+        // Primera clave: una hoja como raíz
+        t->scratch.magic = BT_NODE_MAGIC;
+        t->scratch.level = 0;
+        t->scratch.count = 1;
+        t->scratch.seq = t->seq + 1;
+        t->scratch.entries[0] = (bt_entry_t){ key, value };
+        memset(&t->scratch.entries[1], 0xFF, (BT_FANOUT - 1) * sizeof(bt_entry_t));
+
+        uint32_t page = node_write(t, &t->scratch, true);
+        if (page == BT_NO_PAGE) {
+            return false;
+        }
+        if (!publish(t, page, 1, 1)) {
+            cache_forget(t, page);
+            page_mark(t, page, false);
+            return false;
+        }
+        if (t->batch) {
+            page_bit_set(t->fresh, page);
+        }
+        return true;
+    }
+
+    uint32_t path[BT_MAX_HEIGHT];
+    uint16_t index[BT_MAX_HEIGHT];
+    bool exists = false;
+    int32_t pos = descend(t, key, path, index, &exists);
+    if (pos < 0) {
+        return false;
+    }
+
+    if (exists) {
+        const bt_node_t *leaf = node_get(t, path[0], NULL);
+        if (leaf != NULL && leaf->entries[pos].value == value) {
+            return true;    // Sin cambios: no gastar un borrado
+        }
+    }
+
+    bt_edit_t edit = { .pos = (uint16_t)pos, .remove = exists ? 1 : 0, .add_count = 1 };
+    edit.add[0] = (bt_entry_t){ key, value };
+    return apply_path(t, path, index, edit, exists ? 0 : 1);
+}
+
+bool bt_delete(bt_tree_t *t, uint32_t key) {
+    if (t->root == BT_NO_PAGE) {
+        return false;
+    }
+
+    uint32_t path[BT_MAX_HEIGHT];
+    uint16_t index[BT_MAX_HEIGHT];
+    bool exists = false;
+    int32_t pos = descend(t, key, path, index, &exists);
+    if (pos < 0 || !exists) {
+        return false;
+    }
+
+    bt_edit_t edit = { .pos = (uint16_t)pos, .remove = 1, .add_count = 0 };
+    return apply_path(t, path, index, edit, -1);
+}
+
+/* ---- Carga masiva -------------------------------------------------------- */
+
+/**
+ * @brief Nodo en construcción de cada nivel: la hoja en scratch, el resto en la caché
+ */
+static bt_node_t *bulk_level(bt_tree_t *t, int level) {
+    return (level == 0) ? &t->scratch : &t->cache[level - 1];
+}
+
+static bool bulk_push(bt_tree_t *t, int level, bt_entry_t e);
+
+/**
+ * @brief Escribe el nodo de un nivel y lo agrega al nivel superior
+ */
+static bool bulk_flush(bt_tree_t *t, int level) {
+    bt_node_t *node = bulk_level(t, level);
+    if (level + 1 >= BT_MAX_HEIGHT) {
+        return false;
+    }
+
+    memset(&node->entries[node->count], 0xFF, (BT_FANOUT - node->count) * sizeof(bt_entry_t));
+    uint32_t page = node_write(t, node, false);
+    if (page == BT_NO_PAGE) {
+        return false;
+    }
+    bt_entry_t up = { node->entries[0].key, page };
+    node->count = 0;
+    return bulk_push(t, level + 1, up);
+}
+
+static bool bulk_push(bt_tree_t *t, int level, bt_entry_t e) {
+    bt_node_t *node = bulk_level(t, level);
+    uint32_t limit = (level == 0) ? BT_BULK_LEAF_FILL : BT_FANOUT;
+    if (node->count == limit && !bulk_flush(t, level)) {
+        return false;
+    }
+    node->entries[node->count++] = e;
+    return true;
+}
+
+/**
+ * @brief Cierra los niveles de abajo hacia arriba y publica la raíz
+ */
+static bool bulk_finish(bt_tree_t *t, uint32_t count) {
+    for (int level = 0; level < BT_MAX_HEIGHT; level++) {
+        bt_node_t *node = bulk_level(t, level);
+        bool higher = false;
+        for (int up = level + 1; up < BT_MAX_HEIGHT; up++) {
+            higher = higher || bulk_level(t, up)->count > 0;
+        }
+
+        if (higher) {
+            if (node->count > 0 && !bulk_flush(t, level)) {
+                return false;
+            }
+            continue;
+        }
+
+        if (node->count == 0) {
+            return super_commit(t, BT_NO_PAGE, 0, 0);
+        }
+        if (level > 0 && node->count == 1) {
+            return super_commit(t, node->entries[0].value, (uint8_t)level, count);
+        }
+        memset(&node->entries[node->count], 0xFF, (BT_FANOUT - node->count) * sizeof(bt_entry_t));
+        uint32_t root = node_write(t, node, false);
+        return root != BT_NO_PAGE && super_commit(t, root, (uint8_t)(level + 1), count);
+    }
+    return false;
+}
+
+bool bt_bulk_load(bt_tree_t *t, bt_next_fn next, void *ctx) {
+    if (t->root != BT_NO_PAGE || t->batch) {
+        return false;
+    }
+
+    cache_reset(t);
+    for (int level = 0; level < BT_MAX_HEIGHT; level++) {
+        bt_node_t *node = bulk_level(t, level);
+        node->magic = BT_NODE_MAGIC;
+        node->level = (uint8_t)level;
+        node->count = 0;
+        node->seq = t->seq + 1;
+    }
+
+    uint32_t count = 0;
+    uint32_t key, value, last = 0;
+    bool ok = true;
+    while (ok && next(&key, &value, ctx)) {
+        ok = (count == 0 || key > last) && bulk_push(t, 0, (bt_entry_t){ key, value });
+        last = key;
+        count++;
+    }
+    ok = ok && bulk_finish(t, count);
+
+    // Los buffers de nivel ocuparon la caché
+    cache_reset(t);
+    if (!ok) {
+        // Liberar lo escrito: el árbol publicado sigue vacío
+        rebuild_used(t);
+    }
+    return ok;
+}
+
+/* ---- Lotes --------------------------------------------------------------- */
+
+void bt_batch_begin(bt_tree_t *t) {
+    if (t->batch) {
+        return;
+    }
+    t->batch = true;
+    t->batch_dirty = false;
+    t->batch_root = t->root;
+    t->batch_height = t->height;
+    t->batch_count = t->count;
+    memset(t->fresh, 0, sizeof(t->fresh));
+    memset(t->retired, 0, sizeof(t->retired));
+}
+
+void bt_batch_abort(bt_tree_t *t) {
+    if (!t->batch) {
+        return;
+    }
+    for (uint32_t page = BT_SUPER_PAGES; page < t->pages; page++) {
+        if (page_bit(t->fresh, page)) {
+            cache_forget(t, page);
+            page_mark(t, page, false);
+        }
+    }
+    t->dirty_slot[0] = -1;
+    t->dirty_slot[1] = -1;
+    t->root = t->batch_root;
+    t->height = t->batch_height;
+    t->count = t->batch_count;
+    t->batch = false;
+}
+
+bool bt_batch_commit(bt_tree_t *t) {
+    if (!t->batch) {
+        return false;
+    }
+    if (!t->batch_dirty) {
+        t->batch = false;
+        return true;
+    }
+
+    // Grabar la hoja y la raíz pendientes antes de publicar
+    if (!dirty_flush(t, 0) || !dirty_flush(t, 1) ||
+        !super_commit(t, t->root, t->height, t->count)) {
+        bt_batch_abort(t);
+        return false;
+    }
+
+    t->batch = false;
+    for (uint32_t page = BT_SUPER_PAGES; page < t->pages; page++) {
+        if (page_bit(t->retired, page)) {
+            cache_forget(t, page);
+            page_mark(t, page, false);
+        }
+    }
+    return true;
+}
@@ -0,0 +1,246 @@
+/**
+ * @file flash_btree.h
+ * @brief Árbol B+ en páginas de flash con copia en escritura y caché LRU en RAM
+ * @author Sistema de Control de Acceso
+ * @date 2025
+ *
+ * Índice de claves de 32 bits (el ID de usuario empaquetado) a valores de
+ * 32 bits sobre una región de flash NOR dividida en páginas de 4 KB, el
+ * sector de borrado del RP2040 y de las memorias SPI habituales:
+ *
+ * - Cada nodo ocupa una página: un encabezado de 16 bytes y hasta
+ *   BT_FANOUT entradas {clave, valor} ordenadas. En las hojas el valor es
+ *   el registro del usuario; en los nodos internos es la página del hijo y
+ *   la clave es la menor de su subárbol. Con 510 entradas por página, más
+ *   de 200 mil claves caben en dos niveles: una búsqueda lee a lo sumo dos
+ *   páginas (tres hasta 100 millones de claves).
+ * - Las modificaciones nunca sobrescriben una página en uso: se escribe la
+ *   hoja nueva en una página libre, luego cada ancestro apunta a la copia
+ *   (copia del camino) y al final un registro de superbloque con número de
+ *   secuencia y CRC publica la nueva raíz. Un corte de energía en cualquier
+ *   punto deja el árbol anterior o el nuevo, nunca uno mezclado.
+ * - Los dos primeros sectores de la región guardan el superbloque como un
+ *   log de registros de 256 bytes (la unidad de programación); al montar
+ *   gana el registro válido de mayor secuencia.
+ * - Las páginas libres se llevan en un mapa de bits en RAM que el montaje
+ *   reconstruye recorriendo solo los nodos internos. La asignación avanza
+ *   en ronda por toda la región para repartir el desgaste.
+ * - Una caché LRU de BT_CACHE_PAGES páginas evita releer la raíz y los
+ *   nodos internos: con la raíz en caché una búsqueda cuesta una lectura.
+ * - Un lote (bt_batch_begin/commit) agrupa varias modificaciones bajo un
+ *   solo superbloque: se publican todas o ninguna. La raíz y la última hoja
+ *   modificada quedan pendientes en la caché, así que cambios seguidos sobre
+ *   la misma hoja (claves ordenadas) cuestan una sola escritura.
+ *
+ * El módulo no depende del SDK ni de FreeRTOS: el acceso a la flash se
+ * entrega como bt_flash_t (QSPI interna en user_flash.c, un archivo en
+ * tools/flash_btree_bench.c) y el llamador serializa las llamadas.
+ */
+
+#ifndef FLASH_BTREE_H
+#define FLASH_BTREE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/** @brief Tamaño de página (= sector de borrado) */
+#define BT_PAGE_SIZE            4096u
+
+/** @brief Unidad mínima de programación */
+#define BT_PROGRAM_SIZE         256u
+
+/** @brief Entradas por nodo */
+#define BT_FANOUT               ((BT_PAGE_SIZE - 16u) / 8u)
+
+/** @brief Niveles máximos del árbol */
+#define BT_MAX_HEIGHT           4
+
+/** @brief Páginas de la caché en RAM (4 KB cada una, al menos 4) */
+#ifndef BT_CACHE_PAGES
+#define BT_CACHE_PAGES          4
+#endif
+
+/** @brief Páginas máximas de la región (tamaño del mapa de bits) */
+#ifndef BT_MAX_PAGES
+#define BT_MAX_PAGES            1024
+#endif
+
+/** @brief Páginas reservadas para el log del superbloque */
+#define BT_SUPER_PAGES          2
+
+/** @brief Página inexistente (árbol vacío) */
+#define BT_NO_PAGE              0xFFFFFFFFu
+
+/**
+ * @brief Acceso a la región de flash (direcciones relativas a su inicio)
+ */
+typedef struct {
+    /** Lee len bytes */
+    bool (*read)(void *ctx, uint32_t addr, void *buf, uint32_t len);
+    /** Borra un sector de BT_PAGE_SIZE bytes (deja todo en 0xFF) */
+    bool (*erase)(void *ctx, uint32_t addr);
+    /** Programa len bytes (múltiplo de BT_PROGRAM_SIZE) sobre una zona borrada */
+    bool (*program)(void *ctx, uint32_t addr, const void *buf, uint32_t len);
+    void *ctx;
+    uint32_t size;              /**< Bytes de la región (múltiplo de BT_PAGE_SIZE) */
+} bt_flash_t;
+
+/**
+ * @brief Entrada de un nodo
+ */
+typedef struct {
+    uint32_t key;
+    uint32_t value;             /**< Registro (hoja) o página del hijo (interno) */
+} bt_entry_t;
+
+/**
+ * @brief Página de un nodo tal como se guarda en la flash
+ */
+typedef struct {
+    uint16_t magic;             /**< BT_NODE_MAGIC */
+    uint8_t level;              /**< 0 = hoja */
+    uint8_t reserved;
+    uint16_t count;             /**< Entradas usadas */
+    uint16_t reserved2;
+    uint32_t seq;               /**< Secuencia del superbloque que la publicó */
+    uint32_t reserved3;
+    bt_entry_t entries[BT_FANOUT];
+} bt_node_t;
+
+/**
+ * @brief Contadores de acceso
+ */
+typedef struct {
+    uint32_t lookups;           /**< Búsquedas */
+    uint32_t cache_hits;        /**< Páginas servidas desde la caché */
+    uint32_t cache_misses;      /**< Páginas leídas de la flash */
+    uint32_t page_writes;       /**< Páginas de nodo escritas */
+    uint32_t erases;            /**< Sectores borrados (nodos y superbloque) */
+    uint32_t commits;           /**< Registros de superbloque escritos */
+    uint32_t max_lookup_reads;  /**< Mayor cantidad de lecturas de flash en una búsqueda */
+} bt_stats_t;
+
+/**
+ * @brief Árbol montado
+ */
+typedef struct {
+    const bt_flash_t *flash;
+    uint32_t pages;             /**< Páginas de la región */
+    uint32_t root;              /**< Página raíz o BT_NO_PAGE */
+    uint8_t height;             /**< Niveles (0 = vacío) */
+    uint32_t count;             /**< Claves guardadas */
+    uint32_t seq;               /**< Secuencia del último superbloque */
+    uint32_t super_slot;        /**< Próxima ranura del log del superbloque */
+    uint32_t alloc_cursor;      /**< Próxima página a probar al asignar */
+    uint32_t free_pages;        /**< Páginas libres */
+    uint8_t used[BT_MAX_PAGES / 8];
+
+    /* Caché LRU */
+    uint32_t cache_page[BT_CACHE_PAGES];
+    uint32_t cache_stamp[BT_CACHE_PAGES];
+    uint32_t cache_clock;
+    int cache_pinned;           /**< Ranura que no se puede desalojar (-1 = ninguna) */
+    bt_node_t cache[BT_CACHE_PAGES];
+
+    bt_node_t scratch;          /**< Nodo en construcción */
+    bt_stats_t stats;
+
+    /* Lote en curso */
+    bool batch;
+    bool batch_dirty;           /**< Hubo cambios desde bt_batch_begin */
+    int dirty_slot[2];          /**< Ranuras de la hoja y la raíz aún no grabadas (-1 = ninguna) */
+    uint32_t batch_root;        /**< Árbol publicado al empezar el lote */
+    uint8_t batch_height;
+    uint32_t batch_count;
+    uint8_t fresh[BT_MAX_PAGES / 8];    /**< Páginas escritas por el lote */
+    uint8_t retired[BT_MAX_PAGES / 8];  /**< Páginas publicadas que el lote reemplazó */
+} bt_tree_t;
+
+/**
+ * @brief Función de recorrido: devuelve false para detenerlo
+ */
+typedef bool (*bt_scan_fn)(uint32_t key, uint32_t value, void *ctx);
+
+/**
+ * @brief Entrega la siguiente clave de una carga masiva (false = no hay más)
+ */
+typedef bool (*bt_next_fn)(uint32_t *key, uint32_t *value, void *ctx);
+
+/**
+ * @brief Borra la región y publica un árbol vacío
+ */
+bool bt_format(bt_tree_t *t, const bt_flash_t *flash);
+
+/**
+ * @brief Monta el árbol del último superbloque válido
+ *
+ * @return false si la región no tiene superbloque (usar bt_format)
+ */
+bool bt_mount(bt_tree_t *t, const bt_flash_t *flash);
+
+/**
+ * @brief Busca una clave
+ *
+ * @return true si existe; el valor queda en *value
+ */
+bool bt_lookup(bt_tree_t *t, uint32_t key, uint32_t *value);
+
+/**
+ * @brief Inserta una clave o reemplaza su valor (copia en escritura)
+ *
+ * @return false si no hay páginas libres o falló la flash; el árbol
+ *         publicado no cambia
+ */
+bool bt_put(bt_tree_t *t, uint32_t key, uint32_t value);
+
+/**
+ * @brief Elimina una clave
+ *
+ * @return false si no existe o falló la flash
+ */
+bool bt_delete(bt_tree_t *t, uint32_t key);
+
+/**
+ * @brief Recorre en orden las claves de [from, to]
+ *
+ * La función no debe modificar el árbol.
+ *
+ * @return Claves entregadas
+ */
+uint32_t bt_scan(bt_tree_t *t, uint32_t from, uint32_t to, bt_scan_fn fn, void *ctx);
+
+/**
+ * @brief Construye el árbol a partir de claves ascendentes
+ *
+ * Mucho más rápido que insertar una por una: escribe cada página una vez y
+ * publica un solo superbloque. Las hojas quedan al 90 % para que las altas
+ * posteriores no dividan enseguida. Solo sobre un árbol vacío.
+ *
+ * @return false si el árbol no está vacío, las claves no son estrictamente
+ *         ascendentes, no hay espacio o falló la flash
+ */
+bool bt_bulk_load(bt_tree_t *t, bt_next_fn next, void *ctx);
+
+/**
+ * @brief Empieza un lote: bt_put y bt_delete dejan de publicar cada cambio
+ *
+ * Las búsquedas ven los cambios del lote. Las páginas que el lote reemplaza
+ * siguen reservadas hasta confirmarlo, por lo que un lote grande necesita
+ * espacio libre para las hojas que toca.
+ */
+void bt_batch_begin(bt_tree_t *t);
+
+/**
+ * @brief Publica todos los cambios del lote con un solo superbloque
+ *
+ * @return false si falló la flash; el lote se descarta y queda el árbol
+ *         anterior
+ */
+bool bt_batch_commit(bt_tree_t *t);
+
+/**
+ * @brief Descarta los cambios del lote y vuelve al árbol publicado
+ */
+void bt_batch_abort(bt_tree_t *t);
+
+#endif // FLASH_BTREE_H
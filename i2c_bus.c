@@ -0,0 +1,323 @@
+/**
+ * @file i2c_bus.c
+ * @brief Implementación del gestor del bus I2C compartido
+ * @author Sistema de Control de Acceso
+ * @date 2025
+ */
+
+#include "i2c_bus.h"
+#include <stdio.h>
+#include "pico/stdlib.h"
+#include "hardware/i2c.h"
+#include "hardware/timer.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "semphr.h"
+#include "rtos_static.h"
+#include "board.h"
+
+/** @brief Cola del bus (compartida entre tareas, protegida por sección crítica) */
+static iq_sched_t sched;
+
+/** @brief Copia para imprimir sin mantener la sección crítica */
+static iq_sched_t snapshot;
+
+/** @brief Despierta al gestor cuando se encola una transacción */
+static SemaphoreHandle_t bus_wake;
+RTOS_BINARY_SEMAPHORE_DEFINE(bus_wake);
+
+/** @brief Semáforo y resultado de la transferencia sincrónica de cada cliente */
+static SemaphoreHandle_t client_done[IQ_MAX_CLIENTS];
+RTOS_BINARY_SEMAPHORE_ARRAY_DEFINE(client_done, IQ_MAX_CLIENTS);
+static volatile iq_result_t client_result[IQ_MAX_CLIENTS];
+
+/** @brief Comienzo de la medición de ocupación (arranque del gestor) */
+static uint64_t since_us;
+
+/**
+ * @brief Inicializa la cola
+ */
+bool i2c_bus_init(void) {
+    iq_init(&sched);
+    bus_wake = RTOS_BINARY_SEMAPHORE_CREATE(bus_wake);
+    return bus_wake != NULL;
+}
+
+/**
+ * @brief Registra un cliente y crea su semáforo de espera
+ */
+int i2c_bus_client(const char *name) {
+    taskENTER_CRITICAL();
+    int id = iq_client(&sched, name);
+    taskEXIT_CRITICAL();
+    if (id < 0) {
+        return -1;
+    }
+
+    client_done[id] = RTOS_BINARY_SEMAPHORE_ARRAY_CREATE(client_done, id);
+    return (client_done[id] != NULL) ? id : -1;
+}
+
+/**
+ * @brief Encola una transacción sin esperar
+ */
+bool i2c_bus_submit(const iq_txn_t *txn) {
+    taskENTER_CRITICAL();
+    bool ok = iq_submit(&sched, txn, time_us_32());
+    taskEXIT_CRITICAL();
+
+    if (ok) {
+        xSemaphoreGive(bus_wake);
+    }
+    return ok;
+}
+
+/**
+ * @brief Finalización de las transferencias sincrónicas
+ */
+static void transfer_done(const iq_txn_t *txn, iq_result_t result) {
+    client_result[txn->client] = result;
+    xSemaphoreGive(client_done[txn->client]);
+}
+
+/**
+ * @brief Ejecuta una transacción y espera su resultado
+ */
+iq_result_t i2c_bus_transfer(iq_txn_t *txn) {
+    txn->done = transfer_done;
+    txn->ctx = NULL;
+    if (!i2c_bus_submit(txn)) {
+        return IQ_ERR_REJECTED;
+    }
+
+    // El gestor siempre termina la transacción: los errores del bus se
+    // detectan por byte con I2C_BUS_BYTE_TIMEOUT_US
+    xSemaphoreTake(client_done[txn->client], portMAX_DELAY);
+    return client_result[txn->client];
+}
+
+/**
+ * @brief Escribe un buffer en una sola transferencia
+ */
+iq_result_t i2c_bus_write(int client, uint8_t addr, iq_priority_t priority,
+                          const uint8_t *data, uint16_t len) {
+    iq_txn_t txn = {
+        .client = (uint8_t)client, .addr = addr, .priority = (uint8_t)priority,
+        .seg_count = 1, .seg = { { data, len } },
+    };
+    return i2c_bus_transfer(&txn);
+}
+
+/**
+ * @brief Escribe un registro o dirección y lee la respuesta
+ */
+iq_result_t i2c_bus_write_read(int client, uint8_t addr, iq_priority_t priority,
+                               const uint8_t *wdata, uint16_t wlen,
+                               uint8_t *rdata, uint16_t rlen) {
+    iq_txn_t txn = {
+        .client = (uint8_t)client, .addr = addr, .priority = (uint8_t)priority,
+        .seg_count = (wlen > 0) ? 1 : 0, .seg = { { wdata, wlen } },
+        .read_buf = rdata, .read_len = rlen,
+    };
+    return i2c_bus_transfer(&txn);
+}
+
+/**
+ * @brief Indica si venció el plazo de la transferencia
+ */
+static inline bool expired(uint32_t deadline) {
+    return (int32_t)(time_us_32() - deadline) > 0;
+}
+
+/**
+ * @brief Espera lugar en la FIFO de transmisión
+ */
+static bool wait_tx_room(uint32_t deadline) {
+    while (i2c_get_write_available(BOARD_I2C) == 0) {
+        if (expired(deadline)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Espera el STOP de la transferencia y lo reconoce
+ */
+static bool wait_stop(i2c_hw_t *hw, uint32_t deadline) {
+    while (!(hw->raw_intr_stat & I2C_IC_RAW_INTR_STAT_STOP_DET_BITS)) {
+        if (expired(deadline)) {
+            return false;
+        }
+    }
+    (void)hw->clr_stop_det;
+    return true;
+}
+
+/**
+ * @brief Ejecuta una transferencia: escritura por segmentos y lectura opcional
+ *
+ * Los bytes se cargan directo en la FIFO de transmisión; con la FIFO vacía
+ * el controlador retiene SCL, así que los segmentos salen en una sola
+ * transferencia aunque la tarea sea interrumpida entre ellos. El cambio de
+ * escritura a lectura genera el inicio repetido.
+ */
+static iq_result_t port_transfer(const iq_chunk_t *chunk) {
+    i2c_hw_t *hw = i2c_get_hw(BOARD_I2C);
+    uint32_t deadline = time_us_32() +
+                        (uint32_t)(chunk->bytes + chunk->read_len + 1) * I2C_BUS_BYTE_TIMEOUT_US;
+    uint32_t left = chunk->bytes;
+    bool read = chunk->read_len > 0;
+    bool abort = false;
+
+    hw->enable = 0;
+    hw->tar = chunk->addr;
+    hw->enable = 1;
+
+    for (uint8_t s = 0; s < chunk->seg_count && !abort; s++) {
+        const iq_segment_t *seg = &chunk->seg[s];
+        for (uint16_t i = 0; i < seg->len; i++) {
+            if (!wait_tx_room(deadline)) {
+                hw->enable = 0;
+                return IQ_ERR_TIMEOUT;
+            }
+            left--;
+            hw->data_cmd = seg->data[i] |
+                           ((left == 0 && !read) ? I2C_IC_DATA_CMD_STOP_BITS : 0);
+            if (hw->raw_intr_stat & I2C_IC_RAW_INTR_STAT_TX_ABRT_BITS) {
+                abort = true;
+                break;
+            }
+        }
+    }
+
+    for (uint16_t i = 0; i < chunk->read_len && !abort; i++) {
+        if (!wait_tx_room(deadline)) {
+            hw->enable = 0;
+            return IQ_ERR_TIMEOUT;
+        }
+        hw->data_cmd = I2C_IC_DATA_CMD_CMD_BITS |
+                       ((i == 0 && chunk->bytes > 0) ? I2C_IC_DATA_CMD_RESTART_BITS : 0) |
+                       ((i == chunk->read_len - 1) ? I2C_IC_DATA_CMD_STOP_BITS : 0);
+        while (i2c_get_read_available(BOARD_I2C) == 0) {
+            if (hw->raw_intr_stat & I2C_IC_RAW_INTR_STAT_TX_ABRT_BITS) {
+                abort = true;
+                break;
+            }
+            if (expired(deadline)) {
+                hw->enable = 0;
+                return IQ_ERR_TIMEOUT;
+            }
+        }
+        if (!abort) {
+            chunk->read_buf[i] = (uint8_t)hw->data_cmd;
+        }
+    }
+
+    // Un abort (NACK) vacía la FIFO y el controlador emite el STOP solo
+    bool stopped = wait_stop(hw, deadline);
+    if (abort || (hw->raw_intr_stat & I2C_IC_RAW_INTR_STAT_TX_ABRT_BITS)) {
+        (void)hw->clr_tx_abrt;
+        return IQ_ERR_NACK;
+    }
+    if (!stopped) {
+        hw->enable = 0;
+        return IQ_ERR_TIMEOUT;
+    }
+    return IQ_OK;
+}
+
+/**
+ * @brief Tarea dueña del bus
+ */
+void i2c_bus_task(void *pvParameters) {
+    i2c_init(BOARD_I2C, BOARD_I2C_KHZ * 1000);
+    gpio_set_function(BOARD_I2C_SDA_PIN, GPIO_FUNC_I2C);
+    gpio_set_function(BOARD_I2C_SCL_PIN, GPIO_FUNC_I2C);
+    gpio_pull_up(BOARD_I2C_SDA_PIN);
+    gpio_pull_up(BOARD_I2C_SCL_PIN);
+    since_us = time_us_64();
+
+    printf("Gestor I2C iniciado (%d kHz)\n", BOARD_I2C_KHZ);
+
+    while (1) {
+        iq_chunk_t chunk;
+
+        taskENTER_CRITICAL();
+        bool pending = iq_next(&sched, &chunk);
+        taskEXIT_CRITICAL();
+        if (!pending) {
+            xSemaphoreTake(bus_wake, portMAX_DELAY);
+            continue;
+        }
+
+        uint32_t start_us = time_us_32();
+        iq_result_t result = port_transfer(&chunk);
+        uint32_t end_us = time_us_32();
+
+        iq_txn_t finished;
+        taskENTER_CRITICAL();
+        bool done = iq_complete(&sched, &chunk, result, start_us, end_us, &finished);
+        taskEXIT_CRITICAL();
+
+        if (done && finished.done != NULL) {
+            finished.done(&finished, result);
+        }
+    }
+}
+
+/**
+ * @brief Imprime ocupación, cola y latencia por cliente
+ */
+void i2c_bus_print(bool json) {
+    taskENTER_CRITICAL();
+    snapshot = sched;
+    taskEXIT_CRITICAL();
+
+    uint64_t elapsed = time_us_64() - since_us;
+    unsigned permille = (since_us != 0 && elapsed > 0) ?
+                        (unsigned)(snapshot.busy_us * 1000u / elapsed) : 0;
+
+    if (json) {
+        printf("{\"busy_permille\":%u,\"busy_us\":%llu,\"transfers\":%lu,\"preemptions\":%lu,"
+               "\"depth\":%u,\"peak\":%u,\"queue\":%d,\"clients\":[",
+               permille, (unsigned long long)snapshot.busy_us,
+               (unsigned long)snapshot.transfers, (unsigned long)snapshot.preemptions,
+               iq_depth(&snapshot), snapshot.peak_depth, IQ_QUEUE_LEN);
+    } else {
+        printf("\n=== BUS I2C (%d kHz) ===\n", BOARD_I2C_KHZ);
+        printf("Ocupación: %u.%u %% en %lu transferencias, %lu partes adelantadas\n",
+               permille / 10, permille % 10,
+               (unsigned long)snapshot.transfers, (unsigned long)snapshot.preemptions);
+        printf("Cola: %u/%d (máx. %u)\n", iq_depth(&snapshot), IQ_QUEUE_LEN, snapshot.peak_depth);
+        printf("%-10s %8s %6s %6s %8s %9s %9s %9s\n",
+               "Cliente", "Transac.", "Error", "Rech.", "Bytes", "Prom(us)", "Máx(us)", "Espera(us)");
+    }
+
+    for (int i = 0; i < snapshot.client_count; i++) {
+        const iq_client_t *c = &snapshot.clients[i];
+        uint32_t finished = c->completed + c->errors;
+        unsigned long avg = finished ? (unsigned long)(c->latency_sum_us / finished) : 0;
+
+        if (json) {
+            printf("%s{\"name\":\"%s\",\"submitted\":%lu,\"completed\":%lu,\"errors\":%lu,"
+                   "\"rejected\":%lu,\"bytes\":%lu,\"latency_avg_us\":%lu,"
+                   "\"latency_max_us\":%lu,\"wait_max_us\":%lu}",
+                   (i > 0) ? "," : "", c->name, (unsigned long)c->submitted,
+                   (unsigned long)c->completed, (unsigned long)c->errors,
+                   (unsigned long)c->rejected, (unsigned long)c->bytes, avg,
+                   (unsigned long)c->latency_max_us, (unsigned long)c->wait_max_us);
+        } else {
+            printf("%-10s %8lu %6lu %6lu %8lu %9lu %9lu %9lu\n", c->name,
+                   (unsigned long)c->submitted, (unsigned long)c->errors,
+                   (unsigned long)c->rejected, (unsigned long)c->bytes, avg,
+                   (unsigned long)c->latency_max_us, (unsigned long)c->wait_max_us);
+        }
+    }
+
+    if (json) {
+        printf("]}\n");
+    } else {
+        printf("\n");
+    }
+}
@@ -0,0 +1,93 @@
+/**
+ * @file i2c_bus.h
+ * @brief Gestor del bus I2C compartido sobre FreeRTOS
+ * @author Sistema de Control de Acceso
+ * @date 2025
+ *
+ * Una sola tarea (i2c_bus_task) es dueña de BOARD_I2C: configura el
+ * hardware y ejecuta en orden de prioridad las transacciones que los
+ * clientes encolan (i2c_sched.h). Los clientes no tocan el periférico:
+ *
+ * - i2c_bus_submit encola sin bloquear; la función de finalización de la
+ *   transacción se llama desde la tarea del gestor.
+ * - i2c_bus_transfer (y los atajos i2c_bus_write/i2c_bus_write_read)
+ *   esperan el resultado con el semáforo del cliente, sin espera activa:
+ *   la tarea que llama duerme mientras el gestor transmite. Cada cliente
+ *   admite una transferencia sincrónica a la vez.
+ *
+ * Las escrituras van directo a la FIFO del controlador segmento por
+ * segmento, sin armar un buffer contiguo. "i2c [json]" en la consola
+ * muestra la ocupación del bus, la cola y la latencia por cliente.
+ */
+
+#ifndef I2C_BUS_H
+#define I2C_BUS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "i2c_sched.h"
+
+/** @brief Tiempo máximo por byte antes de dar el bus por trabado */
+#define I2C_BUS_BYTE_TIMEOUT_US     200
+
+/**
+ * @brief Inicializa la cola (antes de que los módulos registren clientes)
+ *
+ * El hardware se configura al comenzar i2c_bus_task; lo encolado antes
+ * espera en la cola.
+ *
+ * @return true si la inicialización fue exitosa
+ */
+bool i2c_bus_init(void);
+
+/**
+ * @brief Registra un cliente y crea su semáforo de espera
+ *
+ * @param name Nombre para reportes
+ * @return Identificador del cliente, o -1 si hubo error
+ */
+int i2c_bus_client(const char *name);
+
+/**
+ * @brief Encola una transacción sin esperar
+ *
+ * Los segmentos y el buffer de lectura deben seguir válidos hasta que se
+ * llame a txn->done.
+ *
+ * @return false si la cola está llena o la transacción es inválida
+ */
+bool i2c_bus_submit(const iq_txn_t *txn);
+
+/**
+ * @brief Ejecuta una transacción y espera su resultado
+ *
+ * Reemplaza done y ctx de la transacción.
+ */
+iq_result_t i2c_bus_transfer(iq_txn_t *txn);
+
+/**
+ * @brief Escribe un buffer (una transferencia, sin dividir)
+ */
+iq_result_t i2c_bus_write(int client, uint8_t addr, iq_priority_t priority,
+                          const uint8_t *data, uint16_t len);
+
+/**
+ * @brief Escribe un registro o dirección y lee la respuesta con inicio repetido
+ */
+iq_result_t i2c_bus_write_read(int client, uint8_t addr, iq_priority_t priority,
+                               const uint8_t *wdata, uint16_t wlen,
+                               uint8_t *rdata, uint16_t rlen);
+
+/**
+ * @brief Tarea dueña del bus: configura el hardware y atiende la cola
+ */
+void i2c_bus_task(void *pvParameters);
+
+/**
+ * @brief Imprime ocupación, cola y latencia por cliente
+ *
+ * @param json true para una línea JSON
+ */
+void i2c_bus_print(bool json);
+
+#endif // I2C_BUS_H
@@ -0,0 +1,267 @@
+/**
+ * @file i2c_sched.c
+ * @brief Implementación de la cola de transacciones I2C con prioridades
+ * @author Sistema de Control de Acceso
+ * @date 2025
+ */
+
+#include "i2c_sched.h"
+#include <string.h>
+
+_Static_assert(IQ_QUEUE_LEN < IQ_NONE, "Los índices de la cola son de 8 bits");
+_Static_assert(IQ_CHUNK_BYTES > 0 && IQ_CHUNK_BYTES <= 0xFFFFu, "IQ_CHUNK_BYTES fuera de rango");
+
+/**
+ * @brief Bytes de datos de una transacción dividida (sin el encabezado)
+ */
+static uint32_t split_payload(const iq_txn_t *txn) {
+    uint32_t total = 0;
+
+    for (uint8_t i = 1; i < txn->seg_count; i++) {
+        total += txn->seg[i].len;
+    }
+    return total;
+}
+
+/**
+ * @brief Indica si la transacción se puede encolar
+ */
+static bool txn_valid(const iq_sched_t *s, const iq_txn_t *txn) {
+    if (txn->client >= s->client_count || txn->priority >= IQ_PRIO_COUNT ||
+        txn->addr > 0x7F || txn->seg_count > IQ_MAX_SEGMENTS) {
+        return false;
+    }
+    if (txn->read_len > 0 && txn->read_buf == NULL) {
+        return false;
+    }
+
+    uint32_t total = 0;
+    for (uint8_t i = 0; i < txn->seg_count; i++) {
+        if (txn->seg[i].len > 0 && txn->seg[i].data == NULL) {
+            return false;
+        }
+        total += txn->seg[i].len;
+    }
+    if (total + txn->read_len == 0 || total > 0xFFFFu) {
+        return false;
+    }
+
+    // Una transacción dividida es encabezado + datos, sin lectura
+    if (txn->flags & IQ_TXN_SPLIT) {
+        return txn->seg_count >= 2 && txn->read_len == 0 && split_payload(txn) > 0;
+    }
+    return true;
+}
+
+/**
+ * @brief Inicializa la cola vacía y sin clientes
+ */
+void iq_init(iq_sched_t *s) {
+    memset(s, 0, sizeof(*s));
+
+    for (int i = 0; i < IQ_QUEUE_LEN; i++) {
+        s->free_list[i] = (uint8_t)(IQ_QUEUE_LEN - 1 - i);
+    }
+    s->free_count = IQ_QUEUE_LEN;
+    memset(s->head, IQ_NONE, sizeof(s->head));
+    memset(s->tail, IQ_NONE, sizeof(s->tail));
+}
+
+/**
+ * @brief Registra un cliente
+ */
+int iq_client(iq_sched_t *s, const char *name) {
+    if (s->client_count >= IQ_MAX_CLIENTS) {
+        return -1;
+    }
+
+    int id = s->client_count++;
+    s->clients[id].name = name;
+    return id;
+}
+
+/**
+ * @brief Encola una copia de la transacción
+ */
+bool iq_submit(iq_sched_t *s, const iq_txn_t *txn, uint32_t now_us) {
+    if (!txn_valid(s, txn)) {
+        if (txn->client < s->client_count) {
+            s->clients[txn->client].rejected++;
+        }
+        return false;
+    }
+
+    iq_client_t *c = &s->clients[txn->client];
+    if (s->free_count == 0) {
+        c->rejected++;
+        return false;
+    }
+
+    uint8_t slot = s->free_list[--s->free_count];
+    iq_entry_t *e = &s->entries[slot];
+    e->txn = *txn;
+    e->submit_us = now_us;
+    e->sent = 0;
+    e->next = IQ_NONE;
+    e->started = false;
+
+    // Al final de la FIFO de su prioridad
+    uint8_t p = txn->priority;
+    if (s->tail[p] == IQ_NONE) {
+        s->head[p] = slot;
+    } else {
+        s->entries[s->tail[p]].next = slot;
+    }
+    s->tail[p] = slot;
+
+    c->submitted++;
+    uint8_t depth = iq_depth(s);
+    if (depth > s->peak_depth) {
+        s->peak_depth = depth;
+    }
+    return true;
+}
+
+/**
+ * @brief Elige la próxima transferencia
+ *
+ * Se atiende la primera transacción de la prioridad más alta con
+ * pendientes. Solo las transacciones en la cabeza de su FIFO llegan al bus,
+ * por lo que una dividida a medio enviar sigue siendo la cabeza de su
+ * prioridad y se retoma cuando las más urgentes terminan. La excepción es
+ * una transacción a la misma dirección que una dividida a medio enviar:
+ * esa espera, para no intercalar bytes en la escritura del dispositivo.
+ */
+bool iq_next(iq_sched_t *s, iq_chunk_t *chunk) {
+    uint8_t slot = IQ_NONE;
+    int p = 0;
+
+    for (; p < IQ_PRIO_COUNT; p++) {
+        if (s->head[p] != IQ_NONE) {
+            slot = s->head[p];
+            break;
+        }
+    }
+    if (slot == IQ_NONE) {
+        return false;
+    }
+
+    if (s->entries[slot].sent == 0) {
+        for (int q = p + 1; q < IQ_PRIO_COUNT; q++) {
+            uint8_t h = s->head[q];
+            if (h == IQ_NONE || s->entries[h].sent == 0) {
+                continue;
+            }
+            if (s->entries[h].txn.addr == s->entries[slot].txn.addr) {
+                slot = h;
+            } else {
+                s->preemptions++;
+            }
+            break;
+        }
+    }
+
+    const iq_entry_t *e = &s->entries[slot];
+    const iq_txn_t *txn = &e->txn;
+    chunk->slot = slot;
+    chunk->addr = txn->addr;
+    chunk->read_buf = txn->read_buf;
+    chunk->read_len = txn->read_len;
+    chunk->last = true;
+
+    if (!(txn->flags & IQ_TXN_SPLIT)) {
+        chunk->seg_count = txn->seg_count;
+        chunk->bytes = 0;
+        for (uint8_t i = 0; i < txn->seg_count; i++) {
+            chunk->seg[i] = txn->seg[i];
+            chunk->bytes += txn->seg[i].len;
+        }
+        chunk->data = chunk->bytes;
+        return true;
+    }
+
+    // Encabezado + los siguientes IQ_CHUNK_BYTES de datos, que pueden
+    // repartirse entre varios segmentos
+    uint32_t skip = e->sent;
+    uint32_t room = IQ_CHUNK_BYTES;
+    uint8_t n = 0;
+
+    chunk->seg[n++] = txn->seg[0];
+    for (uint8_t i = 1; i < txn->seg_count && room > 0; i++) {
+        const iq_segment_t *seg = &txn->seg[i];
+        if (skip >= seg->len) {
+            skip -= seg->len;
+            continue;
+        }
+        uint32_t len = seg->len - skip;
+        if (len > room) {
+            len = room;
+        }
+        chunk->seg[n++] = (iq_segment_t){ seg->data + skip, (uint16_t)len };
+        skip = 0;
+        room -= len;
+    }
+
+    chunk->seg_count = n;
+    chunk->data = (uint16_t)(IQ_CHUNK_BYTES - room);
+    chunk->bytes = (uint16_t)(txn->seg[0].len + chunk->data);
+    chunk->last = (e->sent + chunk->data >= split_payload(txn));
+    return true;
+}
+
+/**
+ * @brief Registra el resultado de una transferencia
+ */
+bool iq_complete(iq_sched_t *s, const iq_chunk_t *chunk, iq_result_t result,
+                 uint32_t start_us, uint32_t end_us, iq_txn_t *finished) {
+    iq_entry_t *e = &s->entries[chunk->slot];
+    iq_client_t *c = &s->clients[e->txn.client];
+
+    s->busy_us += end_us - start_us;
+    s->transfers++;
+
+    if (!e->started) {
+        e->started = true;
+        uint32_t wait = start_us - e->submit_us;
+        if (wait > c->wait_max_us) {
+            c->wait_max_us = wait;
+        }
+    }
+
+    if (result == IQ_OK) {
+        c->bytes += chunk->bytes + chunk->read_len;
+        if (!chunk->last) {
+            e->sent += chunk->data;
+            return false;
+        }
+        c->completed++;
+    } else {
+        // Una parte fallida termina toda la transacción
+        c->errors++;
+    }
+
+    uint32_t latency = end_us - e->submit_us;
+    c->latency_last_us = latency;
+    c->latency_sum_us += latency;
+    if (latency > c->latency_max_us) {
+        c->latency_max_us = latency;
+    }
+
+    // Solo las cabezas de cada FIFO llegan al bus
+    uint8_t p = e->txn.priority;
+    s->head[p] = e->next;
+    if (s->head[p] == IQ_NONE) {
+        s->tail[p] = IQ_NONE;
+    }
+    s->free_list[s->free_count++] = chunk->slot;
+
+    *finished = e->txn;
+    return true;
+}
+
+/**
+ * @brief Transacciones encoladas (incluida la que está en el bus)
+ */
+uint8_t iq_depth(const iq_sched_t *s) {
+    return (uint8_t)(IQ_QUEUE_LEN - s->free_count);
+}
@@ -0,0 +1,221 @@
+/**
+ * @file i2c_sched.h
+ * @brief Cola de transacciones I2C con prioridades y división de escrituras largas
+ * @author Sistema de Control de Acceso
+ * @date 2025
+ *
+ * Varios clientes (display, EEPROM, RTC...) comparten un bus I2C. Cada
+ * transacción se encola en un pool estático de IQ_QUEUE_LEN entradas, en
+ * una cola FIFO por prioridad; el gestor del bus pide la próxima
+ * transferencia (iq_next), la ejecuta y reporta el resultado (iq_complete):
+ *
+ * - Escrituras por partes (scatter-gather): una transacción lista hasta
+ *   IQ_MAX_SEGMENTS segmentos que salen en una sola transferencia, sin
+ *   copiarlos a un buffer intermedio (p. ej. byte de control + framebuffer).
+ *   Opcionalmente sigue una lectura con inicio repetido (registro de un RTC,
+ *   dirección de una EEPROM).
+ * - Con IQ_TXN_SPLIT el primer segmento es un encabezado que se repite y el
+ *   resto se envía en transferencias de hasta IQ_CHUNK_BYTES. Entre partes
+ *   una transacción de mayor prioridad a otra dirección pasa adelante, así
+ *   que una lectura corta espera a lo sumo una parte y no un cuadro de
+ *   512 bytes del display. Sirve para dispositivos que continúan la
+ *   escritura donde quedó (memoria gráfica del SSD1306).
+ * - Al terminar, el gestor llama a la función de finalización de la
+ *   transacción (asincrónica) con el resultado.
+ *
+ * Los contadores miden el tiempo de bus ocupado, la profundidad de la cola
+ * y, por cliente, la espera hasta el primer byte y la latencia hasta el
+ * final de la transacción.
+ *
+ * El módulo no depende de FreeRTOS ni del SDK y no es reentrante: el
+ * llamador serializa el acceso (i2c_bus.c usa secciones críticas) y entrega
+ * el tiempo en microsegundos, lo que permite simularlo en el host
+ * (tools/i2c_bus_sim.c).
+ */
+
+#ifndef I2C_SCHED_H
+#define I2C_SCHED_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/** @brief Transacciones encoladas como máximo (todas las prioridades) */
+#ifndef IQ_QUEUE_LEN
+#define IQ_QUEUE_LEN            8
+#endif
+
+/** @brief Clientes posibles */
+#define IQ_MAX_CLIENTS          6
+
+/** @brief Segmentos de escritura por transacción */
+#define IQ_MAX_SEGMENTS         4
+
+/** @brief Bytes de datos por parte de una transacción dividida (sin el encabezado) */
+#ifndef IQ_CHUNK_BYTES
+#define IQ_CHUNK_BYTES          128
+#endif
+
+/** @brief Opción de transacción: dividir la escritura repitiendo el primer segmento */
+#define IQ_TXN_SPLIT            0x01u
+
+/**
+ * @brief Prioridades (la menor numéricamente se atiende primero)
+ */
+typedef enum {
+    IQ_PRIO_HIGH,               /**< Transferencias cortas con plazo (RTC, sensores) */
+    IQ_PRIO_NORMAL,             /**< Persistencia (EEPROM) */
+    IQ_PRIO_LOW,                /**< Cuadros del display */
+    IQ_PRIO_COUNT
+} iq_priority_t;
+
+/**
+ * @brief Resultado de una transacción
+ */
+typedef enum {
+    IQ_OK,
+    IQ_ERR_NACK,                /**< El dispositivo no respondió o abortó la transferencia */
+    IQ_ERR_TIMEOUT,             /**< El bus no avanzó en el tiempo esperado */
+    IQ_ERR_REJECTED             /**< Cola llena o transacción inválida (no llegó al bus) */
+} iq_result_t;
+
+/**
+ * @brief Segmento de escritura (debe seguir válido hasta la finalización)
+ */
+typedef struct {
+    const uint8_t *data;
+    uint16_t len;
+} iq_segment_t;
+
+typedef struct iq_txn iq_txn_t;
+
+/**
+ * @brief Finalización de una transacción (en la tarea del gestor; no debe bloquear)
+ */
+typedef void (*iq_done_fn)(const iq_txn_t *txn, iq_result_t result);
+
+/**
+ * @brief Transacción pedida por un cliente
+ */
+struct iq_txn {
+    uint8_t client;             /**< Identificador de iq_client */
+    uint8_t addr;               /**< Dirección de 7 bits */
+    uint8_t priority;           /**< iq_priority_t */
+    uint8_t flags;              /**< IQ_TXN_* */
+    uint8_t seg_count;          /**< Segmentos de escritura (0 = solo lectura) */
+    iq_segment_t seg[IQ_MAX_SEGMENTS];
+    uint8_t *read_buf;          /**< Lectura tras la escritura, o NULL */
+    uint16_t read_len;
+    iq_done_fn done;            /**< Finalización, o NULL */
+    void *ctx;                  /**< Dato libre para la finalización */
+};
+
+/**
+ * @brief Una transferencia en el bus (de START a STOP)
+ */
+typedef struct {
+    uint8_t slot;               /**< Entrada de la cola que la originó */
+    uint8_t addr;
+    uint8_t seg_count;
+    iq_segment_t seg[IQ_MAX_SEGMENTS + 1];  /**< Encabezado repetido + datos de la parte */
+    uint16_t bytes;             /**< Bytes a escribir (suma de los segmentos) */
+    uint16_t data;              /**< Bytes de datos sin el encabezado repetido */
+    uint8_t *read_buf;          /**< Lectura con inicio repetido, o NULL */
+    uint16_t read_len;
+    bool last;                  /**< Última parte de la transacción */
+} iq_chunk_t;
+
+/**
+ * @brief Transacción encolada
+ */
+typedef struct {
+    iq_txn_t txn;
+    uint32_t submit_us;         /**< Instante de iq_submit */
+    uint16_t sent;              /**< Bytes de datos ya enviados (transacciones divididas) */
+    uint8_t next;               /**< Siguiente entrada de la misma prioridad */
+    bool started;               /**< Ya ocupó el bus al menos una vez */
+} iq_entry_t;
+
+/**
+ * @brief Contadores de un cliente
+ */
+typedef struct {
+    const char *name;           /**< Nombre para reportes */
+    uint32_t submitted;         /**< Transacciones encoladas */
+    uint32_t completed;         /**< Transacciones terminadas sin error */
+    uint32_t errors;            /**< Terminadas con NACK o timeout */
+    uint32_t rejected;          /**< Rechazadas por cola llena o inválidas */
+    uint32_t bytes;             /**< Bytes transferidos (escritos y leídos) */
+    uint32_t wait_max_us;       /**< Mayor espera desde iq_submit hasta el primer byte */
+    uint32_t latency_last_us;   /**< Latencia de la última transacción (iq_submit a fin) */
+    uint32_t latency_max_us;
+    uint64_t latency_sum_us;    /**< Para el promedio */
+} iq_client_t;
+
+/**
+ * @brief Estado del planificador
+ */
+typedef struct {
+    iq_entry_t entries[IQ_QUEUE_LEN];
+    uint8_t free_list[IQ_QUEUE_LEN];    /**< Pila de entradas libres */
+    uint8_t free_count;
+    uint8_t head[IQ_PRIO_COUNT];        /**< Primera entrada de cada prioridad */
+    uint8_t tail[IQ_PRIO_COUNT];
+    uint8_t peak_depth;                 /**< Máximo de transacciones encoladas a la vez */
+    uint8_t client_count;
+    iq_client_t clients[IQ_MAX_CLIENTS];
+    uint64_t busy_us;                   /**< Tiempo total de bus ocupado */
+    uint32_t transfers;                 /**< Transferencias START..STOP */
+    uint32_t preemptions;               /**< Partes adelantadas a una transacción dividida */
+} iq_sched_t;
+
+/** @brief Entrada inexistente */
+#define IQ_NONE                 0xFFu
+
+/**
+ * @brief Inicializa la cola vacía y sin clientes
+ */
+void iq_init(iq_sched_t *s);
+
+/**
+ * @brief Registra un cliente
+ *
+ * @return Identificador para iq_txn_t.client, o -1 si no hay lugar
+ */
+int iq_client(iq_sched_t *s, const char *name);
+
+/**
+ * @brief Encola una copia de la transacción (los datos no se copian)
+ *
+ * @param now_us Instante actual, para la latencia
+ * @return false si la cola está llena o la transacción es inválida
+ */
+bool iq_submit(iq_sched_t *s, const iq_txn_t *txn, uint32_t now_us);
+
+/**
+ * @brief Elige la próxima transferencia
+ *
+ * La transferencia queda en curso hasta iq_complete; no se debe pedir otra
+ * antes.
+ *
+ * @return false si la cola está vacía
+ */
+bool iq_next(iq_sched_t *s, iq_chunk_t *chunk);
+
+/**
+ * @brief Registra el resultado de una transferencia
+ *
+ * @param start_us Instante en que empezó la transferencia
+ * @param end_us Instante en que terminó
+ * @param finished Copia de la transacción si terminó (para llamar a done
+ *                 fuera de la sección crítica)
+ * @return true si la transacción terminó (con o sin error)
+ */
+bool iq_complete(iq_sched_t *s, const iq_chunk_t *chunk, iq_result_t result,
+                 uint32_t start_us, uint32_t end_us, iq_txn_t *finished);
+
+/**
+ * @brief Transacciones encoladas (incluida la que está en el bus)
+ */
+uint8_t iq_depth(const iq_sched_t *s);
+
+#endif // I2C_SCHED_H
@@ -0,0 +1,108 @@
+/**
+ * @file input_recorder.c
+ * @brief Implementación del registro de entradas externas
+ * @author Sistema de Control de Acceso
+ * @date 2025
+ */
+
+#include "input_recorder.h"
+#include <stdio.h>
+#include "pico/stdlib.h"
+#include "hardware/sync.h"
+#include "FreeRTOS.h"
+#include "task.h"
+
+_Static_assert(sizeof(input_record_t) == 8, "input_record_t debe ocupar 8 bytes");
+_Static_assert((INPUT_RECORDER_RECORDS & (INPUT_RECORDER_RECORDS - 1)) == 0,
+               "INPUT_RECORDER_RECORDS debe ser potencia de 2");
+
+#ifndef FIRMWARE_VERSION
+#define FIRMWARE_VERSION "dev"
+#endif
+
+/** @brief Buffer circular de registros */
+static input_record_t input_buffer[INPUT_RECORDER_RECORDS];
+
+/** @brief Total de registros escritos desde el último inicio */
+static uint32_t input_written;
+
+/** @brief Grabación activa (desde el arranque, para reproducir con estado inicial conocido) */
+static volatile bool input_enabled = true;
+
+/** @brief La grabación se reinició después del arranque */
+static bool input_restarted;
+
+/**
+ * @brief Agrega un registro al buffer circular
+ */
+static inline void input_write(uint32_t tick, uint8_t event, uint8_t arg) {
+    if (!input_enabled) {
+        return;
+    }
+
+    uint32_t irq_state = save_and_disable_interrupts();
+    input_record_t *r = &input_buffer[input_written % INPUT_RECORDER_RECORDS];
+    r->tick = tick;
+    r->time_us = (uint16_t)time_us_32();
+    r->event = event;
+    r->arg = arg;
+    input_written++;
+    restore_interrupts(irq_state);
+}
+
+void input_record(input_event_t event, uint8_t arg) {
+    input_write(xTaskGetTickCount(), (uint8_t)event, arg);
+}
+
+void input_record_from_isr(input_event_t event, uint8_t arg) {
+    input_write(xTaskGetTickCountFromISR(), (uint8_t)event, arg);
+}
+
+/**
+ * @brief Inicia (desde cero) o detiene la grabación
+ */
+void input_recorder_enable(bool enable) {
+    if (enable && !input_enabled) {
+        input_written = 0;
+        input_restarted = true;
+    }
+    input_enabled = enable;
+}
+
+/**
+ * @brief Vuelca el buffer por la salida estándar para tools/replay
+ *
+ * Detiene la grabación para que el volcado sea coherente. El encabezado
+ * indica cuántos registros se perdieron al dar la vuelta el buffer y si la
+ * grabación cubre desde el arranque; si no, la reproducción parte de un
+ * estado supuesto (ambas FSM en reposo).
+ */
+void input_recorder_dump(void) {
+    input_enabled = false;
+
+    uint32_t count = input_written;
+    uint32_t first = 0;
+    if (count > INPUT_RECORDER_RECORDS) {
+        first = count - INPUT_RECORDER_RECORDS;
+    }
+
+    bool from_boot = (first == 0 && !input_restarted);
+
+    printf("INPUT BEGIN 1 %lu %lu %lu %d %s\n", (unsigned long)(count - first),
+           (unsigned long)first, (unsigned long)sizeof(input_record_t), from_boot ? 1 : 0,
+           FIRMWARE_VERSION);
+
+    // Registros en hexadecimal, 16 por línea, en orden cronológico
+    for (uint32_t n = first; n < count; ) {
+        printf("D ");
+        for (int k = 0; k < 16 && n < count; k++, n++) {
+            const uint8_t *b = (const uint8_t *)&input_buffer[n % INPUT_RECORDER_RECORDS];
+            for (size_t j = 0; j < sizeof(input_record_t); j++) {
+                printf("%02x", b[j]);
+            }
+        }
+        printf("\n");
+    }
+
+    printf("INPUT END\n");
+}
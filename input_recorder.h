@@ -0,0 +1,84 @@
+/**
+ * @file input_recorder.h
+ * @brief Registro de entradas externas para reproducir fallas en el host
+ * @author Sistema de Control de Acceso
+ * @date 2025
+ *
+ * Guarda en un buffer circular, con el tick del kernel y los microsegundos,
+ * todo lo que el teclado y el control de acceso reciben desde afuera:
+ *
+ * - Entradas: flancos de las filas (IRQ) y los niveles de fila que lee la
+ *   FSM del teclado, solo cuando cambian.
+ * - Trayectoria: estados del teclado y del control de acceso, teclas
+ *   detectadas, eventos del bus recibidos y vencimientos de timeout.
+ *
+ * El contenido se vuelca por la consola USB ("input dump").
+ * tools/replay/replay.c ejecuta keypad.c y access_control_rtos.c en el host
+ * con un scheduler de tiempo virtual, les entrega las mismas entradas en
+ * los mismos ticks y compara la trayectoria obtenida con la grabada, lo
+ * que muestra dónde diverge otra versión del firmware.
+ */
+
+#ifndef INPUT_RECORDER_H
+#define INPUT_RECORDER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/** @brief Número de registros del buffer circular (8 bytes cada uno, potencia de 2) */
+#ifndef INPUT_RECORDER_RECORDS
+#define INPUT_RECORDER_RECORDS 512
+#endif
+
+/** @brief Bit de nivel alto en el argumento de INPUT_EV_ROW */
+#define INPUT_ROW_HIGH  0x80u
+
+/**
+ * @brief Tipos de registro
+ */
+typedef enum {
+    INPUT_EV_EDGE = 1,          /**< Entrada: IRQ de fila (arg = GPIO, flanco descendente) */
+    INPUT_EV_ROW,               /**< Entrada: nivel leído por la FSM (arg = fila | INPUT_ROW_HIGH) */
+    INPUT_EV_KEYPAD_STATE,      /**< Trayectoria: nuevo estado del teclado (keypad_fsm_state_t) */
+    INPUT_EV_KEY,               /**< Trayectoria: tecla detectada por el teclado (carácter) */
+    INPUT_EV_ACCESS_KEY,        /**< Trayectoria: tecla recibida por el control de acceso */
+    INPUT_EV_ACCESS_EVENT,      /**< Trayectoria: evento del bus recibido (access_event_type_t) */
+    INPUT_EV_TIMEOUT,           /**< Trayectoria: venció el timeout (access_event_type_t) */
+    INPUT_EV_ACCESS_STATE       /**< Trayectoria: nuevo estado del control de acceso (system_state_t) */
+} input_event_t;
+
+/**
+ * @brief Registro binario (8 bytes)
+ *
+ * El tick decide el orden y el instante de la reproducción; los 16 bits
+ * bajos de time_us_32() dan la separación en microsegundos entre registros
+ * cercanos (menos de 65 ms) al analizar una captura.
+ */
+typedef struct {
+    uint32_t tick;              /**< xTaskGetTickCount() al registrar */
+    uint16_t time_us;           /**< 16 bits bajos de time_us_32() */
+    uint8_t event;              /**< input_event_t */
+    uint8_t arg;                /**< Argumento según el tipo */
+} input_record_t;
+
+/**
+ * @brief Registra una entrada o un paso de la trayectoria desde una tarea
+ */
+void input_record(input_event_t event, uint8_t arg);
+
+/**
+ * @brief Registra una entrada desde una ISR
+ */
+void input_record_from_isr(input_event_t event, uint8_t arg);
+
+/**
+ * @brief Inicia (desde cero) o detiene la grabación
+ */
+void input_recorder_enable(bool enable);
+
+/**
+ * @brief Vuelca el buffer por la salida estándar para tools/replay
+ */
+void input_recorder_dump(void);
+
+#endif // INPUT_RECORDER_H
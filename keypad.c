@@ -22,7 +22,11 @@
  * 1. KEYPAD_IDLE: Tarea esperando en semáforo
  * 2. IRQ detecta fila → KEYPAD_DEBOUNCE → xSemaphoreGiveFromISR()
  * 3. Tarea despierta → KEYPAD_COLUMN_SCAN: Polling → KEYPAD_PRESSED
+ *    (la tecla se publica en BUS_TOPIC_KEY del bus de eventos)
  * 4. KEYPAD_PRESSED → KEYPAD_RELEASED → KEYPAD_IDLE
+ *
+ * Los flancos, los niveles de fila leídos y los cambios de estado quedan en
+ * input_recorder.h para reproducir la FSM en el host (tools/replay).
  */
 
 #include "keypad.h"
@@ -31,25 +35,24 @@
 #include <stdio.h>
 #include "FreeRTOS.h"
 #include "task.h"
-#include "queue.h"
 #include "semphr.h"
+#include "rtos_static.h"
+#include "system_bus.h"
+#include "trace_recorder.h"
+#include "boot_profile.h"
+#include "task_health.h"
+#include "board.h"
+#include "input_recorder.h"
 
-#define ROWS 4
-#define COLS 4
+#define LOG_MODULE KEYPAD
+#include "log.h"
+
+#define ROWS BOARD_KEYPAD_ROWS
+#define COLS BOARD_KEYPAD_COLS
 #define DEBOUNCE_TIME_MS 30        // Del proyecto 1
 #define RELEASE_TIME_MS 20         // Del proyecto 1
 #define COLUMN_STABILIZATION_MS 1  // Adaptado para FreeRTOS
 
-/**
- * @brief Pines GPIO asignados a las filas del teclado (con interrupciones)
- */
-static const uint row_pins[ROWS] = {6, 7, 8, 9};
-
-/**
- * @brief Pines GPIO asignados a las columnas del teclado (para polling)
- */
-static const uint col_pins[COLS] = {10, 11, 12, 13};
-
 /**
  * @brief Mapa de caracteres del teclado matricial 4x4 (del proyecto 1)
  */
@@ -84,11 +87,14 @@ static keypad_hybrid_controller_t hybrid_ctrl = {
     .irq_pending = false
 };
 
-/** @brief Cola para eventos del teclado */
-static QueueHandle_t keypad_queue;
+_Static_assert(sizeof(keypad_event_t) <= EB_PAYLOAD_SIZE, "keypad_event_t no cabe en una ranura del bus");
+
+/** @brief Último nivel leído de cada fila (solo se registran los cambios) */
+static bool row_last_level[ROWS];
 
 /** @brief Semáforo para despertar tarea desde ISR */
 static SemaphoreHandle_t keypad_wakeup_semaphore;
+RTOS_BINARY_SEMAPHORE_DEFINE(keypad_wakeup_semaphore);
 
 /**
  * @brief ISR para interrupciones del teclado (adaptada del proyecto 1)
@@ -99,25 +105,30 @@ static SemaphoreHandle_t keypad_wakeup_semaphore;
 static void keypad_gpio_isr(uint gpio, uint32_t events) {
     BaseType_t xHigherPriorityTaskWoken = pdFALSE;
     
+    // El flanco es una entrada externa aunque la FSM lo ignore
+    input_record_from_isr(INPUT_EV_EDGE, (uint8_t)gpio);
+    
     // Solo procesar si estamos en IDLE
     if (hybrid_ctrl.state != KEYPAD_IDLE) {
         return;
     }
+    
+    trace_isr_enter(TRACE_ISR_KEYPAD);
 
-    // Identificar qué fila generó la interrupción
-    for (int r = 0; r < ROWS; r++) {
-        if (gpio == row_pins[r]) {
-            hybrid_ctrl.detected_row = r;              // Guardar fila detectada por IRQ
-            hybrid_ctrl.last_change = xTaskGetTickCountFromISR();
-            hybrid_ctrl.state = KEYPAD_DEBOUNCE;       // Cambiar a estado de polling
-            hybrid_ctrl.irq_pending = true;
-            
-            // Despertar tarea de procesamiento
-            xSemaphoreGiveFromISR(keypad_wakeup_semaphore, &xHigherPriorityTaskWoken);
-            break;
-        }
+    // Identificar qué fila generó la interrupción (tabla de board.h)
+    int8_t row = (gpio < BOARD_NUM_GPIOS) ? board_gpio_row[gpio] : -1;
+    if (row >= 0) {
+        hybrid_ctrl.detected_row = (uint8_t)row;   // Guardar fila detectada por IRQ
+        hybrid_ctrl.last_change = xTaskGetTickCountFromISR();
+        hybrid_ctrl.state = KEYPAD_DEBOUNCE;       // Cambiar a estado de polling
+        hybrid_ctrl.irq_pending = true;
+        input_record_from_isr(INPUT_EV_KEYPAD_STATE, KEYPAD_DEBOUNCE);
+        
+        // Despertar tarea de procesamiento
+        xSemaphoreGiveFromISR(keypad_wakeup_semaphore, &xHigherPriorityTaskWoken);
     }
     
+    trace_isr_exit(TRACE_ISR_KEYPAD);
     portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
 }
 
@@ -130,37 +141,34 @@ bool keypad_init(void) {
     // *** CONFIGURACIÓN DEL SISTEMA HÍBRIDO (del proyecto 1) ***
     
     // Configurar columnas para permitir detección por interrupciones
-    for (int i = 0; i < COLS; i++) {
-        gpio_init(col_pins[i]);
-        gpio_set_dir(col_pins[i], GPIO_OUT);
-        gpio_put(col_pins[i], 0); // LOW para permitir interrupciones
-        printf("Columna %d (GP%d) configurada como salida\n", i, col_pins[i]);
-    }
+    // (todas en LOW para que una tecla presionada baje su fila)
+    gpio_init_mask(BOARD_KEYPAD_COL_MASK);
+    gpio_set_dir_out_masked(BOARD_KEYPAD_COL_MASK);
+    gpio_clr_mask(BOARD_KEYPAD_COL_MASK);
+    printf("Columnas configuradas como salida (máscara 0x%08lx)\n",
+           (unsigned long)BOARD_KEYPAD_COL_MASK);
 
     // Configurar filas con interrupciones (PARTE REACTIVA)
+    gpio_init_mask(BOARD_KEYPAD_ROW_MASK);
+    gpio_set_dir_in_masked(BOARD_KEYPAD_ROW_MASK);
     for (int i = 0; i < ROWS; i++) {
-        gpio_init(row_pins[i]);
-        gpio_set_dir(row_pins[i], GPIO_IN);
-        gpio_pull_up(row_pins[i]);
+        gpio_pull_up(board_row_pins[i]);
+        row_last_level[i] = true;   // En reposo el pull-up mantiene la fila alta
         
         // INTERRUPCIÓN: Detecta flanco descendente cuando se presiona tecla
-        gpio_set_irq_enabled_with_callback(row_pins[i], GPIO_IRQ_EDGE_FALL, true, &keypad_gpio_isr);
-        printf("Fila %d (GP%d) configurada con IRQ en flanco descendente\n", i, row_pins[i]);
+        gpio_set_irq_enabled_with_callback(board_row_pins[i], GPIO_IRQ_EDGE_FALL, true, &keypad_gpio_isr);
     }
+    printf("Filas configuradas con IRQ en flanco descendente (máscara 0x%08lx)\n",
+           (unsigned long)BOARD_KEYPAD_ROW_MASK);
 
-    // Crear cola para eventos del teclado
-    keypad_queue = xQueueCreate(10, sizeof(keypad_event_t));
-    if (keypad_queue == NULL) {
-        printf("ERROR: No se pudo crear la cola del teclado\n");
-        return false;
-    }
-    
     // Crear semáforo para despertar tarea desde ISR
-    keypad_wakeup_semaphore = xSemaphoreCreateBinary();
+    keypad_wakeup_semaphore = RTOS_BINARY_SEMAPHORE_CREATE(keypad_wakeup_semaphore);
     if (keypad_wakeup_semaphore == NULL) {
         printf("ERROR: No se pudo crear el semáforo de despertar\n");
         return false;
     }
+    
+    trace_register_queue(keypad_wakeup_semaphore, TRACE_QUEUE_KEYPAD_SEM, "keypad_sem");
 
     // Estado inicial
     hybrid_ctrl.state = KEYPAD_IDLE;
@@ -170,6 +178,19 @@ bool keypad_init(void) {
     return true;
 }
 
+/**
+ * @brief Lee el nivel de una fila y registra los cambios para la reproducción
+ */
+static bool row_level(uint8_t row) {
+    bool level = gpio_get(board_row_pins[row]);
+    
+    if (level != row_last_level[row]) {
+        row_last_level[row] = level;
+        input_record(INPUT_EV_ROW, (uint8_t)(row | (level ? INPUT_ROW_HIGH : 0)));
+    }
+    return level;
+}
+
 /**
  * @brief Ejecuta la máquina de estados híbrida (adaptada del proyecto 1)
  * 
@@ -178,6 +199,7 @@ bool keypad_init(void) {
  */
 static void keypad_process_hybrid_fsm(void) {
     TickType_t current_time = xTaskGetTickCount();
+    keypad_fsm_state_t previous = hybrid_ctrl.state;
     
     switch (hybrid_ctrl.state) {
         case KEYPAD_DEBOUNCE: {
@@ -185,7 +207,7 @@ static void keypad_process_hybrid_fsm(void) {
             
             if (time_diff >= pdMS_TO_TICKS(DEBOUNCE_TIME_MS)) {
                 // Verificar que la fila sigue activa (debounce)
-                bool row_still_active = !gpio_get(row_pins[hybrid_ctrl.detected_row]);
+                bool row_still_active = !row_level(hybrid_ctrl.detected_row);
                 
                 if (row_still_active) {
                     // Inicializar escaneo de columnas
@@ -193,14 +215,14 @@ static void keypad_process_hybrid_fsm(void) {
                     hybrid_ctrl.state = KEYPAD_COLUMN_SCAN;
                     
                     // Activar primera columna y marcar tiempo
-                    gpio_put(col_pins[0], 1);
+                    gpio_put_masked(BOARD_KEYPAD_COL_MASK, board_col_select[0]);
                     hybrid_ctrl.column_change_time = current_time;
                     
-                    printf("Fila %d activa, iniciando escaneo de columnas\n", hybrid_ctrl.detected_row);
+                    LOG_DEBUG("Fila %d activa, iniciando escaneo de columnas", hybrid_ctrl.detected_row);
                 } else {
                     // Rebote filtrado - volver a IDLE
                     hybrid_ctrl.state = KEYPAD_IDLE;
-                    printf("Rebote filtrado en fila %d\n", hybrid_ctrl.detected_row);
+                    LOG_DEBUG("Rebote filtrado en fila %d", hybrid_ctrl.detected_row);
                 }
             }
             break;
@@ -213,39 +235,46 @@ static void keypad_process_hybrid_fsm(void) {
             if (stabilization_time >= pdMS_TO_TICKS(COLUMN_STABILIZATION_MS)) {
                 
                 // POLLING: Leer estado de la fila conocida (de la IRQ)
-                if (gpio_get(row_pins[hybrid_ctrl.detected_row])) {
+                if (row_level(hybrid_ctrl.detected_row)) {
                     // ¡Tecla encontrada por combinación IRQ + POLLING!
                     hybrid_ctrl.detected_col = hybrid_ctrl.current_column;
                     hybrid_ctrl.state = KEYPAD_PRESSED;
                     
                     char detected_key = keymap[hybrid_ctrl.detected_row][hybrid_ctrl.detected_col];
+                    input_record(INPUT_EV_KEY, (uint8_t)detected_key);
                     
-                    // Crear evento y enviarlo a la cola
-                    keypad_event_t event;
-                    event.key = detected_key;
-                    event.timestamp = current_time;
-                    
-                    if (xQueueSend(keypad_queue, &event, 0) == pdTRUE) {
-                        printf("Tecla detectada (híbrido): '%c' en fila %d, columna %d\n", 
-                               detected_key, hybrid_ctrl.detected_row, hybrid_ctrl.detected_col);
+                    // Escribir el evento directamente en una ranura del bus
+                    eb_msg_t *msg = bus_alloc(BUS_TOPIC_KEY);
+                    if (msg != NULL) {
+                        keypad_event_t *event = EB_PAYLOAD(msg, keypad_event_t);
+                        event->key = detected_key;
+                        event->timestamp = current_time;
+                        
+                        if (bus_publish(msg)) {
+                            LOG_INFO("Tecla detectada (híbrido): '%c' en fila %d, columna %d",
+                                     detected_key, hybrid_ctrl.detected_row, hybrid_ctrl.detected_col);
+                        }
+                    } else {
+                        // Contado en "SinRanura" del comando bus
+                        LOG_WARN("Tecla '%c' descartada: el bus no tiene ranura", detected_key);
                     }
                     
-                    // Restaurar columna para próxima detección
-                    gpio_put(col_pins[hybrid_ctrl.current_column], 0);
+                    // Restaurar columnas para próxima detección
+                    gpio_clr_mask(BOARD_KEYPAD_COL_MASK);
                     
                 } else {
                     // Esta columna no es la correcta, continuar escaneo
-                    gpio_put(col_pins[hybrid_ctrl.current_column], 0);
                     hybrid_ctrl.current_column++;
                     
                     if (hybrid_ctrl.current_column < COLS) {
-                        // Activar siguiente columna
-                        gpio_put(col_pins[hybrid_ctrl.current_column], 1);
+                        // Pasar a la siguiente columna en una sola escritura
+                        gpio_put_masked(BOARD_KEYPAD_COL_MASK, board_col_select[hybrid_ctrl.current_column]);
                         hybrid_ctrl.column_change_time = current_time;
                     } else {
                         // No se encontró tecla válida
+                        gpio_clr_mask(BOARD_KEYPAD_COL_MASK);
                         hybrid_ctrl.state = KEYPAD_IDLE;
-                        printf("No se encontró tecla válida en fila %d\n", hybrid_ctrl.detected_row);
+                        LOG_WARN("No se encontró tecla válida en fila %d", hybrid_ctrl.detected_row);
                     }
                 }
             }
@@ -254,12 +283,12 @@ static void keypad_process_hybrid_fsm(void) {
 
         case KEYPAD_PRESSED: {
             // POLLING: Verificar continuamente si la tecla sigue presionada
-            bool still_pressed = !gpio_get(row_pins[hybrid_ctrl.detected_row]);
+            bool still_pressed = !row_level(hybrid_ctrl.detected_row);
             
             if (!still_pressed) {
                 hybrid_ctrl.state = KEYPAD_RELEASED;
                 hybrid_ctrl.last_change = current_time;
-                printf("Tecla liberada\n");
+                LOG_DEBUG("Tecla liberada");
             }
             break;
         }
@@ -271,7 +300,7 @@ static void keypad_process_hybrid_fsm(void) {
             if (release_time >= pdMS_TO_TICKS(RELEASE_TIME_MS)) {
                 hybrid_ctrl.state = KEYPAD_IDLE;  // Listo para nueva IRQ
                 hybrid_ctrl.irq_pending = false;
-                printf("Sistema híbrido listo para nueva detección\n");
+                LOG_DEBUG("Sistema híbrido listo para nueva detección");
             }
             break;
         }
@@ -281,6 +310,10 @@ static void keypad_process_hybrid_fsm(void) {
             hybrid_ctrl.irq_pending = false;
             break;
     }
+    
+    if (hybrid_ctrl.state != previous) {
+        input_record(INPUT_EV_KEYPAD_STATE, (uint8_t)hybrid_ctrl.state);
+    }
 }
 
 /**
@@ -288,31 +321,24 @@ static void keypad_process_hybrid_fsm(void) {
  */
 void keypad_task(void *pvParameters) {
     printf("Tarea híbrida del teclado iniciada (Proyecto 1 + FreeRTOS)\n");
+    boot_mark(BOOT_PHASE_INPUT_READY);
     
     while (1) {
         // Esperar señal de interrupción o procesar FSM si está activa
         if (hybrid_ctrl.state == KEYPAD_IDLE) {
             // Estado IDLE: Esperar semáforo de IRQ (bloqueo eficiente)
+            task_health_idle(HEALTH_KEYPAD);
             xSemaphoreTake(keypad_wakeup_semaphore, portMAX_DELAY);
+            task_health_start(HEALTH_KEYPAD);
         } else {
             // Estados activos: Procesar FSM continuamente con pequeñas pausas
             keypad_process_hybrid_fsm();
             vTaskDelay(pdMS_TO_TICKS(5)); // Pequeña pausa para permitir otras tareas
+            task_health_heartbeat(HEALTH_KEYPAD);
         }
     }
 }
 
-/**
- * @brief Obtiene un evento del teclado
- */
-bool keypad_get_event(keypad_event_t *event, uint32_t timeout_ms) {
-    if (keypad_queue == NULL || event == NULL) {
-        return false;
-    }
-    
-    return xQueueReceive(keypad_queue, event, pdMS_TO_TICKS(timeout_ms)) == pdTRUE;
-}
-
 /**
  * @brief Verifica si el sistema está en estado IDLE (para WFI)
  */
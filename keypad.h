@@ -9,6 +9,7 @@
  * - Polling identifica columnas (GP10-GP13)
  * - Máquina de estados: IDLE → DEBOUNCE → COLUMN_SCAN → PRESSED → RELEASED
  * - FreeRTOS: Semáforos para sincronización ISR-tarea
+ * - Las teclas se publican en BUS_TOPIC_KEY (system_bus.h) como keypad_event_t
  */
 
 #ifndef KEYPAD_H
@@ -16,7 +17,6 @@
 
 #include "pico/stdlib.h"
 #include "FreeRTOS.h"
-#include "queue.h"
 #include "semphr.h"
 
 /**
@@ -53,16 +53,6 @@ bool keypad_init(void);
  */
 void keypad_task(void *pvParameters);
 
-/**
- * @brief Obtiene un evento del teclado
- * 
- * @param event Puntero donde almacenar el evento
- * @param timeout_ms Tiempo máximo de espera en ms
- * @return true Si se recibió un evento
- * @return false Si hubo timeout
- */
-bool keypad_get_event(keypad_event_t *event, uint32_t timeout_ms);
-
 /**
  * @brief Verifica si el teclado está inactivo (para WFI)
  * 
@@ -0,0 +1,262 @@
+/**
+ * @file led_sequence.c
+ * @brief Implementación del intérprete de secuencias de LEDs
+ * @author Sistema de Control de Acceso
+ * @date 2025
+ */
+
+#include "led_sequence.h"
+#include <string.h>
+
+/** @brief Límite de pasos sin espera ejecutados en una sola llamada */
+#define LED_SEQ_MAX_ZERO_STEPS 16
+
+#define STEP(mask, on, ms)  { LED_OP_STEP, (mask), (on), 255, (ms) }
+#define FADE(mask, b, ms)   { LED_OP_STEP, (mask), (mask), (b), (ms) }
+#define END(mask, on)       { LED_OP_END, (mask), (on), 255, 0 }
+#define LOOP()              { LED_OP_LOOP, 0, 0, 0, 0 }
+
+/* ---- Secuencias predefinidas ---------------------------------------- */
+
+const led_step_t led_seq_verde_on[]     = { END(LED_BIT_VERDE, LED_BIT_VERDE) };
+const led_step_t led_seq_verde_off[]    = { END(LED_BIT_VERDE, 0) };
+const led_step_t led_seq_rojo_on[]      = { END(LED_BIT_ROJO, LED_BIT_ROJO) };
+const led_step_t led_seq_rojo_off[]     = { END(LED_BIT_ROJO, 0) };
+const led_step_t led_seq_amarillo_on[]  = { END(LED_BIT_AMARILLO, LED_BIT_AMARILLO) };
+const led_step_t led_seq_amarillo_off[] = { END(LED_BIT_AMARILLO, 0) };
+const led_step_t led_seq_all_off[]      = { END(LED_BIT_ALL, 0) };
+
+/** @brief Parpadeo a 0.5 Hz: 1 s encendido, 1 s apagado */
+const led_step_t led_seq_amarillo_blink[] = {
+    STEP(LED_BIT_AMARILLO, LED_BIT_AMARILLO, 1000),
+    STEP(LED_BIT_AMARILLO, 0, 1000),
+    LOOP()
+};
+
+/** @brief Verde durante 5 segundos */
+const led_step_t led_seq_acceso_concedido[] = {
+    STEP(LED_BIT_VERDE, LED_BIT_VERDE, 5000),
+    END(LED_BIT_VERDE, 0)
+};
+
+/** @brief Rojo durante 2 segundos */
+const led_step_t led_seq_acceso_denegado[] = {
+    STEP(LED_BIT_ROJO, LED_BIT_ROJO, 2000),
+    END(LED_BIT_ROJO, 0)
+};
+
+/** @brief Doble destello rojo para usuario bloqueado */
+const led_step_t led_seq_bloqueo[] = {
+    STEP(LED_BIT_ROJO, LED_BIT_ROJO, 150),
+    STEP(LED_BIT_ROJO, 0, 150),
+    STEP(LED_BIT_ROJO, LED_BIT_ROJO, 150),
+    STEP(LED_BIT_ROJO, 0, 600),
+    STEP(LED_BIT_ROJO, LED_BIT_ROJO, 150),
+    STEP(LED_BIT_ROJO, 0, 150),
+    STEP(LED_BIT_ROJO, LED_BIT_ROJO, 150),
+    END(LED_BIT_ROJO, 0)
+};
+
+/** @brief Respiración del amarillo (con PWM; sin PWM degrada a parpadeo lento) */
+const led_step_t led_seq_respiracion[] = {
+    FADE(LED_BIT_AMARILLO, 16, 100),  FADE(LED_BIT_AMARILLO, 48, 100),
+    FADE(LED_BIT_AMARILLO, 96, 100),  FADE(LED_BIT_AMARILLO, 160, 100),
+    FADE(LED_BIT_AMARILLO, 224, 100), FADE(LED_BIT_AMARILLO, 255, 300),
+    FADE(LED_BIT_AMARILLO, 224, 100), FADE(LED_BIT_AMARILLO, 160, 100),
+    FADE(LED_BIT_AMARILLO, 96, 100),  FADE(LED_BIT_AMARILLO, 48, 100),
+    FADE(LED_BIT_AMARILLO, 16, 100),  STEP(LED_BIT_AMARILLO, 0, 500),
+    LOOP()
+};
+
+/* ---- Intérprete ------------------------------------------------------ */
+
+/**
+ * @brief true si el instante t ya fue alcanzado en now (tolerante a desborde)
+ */
+static inline bool time_reached(uint32_t now, uint32_t t) {
+    return (int32_t)(now - t) >= 0;
+}
+
+/**
+ * @brief Aplica los niveles de un paso sobre los LEDs de los que es dueño
+ */
+static void apply_levels(led_engine_t *engine, uint8_t mask, uint8_t on, uint8_t brightness) {
+    uint8_t new_on = (uint8_t)((engine->on & ~mask) | (on & mask));
+
+    for (int i = 0; i < LED_SEQ_NUM_LEDS; i++) {
+        uint8_t bit = (uint8_t)(1u << i);
+        if ((mask & on & bit) && engine->brightness[i] != brightness) {
+            engine->brightness[i] = brightness;
+            engine->dirty = true;
+        }
+    }
+
+    if (new_on != engine->on) {
+        engine->on = new_on;
+        engine->dirty = true;
+    }
+}
+
+/**
+ * @brief Libera una secuencia
+ */
+static void player_free(led_player_t *p) {
+    p->seq = NULL;
+    p->owned = 0;
+    p->stepping = false;
+    p->timed = false;
+}
+
+/**
+ * @brief Ejecuta pasos de una secuencia hasta encontrar una espera o el fin
+ *
+ * @param base_ms Instante en que debía comenzar el paso actual
+ */
+static void player_run(led_engine_t *engine, led_player_t *p, uint32_t base_ms) {
+    for (int guard = 0; guard < LED_SEQ_MAX_ZERO_STEPS && p->stepping; guard++) {
+        const led_step_t *step = &p->seq[p->pc];
+
+        switch (step->op) {
+            case LED_OP_STEP:
+                apply_levels(engine, step->mask & p->owned, step->on, step->brightness);
+                p->pc++;
+                if (step->duration_ms > 0) {
+                    p->next_step_ms = base_ms + step->duration_ms;
+                    return;
+                }
+                break;
+
+            case LED_OP_LOOP:
+                p->pc = 0;
+                break;
+
+            case LED_OP_END:
+            default:
+                apply_levels(engine, step->mask & p->owned, step->on, step->brightness);
+                p->stepping = false;
+                // Sin apagado programado no queda nada que vigilar
+                if (!p->timed) {
+                    player_free(p);
+                }
+                return;
+        }
+    }
+
+    // Bucle sin esperas: detener para no bloquear al llamador
+    p->stepping = false;
+}
+
+/**
+ * @brief Inicializa el motor con todos los LEDs apagados
+ */
+void led_engine_init(led_engine_t *engine) {
+    memset(engine, 0, sizeof(*engine));
+    engine->dirty = true;
+}
+
+/**
+ * @brief Inicia una secuencia
+ */
+void led_engine_start(led_engine_t *engine, const led_step_t *seq,
+                      uint32_t duration_ms, uint32_t now_ms) {
+    uint8_t seq_mask = 0;
+    led_player_t *slot = NULL;
+
+    // Máscara de LEDs que toca la secuencia completa
+    for (const led_step_t *s = seq; ; s++) {
+        seq_mask |= s->mask;
+        if (s->op != LED_OP_STEP) {
+            break;
+        }
+    }
+    if (seq_mask == 0) {
+        return;
+    }
+
+    // Quitar esos LEDs a las secuencias anteriores
+    for (int i = 0; i < LED_SEQ_MAX_PLAYERS; i++) {
+        led_player_t *p = &engine->players[i];
+        if (p->seq == NULL) {
+            continue;
+        }
+        p->owned &= (uint8_t)~seq_mask;
+        if (p->owned == 0) {
+            player_free(p);
+        }
+    }
+
+    for (int i = 0; i < LED_SEQ_MAX_PLAYERS; i++) {
+        if (engine->players[i].seq == NULL) {
+            slot = &engine->players[i];
+            break;
+        }
+    }
+    if (slot == NULL) {
+        return;
+    }
+
+    slot->seq = seq;
+    slot->pc = 0;
+    slot->owned = seq_mask;
+    slot->stepping = true;
+    slot->timed = (duration_ms > 0);
+    slot->stop_ms = now_ms + duration_ms;
+
+    player_run(engine, slot, now_ms);
+}
+
+/**
+ * @brief Avanza todas las secuencias hasta el tiempo actual
+ */
+uint32_t led_engine_service(led_engine_t *engine, uint32_t now_ms) {
+    uint32_t wait = LED_SEQ_NO_DEADLINE;
+
+    for (int i = 0; i < LED_SEQ_MAX_PLAYERS; i++) {
+        led_player_t *p = &engine->players[i];
+        if (p->seq == NULL) {
+            continue;
+        }
+
+        if (p->timed && time_reached(now_ms, p->stop_ms)) {
+            apply_levels(engine, p->owned, 0, 0);
+            player_free(p);
+            continue;
+        }
+
+        if (p->stepping && time_reached(now_ms, p->next_step_ms)) {
+            uint32_t base = p->next_step_ms;
+            // Si hubo un atraso mayor a un paso, realinear con el tiempo actual
+            if ((now_ms - base) > p->seq[p->pc > 0 ? p->pc - 1 : 0].duration_ms) {
+                base = now_ms;
+            }
+            player_run(engine, p, base);
+            if (p->seq == NULL) {
+                continue;
+            }
+        }
+
+        if (p->stepping && (p->next_step_ms - now_ms) < wait) {
+            wait = p->next_step_ms - now_ms;
+        }
+        if (p->timed && (p->stop_ms - now_ms) < wait) {
+            wait = p->stop_ms - now_ms;
+        }
+    }
+
+    return wait;
+}
+
+/**
+ * @brief LEDs que deben estar en alto cuando no se usa PWM
+ */
+uint8_t led_engine_gpio_bits(const led_engine_t *engine) {
+    uint8_t bits = 0;
+
+    for (int i = 0; i < LED_SEQ_NUM_LEDS; i++) {
+        uint8_t bit = (uint8_t)(1u << i);
+        if ((engine->on & bit) && engine->brightness[i] >= LED_SEQ_GPIO_THRESHOLD) {
+            bits |= bit;
+        }
+    }
+    return bits;
+}
@@ -0,0 +1,136 @@
+/**
+ * @file led_sequence.h
+ * @brief Intérprete de secuencias declarativas de LEDs
+ * @author Sistema de Control de Acceso
+ * @date 2025
+ *
+ * Cada señal luminosa se describe como una tabla de pasos (máscara, nivel,
+ * duración) guardada en flash. Un intérprete pequeño ejecuta hasta
+ * LED_SEQ_MAX_PLAYERS secuencias a la vez; cada una es dueña de los LEDs que
+ * toca, de modo que patrones sobre LEDs distintos se combinan en lugar de
+ * serializarse.
+ *
+ * El módulo no depende de FreeRTOS ni del SDK: trabaja con tiempos en
+ * milisegundos entregados por el llamador y expone el estado de salida como
+ * máscaras de bits, lo que permite probarlo en el host.
+ */
+
+#ifndef LED_SEQUENCE_H
+#define LED_SEQUENCE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/** @brief Bits de LED usados en las máscaras de los pasos */
+#define LED_BIT_VERDE       (1u << 0)
+#define LED_BIT_ROJO        (1u << 1)
+#define LED_BIT_AMARILLO    (1u << 2)
+#define LED_BIT_ALL         (LED_BIT_VERDE | LED_BIT_ROJO | LED_BIT_AMARILLO)
+
+/** @brief Número de LEDs manejados por el intérprete */
+#define LED_SEQ_NUM_LEDS    3
+
+/** @brief Número máximo de secuencias ejecutándose simultáneamente */
+#define LED_SEQ_MAX_PLAYERS LED_SEQ_NUM_LEDS
+
+/** @brief Brillo mínimo para considerar un LED encendido sin PWM */
+#define LED_SEQ_GPIO_THRESHOLD 128
+
+/** @brief Valor de retorno cuando no hay plazos pendientes */
+#define LED_SEQ_NO_DEADLINE UINT32_MAX
+
+/**
+ * @brief Operaciones de un paso de secuencia
+ */
+typedef enum {
+    LED_OP_STEP,    /**< Aplicar niveles y esperar duration_ms */
+    LED_OP_LOOP,    /**< Volver al primer paso */
+    LED_OP_END      /**< Aplicar niveles y mantenerlos (fin de secuencia) */
+} led_op_t;
+
+/**
+ * @brief Paso de una secuencia de LEDs
+ */
+typedef struct {
+    uint8_t op;             /**< Operación (led_op_t) */
+    uint8_t mask;           /**< LEDs afectados por el paso (LED_BIT_*) */
+    uint8_t on;             /**< LEDs de la máscara que quedan encendidos */
+    uint8_t brightness;     /**< Brillo de los LEDs encendidos (0-255, con PWM) */
+    uint16_t duration_ms;   /**< Duración del paso (solo LED_OP_STEP) */
+} led_step_t;
+
+/**
+ * @brief Estado de ejecución de una secuencia
+ */
+typedef struct {
+    const led_step_t *seq;  /**< Secuencia en ejecución (NULL = libre) */
+    uint8_t pc;             /**< Índice del paso actual */
+    uint8_t owned;          /**< LEDs de los que esta secuencia es dueña */
+    bool stepping;          /**< true mientras la secuencia avanza por pasos */
+    bool timed;             /**< true si debe apagarse en stop_ms */
+    uint32_t next_step_ms;  /**< Instante del próximo paso */
+    uint32_t stop_ms;       /**< Instante de apagado forzado */
+} led_player_t;
+
+/**
+ * @brief Motor de secuencias de LEDs
+ */
+typedef struct {
+    led_player_t players[LED_SEQ_MAX_PLAYERS];
+    uint8_t on;                                 /**< LEDs lógicamente encendidos */
+    uint8_t brightness[LED_SEQ_NUM_LEDS];       /**< Brillo actual de cada LED */
+    bool dirty;                                 /**< Salida cambió desde la última lectura */
+} led_engine_t;
+
+/* Secuencias predefinidas (en flash) */
+extern const led_step_t led_seq_verde_on[];
+extern const led_step_t led_seq_verde_off[];
+extern const led_step_t led_seq_rojo_on[];
+extern const led_step_t led_seq_rojo_off[];
+extern const led_step_t led_seq_amarillo_on[];
+extern const led_step_t led_seq_amarillo_off[];
+extern const led_step_t led_seq_amarillo_blink[];
+extern const led_step_t led_seq_all_off[];
+extern const led_step_t led_seq_acceso_concedido[];
+extern const led_step_t led_seq_acceso_denegado[];
+extern const led_step_t led_seq_bloqueo[];
+extern const led_step_t led_seq_respiracion[];
+
+/**
+ * @brief Inicializa el motor con todos los LEDs apagados
+ */
+void led_engine_init(led_engine_t *engine);
+
+/**
+ * @brief Inicia una secuencia
+ *
+ * La secuencia toma posesión de todos los LEDs que aparecen en sus pasos;
+ * las secuencias previas pierden esos LEDs (y se detienen si se quedan sin
+ * ninguno). Los demás LEDs no se ven afectados.
+ *
+ * @param engine Motor de secuencias
+ * @param seq Secuencia a ejecutar (terminada en LED_OP_END o LED_OP_LOOP)
+ * @param duration_ms Si es mayor a 0, los LEDs de la secuencia se apagan tras
+ *                    esa duración aunque la secuencia no haya terminado
+ * @param now_ms Tiempo actual en milisegundos
+ */
+void led_engine_start(led_engine_t *engine, const led_step_t *seq,
+                      uint32_t duration_ms, uint32_t now_ms);
+
+/**
+ * @brief Avanza todas las secuencias hasta el tiempo actual
+ *
+ * @param engine Motor de secuencias
+ * @param now_ms Tiempo actual en milisegundos
+ * @return uint32_t Milisegundos hasta el próximo plazo, o LED_SEQ_NO_DEADLINE
+ */
+uint32_t led_engine_service(led_engine_t *engine, uint32_t now_ms);
+
+/**
+ * @brief LEDs que deben estar en alto cuando no se usa PWM
+ *
+ * @return uint8_t Máscara LED_BIT_* de LEDs encendidos con brillo suficiente
+ */
+uint8_t led_engine_gpio_bits(const led_engine_t *engine);
+
+#endif // LED_SEQUENCE_H
@@ -13,16 +13,21 @@
 
 #include "pico/stdlib.h"
 #include "FreeRTOS.h"
-#include "queue.h"
+#include "board.h"
 
 /** @brief Pin GPIO para LED verde - indica acceso concedido */
-#define LED_VERDE_PIN   15  
+#define LED_VERDE_PIN   BOARD_LED_VERDE_PIN
 
 /** @brief Pin GPIO para LED rojo - indica acceso denegado */
-#define LED_ROJO_PIN    16  
+#define LED_ROJO_PIN    BOARD_LED_ROJO_PIN
 
 /** @brief Pin GPIO para LED amarillo - estado del sistema */
-#define LED_AMARILLO_PIN 17 
+#define LED_AMARILLO_PIN BOARD_LED_AMARILLO_PIN
+
+/** @brief 1 para controlar el brillo de los LEDs con PWM, 0 para GPIO simple */
+#ifndef LED_USE_PWM
+#define LED_USE_PWM 0
+#endif
 
 /**
  * @brief Estados posibles de los LEDs
@@ -34,7 +39,7 @@ typedef enum {
 } led_state_t;
 
 /**
- * @brief Comandos para la tarea de LEDs
+ * @brief Comandos para la corrutina de LEDs
  */
 typedef enum {
     LED_CMD_VERDE_ON,
@@ -49,7 +54,9 @@ typedef enum {
     LED_CMD_ACCESO_DENEGADO,
     LED_CMD_SISTEMA_LISTO,
     LED_CMD_PROCESO_INICIADO,
-    LED_CMD_ESPERANDO_CLAVE
+    LED_CMD_ESPERANDO_CLAVE,
+    LED_CMD_BLOQUEO,            /**< Doble destello rojo: usuario bloqueado */
+    LED_CMD_RESPIRACION         /**< Amarillo "respirando" (requiere PWM para el efecto) */
 } led_command_t;
 
 /**
@@ -64,7 +71,9 @@ typedef struct {
  * @brief Inicializa todos los LEDs del sistema
  * 
  * Configura los pines GPIO como salidas y los inicializa en estado apagado.
- * Crea la cola para comandos de LEDs.
+ * Registra la corrutina de LEDs en el ejecutor (executor.h), que procesa
+ * los comandos del bus de eventos (BUS_TOPIC_LED) y los pasos de las
+ * secuencias declarativas (ver led_sequence.h). Requiere executor_init.
  * 
  * @return true Si la inicialización fue exitosa
  * @return false Si hubo error en la inicialización
@@ -72,20 +81,13 @@ typedef struct {
 bool leds_init(void);
 
 /**
- * @brief Tarea de FreeRTOS para manejar los LEDs
- * 
- * Esta tarea procesa comandos de LED desde una cola y maneja
- * los patrones de parpadeo automáticamente.
- * 
- * @param pvParameters Parámetros de la tarea (no utilizados)
- */
-void led_task(void *pvParameters);
-
-/**
- * @brief Envía un comando a la tarea de LEDs
+ * @brief Envía un comando a la corrutina de LEDs
  * 
  * @param command Comando a ejecutar
  * @param duration_ms Duración del comando (0 = permanente)
+ * No bloquea: si el pool del bus está agotado el comando se descarta y
+ * queda contado en las estadísticas del tópico.
+ * 
  * @return true Si el comando se envió exitosamente
  * @return false Si hubo error al enviar el comando
  */
@@ -118,4 +120,9 @@ void signal_proceso_iniciado(void);
  */
 void signal_esperando_clave(void);
 
+/**
+ * @brief Señaliza usuario bloqueado con un doble destello rojo
+ */
+void signal_usuario_bloqueado(void);
+
 #endif // LEDS_H
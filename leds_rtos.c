@@ -6,42 +6,93 @@
  */
 
 #include "leds.h"
+#include "led_sequence.h"
+#include "task_health.h"
 #include "hardware/gpio.h"
+#if LED_USE_PWM
+#include "hardware/pwm.h"
+#endif
 #include "FreeRTOS.h"
 #include "task.h"
-#include "queue.h"
+#include "system_bus.h"
+#include "executor.h"
+
+#define LOG_MODULE LEDS
+#include "log.h"
 #include <stdio.h>
 
-/** @brief Cola para comandos de LEDs */
-static QueueHandle_t led_queue;
+/** @brief Suscripción a los comandos de LEDs */
+static int led_sub = -1;
+
+/** @brief Corrutina de los LEDs en el ejecutor */
+static co_t led_co;
+
+static void led_run(co_t *co);
+
+_Static_assert(sizeof(led_cmd_t) <= EB_PAYLOAD_SIZE, "led_cmd_t no cabe en una ranura del bus");
 
-/** @brief Estados actuales de los LEDs */
-static struct {
-    led_state_t verde;
-    led_state_t rojo;
-    led_state_t amarillo;
-} led_states = {LED_OFF, LED_OFF, LED_OFF};
+/** @brief Máscara GPIO de los tres LEDs */
+#define LED_GPIO_MASK BOARD_LED_MASK
+
+_Static_assert(BOARD_NUM_LEDS == LED_SEQ_NUM_LEDS && LED_BIT_ALL == (1u << BOARD_NUM_LEDS) - 1,
+               "board.h y led_sequence.h difieren en los LEDs");
+
+#if LED_USE_PWM
+/** @brief Pines en el orden de los bits LED_BIT_* */
+static const uint led_gpio_pins[LED_SEQ_NUM_LEDS] = {
+    LED_VERDE_PIN, LED_ROJO_PIN, LED_AMARILLO_PIN
+};
+#endif
+
+/**
+ * @brief Secuencia predefinida asociada a cada comando
+ */
+static const led_step_t *const led_command_sequences[] = {
+    [LED_CMD_VERDE_ON]         = led_seq_verde_on,
+    [LED_CMD_VERDE_OFF]        = led_seq_verde_off,
+    [LED_CMD_ROJO_ON]          = led_seq_rojo_on,
+    [LED_CMD_ROJO_OFF]         = led_seq_rojo_off,
+    [LED_CMD_AMARILLO_ON]      = led_seq_amarillo_on,
+    [LED_CMD_AMARILLO_OFF]     = led_seq_amarillo_off,
+    [LED_CMD_AMARILLO_BLINK]   = led_seq_amarillo_blink,
+    [LED_CMD_ALL_OFF]          = led_seq_all_off,
+    [LED_CMD_ACCESO_CONCEDIDO] = led_seq_acceso_concedido,
+    [LED_CMD_ACCESO_DENEGADO]  = led_seq_acceso_denegado,
+    [LED_CMD_SISTEMA_LISTO]    = led_seq_amarillo_on,
+    [LED_CMD_PROCESO_INICIADO] = led_seq_amarillo_off,
+    [LED_CMD_ESPERANDO_CLAVE]  = led_seq_amarillo_blink,
+    [LED_CMD_BLOQUEO]          = led_seq_bloqueo,
+    [LED_CMD_RESPIRACION]      = led_seq_respiracion,
+};
+
+/** @brief Motor de secuencias de LEDs */
+static led_engine_t led_engine;
 
 /**
  * @brief Inicializa todos los LEDs del sistema
  */
 bool leds_init(void) {
     // Configurar pines GPIO como salidas
-    gpio_init(LED_VERDE_PIN);
-    gpio_set_dir(LED_VERDE_PIN, GPIO_OUT);
-    gpio_put(LED_VERDE_PIN, 0);
-
-    gpio_init(LED_ROJO_PIN);
-    gpio_set_dir(LED_ROJO_PIN, GPIO_OUT);
-    gpio_put(LED_ROJO_PIN, 0);
+    gpio_init_mask(LED_GPIO_MASK);
+    gpio_set_dir_out_masked(LED_GPIO_MASK);
+    gpio_clr_mask(LED_GPIO_MASK);
+
+#if LED_USE_PWM
+    for (int i = 0; i < LED_SEQ_NUM_LEDS; i++) {
+        uint slice = pwm_gpio_to_slice_num(led_gpio_pins[i]);
+        gpio_set_function(led_gpio_pins[i], GPIO_FUNC_PWM);
+        pwm_set_wrap(slice, 65535);
+        pwm_set_gpio_level(led_gpio_pins[i], 0);
+        pwm_set_enabled(slice, true);
+    }
+#endif
 
-    gpio_init(LED_AMARILLO_PIN);
-    gpio_set_dir(LED_AMARILLO_PIN, GPIO_OUT);
-    gpio_put(LED_AMARILLO_PIN, 0);
+    led_engine_init(&led_engine);
 
-    // Crear cola para comandos de LEDs
-    led_queue = xQueueCreate(10, sizeof(led_cmd_t));
-    if (led_queue == NULL) {
+    // Recibir comandos de LEDs del bus de eventos en una corrutina del ejecutor
+    int co_id = executor_add(&led_co, "leds", led_run);
+    led_sub = executor_subscribe(co_id, "leds", BUS_TOPIC_BIT(BUS_TOPIC_LED), 0);
+    if (led_sub < 0) {
         return false;
     }
 
@@ -50,162 +101,91 @@ bool leds_init(void) {
 }
 
 /**
- * @brief Controla físicamente un LED
+ * @brief Escribe el estado del motor en los pines
+ * 
+ * Sin PWM, los tres LEDs se actualizan con una única escritura enmascarada,
+ * por lo que los cambios simultáneos no producen estados intermedios.
+ */
+static void led_output_update(void) {
+    if (!led_engine.dirty) {
+        return;
+    }
+    led_engine.dirty = false;
+    
+#if LED_USE_PWM
+    for (int i = 0; i < LED_SEQ_NUM_LEDS; i++) {
+        uint16_t level = 0;
+        if (led_engine.on & (1u << i)) {
+            // Corrección gamma aproximada: brillo al cuadrado
+            level = (uint16_t)(led_engine.brightness[i] * led_engine.brightness[i]);
+        }
+        pwm_set_gpio_level(led_gpio_pins[i], level);
+    }
+#else
+    // Bits LED_BIT_* a pines con la tabla calculada en board.h
+    gpio_put_masked(LED_GPIO_MASK, board_led_gpio[led_engine_gpio_bits(&led_engine) & LED_BIT_ALL]);
+#endif
+}
+
+/**
+ * @brief Tiempo actual en milisegundos para el motor de secuencias
  */
-static void set_led_physical(uint gpio_pin, bool state) {
-    gpio_put(gpio_pin, state ? 1 : 0);
+static inline uint32_t led_now_ms(void) {
+    return (uint32_t)xTaskGetTickCount() * portTICK_PERIOD_MS;
 }
 
 /**
- * @brief Tarea de FreeRTOS para manejar los LEDs
+ * @brief Corrutina que maneja los LEDs
+ * 
+ * Cada comando inicia su secuencia predefinida en el motor, que combina
+ * patrones sobre LEDs distintos. La corrutina espera exactamente hasta el
+ * próximo paso de alguna secuencia o hasta que llegue un comando.
  */
-void led_task(void *pvParameters) {
-    led_cmd_t cmd;
-    TickType_t last_blink_time = 0;
-    bool blink_state = false;
+static void led_run(co_t *co) {
+    const eb_msg_t *msg;
+    uint32_t wait_ms;
+    
+    CO_BEGIN(co);
     
     while (1) {
-        // Verificar si hay comandos en la cola
-        if (xQueueReceive(led_queue, &cmd, pdMS_TO_TICKS(100)) == pdTRUE) {
-            switch (cmd.command) {
-                case LED_CMD_VERDE_ON:
-                    led_states.verde = LED_ON;
-                    set_led_physical(LED_VERDE_PIN, true);
-                    printf("LED Verde: ON\n");
-                    
-                    // Si tiene duración, programar apagado
-                    if (cmd.duration_ms > 0) {
-                        vTaskDelay(pdMS_TO_TICKS(cmd.duration_ms));
-                        led_states.verde = LED_OFF;
-                        set_led_physical(LED_VERDE_PIN, false);
-                        printf("LED Verde: OFF (timeout)\n");
-                    }
-                    break;
-
-                case LED_CMD_VERDE_OFF:
-                    led_states.verde = LED_OFF;
-                    set_led_physical(LED_VERDE_PIN, false);
-                    printf("LED Verde: OFF\n");
-                    break;
-
-                case LED_CMD_ROJO_ON:
-                    led_states.rojo = LED_ON;
-                    set_led_physical(LED_ROJO_PIN, true);
-                    printf("LED Rojo: ON\n");
-                    
-                    // Si tiene duración, programar apagado
-                    if (cmd.duration_ms > 0) {
-                        vTaskDelay(pdMS_TO_TICKS(cmd.duration_ms));
-                        led_states.rojo = LED_OFF;
-                        set_led_physical(LED_ROJO_PIN, false);
-                        printf("LED Rojo: OFF (timeout)\n");
-                    }
-                    break;
-
-                case LED_CMD_ROJO_OFF:
-                    led_states.rojo = LED_OFF;
-                    set_led_physical(LED_ROJO_PIN, false);
-                    printf("LED Rojo: OFF\n");
-                    break;
-
-                case LED_CMD_AMARILLO_ON:
-                    led_states.amarillo = LED_ON;
-                    set_led_physical(LED_AMARILLO_PIN, true);
-                    printf("LED Amarillo: ON\n");
-                    break;
-
-                case LED_CMD_AMARILLO_OFF:
-                    led_states.amarillo = LED_OFF;
-                    set_led_physical(LED_AMARILLO_PIN, false);
-                    printf("LED Amarillo: OFF\n");
-                    break;
-
-                case LED_CMD_AMARILLO_BLINK:
-                    led_states.amarillo = LED_BLINK;
-                    last_blink_time = xTaskGetTickCount();
-                    blink_state = true;
-                    set_led_physical(LED_AMARILLO_PIN, true);
-                    printf("LED Amarillo: BLINK\n");
-                    break;
-
-                case LED_CMD_ALL_OFF:
-                    led_states.verde = LED_OFF;
-                    led_states.rojo = LED_OFF;
-                    led_states.amarillo = LED_OFF;
-                    set_led_physical(LED_VERDE_PIN, false);
-                    set_led_physical(LED_ROJO_PIN, false);
-                    set_led_physical(LED_AMARILLO_PIN, false);
-                    printf("Todos los LEDs: OFF\n");
-                    break;
-
-                case LED_CMD_ACCESO_CONCEDIDO:
-                    // LED verde por 5 segundos
-                    led_states.verde = LED_ON;
-                    set_led_physical(LED_VERDE_PIN, true);
-                    printf("Señal: Acceso Concedido\n");
-                    vTaskDelay(pdMS_TO_TICKS(5000));
-                    led_states.verde = LED_OFF;
-                    set_led_physical(LED_VERDE_PIN, false);
-                    break;
-
-                case LED_CMD_ACCESO_DENEGADO:
-                    // LED rojo por 2 segundos
-                    led_states.rojo = LED_ON;
-                    set_led_physical(LED_ROJO_PIN, true);
-                    printf("Señal: Acceso Denegado\n");
-                    vTaskDelay(pdMS_TO_TICKS(2000));
-                    led_states.rojo = LED_OFF;
-                    set_led_physical(LED_ROJO_PIN, false);
-                    break;
-
-                case LED_CMD_SISTEMA_LISTO:
-                    led_states.amarillo = LED_ON;
-                    set_led_physical(LED_AMARILLO_PIN, true);
-                    printf("Señal: Sistema Listo\n");
-                    break;
-
-                case LED_CMD_PROCESO_INICIADO:
-                    led_states.amarillo = LED_OFF;
-                    set_led_physical(LED_AMARILLO_PIN, false);
-                    printf("Señal: Proceso Iniciado\n");
-                    break;
-
-                case LED_CMD_ESPERANDO_CLAVE:
-                    led_states.amarillo = LED_BLINK;
-                    last_blink_time = xTaskGetTickCount();
-                    blink_state = true;
-                    set_led_physical(LED_AMARILLO_PIN, true);
-                    printf("Señal: Esperando Clave\n");
-                    break;
-            }
-        }
-
-        // Manejar parpadeo del LED amarillo a 0.5Hz (período de 2 segundos, 1 segundo ON, 1 segundo OFF)
-        if (led_states.amarillo == LED_BLINK) {
-            TickType_t current_time = xTaskGetTickCount();
-            if (current_time - last_blink_time >= pdMS_TO_TICKS(1000)) { // Cambio cada 1 segundo para 0.5Hz
-                blink_state = !blink_state;
-                set_led_physical(LED_AMARILLO_PIN, blink_state);
-                last_blink_time = current_time;
+        task_health_begin(HEALTH_LEDS);
+        
+        while ((msg = bus_poll(led_sub)) != NULL) {
+            // El comando se lee en la ranura del bus, sin copiarlo
+            const led_cmd_t *cmd = EB_PAYLOAD(msg, const led_cmd_t);
+            if ((unsigned)cmd->command < count_of(led_command_sequences) &&
+                led_command_sequences[cmd->command] != NULL) {
+                led_engine_start(&led_engine, led_command_sequences[cmd->command],
+                                 cmd->duration_ms, led_now_ms());
+                LOG_DEBUG("LED comando: %d", cmd->command);
             }
+            bus_release(msg);
         }
+        
+        wait_ms = led_engine_service(&led_engine, led_now_ms());
+        led_output_update();
+        task_health_end(HEALTH_LEDS);
+        
+        CO_WAIT(co, (wait_ms == LED_SEQ_NO_DEADLINE) ? CO_FOREVER : wait_ms);
     }
+    
+    CO_END(co);
 }
 
 /**
- * @brief Envía un comando a la tarea de LEDs
+ * @brief Envía un comando a la corrutina de LEDs
  */
 bool led_send_command(led_command_t command, uint32_t duration_ms) {
-    if (led_queue == NULL) {
+    eb_msg_t *msg = bus_alloc(BUS_TOPIC_LED);
+    if (msg == NULL) {
         return false;
     }
 
-    led_cmd_t cmd = {
-        .command = command,
-        .duration_ms = duration_ms
-    };
+    led_cmd_t *cmd = EB_PAYLOAD(msg, led_cmd_t);
+    cmd->command = command;
+    cmd->duration_ms = duration_ms;
 
-    return xQueueSend(led_queue, &cmd, pdMS_TO_TICKS(100)) == pdTRUE;
+    return bus_publish(msg);
 }
 
 /* Funciones de conveniencia */
@@ -229,3 +209,7 @@ void signal_proceso_iniciado(void) {
 void signal_esperando_clave(void) {
     led_send_command(LED_CMD_ESPERANDO_CLAVE, 0);
 }
+
+void signal_usuario_bloqueado(void) {
+    led_send_command(LED_CMD_BLOQUEO, 0);
+}
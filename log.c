@@ -0,0 +1,154 @@
+/**
+ * @file log.c
+ * @brief Implementación del registro diferido de mensajes
+ * @author Sistema de Control de Acceso
+ * @date 2025
+ *
+ * El Cortex-M0+ no tiene instrucciones de acceso exclusivo, por lo que el
+ * productor reserva y llena el registro con las interrupciones enmascaradas
+ * durante unas pocas instrucciones; el formateo y la salida por USB ocurren
+ * únicamente en log_task.
+ */
+
+#include "log.h"
+#include <stdarg.h>
+#include <stdio.h>
+#include "pico/stdlib.h"
+#include "hardware/sync.h"
+#include "FreeRTOS.h"
+#include "task.h"
+
+_Static_assert((LOG_RING_RECORDS & (LOG_RING_RECORDS - 1)) == 0,
+               "LOG_RING_RECORDS debe ser potencia de 2");
+
+/** @brief Buffer circular de registros */
+static log_record_t log_ring[LOG_RING_RECORDS];
+
+/** @brief Registros escritos (productores) */
+static volatile uint32_t log_head;
+
+/** @brief Registros consumidos (log_task) */
+static volatile uint32_t log_tail;
+
+/** @brief Mensajes descartados por buffer lleno */
+static volatile uint32_t log_dropped;
+
+/** @brief Handle de la tarea de log (para despertarla) */
+static TaskHandle_t log_task_handle = NULL;
+
+/**
+ * @brief Guarda un mensaje en el buffer circular
+ */
+void log_write(uint8_t level, uint8_t module, const char *format, int nargs, ...) {
+    va_list ap;
+    uint32_t args[LOG_MAX_ARGS];
+    
+    va_start(ap, nargs);
+    for (int i = 0; i < nargs && i < LOG_MAX_ARGS; i++) {
+        args[i] = va_arg(ap, uint32_t);
+    }
+    va_end(ap);
+    
+    uint32_t irq_state = save_and_disable_interrupts();
+    uint32_t head = log_head;
+    bool was_empty = (head == log_tail);
+    
+    if (head - log_tail >= LOG_RING_RECORDS) {
+        log_dropped++;
+        restore_interrupts(irq_state);
+        return;
+    }
+    
+    log_record_t *r = &log_ring[head & (LOG_RING_RECORDS - 1)];
+    r->timestamp_us = time_us_32();
+    r->format = (uint32_t)(uintptr_t)format;
+    r->level = level;
+    r->module = module;
+    r->nargs = (uint8_t)((nargs < LOG_MAX_ARGS) ? nargs : LOG_MAX_ARGS);
+    r->reserved = 0;
+    for (int i = 0; i < r->nargs; i++) {
+        r->args[i] = args[i];
+    }
+    log_head = head + 1;
+    restore_interrupts(irq_state);
+    
+    // Despertar a la tarea de log solo en la transición vacío -> no vacío
+    if (was_empty && log_task_handle != NULL &&
+        xTaskGetSchedulerState() == taskSCHEDULER_RUNNING) {
+        if (__get_current_exception() != 0) {
+            vTaskNotifyGiveFromISR(log_task_handle, NULL);
+        } else {
+            xTaskNotifyGive(log_task_handle);
+        }
+    }
+}
+
+/**
+ * @brief Inicializa el registro diferido
+ */
+bool log_init(void) {
+    log_head = 0;
+    log_tail = 0;
+    log_dropped = 0;
+    return true;
+}
+
+/**
+ * @brief Envía un registro por la salida estándar
+ */
+static void log_emit(const log_record_t *r) {
+#if LOG_BINARY_OUTPUT
+    const uint8_t *b = (const uint8_t *)r;
+    size_t len = sizeof(*r) - (LOG_MAX_ARGS - r->nargs) * sizeof(uint32_t);
+    
+    printf("@L ");
+    for (size_t i = 0; i < len; i++) {
+        printf("%02x", b[i]);
+    }
+    printf("\n");
+#else
+    static const char level_tag[] = "-EWID";
+    
+    printf("[%10lu] %c ", (unsigned long)r->timestamp_us,
+           level_tag[r->level < sizeof(level_tag) - 1 ? r->level : 0]);
+    printf((const char *)(uintptr_t)r->format, r->args[0], r->args[1], r->args[2], r->args[3]);
+    printf("\n");
+#endif
+}
+
+/**
+ * @brief Tarea de FreeRTOS que vacía el buffer por USB
+ */
+void log_task(void *pvParameters) {
+    uint32_t reported_dropped = 0;
+    log_record_t record;
+    
+    log_task_handle = xTaskGetCurrentTaskHandle();
+    
+    while (1) {
+        // Bloquear hasta que un productor escriba en el buffer vacío
+        if (log_tail == log_head) {
+            ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        }
+        
+        while (log_tail != log_head) {
+            // Copiar antes de liberar el lugar; printf puede bloquear
+            record = log_ring[log_tail & (LOG_RING_RECORDS - 1)];
+            __compiler_memory_barrier();
+            log_tail = log_tail + 1;
+            log_emit(&record);
+        }
+        
+        if (log_dropped != reported_dropped) {
+            reported_dropped = log_dropped;
+            printf("# log: %lu mensajes descartados (buffer lleno)\n", (unsigned long)reported_dropped);
+        }
+    }
+}
+
+/**
+ * @brief Cantidad de mensajes descartados por buffer lleno desde el arranque
+ */
+uint32_t log_get_dropped(void) {
+    return log_dropped;
+}
@@ -0,0 +1,155 @@
+/**
+ * @file log.h
+ * @brief Registro diferido de mensajes en formato binario
+ * @author Sistema de Control de Acceso
+ * @date 2025
+ *
+ * Las macros LOG_ERROR/WARN/INFO/DEBUG no formatean nada en el llamador:
+ * guardan la dirección del formato (que vive en flash), la marca de tiempo y
+ * hasta LOG_MAX_ARGS argumentos de 32 bits en un buffer circular. La tarea
+ * de log, de prioridad mínima, vacía el buffer por USB como registros
+ * binarios en hexadecimal ("@L ...") que tools/log_expand.py convierte a texto
+ * usando el ELF, o bien los formatea en el propio equipo si
+ * LOG_BINARY_OUTPUT = 0.
+ *
+ * Cada archivo define LOG_MODULE (p. ej. KEYPAD) antes de incluir este
+ * encabezado; el nivel de cada módulo se fija en compilación con
+ * LOG_LEVEL_<MÓDULO> y los mensajes por encima de ese nivel no generan código.
+ *
+ * Restricciones de los argumentos: enteros, caracteres y punteros de hasta
+ * 32 bits. %s solo admite cadenas constantes en flash; para IDs numéricos
+ * guardados en RAM usar log_decimal() con %lu. No se admiten flotantes.
+ */
+
+#ifndef LOG_H
+#define LOG_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/** @brief Niveles de log */
+#define LOG_LEVEL_NONE      0
+#define LOG_LEVEL_ERROR     1
+#define LOG_LEVEL_WARN      2
+#define LOG_LEVEL_INFO      3
+#define LOG_LEVEL_DEBUG     4
+
+/**
+ * @brief Módulos que generan logs (el orden lo usa tools/log_expand.py)
+ */
+typedef enum {
+    LOG_MOD_MAIN,
+    LOG_MOD_KEYPAD,
+    LOG_MOD_ACCESS,
+    LOG_MOD_DATABASE,
+    LOG_MOD_LEDS,
+    LOG_MOD_COUNT
+} log_module_t;
+
+/* Nivel por módulo (se puede redefinir desde CMake con -DLOG_LEVEL_xxx=n) */
+#ifndef LOG_LEVEL_MAIN
+#define LOG_LEVEL_MAIN      LOG_LEVEL_INFO
+#endif
+#ifndef LOG_LEVEL_KEYPAD
+#define LOG_LEVEL_KEYPAD    LOG_LEVEL_INFO
+#endif
+#ifndef LOG_LEVEL_ACCESS
+#define LOG_LEVEL_ACCESS    LOG_LEVEL_INFO
+#endif
+#ifndef LOG_LEVEL_DATABASE
+#define LOG_LEVEL_DATABASE  LOG_LEVEL_INFO
+#endif
+#ifndef LOG_LEVEL_LEDS
+#define LOG_LEVEL_LEDS      LOG_LEVEL_INFO
+#endif
+
+/** @brief 1 = registros binarios para log_expand.py, 0 = texto formateado en el equipo */
+#ifndef LOG_BINARY_OUTPUT
+#define LOG_BINARY_OUTPUT   1
+#endif
+
+/** @brief Número máximo de argumentos por mensaje */
+#define LOG_MAX_ARGS        4
+
+/** @brief Capacidad del buffer circular (potencia de 2) */
+#define LOG_RING_RECORDS    128
+
+/**
+ * @brief Registro de log tal como se guarda y se transmite
+ */
+typedef struct {
+    uint32_t timestamp_us;          /**< time_us_32() al registrar */
+    uint32_t format;                /**< Dirección del formato en flash */
+    uint8_t level;                  /**< LOG_LEVEL_* */
+    uint8_t module;                 /**< log_module_t */
+    uint8_t nargs;                  /**< Argumentos válidos en args[] */
+    uint8_t reserved;
+    uint32_t args[LOG_MAX_ARGS];    /**< Argumentos sin formatear */
+} log_record_t;
+
+#define LOG_CAT_(a, b)      a##b
+#define LOG_CAT(a, b)       LOG_CAT_(a, b)
+
+/* Número de argumentos variables (0 a LOG_MAX_ARGS) */
+#define LOG_NARGS_(_0, _1, _2, _3, _4, n, ...) n
+#define LOG_NARGS(...)      LOG_NARGS_(_0, ##__VA_ARGS__, 4, 3, 2, 1, 0)
+
+#define LOG_AT(level, fmt, ...)                                               \
+    do {                                                                      \
+        if ((level) <= LOG_CAT(LOG_LEVEL_, LOG_MODULE)) {                     \
+            log_write((level), LOG_CAT(LOG_MOD_, LOG_MODULE), (fmt),          \
+                      LOG_NARGS(__VA_ARGS__), ##__VA_ARGS__);                 \
+        }                                                                     \
+    } while (0)
+
+#define LOG_ERROR(fmt, ...) LOG_AT(LOG_LEVEL_ERROR, fmt, ##__VA_ARGS__)
+#define LOG_WARN(fmt, ...)  LOG_AT(LOG_LEVEL_WARN, fmt, ##__VA_ARGS__)
+#define LOG_INFO(fmt, ...)  LOG_AT(LOG_LEVEL_INFO, fmt, ##__VA_ARGS__)
+#define LOG_DEBUG(fmt, ...) LOG_AT(LOG_LEVEL_DEBUG, fmt, ##__VA_ARGS__)
+
+/**
+ * @brief Guarda un mensaje en el buffer circular (usar las macros LOG_*)
+ *
+ * Se puede llamar desde tareas e ISRs. Si el buffer está lleno el mensaje
+ * se descarta y se cuenta.
+ *
+ * @param level Nivel del mensaje
+ * @param module Módulo que lo genera
+ * @param format Formato printf (debe ser un literal)
+ * @param nargs Cantidad de argumentos que siguen
+ */
+void log_write(uint8_t level, uint8_t module, const char *format, int nargs, ...);
+
+/**
+ * @brief Convierte una cadena de dígitos (p. ej. un ID de usuario) a entero
+ *
+ * Permite registrar IDs guardados en RAM con %lu sin copiar la cadena.
+ */
+static inline unsigned long log_decimal(const char *digits) {
+    unsigned long value = 0;
+    while (*digits >= '0' && *digits <= '9') {
+        value = value * 10 + (unsigned long)(*digits++ - '0');
+    }
+    return value;
+}
+
+/**
+ * @brief Inicializa el registro diferido
+ *
+ * @return true Si la inicialización fue exitosa
+ */
+bool log_init(void);
+
+/**
+ * @brief Tarea de FreeRTOS que vacía el buffer por USB
+ *
+ * @param pvParameters Parámetros de la tarea (no utilizados)
+ */
+void log_task(void *pvParameters);
+
+/**
+ * @brief Cantidad de mensajes descartados por buffer lleno desde el arranque
+ */
+uint32_t log_get_dropped(void);
+
+#endif // LOG_H
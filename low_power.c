@@ -0,0 +1,147 @@
+/**
+ * @file low_power.c
+ * @brief Implementación del idle sin tick para el RP2040
+ * @author Sistema de Control de Acceso
+ * @date 2025
+ *
+ * FreeRTOS llama a vPortSuppressTicksAndSleep() desde la tarea idle cuando
+ * el próximo plazo está al menos configEXPECTED_IDLE_TIME_BEFORE_SLEEP ticks
+ * en el futuro (configUSE_TICKLESS_IDLE = 2, implementación propia).
+ *
+ * El SysTick solo alcanza ~134 ms a 125 MHz, por lo que la espera se
+ * programa en una alarma del temporizador de 1 MHz. La fracción del tick en
+ * curso y el resto de cada suspensión se acumulan para que el contador de
+ * ticks no derive respecto al tiempo real.
+ */
+
+#include "low_power.h"
+#include "pico/stdlib.h"
+#include "hardware/timer.h"
+#include "hardware/sync.h"
+#include "hardware/structs/systick.h"
+#include "hardware/structs/scb.h"
+#include "FreeRTOS.h"
+#include "task.h"
+
+/** @brief Microsegundos por tick del kernel */
+#define LOW_POWER_US_PER_TICK   (1000000u / configTICK_RATE_HZ)
+
+/** @brief Ciclos de CPU por microsegundo (reloj del SysTick) */
+#define LOW_POWER_CYCLES_PER_US (configCPU_CLOCK_HZ / 1000000u)
+
+/** @brief Alarma de hardware usada para despertar (-1 = no reservada) */
+static int wake_alarm = -1;
+
+/** @brief Tiempo dormido aún no convertido en ticks (menor a un tick) */
+static uint32_t residual_us;
+
+/** @brief Contadores del modo de bajo consumo */
+static low_power_stats_t low_power_stats;
+
+/**
+ * @brief Callback de la alarma: solo sirve para sacar al núcleo de WFI
+ */
+static void wake_alarm_callback(uint alarm_num) {
+}
+
+/**
+ * @brief Prepara el modo de bajo consumo
+ */
+bool low_power_init(void) {
+    wake_alarm = hardware_alarm_claim_unused(false);
+    if (wake_alarm < 0) {
+        return false;
+    }
+
+    hardware_alarm_set_callback(wake_alarm, wake_alarm_callback);
+    return true;
+}
+
+/**
+ * @brief Suspende el tick del kernel y duerme hasta el próximo plazo o IRQ
+ *
+ * @param xExpectedIdleTime Ticks hasta que alguna tarea deba desbloquearse
+ */
+void vPortSuppressTicksAndSleep(TickType_t xExpectedIdleTime) {
+    if (wake_alarm < 0) {
+        return;
+    }
+
+    if (xExpectedIdleTime > pdMS_TO_TICKS(LOW_POWER_MAX_SLEEP_MS)) {
+        xExpectedIdleTime = pdMS_TO_TICKS(LOW_POWER_MAX_SLEEP_MS);
+    }
+
+    // Con PRIMASK activo, una IRQ pendiente igual despierta a WFI pero su
+    // handler recién se ejecuta después de compensar el tick
+    uint32_t irq_state = save_and_disable_interrupts();
+    __dsb();
+    __isb();
+
+    if (eTaskConfirmSleepModeStatus() == eAbortSleep) {
+        low_power_stats.aborted++;
+        restore_interrupts(irq_state);
+        return;
+    }
+
+    // Detener el SysTick y medir cuánto del tick actual ya transcurrió
+    systick_hw->csr &= ~M0PLUS_SYST_CSR_ENABLE_BITS;
+    uint64_t start_us = time_us_64();
+    uint32_t in_tick_us = (systick_hw->rvr + 1 - systick_hw->cvr) / LOW_POWER_CYCLES_PER_US;
+
+    // Si el SysTick venció justo antes de detenerlo, contar ese tick aquí
+    if (scb_hw->icsr & M0PLUS_ICSR_PENDSTSET_BITS) {
+        scb_hw->icsr = M0PLUS_ICSR_PENDSTCLR_BITS;
+        in_tick_us += LOW_POWER_US_PER_TICK;
+    }
+
+    uint64_t budget_us = (uint64_t)xExpectedIdleTime * LOW_POWER_US_PER_TICK;
+    uint64_t already_us = (uint64_t)in_tick_us + residual_us;
+
+    if (budget_us > already_us) {
+        bool missed = hardware_alarm_set_target(wake_alarm,
+                                                from_us_since_boot(start_us + budget_us - already_us));
+        if (!missed) {
+            __dsb();
+            __wfi();
+            __isb();
+        }
+        hardware_alarm_cancel(wake_alarm);
+    }
+
+    // Compensar exactamente: ticks completos al kernel, resto acumulado
+    uint64_t slept_us = time_us_64() - start_us;
+    uint64_t total_us = slept_us + already_us;
+    TickType_t ticks = (TickType_t)(total_us / LOW_POWER_US_PER_TICK);
+
+    if (ticks > xExpectedIdleTime) {
+        ticks = xExpectedIdleTime;
+    }
+    residual_us = (uint32_t)(total_us - (uint64_t)ticks * LOW_POWER_US_PER_TICK);
+
+    if (ticks < xExpectedIdleTime) {
+        low_power_stats.early_wakeups++;
+    }
+    low_power_stats.sleeps++;
+    low_power_stats.slept_us += slept_us;
+
+    vTaskStepTick(ticks);
+
+    // Reanudar el SysTick con un período completo
+    systick_hw->cvr = 0;
+    systick_hw->csr |= M0PLUS_SYST_CSR_ENABLE_BITS;
+
+    restore_interrupts(irq_state);
+}
+
+/**
+ * @brief Obtiene los contadores del modo de bajo consumo
+ */
+void low_power_get_stats(low_power_stats_t *stats) {
+    if (stats == NULL) {
+        return;
+    }
+
+    uint32_t irq_state = save_and_disable_interrupts();
+    *stats = low_power_stats;
+    restore_interrupts(irq_state);
+}
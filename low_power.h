@@ -0,0 +1,51 @@
+/**
+ * @file low_power.h
+ * @brief Modo de bajo consumo con idle sin tick (tickless) para FreeRTOS
+ * @author Sistema de Control de Acceso
+ * @date 2025
+ * 
+ * Implementa vPortSuppressTicksAndSleep() usando el temporizador de hardware
+ * de 1 MHz del RP2040: cuando todas las tareas están bloqueadas se detiene
+ * el SysTick y el núcleo duerme hasta el próximo plazo real del kernel o
+ * hasta cualquier interrupción (p. ej. la IRQ de las filas del teclado).
+ * Al despertar, el contador de ticks se compensa exactamente.
+ */
+
+#ifndef LOW_POWER_H
+#define LOW_POWER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/** @brief Duración máxima de una suspensión sin tick (ms) */
+#define LOW_POWER_MAX_SLEEP_MS 60000
+
+/**
+ * @brief Contadores del modo de bajo consumo
+ */
+typedef struct {
+    uint32_t sleeps;            /**< Veces que el núcleo entró en suspensión */
+    uint32_t aborted;           /**< Suspensiones canceladas por tareas listas */
+    uint32_t early_wakeups;     /**< Despertares por IRQ antes del plazo */
+    uint64_t slept_us;          /**< Tiempo total dormido en microsegundos */
+} low_power_stats_t;
+
+/**
+ * @brief Prepara el modo de bajo consumo
+ * 
+ * Reserva una alarma del temporizador de hardware. Debe llamarse antes de
+ * iniciar el scheduler, desde el núcleo que ejecuta FreeRTOS.
+ * 
+ * @return true Si la inicialización fue exitosa
+ * @return false Si no hay alarmas de hardware libres
+ */
+bool low_power_init(void);
+
+/**
+ * @brief Obtiene los contadores del modo de bajo consumo
+ * 
+ * @param stats Puntero donde copiar los contadores
+ */
+void low_power_get_stats(low_power_stats_t *stats);
+
+#endif // LOW_POWER_H
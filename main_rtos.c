@@ -40,23 +40,93 @@
 #include "database.h"
 #include "access_control.h"
 #include "ssd1306_display.h"
+#include "time_service.h"
+#include "console.h"
+#include "low_power.h"
+#include "rtos_static.h"
+#include "log.h"
+#include "boot_profile.h"
+#include "task_health.h"
+#include "system_bus.h"
+#include "access_report.h"
+#include "i2c_bus.h"
+#include "executor.h"
 
 /**
- * @brief Función principal del sistema con FreeRTOS
- * 
- * Inicializa todos los módulos del sistema, crea las tareas de FreeRTOS
- * y inicia el scheduler del sistema operativo.
+ * @brief Tamaño de pila de cada tarea (en palabras)
+ *
+ * El ejecutor reemplaza a las tareas de LEDs (256) y display (1024): sus
+ * corrutinas comparten una pila dimensionada por la más profunda, el display.
+ */
+#define KEYPAD_TASK_STACK           512
+#define EXECUTOR_TASK_STACK         1024
+#define I2C_BUS_TASK_STACK          256
+#define ACCESS_CONTROL_TASK_STACK   512
+#define CONSOLE_TASK_STACK          512
+#define LOG_TASK_STACK              256
+#define HEALTH_TASK_STACK           256
+#define STATS_TASK_STACK            256
+
+#if configSUPPORT_DYNAMIC_ALLOCATION
+/**
+ * @brief Heap que no son pilas: 9 TCB (~100 B), 7 semáforos (~80 B) y las
+ * cabeceras de heap_4 (8 B por bloque)
+ */
+#define KERNEL_OBJECTS_HEAP_BYTES   2048
+
+_Static_assert((KEYPAD_TASK_STACK + EXECUTOR_TASK_STACK + I2C_BUS_TASK_STACK +
+                ACCESS_CONTROL_TASK_STACK + CONSOLE_TASK_STACK + LOG_TASK_STACK +
+                HEALTH_TASK_STACK + STATS_TASK_STACK + configMINIMAL_STACK_SIZE) *
+               sizeof(StackType_t) + KERNEL_OBJECTS_HEAP_BYTES <= configTOTAL_HEAP_SIZE,
+               "configTOTAL_HEAP_SIZE no alcanza para las pilas de las tareas");
+#endif
+
+/**
+ * @brief Prioridad de cada tarea
  * 
- * @return int Código de salida (nunca se alcanza en sistemas embebidos)
+ * Asignación monotónica en tasa verificada con tools/sched_analysis.py:
+ * el paso de 5 ms del teclado arriba, luego el control de acceso (una tecla
+ * cada 50 ms como máximo, plazo más corto), después el ejecutor (LEDs y
+ * display), gestor I2C y monitor de plazos, y la consola, el log y las estadísticas como tareas de fondo.
  */
-int main() {
-    /**
-     * Inicialización de comunicación serie USB
-     * Timeout extendido para establecer conexión
-     */
-    stdio_init_all();
-    sleep_ms(3000); // Espera para conexión USB
+#define KEYPAD_TASK_PRIORITY            4
+#define ACCESS_CONTROL_TASK_PRIORITY    3
+#define EXECUTOR_TASK_PRIORITY          2
+#define I2C_BUS_TASK_PRIORITY           2
+#define HEALTH_TASK_PRIORITY            2
+#define CONSOLE_TASK_PRIORITY           1
+#define LOG_TASK_PRIORITY               1
+#define STATS_TASK_PRIORITY             1
+
+/** @brief Prioridad utilizable: sobre la tarea idle y bajo configMAX_PRIORITIES */
+#define TASK_PRIORITY_VALID(p)  ((p) > tskIDLE_PRIORITY && (p) < configMAX_PRIORITIES)
+
+_Static_assert(TASK_PRIORITY_VALID(KEYPAD_TASK_PRIORITY) &&
+               TASK_PRIORITY_VALID(ACCESS_CONTROL_TASK_PRIORITY) &&
+               TASK_PRIORITY_VALID(EXECUTOR_TASK_PRIORITY) &&
+               TASK_PRIORITY_VALID(I2C_BUS_TASK_PRIORITY) &&
+               TASK_PRIORITY_VALID(HEALTH_TASK_PRIORITY) &&
+               TASK_PRIORITY_VALID(CONSOLE_TASK_PRIORITY) &&
+               TASK_PRIORITY_VALID(LOG_TASK_PRIORITY) &&
+               TASK_PRIORITY_VALID(STATS_TASK_PRIORITY),
+               "Prioridad de tarea fuera de 1..configMAX_PRIORITIES-1");
 
+RTOS_TASK_DEFINE(keypad_task, KEYPAD_TASK_STACK);
+RTOS_TASK_DEFINE(executor_task, EXECUTOR_TASK_STACK);
+RTOS_TASK_DEFINE(i2c_bus_task, I2C_BUS_TASK_STACK);
+RTOS_TASK_DEFINE(access_control_task, ACCESS_CONTROL_TASK_STACK);
+RTOS_TASK_DEFINE(console_task, CONSOLE_TASK_STACK);
+RTOS_TASK_DEFINE(log_task, LOG_TASK_STACK);
+RTOS_TASK_DEFINE(task_health_task, HEALTH_TASK_STACK);
+RTOS_TASK_DEFINE(access_report_task, STATS_TASK_STACK);
+
+/**
+ * @brief Imprime el banner del sistema y los usuarios de prueba
+ * 
+ * Con FAST_BOOT la consola lo imprime al conectarse la terminal USB, en
+ * lugar de retrasar el arranque esperando la conexión.
+ */
+static void print_banner(void) {
     // Mostrar información del sistema
     printf("=== SISTEMA DE CONTROL DE ACCESO CON FREERTOS ===\n");
     printf("Raspberry Pi Pico - Teclado Matricial 4x4 + Display SSD1306\n");
@@ -69,15 +139,70 @@ int main() {
     printf("[7] [8] [9] [C]\n");
     printf("[*] [0] [#] [D]\n\n");
     
+    // Mostrar información de usuarios para pruebas
+    printf("\n=== USUARIOS REGISTRADOS ===\n");
+    printf("ID: 123456, Contraseña: 1234\n");
+    printf("ID: 789012, Contraseña: 5678\n");
+    printf("ID: 345678, Contraseña: 9012\n");
+    printf("ID: 901234, Contraseña: 3456\n");
+    printf("ID: 567890, Contraseña: 7890\n");
+    printf("Para cambiar contraseña: presione '*' al inicio\n\n");
+}
+
+/**
+ * @brief Función principal del sistema con FreeRTOS
+ * 
+ * Inicializa todos los módulos del sistema, crea las tareas de FreeRTOS
+ * y inicia el scheduler del sistema operativo.
+ * 
+ * @return int Código de salida (nunca se alcanza en sistemas embebidos)
+ */
+int main() {
+    /**
+     * Inicialización de comunicación serie USB
+     * Con FAST_BOOT no se espera la conexión: el USB se enumera en segundo
+     * plano y la consola imprime el banner cuando se conecta la terminal
+     */
+    boot_mark(BOOT_PHASE_MAIN);
+    stdio_init_all();
+    boot_mark(BOOT_PHASE_STDIO);
+    
+#if !FAST_BOOT
+    sleep_ms(3000); // Espera para conexión USB
+    print_banner();
+#endif
+    
     /**
      * Inicialización de módulos del sistema
-     * Orden optimizado para el sistema con FreeRTOS
+     * Primero lo necesario para aceptar teclas (salidas, teclado y máquina
+     * de estados); el display solo se suscribe al bus y se configura en su tarea
      */
     
+    // Inicializar el log diferido primero: los módulos registran desde su init
+    if (!log_init()) {
+        printf("ERROR: No se pudo inicializar el log diferido\n");
+        return -1;
+    }
+    
+    // Bus de eventos: antes de que los módulos se suscriban
+    if (!system_bus_init()) {
+        printf("ERROR: No se pudo inicializar el bus de eventos\n");
+        return -1;
+    }
+    
     // Inicializar base de datos de usuarios
-    database_init();
+    if (!database_init()) {
+        printf("ERROR: No se pudo inicializar la base de datos\n");
+        return -1;
+    }
     printf("Base de datos inicializada\n");
     
+    // Ejecutor de corrutinas: antes de que LEDs y display registren las suyas
+    if (!executor_init()) {
+        printf("ERROR: No se pudo inicializar el ejecutor de corrutinas\n");
+        return -1;
+    }
+    
     // Inicializar sistema de LEDs
     if (!leds_init()) {
         printf("ERROR: No se pudo inicializar el sistema de LEDs\n");
@@ -85,12 +210,19 @@ int main() {
     }
     printf("Sistema de LEDs inicializado\n");
     
+    // Gestor del bus I2C: antes de que el display y otros clientes se registren
+    if (!i2c_bus_init()) {
+        printf("ERROR: No se pudo inicializar el gestor I2C\n");
+        return -1;
+    }
+    
     // Inicializar display SSD1306
     if (!ssd1306_init()) {
         printf("ERROR: No se pudo inicializar el display SSD1306\n");
         return -1;
     }
     printf("Display SSD1306 inicializado\n");
+    boot_mark(BOOT_PHASE_OUTPUTS);
     
     // Inicializar teclado matricial
     if (!keypad_init()) {
@@ -98,6 +230,7 @@ int main() {
         return -1;
     }
     printf("Teclado matricial inicializado\n");
+    boot_mark(BOOT_PHASE_KEYPAD);
     
     // Inicializar sistema de control de acceso
     if (!access_control_init()) {
@@ -105,55 +238,112 @@ int main() {
         return -1;
     }
     printf("Sistema de control de acceso inicializado\n");
+    boot_mark(BOOT_PHASE_ACCESS);
     
-    // Mostrar información de usuarios para pruebas
-    printf("\n=== USUARIOS REGISTRADOS ===\n");
-    printf("ID: 123456, Contraseña: 1234\n");
-    printf("ID: 789012, Contraseña: 5678\n");
-    printf("ID: 345678, Contraseña: 9012\n");
-    printf("ID: 901234, Contraseña: 3456\n");
-    printf("ID: 567890, Contraseña: 7890\n");
-    printf("Para cambiar contraseña: presione '*' al inicio\n\n");
+    // Inicializar servicio de fecha y hora (RTC)
+    if (!time_service_init()) {
+        printf("ERROR: No se pudo inicializar el servicio de tiempo\n");
+        return -1;
+    }
+    printf("Servicio de tiempo inicializado\n");
+    
+    // Estadísticas de acceso (observador de BUS_TOPIC_AUTH)
+    if (!access_report_init()) {
+        printf("ERROR: No se pudo inicializar las estadísticas de acceso\n");
+        return -1;
+    }
+    printf("Estadísticas de acceso inicializadas\n");
+    
+    // Inicializar consola de comandos USB
+    if (!console_init()) {
+        printf("ERROR: No se pudo inicializar la consola USB\n");
+        return -1;
+    }
+    printf("Consola USB inicializada (escriba 'help')\n");
+    
+    // Preparar idle sin tick (alarma de hardware para despertar)
+    if (!low_power_init()) {
+        printf("ERROR: No se pudo inicializar el modo de bajo consumo\n");
+        return -1;
+    }
+    printf("Modo de bajo consumo (tickless) inicializado\n");
+    
+    // Contratos temporales de las tareas y watchdog de hardware
+    if (!task_health_init()) {
+        printf("ERROR: No se pudo inicializar el monitor de plazos\n");
+        return -1;
+    }
+    printf("Monitor de plazos inicializado\n");
+    boot_mark(BOOT_PHASE_SERVICES);
+    
+#if FAST_BOOT
+    console_set_connect_hook(print_banner);
+#endif
     
     /**
      * Crear tareas de FreeRTOS
      * 
      * Cada módulo funcional del sistema se ejecuta como una tarea independiente,
-     * permitiendo procesamiento concurrente y comunicación através de colas.
+     * permitiendo procesamiento concurrente y comunicación a través del bus de eventos.
      */
     
-    // Tarea del teclado matricial (prioridad alta)
-    if (xTaskCreate(keypad_task, "Keypad", 512, NULL, 
-                    4, NULL) != pdPASS) {
+    // Tarea del teclado matricial (prioridad más alta)
+    if (!RTOS_TASK_CREATE(keypad_task, keypad_task, "Keypad", KEYPAD_TASK_STACK, NULL, KEYPAD_TASK_PRIORITY)) {
         printf("ERROR: No se pudo crear la tarea del teclado\n");
         return -1;
     }
     printf("Tarea del teclado creada\n");
     
-    // Tarea de LEDs (prioridad media)
-    if (xTaskCreate(led_task, "LEDs", 256, NULL, 
-                    3, NULL) != pdPASS) {
-        printf("ERROR: No se pudo crear la tarea de LEDs\n");
+    // Ejecutor de las corrutinas de LEDs y display (prioridad media)
+    if (!RTOS_TASK_CREATE(executor_task, executor_task, "Exec", EXECUTOR_TASK_STACK, NULL, EXECUTOR_TASK_PRIORITY)) {
+        printf("ERROR: No se pudo crear la tarea del ejecutor\n");
         return -1;
     }
-    printf("Tarea de LEDs creada\n");
+    printf("Tarea del ejecutor creada\n");
     
-    // Tarea del display (prioridad media)
-    if (xTaskCreate(display_task, "Display", 1024, NULL, 
-                    3, NULL) != pdPASS) {
-        printf("ERROR: No se pudo crear la tarea del display\n");
+    // Gestor del bus I2C (misma prioridad que el ejecutor, donde corre el display, su principal cliente)
+    if (!RTOS_TASK_CREATE(i2c_bus_task, i2c_bus_task, "I2C", I2C_BUS_TASK_STACK, NULL, I2C_BUS_TASK_PRIORITY)) {
+        printf("ERROR: No se pudo crear la tarea del gestor I2C\n");
         return -1;
     }
-    printf("Tarea del display creada\n");
+    printf("Tarea del gestor I2C creada\n");
     
-    // Tarea de control de acceso (prioridad más alta)
-    if (xTaskCreate(access_control_task, "AccessControl", 512, NULL, 
-                    5, NULL) != pdPASS) {
+    // Tarea de control de acceso (prioridad alta)
+    if (!RTOS_TASK_CREATE(access_control_task, access_control_task, "AccessControl", ACCESS_CONTROL_TASK_STACK, NULL, ACCESS_CONTROL_TASK_PRIORITY)) {
         printf("ERROR: No se pudo crear la tarea de control de acceso\n");
         return -1;
     }
     printf("Tarea de control de acceso creada\n");
     
+    // Tarea de consola USB (prioridad baja)
+    if (!RTOS_TASK_CREATE(console_task, console_task, "Console", CONSOLE_TASK_STACK, NULL, CONSOLE_TASK_PRIORITY)) {
+        printf("ERROR: No se pudo crear la tarea de consola\n");
+        return -1;
+    }
+    printf("Tarea de consola creada\n");
+    
+    // Tarea de log diferido (prioridad mínima: solo usa tiempo libre)
+    if (!RTOS_TASK_CREATE(log_task, log_task, "Log", LOG_TASK_STACK, NULL, LOG_TASK_PRIORITY)) {
+        printf("ERROR: No se pudo crear la tarea de log\n");
+        return -1;
+    }
+    printf("Tarea de log creada\n");
+    
+    // Monitor de plazos (sobre consola y log: un bloqueo de ellas no
+    // debe impedir alimentar el watchdog)
+    if (!RTOS_TASK_CREATE(task_health_task, task_health_task, "Health", HEALTH_TASK_STACK, NULL, HEALTH_TASK_PRIORITY)) {
+        printf("ERROR: No se pudo crear la tarea del monitor de plazos\n");
+        return -1;
+    }
+    printf("Tarea del monitor de plazos creada\n");
+    
+    // Estadísticas de acceso (prioridad mínima: fuera del camino del acceso)
+    if (!RTOS_TASK_CREATE(access_report_task, access_report_task, "Stats", STATS_TASK_STACK, NULL, STATS_TASK_PRIORITY)) {
+        printf("ERROR: No se pudo crear la tarea de estadísticas\n");
+        return -1;
+    }
+    printf("Tarea de estadísticas creada\n");
+    
     printf("\nTodas las tareas creadas exitosamente\n");
     printf("Iniciando FreeRTOS scheduler...\n\n");
     
@@ -166,6 +356,7 @@ int main() {
      * 
      * Esta función nunca retorna en operación normal.
      */
+    boot_mark(BOOT_PHASE_SCHEDULER);
     vTaskStartScheduler();
     
     /**
@@ -189,6 +380,22 @@ int main() {
     return -1; // Nunca se alcanza en operación normal
 }
 
+#if configSUPPORT_STATIC_ALLOCATION
+/**
+ * @brief Entrega al kernel la memoria estática de la tarea idle
+ */
+void vApplicationGetIdleTaskMemory(StaticTask_t **ppxIdleTaskTCBBuffer,
+                                   StackType_t **ppxIdleTaskStackBuffer,
+                                   configSTACK_DEPTH_TYPE *puxIdleTaskStackSize) {
+    static StaticTask_t idle_task_tcb;
+    static StackType_t idle_task_stack[configMINIMAL_STACK_SIZE];
+    
+    *ppxIdleTaskTCBBuffer = &idle_task_tcb;
+    *ppxIdleTaskStackBuffer = idle_task_stack;
+    *puxIdleTaskStackSize = configMINIMAL_STACK_SIZE;
+}
+#endif
+
 /**
  * @brief Hook llamado cuando se agota la memoria del heap
  * 
@@ -235,13 +442,16 @@ void vApplicationStackOverflowHook(TaskHandle_t pxTask, char *pcTaskName) {
  * @brief Hook de la tarea idle de FreeRTOS
  * 
  * Esta función es llamada cada vez que no hay tareas listas para ejecutar.
- * Implementa eficiencia energética inteligente basada en el estado del teclado.
+ * Con idle sin tick (low_power.c) el kernel ya duerme hasta el próximo plazo;
+ * el WFI de este hook solo se usa si el tick periódico está habilitado.
  */
 void vApplicationIdleHook(void) {
+#if configUSE_TICKLESS_IDLE == 0
     // Usar __wfi() solo cuando el teclado está en estado IDLE
     if (keypad_is_idle()) {
         __wfi(); // Wait For Interrupt - optimización energética
     }
     // Si el teclado está procesando, mantener CPU activo
+#endif
 }
     
\ No newline at end of file
@@ -0,0 +1,95 @@
+/**
+ * @file merkle_sync.c
+ * @brief Implementación del árbol de Merkle de la sincronización incremental
+ * @author Sistema de Control de Acceso
+ * @date 2025
+ */
+
+#include "merkle_sync.h"
+#include <string.h>
+
+_Static_assert((MS_LEAVES & (MS_LEAVES - 1)) == 0, "MS_LEAVES debe ser potencia de 2");
+_Static_assert(MS_LEAVES <= MS_KEY_SPACE, "más cubetas que IDs");
+
+#define MS_GOLDEN               0x9E3779B97F4A7C15ull
+
+/**
+ * @brief Mezclador de 64 bits de splitmix64
+ */
+static uint64_t mix64(uint64_t x) {
+    x ^= x >> 30;
+    x *= 0xBF58476D1CE4E5B9ull;
+    x ^= x >> 27;
+    x *= 0x94D049BB133111EBull;
+    x ^= x >> 31;
+    return x;
+}
+
+uint64_t ms_entry_hash(uint32_t key, uint32_t record) {
+    return mix64((((uint64_t)key << 32) | record) + MS_GOLDEN);
+}
+
+/**
+ * @brief Combina dos hijos; el orden importa
+ */
+static uint64_t combine(uint64_t left, uint64_t right) {
+    return mix64(left ^ mix64(right + MS_GOLDEN));
+}
+
+void ms_clear(ms_tree_t *t) {
+    memset(t, 0, sizeof(*t));
+    ms_rebuild(t);
+}
+
+void ms_leaf_add(ms_tree_t *t, uint32_t key, uint32_t record) {
+    t->node[MS_LEAVES + ms_bucket(key)] += ms_entry_hash(key, record);
+}
+
+void ms_rebuild(ms_tree_t *t) {
+    for (uint32_t n = MS_LEAVES - 1; n >= MS_ROOT; n--) {
+        t->node[n] = combine(t->node[2 * n], t->node[2 * n + 1]);
+    }
+}
+
+void ms_update(ms_tree_t *t, uint32_t key, const uint32_t *old_record,
+               const uint32_t *new_record) {
+    uint32_t n = MS_LEAVES + ms_bucket(key);
+
+    if (old_record != NULL) {
+        t->node[n] -= ms_entry_hash(key, *old_record);
+    }
+    if (new_record != NULL) {
+        t->node[n] += ms_entry_hash(key, *new_record);
+    }
+    for (n /= 2; n >= MS_ROOT; n /= 2) {
+        t->node[n] = combine(t->node[2 * n], t->node[2 * n + 1]);
+    }
+}
+
+uint64_t ms_hash(const ms_tree_t *t, uint32_t node) {
+    return (node >= MS_ROOT && node < MS_NODES) ? t->node[node] : 0;
+}
+
+uint32_t ms_bucket(uint32_t key) {
+    if (key >= MS_KEY_SPACE) {
+        return MS_LEAVES - 1;
+    }
+    return (uint32_t)((uint64_t)key * MS_LEAVES / MS_KEY_SPACE);
+}
+
+void ms_bucket_range(uint32_t bucket, uint32_t *from, uint32_t *to) {
+    // Primera clave k con k * MS_LEAVES / MS_KEY_SPACE >= bucket
+    *from = (uint32_t)(((uint64_t)bucket * MS_KEY_SPACE + MS_LEAVES - 1) / MS_LEAVES);
+    if (bucket + 1 >= MS_LEAVES) {
+        *to = UINT32_MAX;
+    } else {
+        *to = (uint32_t)(((uint64_t)(bucket + 1) * MS_KEY_SPACE + MS_LEAVES - 1) / MS_LEAVES) - 1;
+    }
+}
+
+void ms_split_range(uint32_t from, uint32_t to, uint32_t parts, uint32_t part,
+                    uint32_t *part_from, uint32_t *part_to) {
+    uint64_t span = (uint64_t)to - from + 1;
+    *part_from = (uint32_t)(from + span * part / parts);
+    *part_to = (uint32_t)(from + span * (part + 1) / parts - 1);
+}
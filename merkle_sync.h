@@ -0,0 +1,117 @@
+/**
+ * @file merkle_sync.h
+ * @brief Árbol de Merkle sobre la base de usuarios para la sincronización incremental
+ * @author Sistema de Control de Acceso
+ * @date 2025
+ *
+ * El espacio de IDs (000000-999999) se divide en MS_LEAVES cubetas de
+ * rango fijo. Cada hoja guarda la suma de los hashes de sus registros
+ * {ID, registro de 32 bits}: la suma no depende del orden, así que un
+ * alta, una baja o un cambio actualiza la hoja restando el hash viejo y
+ * sumando el nuevo, y luego solo los log2(MS_LEAVES) ancestros. Los nodos
+ * internos combinan a sus dos hijos en orden.
+ *
+ * Las cubetas dependen solo del ID y no de cómo está guardada la base (el
+ * arreglo en RAM o las páginas del índice en flash), por lo que el
+ * dispositivo y la herramienta del host calculan el mismo árbol con este
+ * mismo módulo y comparan nodos para encontrar las cubetas que difieren.
+ * Los hashes detectan diferencias accidentales; no son criptográficos.
+ *
+ * Debajo de las hojas no hay más nodos guardados: la suma de cualquier
+ * rango de IDs se calcula recorriéndolo (ms_entry_hash), lo que permite
+ * dividir una cubeta distinta en partes sin gastar RAM.
+ *
+ * Los nodos se numeran como un heap: la raíz es MS_ROOT, los hijos de n
+ * son 2n y 2n+1 y la hoja de la cubeta b es MS_LEAVES + b. El módulo no
+ * depende del SDK ni de FreeRTOS.
+ */
+
+#ifndef MERKLE_SYNC_H
+#define MERKLE_SYNC_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/** @brief Cantidad de IDs distintos (6 dígitos) */
+#define MS_KEY_SPACE            1000000u
+
+/** @brief Cubetas (potencia de 2); el árbol ocupa 16 bytes por cubeta */
+#ifndef MS_LEAVES
+#define MS_LEAVES               512u
+#endif
+
+/** @brief Nodos del heap (el 0 no se usa) */
+#define MS_NODES                (2u * MS_LEAVES)
+
+/** @brief Nodo raíz */
+#define MS_ROOT                 1u
+
+/**
+ * @brief Árbol de hashes
+ */
+typedef struct {
+    uint64_t node[MS_NODES];
+} ms_tree_t;
+
+/**
+ * @brief Deja el árbol de una base vacía
+ */
+void ms_clear(ms_tree_t *t);
+
+/**
+ * @brief Suma un registro a su hoja sin recalcular los ancestros
+ *
+ * Para cargar muchos registros seguidos; terminar con ms_rebuild().
+ */
+void ms_leaf_add(ms_tree_t *t, uint32_t key, uint32_t record);
+
+/**
+ * @brief Recalcula todos los nodos internos a partir de las hojas
+ */
+void ms_rebuild(ms_tree_t *t);
+
+/**
+ * @brief Refleja un alta, baja o cambio de un registro
+ *
+ * @param old_record Registro anterior o NULL si la clave no existía
+ * @param new_record Registro nuevo o NULL si la clave se eliminó
+ */
+void ms_update(ms_tree_t *t, uint32_t key, const uint32_t *old_record,
+               const uint32_t *new_record);
+
+/**
+ * @brief Hash de un nodo (0 fuera de rango)
+ */
+uint64_t ms_hash(const ms_tree_t *t, uint32_t node);
+
+/**
+ * @brief Hash de un registro; el de un conjunto es la suma (módulo 2^64)
+ */
+uint64_t ms_entry_hash(uint32_t key, uint32_t record);
+
+/**
+ * @brief Cubeta de una clave
+ */
+uint32_t ms_bucket(uint32_t key);
+
+/**
+ * @brief Rango de claves [from, to] de una cubeta
+ */
+void ms_bucket_range(uint32_t bucket, uint32_t *from, uint32_t *to);
+
+/**
+ * @brief Parte part de las parts en que se divide [from, to]
+ *
+ * parts no debe superar la cantidad de IDs del rango.
+ */
+void ms_split_range(uint32_t from, uint32_t to, uint32_t parts, uint32_t part,
+                    uint32_t *part_from, uint32_t *part_to);
+
+/**
+ * @brief true si el nodo es una hoja
+ */
+static inline bool ms_is_leaf(uint32_t node) {
+    return node >= MS_LEAVES;
+}
+
+#endif // MERKLE_SYNC_H
@@ -0,0 +1,148 @@
+/**
+ * @file rate_limiter.c
+ * @brief Implementación del limitador de intentos de autenticación
+ * @author Sistema de Control de Acceso
+ * @date 2025
+ */
+
+#include "rate_limiter.h"
+#include <string.h>
+
+_Static_assert((RL_ID_SLOTS & (RL_ID_SLOTS - 1)) == 0, "RL_ID_SLOTS debe ser potencia de 2");
+
+/** @brief Capacidad del bucket global en unidades de ms de recarga */
+#define RL_GLOBAL_FULL ((uint32_t)RL_GLOBAL_CAPACITY * RL_GLOBAL_REFILL_MS)
+
+/**
+ * @brief true si el instante t ya fue alcanzado en now (tolerante a desborde)
+ */
+static inline bool time_reached(uint32_t now, uint32_t t) {
+    return (int32_t)(now - t) >= 0;
+}
+
+/**
+ * @brief Hash FNV-1a del ID (nunca 0, que marca una entrada libre)
+ */
+static uint32_t id_hash(const char *id) {
+    uint32_t h = 2166136261u;
+    while (*id) {
+        h ^= (uint8_t)*id++;
+        h *= 16777619u;
+    }
+    return h ? h : 1;
+}
+
+/**
+ * @brief Recarga el bucket global según el tiempo transcurrido
+ *
+ * Los tokens se guardan multiplicados por RL_GLOBAL_REFILL_MS, así la
+ * recarga es una suma sin divisiones ni restos acumulados.
+ */
+static void global_refill(rate_limiter_t *rl, uint32_t now_ms) {
+    uint32_t elapsed = now_ms - rl->last_refill_ms;
+    rl->last_refill_ms = now_ms;
+
+    if (elapsed >= RL_GLOBAL_FULL - rl->tokens_x_refill) {
+        rl->tokens_x_refill = RL_GLOBAL_FULL;
+    } else {
+        rl->tokens_x_refill += elapsed;
+    }
+}
+
+/**
+ * @brief Inicializa el limitador con el bucket global lleno
+ */
+void rate_limiter_init(rate_limiter_t *rl, uint32_t now_ms) {
+    memset(rl, 0, sizeof(*rl));
+    rl->tokens_x_refill = RL_GLOBAL_FULL;
+    rl->last_refill_ms = now_ms;
+}
+
+/**
+ * @brief Decide si se admite un intento para un ID
+ */
+rl_decision_t rate_limiter_check(rate_limiter_t *rl, const char *id,
+                                 uint32_t now_ms, uint32_t *wait_ms) {
+    uint32_t tag = id_hash(id);
+    const rl_slot_t *slot = &rl->slots[tag & (RL_ID_SLOTS - 1)];
+    bool tracked = (slot->tag == tag);
+
+    global_refill(rl, now_ms);
+
+    if (tracked && !time_reached(now_ms, slot->next_allowed_ms)) {
+        if (wait_ms != NULL) {
+            *wait_ms = slot->next_allowed_ms - now_ms;
+        }
+        rl->stats.denied_id++;
+        return RL_DENY_ID;
+    }
+
+    if (!(tracked && slot->trusted) && rl->tokens_x_refill < RL_GLOBAL_REFILL_MS) {
+        if (wait_ms != NULL) {
+            *wait_ms = RL_GLOBAL_REFILL_MS - rl->tokens_x_refill;
+        }
+        rl->stats.denied_global++;
+        return RL_DENY_GLOBAL;
+    }
+
+    rl->stats.allowed++;
+    return RL_ALLOW;
+}
+
+/**
+ * @brief Informa el resultado de un intento admitido
+ */
+void rate_limiter_report(rate_limiter_t *rl, const char *id,
+                         bool success, uint32_t now_ms) {
+    uint32_t tag = id_hash(id);
+    rl_slot_t *slot = &rl->slots[tag & (RL_ID_SLOTS - 1)];
+
+    if (success) {
+        // Un éxito siempre toma la entrada: los usuarios reales quedan
+        // protegidos del bucket global aunque un atacante la haya ocupado
+        slot->tag = tag;
+        slot->fails = 0;
+        slot->next_allowed_ms = now_ms;
+        slot->trusted = true;
+        return;
+    }
+
+    rl->stats.failures++;
+    global_refill(rl, now_ms);
+    if (rl->tokens_x_refill >= RL_GLOBAL_REFILL_MS) {
+        rl->tokens_x_refill -= RL_GLOBAL_REFILL_MS;
+    } else {
+        rl->tokens_x_refill = 0;
+    }
+
+    if (slot->tag != tag) {
+        // Las fallas de otro ID no desalojan a un usuario confiable; ese ID
+        // queda limitado solo por el bucket global
+        if (slot->tag != 0 && slot->trusted) {
+            return;
+        }
+        slot->tag = tag;
+        slot->fails = 0;
+        slot->trusted = false;
+    }
+
+    if (slot->fails < UINT8_MAX) {
+        slot->fails++;
+    }
+
+    if (slot->fails <= RL_BACKOFF_FREE_FAILS) {
+        slot->next_allowed_ms = now_ms;
+        return;
+    }
+
+    // Espera = base * 2^(fallas penalizadas - 1), con tope
+    uint32_t wait = RL_BACKOFF_BASE_MS;
+    for (uint32_t n = slot->fails - RL_BACKOFF_FREE_FAILS - 1;
+         n > 0 && wait < RL_BACKOFF_MAX_MS; n--) {
+        wait <<= 1;
+    }
+    if (wait > RL_BACKOFF_MAX_MS) {
+        wait = RL_BACKOFF_MAX_MS;
+    }
+    slot->next_allowed_ms = now_ms + wait;
+}
@@ -0,0 +1,116 @@
+/**
+ * @file rate_limiter.h
+ * @brief Limitación de intentos de autenticación contra fuerza bruta
+ * @author Sistema de Control de Acceso
+ * @date 2025
+ *
+ * Combina dos mecanismos de costo y memoria constantes:
+ *
+ * - Un token bucket global que se consume con cada intento fallido. Cuando
+ *   se vacía, los IDs sin un ingreso exitoso reciente deben esperar al
+ *   siguiente token, lo que acota la tasa total de intentos de un atacante
+ *   que prueba IDs al azar.
+ * - Una tabla de RL_ID_SLOTS entradas indexada por hash del ID (mapeo
+ *   directo, sin búsqueda) con backoff exponencial por ID. Un éxito
+ *   reinicia el backoff y marca el ID como confiable: los IDs confiables no
+ *   dependen del bucket global, por lo que los usuarios reales siguen
+ *   entrando durante un ataque. Las fallas de otros IDs no desalojan
+ *   entradas confiables.
+ *
+ * El módulo no depende de FreeRTOS ni del SDK; el llamador entrega el
+ * tiempo en milisegundos.
+ */
+
+#ifndef RATE_LIMITER_H
+#define RATE_LIMITER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/** @brief Intentos fallidos que se admiten en ráfaga */
+#define RL_GLOBAL_CAPACITY      10
+
+/** @brief Milisegundos para recuperar un token global (120 fallas por hora) */
+#define RL_GLOBAL_REFILL_MS     30000
+
+/** @brief Entradas de la tabla por ID (potencia de 2) */
+#define RL_ID_SLOTS             32
+
+/** @brief Fallas consecutivas de un ID admitidas sin espera */
+#define RL_BACKOFF_FREE_FAILS   1
+
+/** @brief Espera tras la primera falla penalizada; se duplica en cada falla */
+#define RL_BACKOFF_BASE_MS      2000
+
+/** @brief Espera máxima por ID */
+#define RL_BACKOFF_MAX_MS       300000
+
+/**
+ * @brief Resultado de la verificación previa a un intento
+ */
+typedef enum {
+    RL_ALLOW,           /**< El intento puede procesarse */
+    RL_DENY_ID,         /**< ID en backoff exponencial */
+    RL_DENY_GLOBAL      /**< Bucket global vacío y el ID no es confiable */
+} rl_decision_t;
+
+/**
+ * @brief Estado por ID
+ */
+typedef struct {
+    uint32_t tag;               /**< Hash completo del ID (0 = libre) */
+    uint32_t next_allowed_ms;   /**< Instante desde el que se admite otro intento */
+    uint8_t fails;              /**< Fallas consecutivas */
+    bool trusted;               /**< Tuvo un ingreso exitoso */
+} rl_slot_t;
+
+/**
+ * @brief Contadores del limitador
+ */
+typedef struct {
+    uint32_t allowed;           /**< Intentos admitidos */
+    uint32_t denied_id;         /**< Rechazados por backoff del ID */
+    uint32_t denied_global;     /**< Rechazados por el bucket global */
+    uint32_t failures;          /**< Intentos fallidos reportados */
+} rl_stats_t;
+
+/**
+ * @brief Estado completo del limitador
+ */
+typedef struct {
+    uint32_t tokens_x_refill;   /**< Tokens globales en unidades de ms de recarga */
+    uint32_t last_refill_ms;    /**< Último instante de recarga */
+    rl_slot_t slots[RL_ID_SLOTS];
+    rl_stats_t stats;
+} rate_limiter_t;
+
+/**
+ * @brief Inicializa el limitador con el bucket global lleno
+ */
+void rate_limiter_init(rate_limiter_t *rl, uint32_t now_ms);
+
+/**
+ * @brief Decide si se admite un intento para un ID
+ *
+ * @param rl Limitador
+ * @param id ID ingresado (cadena de dígitos)
+ * @param now_ms Tiempo actual en milisegundos
+ * @param wait_ms Si no es NULL y el intento se rechaza, recibe los
+ *                milisegundos hasta que volvería a admitirse
+ * @return rl_decision_t Decisión
+ */
+rl_decision_t rate_limiter_check(rate_limiter_t *rl, const char *id,
+                                 uint32_t now_ms, uint32_t *wait_ms);
+
+/**
+ * @brief Informa el resultado de un intento admitido
+ *
+ * @param rl Limitador
+ * @param id ID del intento
+ * @param success true si la autenticación fue exitosa
+ * @param now_ms Tiempo actual en milisegundos
+ */
+void rate_limiter_report(rate_limiter_t *rl, const char *id,
+                         bool success, uint32_t now_ms);
+
+#endif // RATE_LIMITER_H
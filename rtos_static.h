@@ -0,0 +1,91 @@
+/**
+ * @file rtos_static.h
+ * @brief Creación de tareas y colas con memoria estática o dinámica
+ * @author Sistema de Control de Acceso
+ * @date 2025
+ *
+ * Con RTOS_STATIC_ALLOCATION = 1 cada módulo reserva en .bss el bloque de
+ * control, la pila o el almacenamiento de sus objetos del kernel, y el heap
+ * de FreeRTOS desaparece. Con RTOS_STATIC_ALLOCATION = 0 las mismas macros se
+ * reducen a las llamadas xTaskCreate/xQueueCreate habituales.
+ *
+ * Uso: RTOS_xxx_DEFINE(nombre, ...) a nivel de archivo y
+ * RTOS_xxx_CREATE(nombre, ...) donde antes se creaba el objeto.
+ */
+
+#ifndef RTOS_STATIC_H
+#define RTOS_STATIC_H
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+#include "semphr.h"
+
+#if configSUPPORT_STATIC_ALLOCATION
+
+#define RTOS_TASK_DEFINE(name, stack_words)                                   \
+    static StaticTask_t name##_tcb;                                           \
+    static StackType_t name##_stack[(stack_words)]
+
+/** @brief Crea la tarea; evalúa a true si se creó */
+#define RTOS_TASK_CREATE(name, fn, task_name, stack_words, param, prio)       \
+    (xTaskCreateStatic((fn), (task_name), (stack_words), (param), (prio),     \
+                       name##_stack, &name##_tcb) != NULL)
+
+#define RTOS_QUEUE_DEFINE(name, length, item_size)                            \
+    static StaticQueue_t name##_qcb;                                          \
+    static uint8_t name##_storage[(length) * (item_size)]
+
+#define RTOS_QUEUE_CREATE(name, length, item_size)                            \
+    xQueueCreateStatic((length), (item_size), name##_storage, &name##_qcb)
+
+#define RTOS_QUEUE_SET_DEFINE(name, length)                                   \
+    RTOS_QUEUE_DEFINE(name, (length), sizeof(QueueSetMemberHandle_t))
+
+#define RTOS_QUEUE_SET_CREATE(name, length)                                   \
+    xQueueGenericCreateStatic((length), sizeof(QueueSetMemberHandle_t),       \
+                              name##_storage, &name##_qcb, queueQUEUE_TYPE_SET)
+
+#define RTOS_BINARY_SEMAPHORE_DEFINE(name)                                    \
+    static StaticSemaphore_t name##_scb
+
+#define RTOS_BINARY_SEMAPHORE_CREATE(name)                                    \
+    xSemaphoreCreateBinaryStatic(&name##_scb)
+
+#define RTOS_BINARY_SEMAPHORE_ARRAY_DEFINE(name, count)                       \
+    static StaticSemaphore_t name##_scb[(count)]
+
+#define RTOS_BINARY_SEMAPHORE_ARRAY_CREATE(name, index)                       \
+    xSemaphoreCreateBinaryStatic(&name##_scb[(index)])
+
+#define RTOS_MUTEX_DEFINE(name)                                               \
+    static StaticSemaphore_t name##_scb
+
+#define RTOS_MUTEX_CREATE(name)                                               \
+    xSemaphoreCreateMutexStatic(&name##_scb)
+
+#else
+
+/* Sin memoria estática: las declaraciones no reservan nada */
+#define RTOS_TASK_DEFINE(name, stack_words)         struct rtos_static_unused_##name
+#define RTOS_TASK_CREATE(name, fn, task_name, stack_words, param, prio)       \
+    (xTaskCreate((fn), (task_name), (stack_words), (param), (prio), NULL) == pdPASS)
+
+#define RTOS_QUEUE_DEFINE(name, length, item_size)  struct rtos_static_unused_##name
+#define RTOS_QUEUE_CREATE(name, length, item_size)  xQueueCreate((length), (item_size))
+
+#define RTOS_QUEUE_SET_DEFINE(name, length)         struct rtos_static_unused_##name
+#define RTOS_QUEUE_SET_CREATE(name, length)         xQueueCreateSet((length))
+
+#define RTOS_BINARY_SEMAPHORE_DEFINE(name)          struct rtos_static_unused_##name
+#define RTOS_BINARY_SEMAPHORE_CREATE(name)          xSemaphoreCreateBinary()
+
+#define RTOS_BINARY_SEMAPHORE_ARRAY_DEFINE(name, count) struct rtos_static_unused_##name
+#define RTOS_BINARY_SEMAPHORE_ARRAY_CREATE(name, index) xSemaphoreCreateBinary()
+
+#define RTOS_MUTEX_DEFINE(name)                     struct rtos_static_unused_##name
+#define RTOS_MUTEX_CREATE(name)                     xSemaphoreCreateMutex()
+
+#endif
+
+#endif // RTOS_STATIC_H
@@ -10,24 +10,24 @@
 
 #include "ssd1306_display.h"
 #include "ssd1306_font.h"
+#include "ssd1306_frames.h"
 #include <stdio.h>
 #include <string.h>
-#include <stdlib.h>
-#include <ctype.h>
 #include "pico/stdlib.h"
 #include "pico/binary_info.h"
-#include "hardware/i2c.h"
-#include "hardware/rtc.h"
-#include "pico/util/datetime.h"
+#include "time_service.h"
 #include "FreeRTOS.h"
 #include "task.h"
-#include "queue.h"
+#include "system_bus.h"
+#include "boot_profile.h"
+#include "task_health.h"
+#include "i2c_bus.h"
+#include "executor.h"
 
 /* Configuración del display */
 #define SSD1306_HEIGHT              32
 #define SSD1306_WIDTH               128
 #define SSD1306_I2C_ADDR            0x3C
-#define SSD1306_I2C_CLK             400
 
 /* Comandos del SSD1306 */
 #define SSD1306_SET_MEM_MODE        0x20
@@ -49,90 +49,131 @@
 #define SSD1306_SET_COM_PIN_CFG     0xDA
 #define SSD1306_SET_VCOM_DESEL      0xDB
 #define SSD1306_SET_SCROLL          0x2E
+#define SSD1306_SET_HORIZ_SCROLL    0x26
+
+/* Desplazamiento horizontal por hardware (marquesina) */
+#define SSD1306_SCROLL_INTERVAL     0x04    /**< Código de intervalo 100b: un paso cada 3 cuadros */
+#define SSD1306_SCROLL_FRAMES       3
+/** @brief Frecuencia de cuadro nominal con la configuración de ssd1306_hw_init:
+ *  Fosc ≈ 370 kHz / (1 × (1 + 15 + 50) × 32 líneas) */
+#define SSD1306_FRAME_HZ            175
 
 #define SSD1306_PAGE_HEIGHT         8
 #define SSD1306_NUM_PAGES           (SSD1306_HEIGHT / SSD1306_PAGE_HEIGHT)
 #define SSD1306_BUF_LEN             (SSD1306_NUM_PAGES * SSD1306_WIDTH)
 
+/* Mensajes personalizados: una línea desde la columna 8 */
+#define SSD1306_CUSTOM_X            8
+#define SSD1306_CUSTOM_PAGE         1
+#define SSD1306_CUSTOM_MAX_CHARS    ((SSD1306_WIDTH - SSD1306_CUSTOM_X) / 8)
+
+/** @brief Espacios entre el final del mensaje y la vuelta siguiente de la marquesina */
+#define SSD1306_MARQUEE_GAP         3
+
+_Static_assert(DISPLAY_MARQUEE_REFILL_MS ==
+               DISPLAY_MARQUEE_REFILL_PX * SSD1306_SCROLL_FRAMES * 1000 / SSD1306_FRAME_HZ,
+               "DISPLAY_MARQUEE_REFILL_MS no corresponde al intervalo de desplazamiento");
+
+/* Bytes de control: Co = 0 y D/C# elige si lo que sigue son comandos o datos */
+static const uint8_t ssd1306_ctrl_cmd = 0x00;
+static const uint8_t ssd1306_ctrl_data = 0x40;
+
 /* Variables globales */
+/* El framebuffer se envía tal cual como segmento de la transacción I2C,
+ * detrás del byte de control, sin copias adicionales */
 static uint8_t display_buffer[SSD1306_BUF_LEN];
-static QueueHandle_t display_queue;
+static int display_sub = -1;
+static int display_i2c = -1;
+static display_stats_t display_stats;
 
-/**
- * @brief Obtiene la fecha y hora actual formateada
- * 
- * @param date_str Buffer para almacenar la fecha (DD/MM/YY)
- * @param time_str Buffer para almacenar la hora (HH:MM:SS)
- */
-static void get_current_datetime(char* date_str, char* time_str) {
-    // Usar tiempo simulado basado en ticks de FreeRTOS
-    uint32_t ticks = xTaskGetTickCount();
-    uint32_t seconds = (ticks / 1000) % 86400; // Segundos en el día
-    
-    uint32_t hours = seconds / 3600;
-    uint32_t minutes = (seconds % 3600) / 60;
-    uint32_t secs = seconds % 60;
-    
-    // Fecha simulada (27 de Julio de 2025)
-    strcpy(date_str, "27/07/25");
-    
-    // Hora basada en ticks del sistema
-    snprintf(time_str, 12, "%02lu:%02lu:%02lu", hours, minutes, secs);
-}
+/** @brief Corrutina del display en el ejecutor */
+static co_t display_co;
 
 /**
- * @brief Envía un comando al display SSD1306
+ * @brief Estado de display_run que cruza las esperas
+ *
+ * La corrutina no tiene pila propia: lo que antes eran variables locales de
+ * la tarea vive aquí.
  */
-static void ssd1306_send_cmd(uint8_t cmd) {
-    uint8_t buf[2] = {0x80, cmd};
-    i2c_write_blocking(i2c_default, SSD1306_I2C_ADDR, buf, 2, false);
-}
+static struct {
+    TickType_t next_datetime_update;
+    TickType_t standby_deadline;
+    TickType_t next_frame_time;
+    TickType_t marquee_deadline;
+    TickType_t wake_time;       /**< Plazo de la espera en curso */
+    bool in_standby_mode;
+    bool timed_message_active;
+    const eb_msg_t *msg;        /**< Comando a dibujar en el próximo cuadro */
+} dsp;
+
+static void display_run(co_t *co);
 
 /**
- * @brief Envía una lista de comandos al display
+ * @brief Marquesina de un mensaje personalizado que no entra en una línea
+ *
+ * El controlador rota por sí mismo la página del mensaje una columna por
+ * paso. Las primeras DISPLAY_MARQUEE_REFILL_PX columnas de la página quedan
+ * en blanco: mientras rotan hacia el borde derecho no muestran texto viejo,
+ * y al recargar la página con el mensaje avanzado esa misma cantidad el
+ * texto del centro sigue en su lugar.
  */
-static void ssd1306_send_cmd_list(uint8_t *buf, int num) {
-    for (int i = 0; i < num; i++) {
-        ssd1306_send_cmd(buf[i]);
-    }
-}
+static struct {
+    bool active;                /**< Desplazamiento por hardware en marcha */
+    char text[sizeof(((display_command_t *)0)->custom_message)];
+    uint8_t len;
+    uint16_t period_px;         /**< Columnas de una vuelta: mensaje + separación */
+    uint16_t pos;               /**< Columna del mensaje que sigue al margen en blanco */
+} marquee;
+
+_Static_assert(sizeof(display_command_t) <= EB_PAYLOAD_SIZE, "display_command_t no cabe en una ranura del bus");
 
 /**
- * @brief Envía el buffer de datos al display
+ * @brief Envía una lista de comandos al display en una sola transacción I2C
+ *
+ * Con el byte de control 0x00 (Co = 0, D/C# = 0) todos los bytes que siguen
+ * se interpretan como comandos.
  */
-static void ssd1306_send_buf(uint8_t buf[], int buflen) {
-    uint8_t *temp_buf = malloc(buflen + 1);
-    temp_buf[0] = 0x40;
-    memcpy(temp_buf + 1, buf, buflen);
-    i2c_write_blocking(i2c_default, SSD1306_I2C_ADDR, temp_buf, buflen + 1, false);
-    free(temp_buf);
+static void ssd1306_send_cmd_list(const uint8_t *buf, int num) {
+    iq_txn_t txn = {
+        .client = (uint8_t)display_i2c, .addr = SSD1306_I2C_ADDR, .priority = IQ_PRIO_LOW,
+        .seg_count = 2, .seg = { { &ssd1306_ctrl_cmd, 1 }, { buf, (uint16_t)num } },
+    };
+    i2c_bus_transfer(&txn);
 }
 
 /**
- * @brief Renderiza el buffer completo en el display
+ * @brief Envía al display un rango de páginas del buffer
+ *
+ * La ventana de columnas y páginas se fija primero; los datos siguen en
+ * partes de IQ_CHUNK_BYTES que repiten el byte de control 0x40 y el
+ * controlador continúa donde quedó, así que las transacciones urgentes de
+ * otros clientes pueden pasar entre partes. El ejecutor duerme mientras
+ * el gestor del bus transmite.
  */
-static void ssd1306_render(void) {
+static void ssd1306_render_pages(uint8_t first_page, uint8_t last_page) {
     uint8_t cmds[] = {
         SSD1306_SET_COL_ADDR, 0, SSD1306_WIDTH - 1,
-        SSD1306_SET_PAGE_ADDR, 0, SSD1306_NUM_PAGES - 1
+        SSD1306_SET_PAGE_ADDR, first_page, last_page
+    };
+    iq_txn_t txn = {
+        .client = (uint8_t)display_i2c, .addr = SSD1306_I2C_ADDR, .priority = IQ_PRIO_LOW,
+        .flags = IQ_TXN_SPLIT, .seg_count = 2,
+        .seg = {
+            { &ssd1306_ctrl_data, 1 },
+            { &display_buffer[first_page * SSD1306_WIDTH],
+              (uint16_t)((last_page - first_page + 1) * SSD1306_WIDTH) },
+        },
     };
+    
     ssd1306_send_cmd_list(cmds, sizeof(cmds));
-    ssd1306_send_buf(display_buffer, SSD1306_BUF_LEN);
+    i2c_bus_transfer(&txn);
 }
 
 /**
- * @brief Obtiene el índice de fuente para un carácter
+ * @brief Renderiza el buffer completo en el display
  */
-static inline int get_font_index(uint8_t ch) {
-    if (ch >= 'A' && ch <= 'Z') {
-        return ch - 'A' + 1;
-    } else if (ch >= 'a' && ch <= 'z') {
-        return ch - 'a' + 1;
-    } else if (ch >= '0' && ch <= '9') {
-        return ch - '0' + 27;
-    } else {
-        return 0; // Espacio
-    }
+static void ssd1306_render(void) {
+    ssd1306_render_pages(0, SSD1306_NUM_PAGES - 1);
 }
 
 /**
@@ -143,13 +184,8 @@ static void write_char(int16_t x, int16_t y, uint8_t ch) {
         return;
 
     y = y / 8;
-    ch = toupper(ch);
-    int idx = get_font_index(ch);
-    int fb_idx = y * 128 + x;
-
-    for (int i = 0; i < 8; i++) {
-        display_buffer[fb_idx++] = font[idx * 8 + i];
-    }
+    int idx = (ch < sizeof(font_index)) ? font_index[ch] : 0;
+    memcpy(&display_buffer[y * SSD1306_WIDTH + x], &font[idx * 8], 8);
 }
 
 /**
@@ -165,17 +201,102 @@ static void write_string(int16_t x, int16_t y, const char *str) {
     }
 }
 
+/**
+ * @brief Dibuja la página de la marquesina desde marquee.pos
+ */
+static void marquee_draw(void) {
+    uint8_t *line = &display_buffer[SSD1306_CUSTOM_PAGE * SSD1306_WIDTH];
+    uint16_t px = marquee.pos;
+    
+    memset(line, 0, DISPLAY_MARQUEE_REFILL_PX);
+    for (int x = DISPLAY_MARQUEE_REFILL_PX; x < SSD1306_WIDTH; x++) {
+        uint16_t ch = px / 8;
+        uint8_t c = (ch < marquee.len) ? (uint8_t)marquee.text[ch] : ' ';
+        int idx = (c < sizeof(font_index)) ? font_index[c] : 0;
+        line[x] = font[idx * 8 + px % 8];
+        if (++px == marquee.period_px) {
+            px = 0;
+        }
+    }
+}
+
+/**
+ * @brief Activa o detiene el desplazamiento a la izquierda de la página del mensaje
+ *
+ * Al detenerlo la página queda rotada: hay que volver a escribirla.
+ */
+static void marquee_scroll(bool on) {
+    if (on) {
+        uint8_t cmds[] = {
+            SSD1306_SET_HORIZ_SCROLL | 0x01, 0x00,  // Hacia la izquierda
+            SSD1306_CUSTOM_PAGE, SSD1306_SCROLL_INTERVAL, SSD1306_CUSTOM_PAGE,
+            0x00, 0xFF,
+            SSD1306_SET_SCROLL | 0x01               // Activar
+        };
+        ssd1306_send_cmd_list(cmds, sizeof(cmds));
+    } else {
+        uint8_t cmd = SSD1306_SET_SCROLL | 0x00;
+        ssd1306_send_cmd_list(&cmd, 1);
+    }
+}
+
+/**
+ * @brief Detiene la marquesina antes de redibujar
+ */
+static void marquee_stop(void) {
+    if (marquee.active) {
+        marquee_scroll(false);
+        marquee.active = false;
+    }
+}
+
+/**
+ * @brief Prepara la marquesina de un mensaje largo en el buffer
+ */
+static void marquee_start(const char *message) {
+    size_t len = strlen(message);
+    
+    if (len > sizeof(marquee.text) - 1) {
+        len = sizeof(marquee.text) - 1;
+    }
+    memcpy(marquee.text, message, len);
+    marquee.text[len] = '\0';
+    marquee.len = (uint8_t)len;
+    marquee.period_px = (uint16_t)((len + SSD1306_MARQUEE_GAP) * 8);
+    marquee.pos = 0;
+    marquee.active = true;
+    marquee_draw();
+}
+
 /**
  * @brief Inicializa el display SSD1306 I2C
  */
 bool ssd1306_init(void) {
-    // Configurar I2C
-    i2c_init(i2c_default, SSD1306_I2C_CLK * 1000);
-    gpio_set_function(PICO_DEFAULT_I2C_SDA_PIN, GPIO_FUNC_I2C);
-    gpio_set_function(PICO_DEFAULT_I2C_SCL_PIN, GPIO_FUNC_I2C);
-    gpio_pull_up(PICO_DEFAULT_I2C_SDA_PIN);
-    gpio_pull_up(PICO_DEFAULT_I2C_SCL_PIN);
+    // Suscribirse a los comandos del display; los enviados antes de que la
+    // corrutina configure el hardware esperan en el bus. Buzón "gana el
+    // último": con el anillo lleno se descarta el comando más antiguo
+    int co_id = executor_add(&display_co, "display", display_run);
+    display_sub = executor_subscribe(co_id, "display", BUS_TOPIC_BIT(BUS_TOPIC_DISPLAY),
+                                     EB_SUB_KEEP_LATEST);
+    if (display_sub < 0) {
+        return false;
+    }
+    
+    display_i2c = i2c_bus_client("display");
+    if (display_i2c < 0) {
+        return false;
+    }
+    
+    return true;
+}
 
+/**
+ * @brief Configura el controlador SSD1306
+ *
+ * Se ejecuta al comienzo de display_run para que el arranque no espere
+ * las transferencias I2C; el bus lo configura el gestor (i2c_bus.c).
+ */
+static void ssd1306_hw_init(void) {
     // Secuencia de inicialización del display
     uint8_t cmds[] = {
         SSD1306_SET_DISP,               // Display off
@@ -198,145 +319,337 @@ bool ssd1306_init(void) {
     };
 
     ssd1306_send_cmd_list(cmds, sizeof(cmds));
-
-    // Crear cola para comandos del display
-    display_queue = xQueueCreate(5, sizeof(display_command_t));
-    if (display_queue == NULL) {
-        return false;
-    }
-
-    // Limpiar display inicial
-    ssd1306_clear();
-    
-    return true;
 }
 
 /**
  * @brief Limpia completamente el display
  */
 void ssd1306_clear(void) {
+    marquee_stop();
     memset(display_buffer, 0, SSD1306_BUF_LEN);
     ssd1306_render();
 }
 
 /**
  * @brief Muestra un mensaje en el display
+ *
+ * Las pantallas estáticas se copian desde los cuadros pre-renderizados en
+ * flash (ssd1306_frames.h); solo la fecha/hora y los mensajes personalizados
+ * se dibujan carácter por carácter. Un mensaje personalizado que no entra
+ * en la línea se muestra como marquesina desplazada por el controlador.
  */
 void ssd1306_show_message(display_message_type_t type, const char* custom_message) {
-    ssd1306_clear();
+    marquee_stop();
     
     switch (type) {
-        case DISPLAY_MSG_STANDBY: {
-            // Mostrar fecha y hora en tiempo real
-            char date_str[12];
-            char time_str[12];
-            get_current_datetime(date_str, time_str);
-            
-            write_string(20, 0, "SISTEMA LISTO");
-            write_string(32, 12, date_str);  // Fecha: DD/MM/YY
-            write_string(32, 24, time_str);  // Hora: HH:MM:SS
+        case DISPLAY_MSG_STANDBY:
+            // Fondo estático + fecha y hora del servicio de tiempo
+            time_service_update();
+            memcpy(display_buffer, ssd1306_frames[DISPLAY_MSG_STANDBY], SSD1306_BUF_LEN);
+            write_string(32, 12, time_service_date_str());  // Fecha: DD/MM/YY
+            write_string(32, 24, time_service_time_str());  // Hora: HH:MM:SS
             break;
-        }
             
         case DISPLAY_MSG_ENTER_ID:
-            write_string(20, 8, "INGRESE SU ID");
-            break;
-            
         case DISPLAY_MSG_ENTER_PASSWORD:
-            write_string(8, 4, "INGRESE SU");
-            write_string(20, 16, "CONTRASENA");
-            break;
-            
         case DISPLAY_MSG_WELCOME:
-            write_string(30, 8, "BIENVENIDO");
-            break;
-            
         case DISPLAY_MSG_INVALID:
-            write_string(8, 0, "USUARIO O");
-            write_string(8, 8, "CONTRASENA");
-            write_string(20, 16, "INVALIDOS");
-            break;
-            
         case DISPLAY_MSG_CHANGE_USER:
-            write_string(16, 0, "CAMBIAR USUARIO");
-            write_string(8, 16, "NUEVA CONTRASENA");
+            memcpy(display_buffer, ssd1306_frames[type], SSD1306_BUF_LEN);
             break;
             
         case DISPLAY_MSG_CUSTOM:
-            if (custom_message) {
-                write_string(8, 8, custom_message);
+            memset(display_buffer, 0, SSD1306_BUF_LEN);
+            if (custom_message && strlen(custom_message) > SSD1306_CUSTOM_MAX_CHARS) {
+                marquee_start(custom_message);
+            } else if (custom_message) {
+                write_string(SSD1306_CUSTOM_X, SSD1306_CUSTOM_PAGE * 8, custom_message);
             }
             break;
     }
     
     ssd1306_render();
+    if (marquee.active) {
+        marquee_scroll(true);
+    }
+}
+
+/**
+ * @brief Avanza la marquesina recargando solo su página
+ *
+ * Detiene el desplazamiento, escribe la página con el mensaje avanzado
+ * DISPLAY_MARQUEE_REFILL_PX columnas (lo que el controlador rotó desde la
+ * recarga anterior) y lo vuelve a activar: una página por cada
+ * DISPLAY_MARQUEE_REFILL_PX pasos en lugar de un cuadro por paso.
+ */
+bool ssd1306_update_marquee(void) {
+    if (!marquee.active) {
+        return false;
+    }
+    
+    marquee_scroll(false);
+    marquee.pos = (uint16_t)((marquee.pos + DISPLAY_MARQUEE_REFILL_PX) % marquee.period_px);
+    marquee_draw();
+    ssd1306_render_pages(SSD1306_CUSTOM_PAGE, SSD1306_CUSTOM_PAGE);
+    marquee_scroll(true);
+    return true;
 }
 
 /**
  * @brief Actualiza la fecha y hora en el display
+ *
+ * Avanza el servicio de tiempo y redibuja solo los campos que cambiaron:
+ * normalmente basta con la página de la hora.
  */
 void ssd1306_update_datetime(void) {
-    // Esta función ahora se llama automáticamente desde la tarea
-    // Solo actualizar si estamos en modo standby
-    ssd1306_show_message(DISPLAY_MSG_STANDBY, NULL);
+    uint32_t changed = time_service_update();
+    
+    if (changed & (TIME_FIELD_DAY | TIME_FIELD_MONTH | TIME_FIELD_YEAR)) {
+        write_string(32, 12, time_service_date_str());
+        write_string(32, 24, time_service_time_str());
+        ssd1306_render_pages(12 / SSD1306_PAGE_HEIGHT, 24 / SSD1306_PAGE_HEIGHT);
+    } else if (changed) {
+        write_string(32, 24, time_service_time_str());
+        ssd1306_render_pages(24 / SSD1306_PAGE_HEIGHT, 24 / SSD1306_PAGE_HEIGHT);
+    }
+}
+
+/**
+ * @brief Calcula cuántos ticks faltan para un instante dado
+ *
+ * Usa aritmética sin signo para tolerar el desborde del contador de ticks.
+ * Si el instante ya pasó retorna 0.
+ */
+static TickType_t ticks_until(TickType_t now, TickType_t deadline) {
+    TickType_t remaining = deadline - now;
+    
+    // Una diferencia "negativa" aparece como un valor muy grande
+    if (remaining > (portMAX_DELAY / 2)) {
+        return 0;
+    }
+    return remaining;
+}
+
+/**
+ * @brief Convierte un instante en ticks al reloj del ejecutor (ms)
+ *
+ * Los plazos se pasan como instantes y no como esperas: un turno que
+ * dibujó un cuadro ya bloqueó en el bus I2C, y una espera relativa se
+ * contaría desde el comienzo de la ronda.
+ */
+static uint32_t tick_ms(TickType_t ticks) {
+    return (uint32_t)ticks * portTICK_PERIOD_MS;
 }
 
 /**
- * @brief Tarea de FreeRTOS para manejar el display
+ * @brief Dibuja el comando pendiente y programa los plazos que dependen de él
  */
-void display_task(void *pvParameters) {
-    display_command_t cmd;
-    TickType_t last_datetime_update = xTaskGetTickCount();
-    bool in_standby_mode = true;
+static void display_render_pending(void) {
+    // El comando se lee en la ranura del bus y se suelta al terminar
+    const display_command_t *cmd = EB_PAYLOAD(dsp.msg, const display_command_t);
+    display_message_type_t type = cmd->type;
+    uint32_t display_time_ms = cmd->display_time_ms;
     
-    printf("Tarea del display iniciada\n");
+    // Un comando nuevo siempre reemplaza al mensaje actual
+    task_health_begin(HEALTH_DISPLAY);
+    ssd1306_show_message(type, cmd->custom_message);
+    task_health_end(HEALTH_DISPLAY);
+    bus_release(dsp.msg);
+    dsp.msg = NULL;
+    display_stats.rendered++;
+    TickType_t now = xTaskGetTickCount();
+    dsp.next_frame_time = now + pdMS_TO_TICKS(DISPLAY_FRAME_PERIOD_MS);
+    dsp.marquee_deadline = now + pdMS_TO_TICKS(DISPLAY_MARQUEE_REFILL_MS);
     
-    // Mostrar mensaje inicial
+    // Determinar si estamos en modo standby
+    dsp.in_standby_mode = (type == DISPLAY_MSG_STANDBY);
+    if (dsp.in_standby_mode) {
+        dsp.next_datetime_update = now + pdMS_TO_TICKS(1000);
+        task_health_start(HEALTH_CLOCK);
+    } else {
+        task_health_idle(HEALTH_CLOCK);
+    }
+    
+    // Si el mensaje tiene tiempo limitado, programar regreso a standby
+    dsp.timed_message_active = (display_time_ms > 0);
+    if (dsp.timed_message_active) {
+        dsp.standby_deadline = now + pdMS_TO_TICKS(display_time_ms);
+    }
+}
+
+/**
+ * @brief Atiende los plazos cumplidos: marquesina, regreso a standby y reloj
+ */
+static void display_service_deadlines(void) {
+    TickType_t now = xTaskGetTickCount();
+    
+    if (marquee.active && ticks_until(now, dsp.marquee_deadline) == 0) {
+        // El plazo se mide desde que el desplazamiento se reactiva
+        task_health_begin(HEALTH_DISPLAY);
+        ssd1306_update_marquee();
+        task_health_end(HEALTH_DISPLAY);
+        dsp.marquee_deadline = xTaskGetTickCount() + pdMS_TO_TICKS(DISPLAY_MARQUEE_REFILL_MS);
+    }
+    
+    if (dsp.timed_message_active) {
+        // Plazo del mensaje temporizado cumplido - volver a standby
+        if (ticks_until(now, dsp.standby_deadline) == 0) {
+            dsp.timed_message_active = false;
+            dsp.in_standby_mode = true;
+            task_health_begin(HEALTH_DISPLAY);
+            ssd1306_show_message(DISPLAY_MSG_STANDBY, NULL);
+            task_health_end(HEALTH_DISPLAY);
+            dsp.next_datetime_update = now + pdMS_TO_TICKS(1000);
+            task_health_start(HEALTH_CLOCK);
+        }
+    } else if (dsp.in_standby_mode && ticks_until(now, dsp.next_datetime_update) == 0) {
+        // Actualizar fecha/hora cada segundo solo en standby
+        task_health_heartbeat(HEALTH_CLOCK);
+        task_health_begin(HEALTH_DISPLAY);
+        ssd1306_update_datetime();
+        task_health_end(HEALTH_DISPLAY);
+        dsp.next_datetime_update += pdMS_TO_TICKS(1000);
+        
+        // Si nos atrasamos más de un período, realinear con el tiempo actual
+        if (ticks_until(now, dsp.next_datetime_update) == 0) {
+            dsp.next_datetime_update = now + pdMS_TO_TICKS(1000);
+        }
+    }
+}
+
+/**
+ * @brief Próximo plazo pendiente
+ *
+ * @param deadline Instante del plazo, en ticks
+ * @return false si no hay ninguno (solo un comando despierta al display)
+ */
+static bool display_next_deadline(TickType_t *deadline) {
+    TickType_t now = xTaskGetTickCount();
+    TickType_t wait = portMAX_DELAY;
+    
+    if (dsp.timed_message_active) {
+        wait = ticks_until(now, dsp.standby_deadline);
+    } else if (dsp.in_standby_mode) {
+        wait = ticks_until(now, dsp.next_datetime_update);
+    }
+    if (marquee.active) {
+        TickType_t refill = ticks_until(now, dsp.marquee_deadline);
+        if (refill < wait) {
+            wait = refill;
+        }
+    }
+    *deadline = now + wait;
+    return wait != portMAX_DELAY;
+}
+
+/**
+ * @brief Toma los comandos que llegaron: gana el último
+ */
+static void display_take_newer(void) {
+    const eb_msg_t *newer;
+    
+    while ((newer = bus_poll(display_sub)) != NULL) {
+        if (dsp.msg != NULL) {
+            bus_release(dsp.msg);
+            display_stats.merged++;
+        }
+        dsp.msg = newer;
+        display_stats.received++;
+    }
+}
+
+/**
+ * @brief Corrutina que maneja el display
+ *
+ * Nunca duerme durante un mensaje temporizado: el regreso a standby y el
+ * refresco del reloj se manejan como plazos dentro del mismo bucle de
+ * eventos, de modo que un comando nuevo reemplaza de inmediato al mensaje
+ * temporizado que se esté mostrando.
+ *
+ * Las transferencias I2C de un cuadro se esperan dentro del turno: durante
+ * ese tiempo (a lo sumo DISPLAY_FRAME_PERIOD_MS) las demás corrutinas del
+ * ejecutor no corren.
+ */
+static void display_run(co_t *co) {
+    CO_BEGIN(co);
+    
+    printf("Corrutina del display iniciada\n");
+    
+    // Configurar el hardware y mostrar directamente la pantalla inicial
+    // (sin cuadro en blanco intermedio)
+    task_health_begin(HEALTH_DISPLAY);
+    ssd1306_hw_init();
     ssd1306_show_message(DISPLAY_MSG_STANDBY, NULL);
+    task_health_end(HEALTH_DISPLAY);
+    boot_mark(BOOT_PHASE_DISPLAY_READY);
+    dsp.in_standby_mode = true;
+    dsp.next_frame_time = xTaskGetTickCount();
+    dsp.next_datetime_update = dsp.next_frame_time + pdMS_TO_TICKS(1000);
+    task_health_start(HEALTH_CLOCK);
     
     while (1) {
-        // Verificar si hay comandos en la cola (con timeout de 1 segundo)
-        if (xQueueReceive(display_queue, &cmd, pdMS_TO_TICKS(1000)) == pdTRUE) {
-            // Procesar comando del display
-            ssd1306_show_message(cmd.type, cmd.custom_message);
-            
-            // Determinar si estamos en modo standby
-            in_standby_mode = (cmd.type == DISPLAY_MSG_STANDBY);
-            
-            // Si el mensaje tiene tiempo limitado, esperar y volver a standby
-            if (cmd.display_time_ms > 0) {
-                vTaskDelay(pdMS_TO_TICKS(cmd.display_time_ms));
-                ssd1306_show_message(DISPLAY_MSG_STANDBY, NULL);
-                in_standby_mode = true;
-            }
-        } else {
-            // Timeout - actualizar fecha/hora cada segundo solo en standby
-            if (in_standby_mode && 
-                (xTaskGetTickCount() - last_datetime_update >= pdMS_TO_TICKS(1000))) {
-                ssd1306_show_message(DISPLAY_MSG_STANDBY, NULL);
-                last_datetime_update = xTaskGetTickCount();
+        display_take_newer();
+        
+        if (dsp.msg == NULL) {
+            // Esperar exactamente hasta el próximo plazo pendiente o un comando
+            display_service_deadlines();
+            if (display_next_deadline(&dsp.wake_time)) {
+                CO_WAIT_UNTIL(co, tick_ms(dsp.wake_time));
+            } else {
+                CO_WAIT(co, CO_FOREVER);
             }
+            continue;
+        }
+        
+        // Respetar el período mínimo entre cuadros: mientras tanto, los
+        // comandos que lleguen reemplazan al pendiente (gana el último)
+        while (ticks_until(xTaskGetTickCount(), dsp.next_frame_time) > 0) {
+            CO_WAIT_UNTIL(co, tick_ms(dsp.next_frame_time));
+            display_take_newer();
         }
+        
+        display_render_pending();
     }
+    
+    CO_END(co);
 }
 
 /**
  * @brief Envía un comando al display desde otras tareas
  */
 bool ssd1306_send_command(display_message_type_t type, const char* custom_message, uint32_t display_time_ms) {
-    if (display_queue == NULL) {
+    // El comando se escribe una sola vez, directamente en la ranura del bus;
+    // con el anillo del display lleno el bus descarta el más antiguo
+    eb_msg_t *msg = bus_alloc(BUS_TOPIC_DISPLAY);
+    if (msg == NULL) {
         return false;
     }
     
-    display_command_t cmd = {
-        .type = type,
-        .display_time_ms = display_time_ms
-    };
-    
+    display_command_t *cmd = EB_PAYLOAD(msg, display_command_t);
+    cmd->type = type;
+    cmd->display_time_ms = display_time_ms;
+    cmd->custom_message[0] = '\0';
     if (custom_message) {
-        strncpy(cmd.custom_message, custom_message, sizeof(cmd.custom_message) - 1);
-        cmd.custom_message[sizeof(cmd.custom_message) - 1] = '\0';
+        strncpy(cmd->custom_message, custom_message, sizeof(cmd->custom_message) - 1);
+        cmd->custom_message[sizeof(cmd->custom_message) - 1] = '\0';
     }
     
-    return xQueueSend(display_queue, &cmd, pdMS_TO_TICKS(100)) == pdTRUE;
+    return bus_publish(msg);
+}
+
+/**
+ * @brief Obtiene los contadores de coalescencia del display
+ */
+void ssd1306_get_stats(display_stats_t *stats) {
+    if (stats == NULL) {
+        return;
+    }
+    
+    eb_topic_stats_t bus_stats;
+    bus_get_topic_stats(BUS_TOPIC_DISPLAY, &bus_stats);
+    
+    taskENTER_CRITICAL();
+    *stats = display_stats;
+    taskEXIT_CRITICAL();
+    stats->dropped = bus_stats.dropped + bus_stats.no_slot;
 }
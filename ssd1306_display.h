@@ -38,10 +38,37 @@ typedef struct {
 } display_command_t;
 
 /**
- * @brief Inicializa el display SSD1306 I2C
+ * @brief Contadores de coalescencia de comandos del display
+ */
+typedef struct {
+    uint32_t received;          /**< Comandos recibidos por la corrutina */
+    uint32_t rendered;          /**< Cuadros enviados al display por comandos */
+    uint32_t merged;            /**< Comandos reemplazados por uno más reciente antes de renderizar */
+    uint32_t dropped;           /**< Comandos descartados por el bus (reemplazados o sin ranura) */
+} display_stats_t;
+
+/** @brief Período mínimo entre cuadros renderizados por comandos (máx. 20 fps) */
+#define DISPLAY_FRAME_PERIOD_MS 50
+
+/**
+ * @brief Marquesina de mensajes largos
+ *
+ * Un mensaje personalizado de más de 15 caracteres se desplaza con el
+ * scroll horizontal del controlador (un paso por columna cada 3 cuadros,
+ * ≈17 ms); la corrutina del display solo recarga la página cada
+ * DISPLAY_MARQUEE_REFILL_PX pasos.
+ */
+#define DISPLAY_MARQUEE_REFILL_PX   16
+#define DISPLAY_MARQUEE_REFILL_MS   274
+
+/**
+ * @brief Inicializa el módulo del display SSD1306 I2C
  * 
- * Configura el hardware I2C, inicializa el display y prepara
- * la pantalla para mostrar información del sistema.
+ * Solo registra su corrutina en el ejecutor, la suscribe a los comandos del
+ * bus de eventos (BUS_TOPIC_DISPLAY) y se registra como cliente del gestor
+ * I2C (llamar después de executor_init e i2c_bus_init): la configuración
+ * del controlador se hace al comenzar la corrutina, fuera del camino de
+ * arranque. Los comandos enviados antes quedan pendientes.
  * 
  * @return true Si la inicialización fue exitosa
  * @return false Si hubo error en la inicialización
@@ -60,24 +87,27 @@ void ssd1306_show_message(display_message_type_t type, const char* custom_messag
  * @brief Actualiza la fecha y hora en el display
  * 
  * Esta función debe llamarse periódicamente para mantener
- * actualizada la información de fecha y hora.
+ * actualizada la información de fecha y hora. Solo retransmite las
+ * páginas del display cuyos campos cambiaron.
  */
 void ssd1306_update_datetime(void);
 
 /**
- * @brief Limpia completamente el display
+ * @brief Avanza la marquesina de un mensaje largo
+ *
+ * Debe llamarse cada DISPLAY_MARQUEE_REFILL_MS, contados desde que el
+ * desplazamiento se activó o se recargó por última vez. El oscilador del
+ * controlador no está sincronizado con el tick: cada recarga puede adelantar
+ * o atrasar el texto una o dos columnas (oscilador a ±10 % del nominal).
+ *
+ * @return false si no hay una marquesina en curso
  */
-void ssd1306_clear(void);
+bool ssd1306_update_marquee(void);
 
 /**
- * @brief Tarea de FreeRTOS para manejar el display
- * 
- * Esta tarea maneja la cola de comandos del display y actualiza
- * la pantalla según los mensajes recibidos.
- * 
- * @param pvParameters Parámetros de la tarea (no utilizados)
+ * @brief Limpia completamente el display
  */
-void display_task(void *pvParameters);
+void ssd1306_clear(void);
 
 /**
  * @brief Envía un comando al display desde otras tareas
@@ -90,4 +120,11 @@ void display_task(void *pvParameters);
  */
 bool ssd1306_send_command(display_message_type_t type, const char* custom_message, uint32_t display_time_ms);
 
+/**
+ * @brief Obtiene los contadores de coalescencia del display
+ * 
+ * @param stats Puntero donde copiar los contadores
+ */
+void ssd1306_get_stats(display_stats_t *stats);
+
 #endif /* SSD1306_DISPLAY_H */
@@ -4,10 +4,18 @@
  * SPDX-License-Identifier: BSD-3-Clause
  */
 
-// Vertical bitmaps, A-Z, 0-9. Each is 8 pixels high and wide
+// Vertical bitmaps, A-Z, 0-9 y signos de puntuación. Each is 8 pixels high and wide
 // These are defined vertically to make them quick to copy to FB
+//
+// tools/gen_ssd1306_frames.py lee esta tabla (una línea por glifo, con la
+// etiqueta del carácter en el comentario) para generar los cuadros estáticos.
 
-static uint8_t font[] = {
+#ifndef SSD1306_FONT_H
+#define SSD1306_FONT_H
+
+#include <stdint.h>
+
+static const uint8_t font[] = {
 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, // Nothing
 0x78, 0x14, 0x12, 0x11, 0x12, 0x14, 0x78, 0x00, //A
 0x7f, 0x49, 0x49, 0x49, 0x49, 0x49, 0x7f, 0x00, //B
@@ -45,4 +53,38 @@ static uint8_t font[] = {
 0x01, 0x01, 0x01, 0x61, 0x31, 0x0d, 0x03, 0x00, //7
 0x36, 0x49, 0x49, 0x49, 0x49, 0x49, 0x36, 0x00, //8
 0x06, 0x09, 0x09, 0x09, 0x09, 0x09, 0x7f, 0x00, //9
+0x00, 0x00, 0x36, 0x36, 0x00, 0x00, 0x00, 0x00, //:
+0x40, 0x20, 0x10, 0x08, 0x04, 0x02, 0x01, 0x00, ///
+0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x00, 0x00, //-
+0x00, 0x00, 0x60, 0x60, 0x00, 0x00, 0x00, 0x00, //.
+0x00, 0x80, 0x60, 0x00, 0x00, 0x00, 0x00, 0x00, //,
+0x00, 0x00, 0x00, 0x5f, 0x00, 0x00, 0x00, 0x00, //!
+0x02, 0x01, 0x01, 0x51, 0x09, 0x09, 0x06, 0x00, //?
+0x14, 0x08, 0x3e, 0x08, 0x14, 0x00, 0x00, 0x00, //*
+0x14, 0x7f, 0x14, 0x14, 0x7f, 0x14, 0x00, 0x00, //#
+};
+
+/**
+ * @brief Índice de glifo para cada carácter ASCII (0 = espacio/desconocido)
+ *
+ * Reemplaza la cadena de comparaciones y el toupper(): las minúsculas
+ * apuntan directamente al glifo de su mayúscula.
+ */
+static const uint8_t font_index[128] = {
+    ['A'] = 1,  ['B'] = 2,  ['C'] = 3,  ['D'] = 4,  ['E'] = 5,  ['F'] = 6,
+    ['G'] = 7,  ['H'] = 8,  ['I'] = 9,  ['J'] = 10, ['K'] = 11, ['L'] = 12,
+    ['M'] = 13, ['N'] = 14, ['O'] = 15, ['P'] = 16, ['Q'] = 17, ['R'] = 18,
+    ['S'] = 19, ['T'] = 20, ['U'] = 21, ['V'] = 22, ['W'] = 23, ['X'] = 24,
+    ['Y'] = 25, ['Z'] = 26,
+    ['a'] = 1,  ['b'] = 2,  ['c'] = 3,  ['d'] = 4,  ['e'] = 5,  ['f'] = 6,
+    ['g'] = 7,  ['h'] = 8,  ['i'] = 9,  ['j'] = 10, ['k'] = 11, ['l'] = 12,
+    ['m'] = 13, ['n'] = 14, ['o'] = 15, ['p'] = 16, ['q'] = 17, ['r'] = 18,
+    ['s'] = 19, ['t'] = 20, ['u'] = 21, ['v'] = 22, ['w'] = 23, ['x'] = 24,
+    ['y'] = 25, ['z'] = 26,
+    ['0'] = 27, ['1'] = 28, ['2'] = 29, ['3'] = 30, ['4'] = 31, ['5'] = 32,
+    ['6'] = 33, ['7'] = 34, ['8'] = 35, ['9'] = 36,
+    [':'] = 37, ['/'] = 38, ['-'] = 39, ['.'] = 40, [','] = 41, ['!'] = 42,
+    ['?'] = 43, ['*'] = 44, ['#'] = 45,
 };
+
+#endif /* SSD1306_FONT_H */
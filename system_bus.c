@@ -0,0 +1,294 @@
+/**
+ * @file system_bus.c
+ * @brief Implementación del bus de eventos del sistema sobre FreeRTOS
+ * @author Sistema de Control de Acceso
+ * @date 2025
+ */
+
+#include "system_bus.h"
+#include <stdio.h>
+#include <string.h>
+#include "FreeRTOS.h"
+#include "task.h"
+#include "semphr.h"
+#include "rtos_static.h"
+
+/** @brief Nombres de los tópicos para reportes */
+static const char *const topic_names[BUS_TOPIC_COUNT] = {
+    [BUS_TOPIC_KEY]     = "key",
+    [BUS_TOPIC_ACCESS]  = "access",
+    [BUS_TOPIC_LED]     = "led",
+    [BUS_TOPIC_DISPLAY] = "display",
+    [BUS_TOPIC_AUTH]    = "auth",
+};
+
+/** @brief Estado del bus (compartido entre tareas, protegido por sección crítica) */
+static eb_bus_t bus;
+
+/**
+ * @brief Contadores copiados para imprimir sin mantener la sección crítica
+ *
+ * Solo lo que muestra bus_print, no el bus entero con su pool.
+ */
+static struct {
+    uint8_t free_count;
+    uint8_t peak_in_use;
+    uint8_t sub_count;
+    eb_topic_stats_t stats[BUS_TOPIC_COUNT];
+    struct {
+        const char *name;
+        uint8_t pending;
+        uint8_t peak;
+    } subs[EB_MAX_SUBSCRIBERS];
+} report;
+
+/** @brief Semáforo de espera de cada suscriptor */
+static SemaphoreHandle_t sub_wake[EB_MAX_SUBSCRIBERS];
+RTOS_BINARY_SEMAPHORE_ARRAY_DEFINE(sub_wake, EB_MAX_SUBSCRIBERS);
+
+/** @brief Aviso de entrega de los suscriptores sin semáforo */
+static bus_notify_fn sub_notify[EB_MAX_SUBSCRIBERS];
+static void *sub_notify_ctx[EB_MAX_SUBSCRIBERS];
+
+/**
+ * @brief Inicializa el bus (antes de que los módulos se suscriban)
+ */
+bool system_bus_init(void) {
+    eb_init(&bus);
+    // Una tecla no debe quedar sin ranura por el display o las estadísticas
+    eb_reserve(&bus, BUS_TOPIC_BIT(BUS_TOPIC_KEY));
+    return true;
+}
+
+/**
+ * @brief Registra un suscriptor y crea su semáforo de espera
+ */
+int bus_subscribe(const char *name, uint32_t topics, uint8_t flags, trace_queue_id_t trace_id) {
+    taskENTER_CRITICAL();
+    int id = eb_subscribe(&bus, name, topics, flags);
+    taskEXIT_CRITICAL();
+    if (id < 0) {
+        return -1;
+    }
+
+    sub_wake[id] = RTOS_BINARY_SEMAPHORE_ARRAY_CREATE(sub_wake, id);
+    if (sub_wake[id] == NULL) {
+        return -1;
+    }
+    if (trace_id != TRACE_QUEUE_NONE) {
+        trace_register_queue(sub_wake[id], trace_id, name);
+    }
+    return id;
+}
+
+/**
+ * @brief Registra un suscriptor que recibe un aviso en lugar de un semáforo
+ */
+int bus_subscribe_notify(const char *name, uint32_t topics, uint8_t flags,
+                         bus_notify_fn notify, void *ctx) {
+    if (notify == NULL) {
+        return -1;
+    }
+
+    taskENTER_CRITICAL();
+    int id = eb_subscribe(&bus, name, topics, flags);
+    if (id >= 0) {
+        sub_notify[id] = notify;
+        sub_notify_ctx[id] = ctx;
+    }
+    taskEXIT_CRITICAL();
+    return id;
+}
+
+/**
+ * @brief Reserva una ranura para publicar
+ */
+eb_msg_t *bus_alloc(bus_topic_t topic) {
+    taskENTER_CRITICAL();
+    eb_msg_t *msg = eb_alloc(&bus, (uint8_t)topic);
+    taskEXIT_CRITICAL();
+    return msg;
+}
+
+/**
+ * @brief Publica una ranura reservada y despierta a sus suscriptores
+ */
+bool bus_publish(eb_msg_t *msg) {
+    if (msg == NULL) {
+        return false;
+    }
+
+    taskENTER_CRITICAL();
+    uint32_t delivered = eb_publish(&bus, msg);
+    taskEXIT_CRITICAL();
+
+    bool any = (delivered != 0);
+
+    // Despertar fuera de la sección crítica: el anillo ya tiene la referencia
+    for (int id = 0; delivered != 0; id++, delivered >>= 1) {
+        if (!(delivered & 1u)) {
+            continue;
+        }
+        if (sub_notify[id] != NULL) {
+            sub_notify[id](sub_notify_ctx[id]);
+        } else {
+            xSemaphoreGive(sub_wake[id]);
+        }
+    }
+    return any;
+}
+
+/**
+ * @brief Publica un evento pequeño copiándolo en una ranura
+ */
+bool bus_publish_copy(bus_topic_t topic, const void *payload, uint32_t size) {
+    if (size > EB_PAYLOAD_SIZE) {
+        return false;
+    }
+
+    eb_msg_t *msg = bus_alloc(topic);
+    if (msg == NULL) {
+        return false;
+    }
+    memcpy(msg->data, payload, size);
+    return bus_publish(msg);
+}
+
+/**
+ * @brief Espera el próximo evento de un suscriptor
+ *
+ * El anillo es la fuente de verdad y el semáforo solo despierta: una
+ * entrega que encuentra el anillo ya vacío se descuenta del tiempo de
+ * espera restante.
+ */
+const eb_msg_t *bus_receive(int sub, TickType_t wait) {
+    TimeOut_t timeout;
+
+    if (sub < 0 || sub >= EB_MAX_SUBSCRIBERS || sub_wake[sub] == NULL) {
+        return NULL;
+    }
+
+    vTaskSetTimeOutState(&timeout);
+    while (1) {
+        taskENTER_CRITICAL();
+        const eb_msg_t *msg = eb_pop(&bus, sub);
+        taskEXIT_CRITICAL();
+        if (msg != NULL) {
+            return msg;
+        }
+
+        if (xTaskCheckForTimeOut(&timeout, &wait) == pdTRUE ||
+            xSemaphoreTake(sub_wake[sub], wait) != pdTRUE) {
+            return NULL;
+        }
+    }
+}
+
+/**
+ * @brief Toma el próximo evento de un suscriptor sin esperar
+ */
+const eb_msg_t *bus_poll(int sub) {
+    if (sub < 0 || sub >= EB_MAX_SUBSCRIBERS) {
+        return NULL;
+    }
+
+    taskENTER_CRITICAL();
+    const eb_msg_t *msg = eb_pop(&bus, sub);
+    taskEXIT_CRITICAL();
+    return msg;
+}
+
+/**
+ * @brief Suelta una referencia recibida
+ */
+void bus_release(const eb_msg_t *msg) {
+    taskENTER_CRITICAL();
+    eb_release(&bus, msg);
+    taskEXIT_CRITICAL();
+}
+
+/**
+ * @brief Obtiene los contadores de un tópico
+ */
+void bus_get_topic_stats(bus_topic_t topic, eb_topic_stats_t *stats) {
+    if (stats == NULL || topic >= BUS_TOPIC_COUNT) {
+        return;
+    }
+
+    taskENTER_CRITICAL();
+    *stats = bus.stats[topic];
+    taskEXIT_CRITICAL();
+}
+
+/**
+ * @brief Imprime los contadores por tópico y por suscriptor
+ */
+void bus_print(bool json) {
+    taskENTER_CRITICAL();
+    report.free_count = bus.free_count;
+    report.peak_in_use = bus.peak_in_use;
+    report.sub_count = bus.sub_count;
+    memcpy(report.stats, bus.stats, sizeof(report.stats));
+    for (int i = 0; i < bus.sub_count; i++) {
+        report.subs[i].name = bus.subs[i].name;
+        report.subs[i].pending = eb_pending(&bus, i);
+        report.subs[i].peak = bus.subs[i].peak;
+    }
+    taskEXIT_CRITICAL();
+
+    uint8_t in_use = (uint8_t)(EB_POOL_SLOTS - report.free_count);
+
+    if (json) {
+        printf("{\"pool\":{\"slots\":%d,\"slot_bytes\":%u,\"in_use\":%u,\"peak\":%u,"
+               "\"reserved\":%d},\"topics\":[",
+               EB_POOL_SLOTS, (unsigned)sizeof(eb_msg_t), in_use, report.peak_in_use,
+               EB_RESERVED_SLOTS);
+    } else {
+        printf("\n=== BUS DE EVENTOS ===\n");
+        printf("Pool: %u/%d ranuras en uso (máx. %u, %d reservadas para teclas), %u bytes por ranura\n",
+               in_use, EB_POOL_SLOTS, report.peak_in_use, EB_RESERVED_SLOTS,
+               (unsigned)sizeof(eb_msg_t));
+        printf("%-8s %10s %10s %8s %8s %8s\n",
+               "Tópico", "Publicados", "Entregados", "SinRanura", "Perdidos", "SinDest");
+    }
+
+    for (int t = 0; t < BUS_TOPIC_COUNT; t++) {
+        const eb_topic_stats_t *st = &report.stats[t];
+        if (json) {
+            printf("%s{\"name\":\"%s\",\"published\":%lu,\"delivered\":%lu,"
+                   "\"no_slot\":%lu,\"dropped\":%lu,\"unrouted\":%lu}",
+                   (t > 0) ? "," : "", topic_names[t],
+                   (unsigned long)st->published, (unsigned long)st->delivered,
+                   (unsigned long)st->no_slot, (unsigned long)st->dropped,
+                   (unsigned long)st->unrouted);
+        } else {
+            printf("%-8s %10lu %10lu %8lu %8lu %8lu\n", topic_names[t],
+                   (unsigned long)st->published, (unsigned long)st->delivered,
+                   (unsigned long)st->no_slot, (unsigned long)st->dropped,
+                   (unsigned long)st->unrouted);
+        }
+    }
+
+    if (json) {
+        printf("],\"subscribers\":[");
+    } else {
+        printf("%-14s %10s %10s\n", "Suscriptor", "Pendientes", "Máximo");
+    }
+
+    for (int i = 0; i < report.sub_count; i++) {
+        if (json) {
+            printf("%s{\"name\":\"%s\",\"pending\":%u,\"peak\":%u,\"depth\":%d}",
+                   (i > 0) ? "," : "", report.subs[i].name, report.subs[i].pending,
+                   report.subs[i].peak, EB_SUB_DEPTH);
+        } else {
+            printf("%-14s %10u %7u/%d\n", report.subs[i].name, report.subs[i].pending,
+                   report.subs[i].peak, EB_SUB_DEPTH);
+        }
+    }
+
+    if (json) {
+        printf("]}\n");
+    } else {
+        printf("\n");
+    }
+}
@@ -0,0 +1,146 @@
+/**
+ * @file system_bus.h
+ * @brief Bus de eventos del sistema sobre FreeRTOS
+ * @author Sistema de Control de Acceso
+ * @date 2025
+ *
+ * Reemplaza las colas propias de teclado, LEDs, display y control de acceso
+ * por un único bus (event_bus.h): los productores escriben el evento una
+ * sola vez en una ranura del pool y cada suscriptor recibe una referencia.
+ * Publicar nunca bloquea; la contrapresión y las pérdidas quedan en los
+ * contadores de cada tópico ("bus [json]" en la consola).
+ *
+ * Cada suscriptor espera con su propio semáforo binario, así que una tarea
+ * puede recibir varios tópicos en orden de llegada sin conjuntos de colas.
+ *
+ * Todas las funciones son solo para tareas: usan taskENTER_CRITICAL,
+ * xSemaphoreGive y los avisos de bus_subscribe_notify, que no valen dentro
+ * de una ISR. Una interrupción despierta a una tarea (semáforo o
+ * notificación) y esa tarea publica, como hace el teclado.
+ */
+
+#ifndef SYSTEM_BUS_H
+#define SYSTEM_BUS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "event_bus.h"
+#include "trace_recorder.h"
+#include "FreeRTOS.h"
+
+/**
+ * @brief Tópicos del sistema
+ */
+typedef enum {
+    BUS_TOPIC_KEY,          /**< Tecla detectada (keypad_event_t) */
+    BUS_TOPIC_ACCESS,       /**< Evento para el control de acceso (access_event_t) */
+    BUS_TOPIC_LED,          /**< Comando de LEDs (led_cmd_t) */
+    BUS_TOPIC_DISPLAY,      /**< Comando del display (display_command_t) */
+    BUS_TOPIC_AUTH,         /**< Resultado de una autenticación (auth_event_t) */
+    BUS_TOPIC_COUNT
+} bus_topic_t;
+
+_Static_assert(BUS_TOPIC_COUNT <= EB_MAX_TOPICS, "Demasiados tópicos para el bus");
+
+/** @brief Bit de un tópico para bus_subscribe */
+#define BUS_TOPIC_BIT(topic)    (1u << (topic))
+
+/**
+ * @brief Aviso de entrega para bus_subscribe_notify (se llama desde bus_publish)
+ */
+typedef void (*bus_notify_fn)(void *ctx);
+
+/**
+ * @brief Inicializa el bus (antes de que los módulos se suscriban)
+ *
+ * @return true si la inicialización fue exitosa
+ */
+bool system_bus_init(void);
+
+/**
+ * @brief Registra un suscriptor y crea su semáforo de espera
+ *
+ * @param name Nombre para reportes
+ * @param topics Máscara de tópicos (BUS_TOPIC_BIT)
+ * @param flags EB_SUB_KEEP_LATEST para que los eventos nuevos reemplacen a los viejos
+ * @param trace_id Identificador del semáforo en la traza (TRACE_QUEUE_NONE = sin trazar)
+ * @return Identificador del suscriptor, o -1 si hubo error
+ */
+int bus_subscribe(const char *name, uint32_t topics, uint8_t flags, trace_queue_id_t trace_id);
+
+/**
+ * @brief Registra un suscriptor que recibe un aviso en lugar de un semáforo
+ *
+ * Para suscriptores que no tienen tarea propia (corrutinas del ejecutor):
+ * cada entrega llama a notify fuera de la sección crítica, en el contexto
+ * de la tarea que publica, y los eventos se leen con bus_poll.
+ *
+ * @param notify Aviso de entrega (breve y sin bloquear)
+ * @param ctx Argumento de notify
+ * @return Identificador del suscriptor, o -1 si hubo error
+ */
+int bus_subscribe_notify(const char *name, uint32_t topics, uint8_t flags,
+                         bus_notify_fn notify, void *ctx);
+
+/**
+ * @brief Reserva una ranura para publicar (solo desde tareas)
+ *
+ * @return Ranura a completar con EB_PAYLOAD, o NULL si el tópico no tiene
+ *         suscriptores o el pool está agotado (no se bloquea)
+ */
+eb_msg_t *bus_alloc(bus_topic_t topic);
+
+/**
+ * @brief Publica una ranura reservada y despierta a sus suscriptores
+ *
+ * Solo desde tareas: los avisos de los suscriptores se llaman en el
+ * contexto de quien publica.
+ *
+ * @return true si al menos un suscriptor recibió el evento
+ */
+bool bus_publish(eb_msg_t *msg);
+
+/**
+ * @brief Publica un evento pequeño copiándolo en una ranura (solo desde tareas)
+ *
+ * @return true si al menos un suscriptor recibió el evento
+ */
+bool bus_publish_copy(bus_topic_t topic, const void *payload, uint32_t size);
+
+/**
+ * @brief Espera el próximo evento de un suscriptor
+ *
+ * @param sub Identificador devuelto por bus_subscribe
+ * @param wait Ticks máximos de espera (portMAX_DELAY = sin límite)
+ * @return Ranura a leer y luego soltar con bus_release, o NULL si venció la espera
+ */
+const eb_msg_t *bus_receive(int sub, TickType_t wait);
+
+/**
+ * @brief Toma el próximo evento de un suscriptor sin esperar
+ *
+ * @return Ranura a leer y luego soltar con bus_release, o NULL si no hay eventos
+ */
+const eb_msg_t *bus_poll(int sub);
+
+/**
+ * @brief Suelta una referencia recibida
+ */
+void bus_release(const eb_msg_t *msg);
+
+/**
+ * @brief Obtiene los contadores de un tópico
+ *
+ * @param topic Tópico
+ * @param stats Puntero donde copiar los contadores
+ */
+void bus_get_topic_stats(bus_topic_t topic, eb_topic_stats_t *stats);
+
+/**
+ * @brief Imprime los contadores por tópico y por suscriptor
+ *
+ * @param json true para una línea JSON, false para tabla legible
+ */
+void bus_print(bool json);
+
+#endif // SYSTEM_BUS_H
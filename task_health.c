@@ -0,0 +1,226 @@
+/**
+ * @file task_health.c
+ * @brief Implementación de la vigilancia de plazos y del watchdog de hardware
+ * @author Sistema de Control de Acceso
+ * @date 2025
+ */
+
+#include "task_health.h"
+#include "deadline_monitor.h"
+#include <stdio.h>
+#include <string.h>
+#include "pico/stdlib.h"
+#include "hardware/watchdog.h"
+#include "FreeRTOS.h"
+#include "task.h"
+
+/** @brief Marca en el registro scratch del watchdog (sobrevive al reinicio) */
+#define HEALTH_SCRATCH_MAGIC    0x484C0000u
+#define HEALTH_SCRATCH_MASK     0x0000FFFFu
+
+_Static_assert(HEALTH_COUNT <= DM_MAX_TASKS, "Demasiados contratos para el monitor");
+_Static_assert(HEALTH_COUNT <= 16, "La máscara de tareas no cabe en el registro scratch");
+
+/**
+ * @brief Contrato temporal de cada tarea vigilada
+ *
+ * Plazo y tolerancia en milisegundos: un latido o trabajo que supera
+ * plazo + tolerancia cuenta como incumplimiento.
+ */
+static const struct {
+    const char *name;
+    dm_kind_t kind;
+    uint32_t period_ms;
+    uint32_t tolerance_ms;
+} contracts[HEALTH_COUNT] = {
+    [HEALTH_KEYPAD]  = { "Keypad",        DM_KIND_PERIODIC, 5,    45  },
+    [HEALTH_LEDS]    = { "LEDs",          DM_KIND_JOB,      50,   50  },
+    [HEALTH_DISPLAY] = { "Display",       DM_KIND_JOB,      50,   50  },
+    [HEALTH_CLOCK]   = { "Clock",         DM_KIND_PERIODIC, 1000, 250 },
+    [HEALTH_ACCESS]  = { "AccessControl", DM_KIND_JOB,      100,  100 },
+};
+
+/** @brief Estado del monitor (compartido entre tareas, protegido por sección crítica) */
+static dm_monitor_t monitor;
+
+/** @brief Copia para imprimir sin mantener la sección crítica */
+static dm_monitor_t snapshot;
+
+/**
+ * @brief Tiempo actual en milisegundos
+ */
+static inline uint32_t health_now_ms(void) {
+    return (uint32_t)xTaskGetTickCount() * portTICK_PERIOD_MS;
+}
+
+/**
+ * @brief Registra los contratos e informa si el último reinicio fue del watchdog
+ */
+bool task_health_init(void) {
+    dm_init(&monitor);
+
+    for (int i = 0; i < HEALTH_COUNT; i++) {
+        if (dm_register(&monitor, contracts[i].name, contracts[i].kind,
+                        contracts[i].period_ms, contracts[i].tolerance_ms) != i) {
+            return false;
+        }
+    }
+
+    if (watchdog_caused_reboot()) {
+        uint32_t scratch = watchdog_hw->scratch[0];
+        printf("ATENCIÓN: el último reinicio fue causado por el watchdog");
+        if ((scratch & ~HEALTH_SCRATCH_MASK) == HEALTH_SCRATCH_MAGIC) {
+            printf(" - tareas sin responder:");
+            for (int i = 0; i < HEALTH_COUNT; i++) {
+                if (scratch & (1u << i)) {
+                    printf(" %s", contracts[i].name);
+                }
+            }
+        }
+        printf("\n");
+    }
+    watchdog_hw->scratch[0] = 0;
+
+    return true;
+}
+
+/**
+ * @brief Comienzo de la actividad periódica de una tarea
+ */
+void task_health_start(health_task_id_t id) {
+    taskENTER_CRITICAL();
+    dm_start(&monitor, id, health_now_ms());
+    taskEXIT_CRITICAL();
+}
+
+/**
+ * @brief Latido de una tarea periódica
+ */
+void task_health_heartbeat(health_task_id_t id) {
+    taskENTER_CRITICAL();
+    dm_heartbeat(&monitor, id, health_now_ms());
+    taskEXIT_CRITICAL();
+}
+
+/**
+ * @brief La tarea va a bloquearse sin plazo
+ */
+void task_health_idle(health_task_id_t id) {
+    taskENTER_CRITICAL();
+    dm_idle(&monitor, id);
+    taskEXIT_CRITICAL();
+}
+
+/**
+ * @brief Comienzo de un trabajo con plazo
+ */
+void task_health_begin(health_task_id_t id) {
+    taskENTER_CRITICAL();
+    dm_begin(&monitor, id, health_now_ms());
+    taskEXIT_CRITICAL();
+}
+
+/**
+ * @brief Fin del trabajo en curso
+ */
+void task_health_end(health_task_id_t id) {
+    taskENTER_CRITICAL();
+    dm_end(&monitor, id, health_now_ms());
+    taskEXIT_CRITICAL();
+}
+
+/**
+ * @brief Tarea de FreeRTOS que revisa los plazos y alimenta el watchdog
+ */
+void task_health_task(void *pvParameters) {
+    TickType_t last_wake = xTaskGetTickCount();
+    uint32_t reported = 0;
+
+#if HEALTH_WATCHDOG_ENABLED
+    // Pausado mientras el depurador detiene al núcleo
+    watchdog_enable(HEALTH_WATCHDOG_TIMEOUT_MS, true);
+#endif
+
+    while (1) {
+        vTaskDelayUntil(&last_wake, pdMS_TO_TICKS(HEALTH_CHECK_PERIOD_MS));
+
+        taskENTER_CRITICAL();
+        uint32_t unhealthy = dm_check(&monitor, health_now_ms());
+        taskEXIT_CRITICAL();
+
+        if (unhealthy == 0) {
+#if HEALTH_WATCHDOG_ENABLED
+            watchdog_update();
+#endif
+        } else {
+            // Dejar constancia para el próximo arranque si el watchdog vence
+            watchdog_hw->scratch[0] = HEALTH_SCRATCH_MAGIC | unhealthy;
+        }
+
+        if (unhealthy != reported) {
+            for (int i = 0; i < HEALTH_COUNT; i++) {
+                uint32_t bit = 1u << i;
+                if ((unhealthy & bit) && !(reported & bit)) {
+                    printf("WATCHDOG: tarea %s no cumple su plazo\n", contracts[i].name);
+                } else if (!(unhealthy & bit) && (reported & bit)) {
+                    printf("WATCHDOG: tarea %s recuperada\n", contracts[i].name);
+                }
+            }
+            if (unhealthy == 0) {
+                watchdog_hw->scratch[0] = 0;
+            }
+            reported = unhealthy;
+        }
+    }
+}
+
+/**
+ * @brief Imprime incumplimientos, peor atraso e histogramas
+ */
+void task_health_print(bool json) {
+    taskENTER_CRITICAL();
+    snapshot = monitor;
+    taskEXIT_CRITICAL();
+
+    if (json) {
+        printf("{\"tasks\":[");
+    } else {
+        printf("\n=== PLAZOS DE TAREAS ===\n");
+        printf("%-14s %-4s %6s %8s %6s %8s  %s\n",
+               "Tarea", "Tipo", "Plazo", "Medidos", "Fallas", "PeorAtr",
+               "Histograma ms: <1 <2 <4 <8 <16 <32 <64 >=64");
+    }
+
+    for (int i = 0; i < snapshot.count; i++) {
+        const dm_task_t *t = &snapshot.tasks[i];
+        bool periodic = (t->kind == DM_KIND_PERIODIC);
+
+        if (json) {
+            printf("%s{\"name\":\"%s\",\"kind\":\"%s\",\"period_ms\":%lu,\"tolerance_ms\":%lu,"
+                   "\"count\":%lu,\"misses\":%lu,\"worst_late_ms\":%lu,\"overdue\":%s,\"hist\":[",
+                   (i > 0) ? "," : "", t->name, periodic ? "periodic" : "job",
+                   (unsigned long)t->period_ms, (unsigned long)t->tolerance_ms,
+                   (unsigned long)t->count, (unsigned long)t->misses,
+                   (unsigned long)t->worst_late_ms, t->overdue ? "true" : "false");
+            for (int b = 0; b < DM_HIST_BUCKETS; b++) {
+                printf("%s%lu", (b > 0) ? "," : "", (unsigned long)t->hist[b]);
+            }
+            printf("]}");
+        } else {
+            printf("%-14s %-4s %6lu %8lu %6lu %8lu  ",
+                   t->name, periodic ? "Per" : "Trab", (unsigned long)t->period_ms,
+                   (unsigned long)t->count, (unsigned long)t->misses,
+                   (unsigned long)t->worst_late_ms);
+            for (int b = 0; b < DM_HIST_BUCKETS; b++) {
+                printf(" %lu", (unsigned long)t->hist[b]);
+            }
+            printf("%s\n", t->overdue ? "  VENCIDA" : "");
+        }
+    }
+
+    if (json) {
+        printf("]}\n");
+    } else {
+        printf("Histograma: jitter del latido (Per) o tiempo de respuesta (Trab)\n\n");
+    }
+}
@@ -0,0 +1,91 @@
+/**
+ * @file task_health.h
+ * @brief Vigilancia de plazos de las tareas y watchdog de hardware
+ * @author Sistema de Control de Acceso
+ * @date 2025
+ *
+ * Cada tarea principal declara su contrato temporal en task_health.c y lo
+ * informa con latidos (tareas periódicas) o con el inicio y fin de cada
+ * trabajo (tareas por eventos). La tarea "Health" revisa los plazos cada
+ * HEALTH_CHECK_PERIOD_MS y alimenta el watchdog de hardware solo mientras
+ * todas las tareas cumplen; si alguna queda colgada (por ejemplo en una
+ * transferencia I2C) el equipo se reinicia tras HEALTH_WATCHDOG_TIMEOUT_MS
+ * y al arrancar informa qué tareas habían fallado.
+ */
+
+#ifndef TASK_HEALTH_H
+#define TASK_HEALTH_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/** @brief Período de revisión de plazos */
+#define HEALTH_CHECK_PERIOD_MS      500
+
+/** @brief Tiempo sin alimentar el watchdog antes del reinicio */
+#define HEALTH_WATCHDOG_TIMEOUT_MS  3000
+
+/** @brief Alimentar el watchdog de hardware (0 = solo registrar incumplimientos) */
+#ifndef HEALTH_WATCHDOG_ENABLED
+#define HEALTH_WATCHDOG_ENABLED 1
+#endif
+
+/**
+ * @brief Contratos vigilados
+ */
+typedef enum {
+    HEALTH_KEYPAD,      /**< Paso de la FSM del teclado cada 5 ms mientras está activa */
+    HEALTH_LEDS,        /**< Atención de cada comando o paso de secuencia */
+    HEALTH_DISPLAY,     /**< Dibujo de cada cuadro en el display */
+    HEALTH_CLOCK,       /**< Refresco del reloj cada 1 s en standby */
+    HEALTH_ACCESS,      /**< Atención de cada tecla o evento de control de acceso */
+    HEALTH_COUNT
+} health_task_id_t;
+
+/**
+ * @brief Registra los contratos e informa si el último reinicio fue del watchdog
+ *
+ * @return true si la inicialización fue exitosa
+ */
+bool task_health_init(void);
+
+/**
+ * @brief Comienzo de la actividad periódica de una tarea
+ */
+void task_health_start(health_task_id_t id);
+
+/**
+ * @brief Latido de una tarea periódica
+ */
+void task_health_heartbeat(health_task_id_t id);
+
+/**
+ * @brief La tarea va a bloquearse sin plazo
+ */
+void task_health_idle(health_task_id_t id);
+
+/**
+ * @brief Comienzo de un trabajo con plazo
+ */
+void task_health_begin(health_task_id_t id);
+
+/**
+ * @brief Fin del trabajo en curso
+ */
+void task_health_end(health_task_id_t id);
+
+/**
+ * @brief Tarea de FreeRTOS que revisa los plazos y alimenta el watchdog
+ *
+ * @param pvParameters Parámetros de la tarea (no utilizados)
+ */
+void task_health_task(void *pvParameters);
+
+/**
+ * @brief Imprime incumplimientos, peor atraso e histogramas
+ *
+ * @param json true para una línea JSON, false para una tabla legible
+ */
+void task_health_print(bool json);
+
+#endif // TASK_HEALTH_H
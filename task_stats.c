@@ -0,0 +1,145 @@
+/**
+ * @file task_stats.c
+ * @brief Implementación de las estadísticas de ejecución por tarea
+ * @author Sistema de Control de Acceso
+ * @date 2025
+ */
+
+#include "task_stats.h"
+#include <stdio.h>
+#include "pico/stdlib.h"
+#include "FreeRTOS.h"
+#include "task.h"
+
+/** @brief Cambios de contexto por número de seguimiento (0 = otras tareas) */
+static volatile uint32_t switch_counts[TASK_STATS_MAX_TASKS];
+
+/** @brief Último número de seguimiento asignado */
+static UBaseType_t last_task_number = 0;
+
+/** @brief Tiempo de ejecución de cada tarea en la consulta anterior */
+static struct {
+    TaskHandle_t handle;
+    configRUN_TIME_COUNTER_TYPE runtime;
+} last_runtime[TASK_STATS_MAX_TASKS];
+
+/** @brief Número de entradas válidas en last_runtime */
+static UBaseType_t last_runtime_count;
+
+/** @brief Tiempo total en la consulta anterior */
+static configRUN_TIME_COUNTER_TYPE last_total_runtime;
+
+/** @brief Instantánea del estado de las tareas (estática para no usar stack) */
+static TaskStatus_t task_status[TASK_STATS_MAX_TASKS];
+
+/**
+ * @brief Contador de tiempo de ejecución para FreeRTOS (1 MHz)
+ */
+configRUN_TIME_COUNTER_TYPE task_stats_timer_us(void) {
+    return time_us_64();
+}
+
+/**
+ * @brief Hook de cambio de contexto
+ */
+void task_stats_switched_in(void) {
+    TaskHandle_t current = xTaskGetCurrentTaskHandle();
+    UBaseType_t n = uxTaskGetTaskNumber(current);
+    
+    // Asignar número de seguimiento en la primera ejecución de la tarea
+    if (n == 0 && last_task_number + 1 < TASK_STATS_MAX_TASKS) {
+        n = ++last_task_number;
+        vTaskSetTaskNumber(current, n);
+    }
+    
+    if (n >= TASK_STATS_MAX_TASKS) {
+        n = 0;
+    }
+    switch_counts[n]++;
+}
+
+#if configSUPPORT_DYNAMIC_ALLOCATION
+#define task_stats_heap_free()      xPortGetFreeHeapSize()
+#define task_stats_heap_min_free()  xPortGetMinimumEverFreeHeapSize()
+#else
+/* Asignación estática: no hay heap de FreeRTOS */
+#define task_stats_heap_free()      0u
+#define task_stats_heap_min_free()  0u
+#endif
+
+/**
+ * @brief Tiempo de ejecución de una tarea en la consulta anterior
+ * 
+ * @return Tiempo previo, o 0 si la tarea se creó después de esa consulta
+ */
+static configRUN_TIME_COUNTER_TYPE previous_runtime(TaskHandle_t handle) {
+    for (UBaseType_t i = 0; i < last_runtime_count; i++) {
+        if (last_runtime[i].handle == handle) {
+            return last_runtime[i].runtime;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Imprime las estadísticas por la salida estándar
+ */
+void task_stats_print(bool json) {
+    configRUN_TIME_COUNTER_TYPE total_runtime;
+    UBaseType_t count = uxTaskGetSystemState(task_status, TASK_STATS_MAX_TASKS, &total_runtime);
+    configRUN_TIME_COUNTER_TYPE interval = total_runtime - last_total_runtime;
+    
+    if (interval == 0) {
+        interval = 1;
+    }
+    
+    if (json) {
+        printf("{\"fw\":\"%s\",\"uptime_us\":%llu,\"interval_us\":%llu,"
+               "\"heap_free\":%u,\"heap_min_free\":%u,\"tasks\":[",
+               FIRMWARE_VERSION, (unsigned long long)total_runtime,
+               (unsigned long long)interval,
+               (unsigned)task_stats_heap_free(), (unsigned)task_stats_heap_min_free());
+    } else {
+        printf("\n=== ESTADÍSTICAS DE TAREAS (intervalo %llu ms) ===\n",
+               (unsigned long long)(interval / 1000));
+        printf("%-14s %4s %8s %10s %8s\n", "Tarea", "Prio", "CPU%", "Cambios", "StackLib");
+    }
+    
+    for (UBaseType_t i = 0; i < count; i++) {
+        const TaskStatus_t *t = &task_status[i];
+        UBaseType_t n = uxTaskGetTaskNumber(t->xHandle);
+        configRUN_TIME_COUNTER_TYPE delta = t->ulRunTimeCounter - previous_runtime(t->xHandle);
+        
+        uint32_t cpu_x100 = (uint32_t)((delta * 10000u) / interval);
+        uint32_t switches = (n > 0 && n < TASK_STATS_MAX_TASKS) ? switch_counts[n] : 0;
+        
+        if (json) {
+            printf("%s{\"name\":\"%s\",\"prio\":%u,\"cpu_pct_x100\":%lu,\"runtime_us\":%llu,"
+                   "\"switches\":%lu,\"stack_hwm_words\":%u}",
+                   (i > 0) ? "," : "", t->pcTaskName, (unsigned)t->uxCurrentPriority,
+                   (unsigned long)cpu_x100, (unsigned long long)t->ulRunTimeCounter,
+                   (unsigned long)switches, (unsigned)t->usStackHighWaterMark);
+        } else {
+            printf("%-14s %4u %5lu.%02lu %10lu %8u\n",
+                   t->pcTaskName, (unsigned)t->uxCurrentPriority,
+                   (unsigned long)(cpu_x100 / 100), (unsigned long)(cpu_x100 % 100),
+                   (unsigned long)switches, (unsigned)t->usStackHighWaterMark);
+        }
+    }
+    
+    if (json) {
+        printf("]}\n");
+    } else {
+        printf("Heap libre: %u bytes (mínimo histórico: %u bytes)\n",
+               (unsigned)task_stats_heap_free(), (unsigned)task_stats_heap_min_free());
+        printf("StackLib = marca de agua mínima de stack libre en palabras\n\n");
+    }
+    
+    // Guardar la instantánea para calcular el próximo intervalo
+    for (UBaseType_t i = 0; i < count; i++) {
+        last_runtime[i].handle = task_status[i].xHandle;
+        last_runtime[i].runtime = task_status[i].ulRunTimeCounter;
+    }
+    last_runtime_count = count;
+    last_total_runtime = total_runtime;
+}
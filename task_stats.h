@@ -0,0 +1,47 @@
+/**
+ * @file task_stats.h
+ * @brief Estadísticas de ejecución por tarea para el sistema de control de acceso
+ * @author Sistema de Control de Acceso
+ * @date 2025
+ * 
+ * Recolecta, por tarea, el uso de CPU (medido con el temporizador de 1 MHz),
+ * el número de cambios de contexto y la marca de agua del stack, además del
+ * mínimo histórico de heap libre. Los datos se consultan por la consola USB
+ * en formato de tabla o en una línea JSON para seguimiento entre versiones.
+ */
+
+#ifndef TASK_STATS_H
+#define TASK_STATS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "FreeRTOS.h"
+#include "task.h"
+
+/** @brief Número máximo de tareas seguidas (las que excedan se agrupan en "otras") */
+#define TASK_STATS_MAX_TASKS 12
+
+/** @brief Versión de firmware reportada junto a las estadísticas */
+#ifndef FIRMWARE_VERSION
+#define FIRMWARE_VERSION "desconocida"
+#endif
+
+/**
+ * @brief Hook de cambio de contexto (llamado desde traceTASK_SWITCHED_IN)
+ * 
+ * La primera vez que una tarea entra en ejecución se le asigna un número
+ * de seguimiento (vTaskSetTaskNumber) para contar sus cambios de contexto.
+ */
+void task_stats_switched_in(void);
+
+/**
+ * @brief Imprime las estadísticas por la salida estándar
+ * 
+ * El uso de CPU se calcula sobre el intervalo transcurrido desde la
+ * consulta anterior (o desde el arranque en la primera consulta).
+ * 
+ * @param json true para una línea JSON, false para una tabla legible
+ */
+void task_stats_print(bool json);
+
+#endif // TASK_STATS_H
@@ -0,0 +1,338 @@
+/**
+ * @file time_service.c
+ * @brief Implementación del servicio de fecha y hora respaldado por RTC
+ * @author Sistema de Control de Acceso
+ * @date 2025
+ *
+ * La hora se lee del RTC solo al fijarla o para recuperarse de un atraso
+ * grande. En operación normal avanza segundo a segundo incrementando los
+ * dígitos ASCII de las cadenas ya formateadas.
+ */
+
+#include "time_service.h"
+#include <stdio.h>
+#include "pico/stdlib.h"
+#include "hardware/rtc.h"
+#include "FreeRTOS.h"
+#include "task.h"
+
+/** @brief Atraso máximo (en segundos) que se recupera avanzando dígitos */
+#define TIME_SERVICE_MAX_CATCHUP_S 60
+
+/** @brief Fecha por defecto si el RTC no estaba corriendo (27/07/2025) */
+static const datetime_t default_datetime = {
+    .year = 2025, .month = 7, .day = 27, .dotw = 0,
+    .hour = 0, .min = 0, .sec = 0
+};
+
+/** @brief Días por mes (febrero se ajusta en años bisiestos) */
+static const uint8_t days_in_month[13] = {
+    0, 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31
+};
+
+/** @brief Fecha y hora actual en forma descompuesta */
+static datetime_t now_dt;
+
+/** @brief Fecha formateada "DD/MM/YY" */
+static char date_str[9] = "00/00/00";
+
+/** @brief Hora formateada "HH:MM:SS" */
+static char time_str[9] = "00:00:00";
+
+/** @brief Tick en que comenzó el segundo actual */
+static TickType_t second_start_tick;
+
+/** @brief Campos cambiados por time_service_set aún no informados */
+static uint32_t pending_changed;
+
+/** @brief Suscriptores registrados */
+static struct {
+    time_service_callback_t callback;
+    void *ctx;
+} subscribers[TIME_SERVICE_MAX_SUBSCRIBERS];
+
+/**
+ * @brief Escribe un valor de 0 a 99 como dos dígitos ASCII
+ *
+ * Solo se usa al fijar la hora, nunca en el avance por segundo.
+ */
+static void put_two_digits(char *dst, int value) {
+    dst[0] = '0' + (value / 10);
+    dst[1] = '0' + (value % 10);
+}
+
+/**
+ * @brief Incrementa un campo de dos dígitos ASCII en uno
+ */
+static void inc_two_digits(char *dst) {
+    if (++dst[1] > '9') {
+        dst[1] = '0';
+        dst[0]++;
+    }
+}
+
+/**
+ * @brief Días del mes actual considerando años bisiestos (2000-2099)
+ */
+static uint8_t current_month_days(void) {
+    if (now_dt.month == 2 && (now_dt.year & 3) == 0) {
+        return 29;
+    }
+    return days_in_month[now_dt.month];
+}
+
+/**
+ * @brief Avanza la fecha y hora exactamente un segundo
+ *
+ * @return uint32_t Máscara de campos que cambiaron
+ */
+static uint32_t advance_one_second(void) {
+    uint32_t changed = TIME_FIELD_SEC;
+
+    if (++now_dt.sec < 60) {
+        inc_two_digits(&time_str[6]);
+        return changed;
+    }
+    now_dt.sec = 0;
+    time_str[6] = '0';
+    time_str[7] = '0';
+    changed |= TIME_FIELD_MIN;
+
+    if (++now_dt.min < 60) {
+        inc_two_digits(&time_str[3]);
+        return changed;
+    }
+    now_dt.min = 0;
+    time_str[3] = '0';
+    time_str[4] = '0';
+    changed |= TIME_FIELD_HOUR;
+
+    if (++now_dt.hour < 24) {
+        inc_two_digits(&time_str[0]);
+        return changed;
+    }
+    now_dt.hour = 0;
+    time_str[0] = '0';
+    time_str[1] = '0';
+    changed |= TIME_FIELD_DAY;
+    now_dt.dotw = (now_dt.dotw == 6) ? 0 : now_dt.dotw + 1;
+
+    if (++now_dt.day <= current_month_days()) {
+        inc_two_digits(&date_str[0]);
+        return changed;
+    }
+    now_dt.day = 1;
+    date_str[0] = '0';
+    date_str[1] = '1';
+    changed |= TIME_FIELD_MONTH;
+
+    if (++now_dt.month <= 12) {
+        inc_two_digits(&date_str[3]);
+        return changed;
+    }
+    now_dt.month = 1;
+    date_str[3] = '0';
+    date_str[4] = '1';
+    changed |= TIME_FIELD_YEAR;
+
+    now_dt.year++;
+    if (date_str[6] == '9' && date_str[7] == '9') {
+        date_str[6] = '0';
+        date_str[7] = '0';
+    } else {
+        inc_two_digits(&date_str[6]);
+    }
+    return changed;
+}
+
+/**
+ * @brief Carga la fecha y hora completas y reformatea las cadenas
+ */
+static void load_datetime(const datetime_t *dt) {
+    now_dt = *dt;
+
+    put_two_digits(&date_str[0], dt->day);
+    put_two_digits(&date_str[3], dt->month);
+    put_two_digits(&date_str[6], dt->year % 100);
+    put_two_digits(&time_str[0], dt->hour);
+    put_two_digits(&time_str[3], dt->min);
+    put_two_digits(&time_str[6], dt->sec);
+
+    second_start_tick = xTaskGetTickCount();
+}
+
+/**
+ * @brief Invoca a todos los suscriptores con la máscara de cambios
+ */
+static void notify_subscribers(uint32_t changed) {
+    for (int i = 0; i < TIME_SERVICE_MAX_SUBSCRIBERS; i++) {
+        if (subscribers[i].callback != NULL) {
+            subscribers[i].callback(changed, subscribers[i].ctx);
+        }
+    }
+}
+
+/**
+ * @brief Día de la semana de una fecha (algoritmo de Sakamoto)
+ */
+int time_service_day_of_week(int year, int month, int day) {
+    static const uint8_t month_offset[12] = { 0, 3, 2, 5, 0, 3, 5, 1, 4, 6, 2, 4 };
+
+    if (month < 1 || month > 12) {
+        return -1;
+    }
+    if (month < 3) {
+        year--;
+    }
+    return (year + year / 4 - year / 100 + year / 400 + month_offset[month - 1] + day) % 7;
+}
+
+/**
+ * @brief Verifica que todos los campos de una fecha estén en rango
+ */
+static bool datetime_is_valid(const datetime_t *dt) {
+    if (dt->year < 2000 || dt->year > 2099 || dt->month < 1 || dt->month > 12) {
+        return false;
+    }
+
+    uint8_t max_day = days_in_month[dt->month];
+    if (dt->month == 2 && (dt->year & 3) == 0) {
+        max_day = 29;
+    }
+
+    return dt->day >= 1 && dt->day <= max_day &&
+           dt->dotw >= 0 && dt->dotw <= 6 &&
+           dt->hour >= 0 && dt->hour <= 23 &&
+           dt->min >= 0 && dt->min <= 59 &&
+           dt->sec >= 0 && dt->sec <= 59;
+}
+
+/**
+ * @brief Inicializa el servicio de tiempo
+ */
+bool time_service_init(void) {
+    datetime_t dt;
+
+    // El RTC conserva la hora tras un reinicio por software; solo se
+    // inicializa (y se pierde la hora) si no estaba corriendo
+    if (rtc_running() && rtc_get_datetime(&dt) && datetime_is_valid(&dt)) {
+        load_datetime(&dt);
+        printf("Hora tomada del RTC: %s %s\n", date_str, time_str);
+        return true;
+    }
+
+    rtc_init();
+    if (!rtc_set_datetime(&default_datetime)) {
+        return false;
+    }
+    // El RTC necesita algunos ciclos de su reloj para aplicar la escritura
+    sleep_us(64);
+
+    load_datetime(&default_datetime);
+    printf("RTC sin hora - usando fecha por defecto %s %s\n", date_str, time_str);
+    return true;
+}
+
+/**
+ * @brief Fija la fecha y hora actuales (y las escribe en el RTC)
+ */
+bool time_service_set(const datetime_t *dt) {
+    if (dt == NULL || !datetime_is_valid(dt)) {
+        return false;
+    }
+
+    if (!rtc_set_datetime(dt)) {
+        return false;
+    }
+
+    // Todos los campos cambiaron: los informa el próximo avance, que es lo
+    // que consulta el display para decidir qué redibujar
+    taskENTER_CRITICAL();
+    load_datetime(dt);
+    pending_changed = TIME_FIELD_ALL;
+    taskEXIT_CRITICAL();
+    return true;
+}
+
+/**
+ * @brief Avanza el reloj según el tiempo transcurrido desde la última llamada
+ */
+uint32_t time_service_update(void) {
+    const TickType_t one_second = pdMS_TO_TICKS(1000);
+    TickType_t now = xTaskGetTickCount();
+    uint32_t changed;
+    uint32_t steps = 0;
+
+    taskENTER_CRITICAL();
+    changed = pending_changed;
+    pending_changed = 0;
+    while ((TickType_t)(now - second_start_tick) >= one_second &&
+           steps < TIME_SERVICE_MAX_CATCHUP_S) {
+        changed |= advance_one_second();
+        second_start_tick += one_second;
+        steps++;
+    }
+    taskEXIT_CRITICAL();
+
+    // Atraso demasiado grande para recuperarlo segundo a segundo:
+    // resincronizar desde el RTC de hardware
+    if ((TickType_t)(now - second_start_tick) >= one_second) {
+        datetime_t dt;
+        if (rtc_get_datetime(&dt) && datetime_is_valid(&dt)) {
+            taskENTER_CRITICAL();
+            load_datetime(&dt);
+            taskEXIT_CRITICAL();
+            changed = TIME_FIELD_ALL;
+        }
+    }
+
+    if (changed) {
+        notify_subscribers(changed);
+    }
+    return changed;
+}
+
+/**
+ * @brief Cadena de fecha actual "DD/MM/YY"
+ */
+const char *time_service_date_str(void) {
+    return date_str;
+}
+
+/**
+ * @brief Cadena de hora actual "HH:MM:SS"
+ */
+const char *time_service_time_str(void) {
+    return time_str;
+}
+
+/**
+ * @brief Obtiene la fecha y hora actual en forma descompuesta
+ */
+void time_service_get(datetime_t *dt) {
+    if (dt == NULL) {
+        return;
+    }
+
+    taskENTER_CRITICAL();
+    *dt = now_dt;
+    taskEXIT_CRITICAL();
+}
+
+/**
+ * @brief Registra un suscriptor de cambios de fecha/hora
+ */
+bool time_service_subscribe(time_service_callback_t callback, void *ctx) {
+    if (callback == NULL) {
+        return false;
+    }
+
+    for (int i = 0; i < TIME_SERVICE_MAX_SUBSCRIBERS; i++) {
+        if (subscribers[i].callback == NULL) {
+            subscribers[i].ctx = ctx;
+            subscribers[i].callback = callback;
+            return true;
+        }
+    }
+    return false;
+}
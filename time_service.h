@@ -0,0 +1,119 @@
+/**
+ * @file time_service.h
+ * @brief Servicio de fecha y hora respaldado por el RTC del RP2040
+ * @author Sistema de Control de Acceso
+ * @date 2025
+ *
+ * Mantiene la fecha y hora en forma descompuesta y ya formateada
+ * ("DD/MM/YY" y "HH:MM:SS"). La hora se fija una sola vez desde el RTC de
+ * hardware o desde la consola USB y luego avanza incrementando dígitos, sin
+ * divisiones ni snprintf en cada segundo. Los suscriptores solo reciben
+ * los campos que cambiaron.
+ */
+
+#ifndef TIME_SERVICE_H
+#define TIME_SERVICE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "pico/util/datetime.h"
+
+/**
+ * @brief Campos de fecha/hora que pueden cambiar en un avance
+ */
+typedef enum {
+    TIME_FIELD_SEC   = (1u << 0),   /**< Segundos */
+    TIME_FIELD_MIN   = (1u << 1),   /**< Minutos */
+    TIME_FIELD_HOUR  = (1u << 2),   /**< Horas */
+    TIME_FIELD_DAY   = (1u << 3),   /**< Día del mes */
+    TIME_FIELD_MONTH = (1u << 4),   /**< Mes */
+    TIME_FIELD_YEAR  = (1u << 5),   /**< Año */
+    TIME_FIELD_ALL   = 0x3F         /**< Todos los campos (tras fijar la hora) */
+} time_field_t;
+
+/** @brief Número máximo de suscriptores del servicio */
+#define TIME_SERVICE_MAX_SUBSCRIBERS 4
+
+/**
+ * @brief Callback de notificación de cambios
+ *
+ * @param changed Máscara de campos (time_field_t) que cambiaron
+ * @param ctx Contexto entregado al suscribirse
+ */
+typedef void (*time_service_callback_t)(uint32_t changed, void *ctx);
+
+/**
+ * @brief Inicializa el servicio de tiempo
+ *
+ * Si el RTC ya está corriendo toma la hora de él; de lo contrario lo
+ * inicializa con una fecha por defecto hasta que se fije desde la consola.
+ *
+ * @return true Si la inicialización fue exitosa
+ * @return false Si hubo error al configurar el RTC
+ */
+bool time_service_init(void);
+
+/**
+ * @brief Fija la fecha y hora actuales (y las escribe en el RTC)
+ *
+ * El próximo time_service_update() devuelve (y notifica) TIME_FIELD_ALL,
+ * así que quien redibuja según la máscara actualiza fecha y hora.
+ *
+ * @param dt Fecha y hora a establecer (año completo, p. ej. 2025); dotw
+ *           debe corresponder a la fecha (ver time_service_day_of_week)
+ * @return true Si la fecha es válida y se aplicó
+ * @return false Si algún campo está fuera de rango
+ */
+bool time_service_set(const datetime_t *dt);
+
+/**
+ * @brief Avanza el reloj según el tiempo transcurrido desde la última llamada
+ *
+ * Se llama periódicamente (típicamente cada segundo) desde una tarea.
+ * Avanza un segundo por cada período de tick completo transcurrido y
+ * notifica a los suscriptores. Tras time_service_set() la máscara es
+ * TIME_FIELD_ALL.
+ *
+ * @return uint32_t Máscara de campos (time_field_t) que cambiaron
+ */
+uint32_t time_service_update(void);
+
+/**
+ * @brief Día de la semana de una fecha del calendario gregoriano
+ *
+ * @param year Año completo (p. ej. 2025)
+ * @param month Mes (1-12)
+ * @param day Día del mes (1-31)
+ * @return int 0 = domingo ... 6 = sábado, como datetime_t.dotw; -1 si el
+ *             mes está fuera de rango (time_service_set lo rechaza)
+ */
+int time_service_day_of_week(int year, int month, int day);
+
+/**
+ * @brief Cadena de fecha actual "DD/MM/YY" (terminada en nulo)
+ */
+const char *time_service_date_str(void);
+
+/**
+ * @brief Cadena de hora actual "HH:MM:SS" (terminada en nulo)
+ */
+const char *time_service_time_str(void);
+
+/**
+ * @brief Obtiene la fecha y hora actual en forma descompuesta
+ *
+ * @param dt Puntero donde copiar la fecha y hora
+ */
+void time_service_get(datetime_t *dt);
+
+/**
+ * @brief Registra un suscriptor de cambios de fecha/hora
+ *
+ * @param callback Función a invocar con la máscara de campos cambiados
+ * @param ctx Contexto opcional para el callback
+ * @return true Si se registró el suscriptor
+ * @return false Si no quedan espacios libres
+ */
+bool time_service_subscribe(time_service_callback_t callback, void *ctx);
+
+#endif // TIME_SERVICE_H
@@ -0,0 +1,128 @@
+#!/usr/bin/env python3
+"""
+Consulta las estadísticas de acceso exportadas por el firmware.
+
+Lee la línea JSON de "access json" (access_report.c) desde una captura de la
+consola USB o stdin y responde sin reprocesar el log: accesos por hora,
+hora pico, IDs más negados, cuantiles de duración de sesión y la estimación
+del count-min sketch para cualquier ID (mismo hash que access_stats.c).
+
+Uso: access_stats.py [captura.txt] [--hours N] [--id ID ...] [--quantile P ...]
+"""
+
+import argparse
+import datetime
+import json
+import sys
+
+OUTCOMES = ["granted", "denied", "blocked", "limited"]
+
+# Época de las horas absolutas (as_abs_hour)
+EPOCH = datetime.datetime(2000, 1, 1)
+
+
+def find_export(lines):
+    """Última exportación de la captura (puede haber varias)."""
+    found = None
+    for line in lines:
+        line = line.strip()
+        if line.startswith('{"now_hour"'):
+            found = json.loads(line)
+    return found
+
+
+def hour_label(abs_hour):
+    return (EPOCH + datetime.timedelta(hours=abs_hour)).strftime("%Y-%m-%d %H:00")
+
+
+def id_hash(user_id):
+    """FNV-1a de 32 bits, como id_hash() en access_stats.c."""
+    h = 2166136261
+    for b in user_id.encode():
+        h ^= b
+        h = (h * 16777619) & 0xFFFFFFFF
+    return h
+
+
+def cms_estimate(cms, user_id):
+    """Negaciones estimadas de un ID: mínimo de sus contadores (cota superior)."""
+    width = len(cms[0])
+    h = id_hash(user_id)
+    h2 = (h >> 16) | 1
+    return min(row[(h + i * h2) & 0xFFFFFFFF & (width - 1)] for i, row in enumerate(cms))
+
+
+def session_quantile(sessions, permille):
+    """Cuantil interpolado dentro de la cubeta, como as_session_quantile()."""
+    count = sessions["count"]
+    if count == 0:
+        return 0
+    permille = min(permille, 1000)
+    rank = max(1, (count * permille + 999) // 1000)
+    floors, hist = sessions["floors_ms"], sessions["hist"]
+    lo_clamp, hi_clamp = sessions["min_ms"], sessions["max_ms"]
+
+    seen = 0
+    for b, n in enumerate(hist):
+        if n == 0 or seen + n < rank:
+            seen += n
+            continue
+        lo = max(floors[b], lo_clamp)
+        hi = min(floors[b + 1] if b + 1 < len(floors) else hi_clamp, hi_clamp)
+        hi = max(hi, lo)
+        return lo + (hi - lo) * (rank - seen) // n
+    return hi_clamp
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[1])
+    parser.add_argument("capture", nargs="?", help="captura de la consola (por defecto stdin)")
+    parser.add_argument("--hours", type=int, default=24, help="horas a listar (por defecto 24)")
+    parser.add_argument("--id", action="append", default=[], help="ID a estimar en el sketch")
+    parser.add_argument("--quantile", type=float, action="append", default=[],
+                        help="cuantil de sesión en %% (por defecto 50, 90 y 99)")
+    args = parser.parse_args()
+
+    if args.capture:
+        with open(args.capture, encoding="utf-8", errors="replace") as f:
+            data = find_export(f)
+    else:
+        data = find_export(sys.stdin)
+    if data is None:
+        sys.exit("no se encontró la salida de 'access json' en la captura")
+
+    totals = data["totals"]
+    print("Totales: " + ", ".join(f"{totals[o]} {o}" for o in OUTCOMES))
+
+    first = data["now_hour"] - args.hours + 1
+    hours = [h for h in data["hours"] if h[0] >= first]
+    print(f"\nÚltimas {args.hours} horas:")
+    print(f"{'Hora':<17}" + "".join(f"{o:>9}" for o in OUTCOMES))
+    for h in hours:
+        print(f"{hour_label(h[0]):<17}" + "".join(f"{n:>9}" for n in h[1:]))
+    if hours:
+        busiest = max(hours, key=lambda h: sum(h[1:]))
+        print(f"Hora con más intentos: {hour_label(busiest[0])} ({sum(busiest[1:])})")
+
+    by_hour = data["hour_of_day"]
+    if any(by_hour):
+        peak = max(range(24), key=lambda h: by_hour[h])
+        print(f"Hora pico del día: {peak:02d}:00 ({by_hour[peak]} intentos desde el arranque)")
+
+    print("\nIDs más negados (estimación del sketch):")
+    for entry in sorted(data["top_denied"], key=lambda e: -e["estimate"]):
+        print(f"  {entry['id']}  {entry['estimate']}")
+    for user_id in args.id:
+        print(f"  {user_id}  {cms_estimate(data['cms'], user_id)}  (consultado)")
+
+    sessions = data["sessions"]
+    print(f"\nSesiones: {sessions['count']}")
+    if sessions["count"]:
+        print(f"  promedio {sessions['sum_ms'] / sessions['count']:.0f} ms, "
+              f"mín. {sessions['min_ms']} ms, máx. {sessions['max_ms']} ms")
+        for q in args.quantile or [50, 90, 99]:
+            print(f"  p{q:g}: {session_quantile(sessions, round(q * 10))} ms")
+
+
+if __name__ == "__main__":
+    main()
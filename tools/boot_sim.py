@@ -0,0 +1,163 @@
+#!/usr/bin/env python3
+"""
+Simulación en el host del orden de arranque del firmware.
+
+Modela los pasos de main() y el trabajo inicial de cada tarea con costos
+estimados (I2C a la frecuencia del display, printf por USB, enumeración USB)
+y calcula, para el arranque normal y el rápido (FAST_BOOT), el instante de
+cada fase con los mismos nombres que reporta el comando de consola "boot".
+Con --measured se compara contra la salida de "boot json" del equipo.
+
+Uso: boot_sim.py [--i2c-khz 400] [--usb-enum-ms 900] [--measured boot.json]
+"""
+
+import argparse
+import json
+
+# Prioridades de las tareas (main_rtos.c)
+PRIO = {"Keypad": 4, "AccessControl": 3, "Exec": 2, "Console": 1, "Log": 1}
+
+# Bytes de la secuencia de inicialización del SSD1306 y del cuadro completo
+SSD1306_INIT_CMDS = 26
+SSD1306_FRAME_BYTES = 1 + 4 * 128
+SSD1306_ADDR_CMDS = 6
+
+
+class Costs:
+    """Costos estimados en microsegundos."""
+
+    def __init__(self, i2c_khz, usb_enum_ms):
+        self.i2c_khz = i2c_khz
+        self.usb_enum_us = usb_enum_ms * 1000
+        self.stdio_init = 1500          # stdio_init_all() con TinyUSB
+        self.printf_connected = 120     # una línea por USB con la terminal abierta
+        self.printf_offline = 15        # una línea sin terminal (se descarta)
+        self.gpio_init = 40             # configuración de un módulo de GPIO
+        self.rtos_object = 10           # creación de una cola/tarea
+        self.rtc_init = 200             # rtc_init + espera de escritura
+
+    def i2c(self, transactions, bytes_per_transaction):
+        """Duración de transacciones I2C (dirección + datos + start/stop)."""
+        bits = (bytes_per_transaction + 1) * 9 + 2
+        return transactions * (bits * 1000.0 / self.i2c_khz + 10)
+
+
+def legacy_main(c):
+    """Pasos de main() antes de FAST_BOOT: (fase o None, costo)."""
+    p = c.printf_connected
+    display = (c.i2c(SSD1306_INIT_CMDS, 1) + c.rtos_object
+               + c.i2c(SSD1306_ADDR_CMDS, 1) + c.i2c(1, SSD1306_FRAME_BYTES))
+    return [
+        ("main", 0),
+        ("stdio", c.stdio_init),
+        (None, 3000000),                    # sleep_ms(3000)
+        (None, 10 * p),                     # banner
+        (None, c.rtos_object + p),          # log + base de datos
+        (None, c.gpio_init + c.rtos_object + p),    # LEDs
+        (None, c.rtc_init + 2 * p),         # RTC
+        ("salidas", display + p),           # display completo por I2C
+        ("teclado", c.gpio_init + 3 * c.rtos_object + 10 * p),
+        ("acceso", 2 * c.rtos_object + 2 * p),
+        ("servicios", 3 * p + 8 * p),       # consola, bajo consumo, usuarios
+        ("scheduler", 6 * (c.rtos_object + p)),
+    ]
+
+
+def fast_main(c):
+    """Pasos de main() con FAST_BOOT (terminal todavía sin conectar)."""
+    p = c.printf_offline
+    return [
+        ("main", 0),
+        ("stdio", c.stdio_init),
+        (None, c.rtos_object + p),
+        ("salidas", c.gpio_init + 2 * c.rtos_object + 2 * p),
+        ("teclado", c.gpio_init + 3 * c.rtos_object + 10 * p),
+        ("acceso", 2 * c.rtos_object + 2 * p),
+        ("servicios", c.rtc_init + 3 * p),
+        ("scheduler", 6 * (c.rtos_object + p)),
+    ]
+
+
+def task_work(c, fast):
+    """Trabajo inicial de cada tarea antes de bloquearse: (tarea, fase, costo)."""
+    standby = c.i2c(1 if fast else SSD1306_ADDR_CMDS, SSD1306_ADDR_CMDS if fast else 1) \
+        + c.i2c(1, SSD1306_FRAME_BYTES)
+    display = standby + (c.i2c(1, SSD1306_INIT_CMDS) if fast else 0)
+    return [
+        ("AccessControl", None, 20),
+        ("Keypad", "acepta_teclas", 20),
+        ("Exec", None, 30),                 # corrutina de LEDs
+        ("Exec", "display", display),       # corrutina del display, en la misma ronda
+        ("Console", None, 10),
+        ("Log", None, 10),
+    ]
+
+
+def simulate(c, fast):
+    """Devuelve {fase: us} para un modo de arranque."""
+    t = 0.0
+    phases = {}
+    for phase, cost in (fast_main(c) if fast else legacy_main(c)):
+        t += cost
+        if phase:
+            phases[phase] = t
+
+    # Un solo núcleo: todas las tareas quedan listas a la vez y corren su
+    # trabajo inicial en orden de prioridad (FIFO entre iguales)
+    console_start = None
+    for task, phase, cost in sorted(task_work(c, fast), key=lambda w: -PRIO[w[0]]):
+        if task == "Console":
+            console_start = t
+        t += cost
+        if phase:
+            phases[phase] = t
+
+    # La consola consulta la conexión desde su inicio, primero a los 250 ms
+    # y duplicando la espera hasta 8 s (CONSOLE_USB_POLL_MS/_MAX_MS)
+    connected = max(c.usb_enum_us, console_start)
+    poll, wait = console_start, 250000
+    while poll < connected:
+        poll += wait
+        wait = min(wait * 2, 8000000)
+    phases["usb"] = poll
+    return phases
+
+
+def print_timeline(title, phases, measured=None):
+    print("\n=== %s ===" % title)
+    header = "%-14s %12s" % ("Fase", "Simulado ms")
+    if measured:
+        header += " %12s" % "Medido ms"
+    print(header)
+    for name, t in sorted(phases.items(), key=lambda kv: kv[1]):
+        line = "%-14s %12.3f" % (name, t / 1000.0)
+        if measured and name in measured:
+            line += " %12.3f" % (measured[name] / 1000.0)
+        print(line)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[1])
+    parser.add_argument("--i2c-khz", type=float, default=400)
+    parser.add_argument("--usb-enum-ms", type=float, default=900)
+    parser.add_argument("--measured", help="salida de 'boot json' del equipo")
+    args = parser.parse_args()
+
+    costs = Costs(args.i2c_khz, args.usb_enum_ms)
+    measured, measured_fast = None, True
+    if args.measured:
+        with open(args.measured, encoding="utf-8") as f:
+            report = json.loads(f.read().strip().splitlines()[-1])
+        measured, measured_fast = report["phases_us"], bool(report["fast_boot"])
+
+    legacy = simulate(costs, fast=False)
+    fast = simulate(costs, fast=True)
+    print_timeline("Arranque normal", legacy, None if measured_fast else measured)
+    print_timeline("Arranque rápido (FAST_BOOT)", fast, measured if measured_fast else None)
+
+    print("\nAcepta teclas: %.1f ms -> %.1f ms" % (legacy["acepta_teclas"] / 1000.0,
+                                                  fast["acepta_teclas"] / 1000.0))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,329 @@
+/**
+ * @file coop_sim.c
+ * @brief Simulación en el host del planificador cooperativo de corrutinas
+ * @author Sistema de Control de Acceso
+ * @date 2025
+ *
+ * Enlaza el mismo coop.c del firmware con un reloj simulado y reproduce la
+ * carga del ejecutor: una corrutina de LEDs (pasos de secuencia y comandos
+ * breves), una de display (reloj cada segundo y cuadros de ~14 ms por
+ * comando) y, opcionalmente, corrutinas que siempre ceden el turno con
+ * CO_YIELD para forzar el peor caso de reparto.
+ *
+ * Verifica en cada ronda que:
+ * - cada corrutina lista al comenzar la ronda corre exactamente una vez y
+ *   ninguna otra corre;
+ * - la ronda empieza por la primera corrutina lista a partir del cursor,
+ *   que avanza una posición por ronda;
+ * y al final que las corrutinas que siempre ceden recibieron los mismos
+ * turnos (±1) y que el atraso de las esperas con plazo y la latencia de
+ * las señales no superan una y dos rondas respectivamente.
+ *
+ * Compilar y ejecutar desde la raíz del proyecto:
+ *
+ *     cc -std=c11 -O2 -I. tools/coop_sim.c coop.c -lm -o coop_sim
+ *     ./coop_sim [-d segundos] [-y corrutinas_que_ceden] [-s semilla]
+ *
+ * Las señales externas solo se entregan entre rondas, como en
+ * executor_task; no se modela la tarea de mayor prioridad que desaloja al
+ * ejecutor.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <math.h>
+#include "coop.h"
+
+/** @brief Corrutinas simuladas como máximo (LEDs, display y las que ceden) */
+#define SIM_MAX_CO              (2 + SIM_MAX_SPINNERS)
+#define SIM_MAX_SPINNERS        4
+
+/** @brief Costo de un turno de cada corrutina (us) */
+#define SIM_LED_TURN_US         50
+#define SIM_DISPLAY_TURN_US     200
+#define SIM_DISPLAY_FRAME_US    14000
+#define SIM_SPIN_TURN_US        500
+
+/** @brief Separación media entre comandos externos (ms) */
+#define SIM_LED_CMD_MEAN_MS     300
+#define SIM_DISPLAY_CMD_MEAN_MS 200
+
+/**
+ * @brief Corrutina simulada (co debe ser el primer campo)
+ */
+typedef struct {
+    co_t co;
+    int id;
+    bool external;              /**< Recibe señales de otras tareas */
+    uint32_t cmd_mean_ms;
+    uint64_t next_cmd_us;       /**< Próxima señal externa */
+    uint64_t signal_us;         /**< Señal entregada y todavía no atendida */
+    bool signal_pending;
+    uint64_t latency_max_us;
+    bool ran;                   /**< Corrió en la ronda en curso */
+} sim_co_t;
+
+static sim_co_t sims[SIM_MAX_CO];
+static int sim_count;
+static co_exec_t exec;
+
+static uint64_t now_us;
+static int first_runner;
+static uint32_t rng_state;
+
+static uint32_t rng_next(void) {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return rng_state;
+}
+
+static double rng_unit(void) {
+    return (rng_next() >> 8) * (1.0 / 16777216.0);
+}
+
+static uint32_t rng_exp_ms(uint32_t mean_ms) {
+    return 1 + (uint32_t)(-log(1.0 - rng_unit()) * mean_ms);
+}
+
+static uint32_t sim_clock_us(void) {
+    return (uint32_t)now_us;
+}
+
+/**
+ * @brief Contabiliza un turno y avanza el reloj lo que cuesta
+ */
+static void sim_turn(sim_co_t *s, uint32_t cost_us) {
+    if (s->ran) {
+        printf("ERROR: %s corrió dos veces en la misma ronda\n", s->co.name);
+        exit(1);
+    }
+    s->ran = true;
+    if (first_runner < 0) {
+        first_runner = s->id;
+    }
+    if (s->signal_pending) {
+        uint64_t latency = now_us - s->signal_us;
+        if (latency > s->latency_max_us) {
+            s->latency_max_us = latency;
+        }
+        s->signal_pending = false;
+    }
+    now_us += cost_us;
+}
+
+/**
+ * @brief LEDs: atiende comandos y duerme hasta el próximo paso de secuencia
+ */
+static void led_run(co_t *co) {
+    sim_co_t *s = (sim_co_t *)co;
+
+    CO_BEGIN(co);
+    while (1) {
+        sim_turn(s, SIM_LED_TURN_US);
+        CO_WAIT(co, (rng_next() % 4 == 0) ? CO_FOREVER : 20 + rng_next() % 180);
+    }
+    CO_END(co);
+}
+
+/**
+ * @brief Display: un cuadro por comando, reloj una vez por segundo
+ */
+static void display_run(co_t *co) {
+    sim_co_t *s = (sim_co_t *)co;
+
+    CO_BEGIN(co);
+    while (1) {
+        sim_turn(s, s->signal_pending ? SIM_DISPLAY_FRAME_US : SIM_DISPLAY_TURN_US);
+        CO_WAIT(co, 1000);
+    }
+    CO_END(co);
+}
+
+/**
+ * @brief Trabajo de fondo que nunca espera
+ */
+static void spin_run(co_t *co) {
+    sim_co_t *s = (sim_co_t *)co;
+
+    CO_BEGIN(co);
+    while (1) {
+        sim_turn(s, SIM_SPIN_TURN_US);
+        CO_YIELD(co);
+    }
+    CO_END(co);
+}
+
+static void sim_add(const char *name, co_fn fn, uint32_t cmd_mean_ms) {
+    sim_co_t *s = &sims[sim_count];
+    s->id = co_add(&exec, &s->co, name, fn);
+    s->external = (cmd_mean_ms != 0);
+    s->cmd_mean_ms = cmd_mean_ms;
+    s->next_cmd_us = s->external ? rng_exp_ms(cmd_mean_ms) * 1000ull : UINT64_MAX;
+    sim_count++;
+}
+
+/**
+ * @brief Lista al comenzar la ronda, con la misma regla que coop.c
+ */
+static bool sim_ready(const co_t *co, uint32_t now_ms, bool signal) {
+    switch (co->state) {
+        case CO_READY:
+            return true;
+        case CO_WAITING:
+            return co->signaled || signal;
+        case CO_WAITING_TIMED:
+            return co->signaled || signal || (int32_t)(now_ms - co->wake_ms) >= 0;
+        default:
+            return false;
+    }
+}
+
+int main(int argc, char **argv) {
+    uint32_t duration_s = 600;
+    int spinners = 2;
+    rng_state = 12345;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-d") == 0 && i + 1 < argc) {
+            duration_s = (uint32_t)strtoul(argv[++i], NULL, 0);
+        } else if (strcmp(argv[i], "-y") == 0 && i + 1 < argc) {
+            spinners = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-s") == 0 && i + 1 < argc) {
+            rng_state = (uint32_t)strtoul(argv[++i], NULL, 0);
+        } else {
+            fprintf(stderr, "uso: %s [-d segundos] [-y corrutinas_que_ceden] [-s semilla]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (spinners < 0 || spinners > SIM_MAX_SPINNERS || rng_state == 0) {
+        fprintf(stderr, "-y debe estar entre 0 y %d y la semilla no puede ser 0\n", SIM_MAX_SPINNERS);
+        return 1;
+    }
+
+    co_exec_init(&exec, sim_clock_us);
+    sim_add("leds", led_run, SIM_LED_CMD_MEAN_MS);
+    sim_add("display", display_run, SIM_DISPLAY_CMD_MEAN_MS);
+    static const char *const spin_names[SIM_MAX_SPINNERS] = { "fondo1", "fondo2", "fondo3", "fondo4" };
+    for (int i = 0; i < spinners; i++) {
+        sim_add(spin_names[i], spin_run, 0);
+    }
+
+    uint64_t end_us = (uint64_t)duration_s * 1000000ull;
+    uint64_t round_max_us = 0;
+    uint32_t rounds = 0;
+    bool ok = true;
+
+    while (now_us < end_us) {
+        // Señales de otras tareas entregadas desde la ronda anterior
+        uint32_t signals = 0;
+        for (int i = 0; i < sim_count; i++) {
+            sim_co_t *s = &sims[i];
+            if (s->next_cmd_us <= now_us) {
+                signals |= 1u << s->id;
+                if (!s->signal_pending) {
+                    s->signal_pending = true;
+                    s->signal_us = s->next_cmd_us;
+                }
+                s->next_cmd_us = now_us + rng_exp_ms(s->cmd_mean_ms) * 1000ull;
+            }
+        }
+
+        // Corrutinas que deben correr y la que debe empezar la ronda
+        uint32_t now_ms = (uint32_t)(now_us / 1000);
+        bool expected[SIM_MAX_CO];
+        int expected_first = -1;
+        for (int i = 0; i < sim_count; i++) {
+            expected[i] = sim_ready(&sims[i].co, now_ms, signals & (1u << i));
+            sims[i].ran = false;
+        }
+        for (int i = 0; i < sim_count && expected_first < 0; i++) {
+            int id = (exec.cursor + i) % sim_count;
+            if (expected[id]) {
+                expected_first = id;
+            }
+        }
+        uint8_t cursor = exec.cursor;
+
+        first_runner = -1;
+        uint64_t start_us = now_us;
+        uint32_t wait_ms = co_run(&exec, now_ms, signals);
+        if (now_us - start_us > round_max_us) {
+            round_max_us = now_us - start_us;
+        }
+
+        for (int i = 0; i < sim_count; i++) {
+            if (sims[i].ran != expected[i]) {
+                printf("ERROR: t=%u ms, %s %s\n", now_ms, sims[i].co.name,
+                       expected[i] ? "estaba lista y no corrió" : "corrió sin estar lista");
+                ok = false;
+            }
+        }
+        if (first_runner != expected_first) {
+            printf("ERROR: t=%u ms, la ronda empezó por %d en lugar de %d\n",
+                   now_ms, first_runner, expected_first);
+            ok = false;
+        }
+        if (expected_first >= 0) {
+            rounds++;
+            if (exec.cursor != (cursor + 1) % sim_count) {
+                printf("ERROR: t=%u ms, el cursor no avanzó\n", now_ms);
+                ok = false;
+            }
+        }
+        if (!ok) {
+            break;
+        }
+
+        if (wait_ms == 0) {
+            continue;
+        }
+
+        // Dormir hasta el plazo más cercano o la próxima señal externa
+        uint64_t wake_us = (wait_ms == CO_FOREVER) ? UINT64_MAX : (uint64_t)(now_ms + wait_ms) * 1000ull;
+        for (int i = 0; i < sim_count; i++) {
+            if (sims[i].next_cmd_us < wake_us) {
+                wake_us = sims[i].next_cmd_us;
+            }
+        }
+        if (wake_us > now_us) {
+            now_us = wake_us;
+        }
+    }
+
+    printf("Simulados %u s: %u rondas, ronda más larga %.1f ms\n\n",
+           duration_s, rounds, round_max_us / 1000.0);
+    printf("%-9s %9s %9s %11s %13s\n", "Corrutina", "Turnos", "Señales", "Atraso(ms)", "Latencia(ms)");
+    for (int i = 0; i < sim_count; i++) {
+        const sim_co_t *s = &sims[i];
+        printf("%-9s %9lu %9lu %11lu %13.1f\n", s->co.name, (unsigned long)s->co.runs,
+               (unsigned long)s->co.signals, (unsigned long)s->co.late_max_ms,
+               s->latency_max_us / 1000.0);
+
+        // El tiempo de la ronda es a ms enteros: un ms más de tolerancia
+        if (s->co.late_max_ms > round_max_us / 1000 + 1) {
+            printf("ERROR: %s se atrasó más de una ronda\n", s->co.name);
+            ok = false;
+        }
+        if (s->latency_max_us > 2 * round_max_us + 1000) {
+            printf("ERROR: %s atendió una señal después de más de dos rondas\n", s->co.name);
+            ok = false;
+        }
+    }
+
+    for (int i = 3; i < sim_count; i++) {
+        long diff = (long)sims[i].co.runs - (long)sims[2].co.runs;
+        if (labs(diff) > 1) {
+            printf("ERROR: %s y %s recibieron turnos distintos (%ld)\n",
+                   sims[i].co.name, sims[2].co.name, diff);
+            ok = false;
+        }
+    }
+
+    printf("\n%s\n", ok ? "Verificación del ejecutor: OK"
+                        : "ERROR: el ejecutor no pasó la verificación");
+    return ok ? 0 : 1;
+}
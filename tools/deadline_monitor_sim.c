@@ -0,0 +1,225 @@
+/**
+ * @file deadline_monitor_sim.c
+ * @brief Simulación en el host del monitor de plazos con bloqueos inyectados
+ * @author Sistema de Control de Acceso
+ * @date 2025
+ *
+ * Enlaza el mismo deadline_monitor.c del firmware con los contratos de
+ * task_health.c y reproduce 30 s de actividad: ráfagas del teclado cada
+ * 4 s (paso de 5 ms con jitter), reloj del display cada segundo (cuadro de
+ * ~13 ms por I2C), trabajos cortos de LEDs y control de acceso. Se puede
+ * inyectar un bloqueo en una tarea y ver los incumplimientos, el
+ * histograma y si el watchdog llegaría a reiniciar el equipo.
+ *
+ * Compilar y ejecutar desde la raíz del proyecto:
+ *
+ *     cc -std=c11 -O2 -I. tools/deadline_monitor_sim.c deadline_monitor.c -o dm_sim
+ *     ./dm_sim [-s none|keypad|leds|display|access] [-d duracion_ms] [-a inicio_ms]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "deadline_monitor.h"
+#include "task_health.h"
+
+/** @brief Duración simulada */
+#define SIM_DURATION_MS     30000u
+
+/** @brief Tiempo de un cuadro completo por I2C a 400 kHz */
+#define SIM_FRAME_MS        13u
+
+/** @brief Período de las ráfagas de teclas y su duración */
+#define SIM_KEY_PERIOD_MS   4000u
+#define SIM_KEY_ACTIVE_MS   300u
+
+/**
+ * @brief Contratos (copia de la tabla de task_health.c)
+ */
+static const struct {
+    const char *name;
+    dm_kind_t kind;
+    uint32_t period_ms;
+    uint32_t tolerance_ms;
+} contracts[HEALTH_COUNT] = {
+    [HEALTH_KEYPAD]  = { "Keypad",        DM_KIND_PERIODIC, 5,    45  },
+    [HEALTH_LEDS]    = { "LEDs",          DM_KIND_JOB,      50,   50  },
+    [HEALTH_DISPLAY] = { "Display",       DM_KIND_JOB,      50,   50  },
+    [HEALTH_CLOCK]   = { "Clock",         DM_KIND_PERIODIC, 1000, 250 },
+    [HEALTH_ACCESS]  = { "AccessControl", DM_KIND_JOB,      100,  100 },
+};
+
+static uint32_t rng_state = 12345;
+
+static uint32_t rng_next(void) {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return rng_state;
+}
+
+/**
+ * @brief Trabajo en curso de una tarea por eventos (0 = ninguno)
+ */
+typedef struct {
+    bool busy;
+    uint32_t end_ms;
+} sim_job_t;
+
+static dm_monitor_t monitor;
+
+static void job_start(sim_job_t *job, int id, uint32_t now, uint32_t duration) {
+    dm_begin(&monitor, id, now);
+    job->busy = true;
+    job->end_ms = now + duration;
+}
+
+static void job_poll(sim_job_t *job, int id, uint32_t now) {
+    if (job->busy && now >= job->end_ms) {
+        dm_end(&monitor, id, now);
+        job->busy = false;
+    }
+}
+
+int main(int argc, char **argv) {
+    int stall_task = -1;
+    uint32_t stall_ms = 5000;
+    uint32_t stall_at = 10000;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-s") == 0 && i + 1 < argc) {
+            const char *name = argv[++i];
+            stall_task = -1;
+            if (strcmp(name, "keypad") == 0) stall_task = HEALTH_KEYPAD;
+            else if (strcmp(name, "leds") == 0) stall_task = HEALTH_LEDS;
+            else if (strcmp(name, "display") == 0) stall_task = HEALTH_DISPLAY;
+            else if (strcmp(name, "access") == 0) stall_task = HEALTH_ACCESS;
+            else if (strcmp(name, "none") != 0) {
+                fprintf(stderr, "tarea desconocida: %s\n", name);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "-d") == 0 && i + 1 < argc) {
+            stall_ms = (uint32_t)strtoul(argv[++i], NULL, 0);
+        } else if (strcmp(argv[i], "-a") == 0 && i + 1 < argc) {
+            stall_at = (uint32_t)strtoul(argv[++i], NULL, 0);
+        } else {
+            fprintf(stderr, "uso: %s [-s none|keypad|leds|display|access] [-d duracion_ms] [-a inicio_ms]\n",
+                    argv[0]);
+            return 1;
+        }
+    }
+
+    dm_init(&monitor);
+    for (int i = 0; i < HEALTH_COUNT; i++) {
+        dm_register(&monitor, contracts[i].name, contracts[i].kind,
+                    contracts[i].period_ms, contracts[i].tolerance_ms);
+    }
+
+    sim_job_t leds = {0}, display = {0}, access = {0};
+    bool keypad_active = false;
+    bool stall_done = false;
+    uint32_t keypad_next = 0;
+    uint32_t clock_next = 1000;
+    uint32_t last_feed = 0;
+    uint32_t reported = 0;
+
+    printf("Bloqueo inyectado: %s, %u ms desde t=%u ms\n",
+           stall_task >= 0 ? contracts[stall_task].name : "ninguno", stall_ms, stall_at);
+
+    // Estado inicial como en el firmware: display dibujado y reloj en marcha
+    dm_start(&monitor, HEALTH_CLOCK, 0);
+
+    for (uint32_t now = 0; now < SIM_DURATION_MS; now++) {
+        bool stall_now = !stall_done && now >= stall_at;
+
+        job_poll(&leds, HEALTH_LEDS, now);
+        job_poll(&display, HEALTH_DISPLAY, now);
+        job_poll(&access, HEALTH_ACCESS, now);
+
+        // Teclado: ráfaga activa de 300 ms cada 4 s, paso de 5 ms (+0..1 ms)
+        bool in_burst = (now % SIM_KEY_PERIOD_MS) < SIM_KEY_ACTIVE_MS && now >= SIM_KEY_PERIOD_MS;
+        if (in_burst && !keypad_active) {
+            keypad_active = true;
+            dm_start(&monitor, HEALTH_KEYPAD, now);
+            keypad_next = now + 5;
+        } else if (!in_burst && keypad_active && now >= keypad_next) {
+            keypad_active = false;
+            dm_idle(&monitor, HEALTH_KEYPAD);
+        }
+        if (keypad_active && now >= keypad_next) {
+            if (stall_now && stall_task == HEALTH_KEYPAD) {
+                keypad_next = now + stall_ms;
+                stall_done = true;
+            } else {
+                dm_heartbeat(&monitor, HEALTH_KEYPAD, now);
+                keypad_next = now + 5 + (rng_next() % 2);
+            }
+        }
+
+        // Al final de cada ráfaga: tecla a control de acceso y comando de LEDs
+        if (now >= SIM_KEY_PERIOD_MS && now % SIM_KEY_PERIOD_MS == SIM_KEY_ACTIVE_MS) {
+            if (!access.busy) {
+                bool stall = stall_now && stall_task == HEALTH_ACCESS;
+                job_start(&access, HEALTH_ACCESS, now, stall ? stall_ms : 1);
+                stall_done |= stall;
+            }
+            if (!leds.busy) {
+                bool stall = stall_now && stall_task == HEALTH_LEDS;
+                job_start(&leds, HEALTH_LEDS, now, stall ? stall_ms : 1);
+                stall_done |= stall;
+            }
+        }
+
+        // Reloj del display: latido y cuadro cada segundo
+        if (!display.busy && now >= clock_next) {
+            bool stall = stall_now && stall_task == HEALTH_DISPLAY;
+            dm_heartbeat(&monitor, HEALTH_CLOCK, now);
+            job_start(&display, HEALTH_DISPLAY, now, stall ? stall_ms : SIM_FRAME_MS + rng_next() % 3);
+            stall_done |= stall;
+            clock_next += 1000;
+            if (clock_next <= now) {
+                clock_next = now + 1000;
+            }
+        }
+
+        // Tarea Health
+        if (now % HEALTH_CHECK_PERIOD_MS == 0) {
+            uint32_t unhealthy = dm_check(&monitor, now);
+            if (unhealthy == 0) {
+                last_feed = now;
+            }
+            if (unhealthy != reported) {
+                for (int i = 0; i < HEALTH_COUNT; i++) {
+                    uint32_t bit = 1u << i;
+                    if ((unhealthy & bit) && !(reported & bit)) {
+                        printf("t=%6u ms  %s no cumple su plazo\n", now, contracts[i].name);
+                    } else if (!(unhealthy & bit) && (reported & bit)) {
+                        printf("t=%6u ms  %s recuperada\n", now, contracts[i].name);
+                    }
+                }
+                reported = unhealthy;
+            }
+        }
+        if (now - last_feed >= HEALTH_WATCHDOG_TIMEOUT_MS) {
+            printf("t=%6u ms  WATCHDOG: reinicio (último alimento en t=%u ms)\n", now, last_feed);
+            break;
+        }
+    }
+
+    printf("\n%-14s %-4s %6s %8s %6s %8s  %s\n",
+           "Tarea", "Tipo", "Plazo", "Medidos", "Fallas", "PeorAtr",
+           "Histograma ms: <1 <2 <4 <8 <16 <32 <64 >=64");
+    for (int i = 0; i < monitor.count; i++) {
+        const dm_task_t *t = &monitor.tasks[i];
+        printf("%-14s %-4s %6u %8u %6u %8u  ",
+               t->name, t->kind == DM_KIND_PERIODIC ? "Per" : "Trab",
+               t->period_ms, t->count, t->misses, t->worst_late_ms);
+        for (int b = 0; b < DM_HIST_BUCKETS; b++) {
+            printf(" %u", t->hist[b]);
+        }
+        printf("\n");
+    }
+    return 0;
+}
@@ -0,0 +1,379 @@
+/**
+ * @file display_burst_sim.c
+ * @brief Latencia de comando a cuadro del display bajo ráfagas, en el host
+ * @author Sistema de Control de Acceso
+ * @date 2025
+ *
+ * Enlaza el mismo ssd1306_display.c del firmware (corrutina display_run),
+ * coop.c y el núcleo del bus de eventos (event_bus.c) con un reloj
+ * simulado; cada transferencia I2C ocupa el tiempo que tarda a
+ * BOARD_I2C_KHZ. Las tareas que envían comandos se modelan como ráfagas de
+ * 1 a 6 comandos separados por 0-5 ms (como las del control de acceso),
+ * mezclando mensajes temporizados, estáticos y personalizados.
+ *
+ * La latencia de un comando se mide desde que se envía hasta que termina
+ * de transmitirse el cuadro que lo muestra, o uno posterior que lo
+ * reemplazó (gana el último). Verifica que:
+ * - ninguna latencia supera un cuadro en curso + DISPLAY_FRAME_PERIOD_MS +
+ *   el propio cuadro (un mensaje temporizado nunca demora al siguiente);
+ * - todo comando termina dibujado o reemplazado;
+ * - un mensaje temporizado sin comandos posteriores vuelve a standby a los
+ *   display_time_ms de haberse dibujado;
+ * - el display no despierta por plazo antes de tiempo: todo turno sin señal
+ *   transfiere algo (un cuadro, la marquesina o el reloj).
+ *
+ * Compilar y ejecutar desde la raíz del proyecto:
+ *
+ *     python3 tools/gen_ssd1306_frames.py ssd1306_font.h /tmp/ssd1306_frames.h
+ *     cc -std=c11 -O2 -Itools/replay/shim -I. -I/tmp tools/display_burst_sim.c \
+ *        ssd1306_display.c coop.c event_bus.c -lm -o display_burst_sim
+ *     ./display_burst_sim [-d segundos] [-s semilla]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <math.h>
+#include "board.h"
+#include "ssd1306_display.h"
+#include "system_bus.h"
+#include "event_bus.h"
+#include "time_service.h"
+#include "task_health.h"
+#include "boot_profile.h"
+#include "i2c_bus.h"
+#include "executor.h"
+#include "task.h"
+
+#define SIM_DEFAULT_SECONDS     600
+
+/** @brief Separación media entre ráfagas (ms) */
+#define SIM_BURST_MEAN_MS       400
+
+/** @brief Comandos por ráfaga y separación máxima entre ellos (ms) */
+#define SIM_BURST_MAX_CMDS      6
+#define SIM_BURST_GAP_MS        5
+
+/** @brief Bytes de un cuadro completo (byte de control + 512) */
+#define SIM_FULL_FRAME_BYTES    (1 + 512)
+
+/** @brief Comandos registrados para medir su latencia */
+#define SIM_MAX_CMDS            8192
+
+/* ---- Reloj, bus I2C y ejecutor ----------------------------------------- */
+
+static uint64_t now_us;
+static uint32_t rng_state;
+
+static co_exec_t exec;
+static uint32_t pending_signals;
+static int display_co_id = -1;
+
+static eb_bus_t bus;
+
+/** @brief Transferencias I2C hasta el momento y en el último bus_poll */
+static uint32_t transfers;
+static uint32_t transfers_at_poll;
+
+/** @brief Turnos del display y los que despertaron por plazo sin nada que hacer */
+static uint32_t display_turns;
+static uint32_t idle_turns;
+
+/** @brief Comienzo de la última transferencia de un cuadro completo */
+static uint64_t last_full_frame_us;
+
+/** @brief Comando publicado en cada ranura del pool */
+static int slot_cmd[EB_POOL_SLOTS];
+
+static struct {
+    uint64_t sent_us;
+    uint64_t latency_us;
+    bool done;
+} cmds[SIM_MAX_CMDS];
+static int cmd_count;
+static int first_open;          /**< Primer comando sin resolver */
+
+static uint32_t rng_next(void) {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return rng_state;
+}
+
+static double rng_unit(void) {
+    return (rng_next() >> 8) * (1.0 / 16777216.0);
+}
+
+static uint32_t rng_exp_ms(uint32_t mean_ms) {
+    return 1 + (uint32_t)(-log(1.0 - rng_unit()) * mean_ms);
+}
+
+/**
+ * @brief El cuadro que mostraba el comando cmd terminó: resuelve ese y
+ * todos los anteriores (reemplazados por él)
+ */
+static void resolve_up_to(int cmd) {
+    for (; first_open <= cmd; first_open++) {
+        cmds[first_open].latency_us = now_us - cmds[first_open].sent_us;
+        cmds[first_open].done = true;
+    }
+}
+
+/* ---- Dependencias de ssd1306_display.c --------------------------------- */
+
+int i2c_bus_client(const char *name) {
+    (void)name;
+    return 0;
+}
+
+iq_result_t i2c_bus_transfer(iq_txn_t *txn) {
+    uint32_t len = 0;
+
+    for (uint8_t s = 0; s < txn->seg_count; s++) {
+        len += txn->seg[s].len;
+    }
+    if (len >= SIM_FULL_FRAME_BYTES) {
+        last_full_frame_us = now_us;
+    }
+
+    // START, dirección, 9 ciclos por byte y STOP
+    uint32_t bits = 1 + 9 + 9 * len + 1;
+    now_us += (bits * 1000u + BOARD_I2C_KHZ - 1) / BOARD_I2C_KHZ;
+    transfers++;
+    return IQ_OK;
+}
+
+TickType_t xTaskGetTickCount(void) {
+    return (TickType_t)(now_us / 1000);
+}
+
+int executor_add(co_t *co, const char *name, co_fn fn) {
+    display_co_id = co_add(&exec, co, name, fn);
+    return display_co_id;
+}
+
+int executor_subscribe(int id, const char *name, uint32_t topics, uint8_t flags) {
+    (void)id;
+    return eb_subscribe(&bus, name, topics, flags);
+}
+
+eb_msg_t *bus_alloc(bus_topic_t topic) {
+    return eb_alloc(&bus, (uint8_t)topic);
+}
+
+bool bus_publish(eb_msg_t *msg) {
+    slot_cmd[msg->index] = cmd_count - 1;
+    uint32_t delivered = eb_publish(&bus, msg);
+    if (delivered != 0) {
+        pending_signals |= 1u << display_co_id;
+    }
+    return delivered != 0;
+}
+
+const eb_msg_t *bus_poll(int sub) {
+    transfers_at_poll = transfers;
+    return eb_pop(&bus, sub);
+}
+
+/**
+ * @brief Un comando se suelta tras dibujarlo o al ser reemplazado; solo en
+ * el primer caso hubo transferencias desde que se tomó del bus
+ */
+void bus_release(const eb_msg_t *msg) {
+    if (transfers != transfers_at_poll) {
+        resolve_up_to(slot_cmd[msg->index]);
+    }
+    eb_release(&bus, msg);
+}
+
+void bus_get_topic_stats(bus_topic_t topic, eb_topic_stats_t *stats) {
+    *stats = bus.stats[topic];
+}
+
+/** @brief Cada refresco del reloj cambia los segundos y se dibuja */
+uint32_t time_service_update(void) { return TIME_FIELD_SEC; }
+const char *time_service_date_str(void) { return "01/01/25"; }
+const char *time_service_time_str(void) { return "00:00:00"; }
+void task_health_start(health_task_id_t id) { (void)id; }
+void task_health_heartbeat(health_task_id_t id) { (void)id; }
+void task_health_idle(health_task_id_t id) { (void)id; }
+void task_health_begin(health_task_id_t id) { (void)id; }
+void task_health_end(health_task_id_t id) { (void)id; }
+void boot_mark(boot_phase_t phase) { (void)phase; }
+
+/* ---- Simulación -------------------------------------------------------- */
+
+/**
+ * @brief Ejecuta el ejecutor hasta el instante until_us
+ */
+static void run_until(uint64_t until_us) {
+    while (now_us < until_us) {
+        uint32_t signals = pending_signals;
+        pending_signals = 0;
+
+        // Un turno por plazo que no transfiere nada despertó antes de tiempo
+        const co_t *display = exec.tasks[display_co_id];
+        uint32_t runs = display->runs;
+        uint32_t transfers_before = transfers;
+        bool signaled = display->signaled || (signals & (1u << display_co_id)) != 0;
+
+        uint32_t wait_ms = co_run(&exec, (uint32_t)(now_us / 1000), signals);
+        if (display->runs != runs) {
+            display_turns++;
+            if (!signaled && transfers == transfers_before) {
+                idle_turns++;
+            }
+        }
+        if (wait_ms == 0 || pending_signals != 0) {
+            continue;
+        }
+
+        uint64_t wake_us = (wait_ms == CO_FOREVER) ? until_us
+                         : (now_us / 1000 + wait_ms) * 1000ull;
+        now_us = (wake_us < until_us) ? wake_us : until_us;
+    }
+}
+
+/**
+ * @brief Envía un comando desde otra tarea en el instante actual
+ */
+static void send(display_message_type_t type, const char *text, uint32_t display_time_ms) {
+    if (cmd_count == SIM_MAX_CMDS) {
+        return;
+    }
+    cmds[cmd_count].sent_us = now_us;
+    cmd_count++;
+    if (!ssd1306_send_command(type, text, display_time_ms)) {
+        printf("ERROR: el bus rechazó un comando\n");
+        exit(1);
+    }
+}
+
+/**
+ * @brief Comando al azar con la mezcla del control de acceso
+ */
+static void send_random(void) {
+    switch (rng_next() % 6) {
+        case 0: send(DISPLAY_MSG_ENTER_ID, NULL, 0); break;
+        case 1: send(DISPLAY_MSG_ENTER_PASSWORD, NULL, 0); break;
+        case 2: send(DISPLAY_MSG_WELCOME, NULL, 2000); break;
+        case 3: send(DISPLAY_MSG_INVALID, NULL, 2000); break;
+        case 4: send(DISPLAY_MSG_CUSTOM, "ID: 1234", 0); break;
+        default: send(DISPLAY_MSG_CUSTOM, "TIMEOUT", 2000); break;
+    }
+}
+
+int main(int argc, char **argv) {
+    uint32_t duration_s = SIM_DEFAULT_SECONDS;
+    rng_state = 12345;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-d") == 0 && i + 1 < argc) {
+            duration_s = (uint32_t)strtoul(argv[++i], NULL, 0);
+        } else if (strcmp(argv[i], "-s") == 0 && i + 1 < argc) {
+            rng_state = (uint32_t)strtoul(argv[++i], NULL, 0);
+        } else {
+            fprintf(stderr, "uso: %s [-d segundos] [-s semilla]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (rng_state == 0) {
+        fprintf(stderr, "la semilla no puede ser 0\n");
+        return 1;
+    }
+
+    co_exec_init(&exec, NULL);
+    eb_init(&bus);
+    if (!ssd1306_init()) {
+        printf("ERROR: ssd1306_init\n");
+        return 1;
+    }
+    run_until(100000);
+
+    bool ok = true;
+    uint64_t frame_us = ((1 + 9 + 9 * SIM_FULL_FRAME_BYTES + 1) * 1000u) / BOARD_I2C_KHZ;
+    uint64_t bound_us = 2 * (frame_us + 1000) + DISPLAY_FRAME_PERIOD_MS * 1000u + 1000;
+
+    // Mensaje temporizado sin comandos posteriores: vuelve a standby a tiempo
+    send(DISPLAY_MSG_WELCOME, NULL, 2000);
+    run_until(now_us + 100000);
+    uint64_t drawn_us = cmds[0].sent_us + cmds[0].latency_us;
+    run_until(drawn_us + 2500000);
+    int64_t standby_err_us = (int64_t)last_full_frame_us - (int64_t)(drawn_us + 2000000);
+    printf("Regreso a standby: %+.1f ms respecto del plazo de 2000 ms\n", standby_err_us / 1000.0);
+    // Los plazos son en ticks de 1 ms: hasta un tick antes o después
+    if (!cmds[0].done || standby_err_us < -1000 || standby_err_us > 1000) {
+        printf("ERROR: el mensaje temporizado no volvió a standby a tiempo\n");
+        ok = false;
+    }
+
+    // Mensaje temporizado interrumpido: el siguiente no espera los 2 s
+    send(DISPLAY_MSG_INVALID, NULL, 2000);
+    run_until(now_us + 300000);
+    send(DISPLAY_MSG_ENTER_ID, NULL, 0);
+    run_until(now_us + 300000);
+    printf("Comando tras un mensaje temporizado: %.1f ms\n", cmds[2].latency_us / 1000.0);
+    if (!cmds[2].done || cmds[2].latency_us > bound_us) {
+        printf("ERROR: el mensaje temporizado demoró al siguiente\n");
+        ok = false;
+    }
+
+    // Ráfagas al azar
+    int first_burst_cmd = cmd_count;
+    uint64_t end_us = now_us + (uint64_t)duration_s * 1000000ull;
+    uint32_t bursts = 0;
+    while (now_us < end_us && cmd_count < SIM_MAX_CMDS - SIM_BURST_MAX_CMDS) {
+        run_until(now_us + rng_exp_ms(SIM_BURST_MEAN_MS) * 1000ull);
+        int n = 1 + (int)(rng_next() % SIM_BURST_MAX_CMDS);
+        for (int i = 0; i < n; i++) {
+            send_random();
+            run_until(now_us + (rng_next() % (SIM_BURST_GAP_MS + 1)) * 1000ull);
+        }
+        bursts++;
+    }
+    run_until(now_us + 1000000);
+
+    uint64_t max_us = 0, sum_us = 0;
+    int count = 0, open = 0;
+    for (int i = first_burst_cmd; i < cmd_count; i++) {
+        if (!cmds[i].done) {
+            open++;
+            continue;
+        }
+        sum_us += cmds[i].latency_us;
+        if (cmds[i].latency_us > max_us) {
+            max_us = cmds[i].latency_us;
+        }
+        count++;
+    }
+
+    display_stats_t stats;
+    ssd1306_get_stats(&stats);
+    printf("\n%u ráfagas, %d comandos: %lu recibidos, %lu cuadros, %lu combinados, %lu descartados por el bus\n",
+           bursts, cmd_count - first_burst_cmd, (unsigned long)stats.received,
+           (unsigned long)stats.rendered, (unsigned long)stats.merged, (unsigned long)stats.dropped);
+    printf("Latencia comando -> cuadro: media %.1f ms, máxima %.1f ms (cota %.1f ms)\n",
+           count ? sum_us / 1000.0 / count : 0.0, max_us / 1000.0, bound_us / 1000.0);
+
+    printf("Turnos del display: %lu, %lu despertados antes de su plazo\n",
+           (unsigned long)display_turns, (unsigned long)idle_turns);
+
+    if (open > 0) {
+        printf("ERROR: %d comandos nunca se dibujaron\n", open);
+        ok = false;
+    }
+    if (max_us > bound_us) {
+        printf("ERROR: la latencia superó la cota\n");
+        ok = false;
+    }
+    if (idle_turns > 0) {
+        printf("ERROR: el display despertó antes de sus plazos\n");
+        ok = false;
+    }
+
+    printf("\n%s\n", ok ? "Verificación de la latencia del display: OK"
+                        : "ERROR: el display no pasó la verificación");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,292 @@
+/**
+ * @file event_bus_bench.c
+ * @brief Comparación en el host del bus de eventos contra colas por copia
+ * @author Sistema de Control de Acceso
+ * @date 2025
+ *
+ * Enlaza el mismo event_bus.c del firmware y lo compara con un modelo de
+ * las colas de FreeRTOS: xQueueSend copia el elemento completo en el
+ * almacenamiento de la cola y xQueueReceive lo copia de vuelta al
+ * receptor. Con N observadores de un mismo evento, las colas necesitan N
+ * envíos (N copias de ida y N de vuelta); el bus escribe el evento una vez
+ * y entrega N referencias.
+ *
+ * La mezcla de eventos reproduce el tráfico de una autenticación: por cada
+ * tecla hay comandos de LEDs y del display (40 bytes, el más grande) y
+ * eventos del control de acceso.
+ *
+ * Compilar y ejecutar desde la raíz del proyecto:
+ *
+ *     cc -std=c11 -O2 -I. tools/event_bus_bench.c event_bus.c -o eb_bench
+ *     ./eb_bench [-n eventos] [-o observadores_max]
+ *
+ * Los tiempos son del host; no incluyen las secciones críticas ni los
+ * cambios de contexto, que ambos modelos pagan por igual en el RP2040. Los
+ * bytes copiados por evento sí se trasladan directamente al firmware.
+ *
+ * Antes de medir verifica la reserva de ranuras (eb_reserve): suscriptores
+ * que no sueltan nada agotan el pool para los demás tópicos pero no para
+ * el reservado, como las teclas frente al display y las estadísticas.
+ */
+
+#define _POSIX_C_SOURCE 199309L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <time.h>
+#include "event_bus.h"
+
+/** @brief Tamaño de los eventos del firmware (keypad, access, led, display) */
+#define SIZE_KEY        8
+#define SIZE_ACCESS     12
+#define SIZE_LED        8
+#define SIZE_DISPLAY    40
+
+/** @brief Longitud de cada cola del modelo por copia */
+#define QUEUE_LENGTH    8
+
+/** @brief Máximo de observadores simulados */
+#define MAX_OBSERVERS   4
+
+/** @brief Bloque de control de una cola estática de FreeRTOS en el RP2040 */
+#define STATIC_QUEUE_BYTES  80
+
+/**
+ * @brief Cola por copia (modelo de xQueueSend/xQueueReceive)
+ */
+typedef struct {
+    uint8_t storage[QUEUE_LENGTH * SIZE_DISPLAY];
+    uint32_t item_size;
+    uint32_t head;
+    uint32_t count;
+} copy_queue_t;
+
+/**
+ * @brief Evento de la mezcla: tópico y tamaño
+ */
+typedef struct {
+    uint8_t topic;
+    uint32_t size;
+} bench_event_t;
+
+/** @brief Tráfico de una tecla: la tecla y las reacciones que provoca */
+static const bench_event_t mix[] = {
+    { 0, SIZE_KEY },
+    { 2, SIZE_LED },
+    { 3, SIZE_DISPLAY },
+    { 1, SIZE_ACCESS },
+    { 2, SIZE_LED },
+    { 3, SIZE_DISPLAY },
+};
+
+#define MIX_LEN (sizeof(mix) / sizeof(mix[0]))
+
+/** @brief Acumulador para que el compilador no elimine las lecturas */
+static volatile uint32_t sink;
+
+static uint64_t bytes_copied;
+
+static bool queue_send(copy_queue_t *q, const void *item) {
+    if (q->count >= QUEUE_LENGTH) {
+        return false;
+    }
+    uint32_t slot = (q->head + q->count) % QUEUE_LENGTH;
+    memcpy(&q->storage[slot * q->item_size], item, q->item_size);
+    bytes_copied += q->item_size;
+    q->count++;
+    return true;
+}
+
+static bool queue_receive(copy_queue_t *q, void *item) {
+    if (q->count == 0) {
+        return false;
+    }
+    memcpy(item, &q->storage[q->head * q->item_size], q->item_size);
+    bytes_copied += q->item_size;
+    q->head = (q->head + 1) % QUEUE_LENGTH;
+    q->count--;
+    return true;
+}
+
+static double now_s(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/**
+ * @brief Llena un evento como lo haría el productor
+ */
+static void fill_event(uint8_t *dst, uint32_t size, uint32_t seq) {
+    // Campos escalares y, en el display, el texto del mensaje
+    memcpy(dst, &seq, sizeof(seq));
+    if (size > 8) {
+        memset(dst + 4, 'A' + (int)(seq % 26), size - 8);
+    }
+    memcpy(dst + size - 4, &seq, sizeof(seq));
+}
+
+/**
+ * @brief Consume un evento leyendo su contenido
+ */
+static void read_event(const uint8_t *src, uint32_t size) {
+    uint32_t first, last;
+    memcpy(&first, src, sizeof(first));
+    memcpy(&last, src + size - 4, sizeof(last));
+    sink += first ^ last ^ src[size / 2];
+}
+
+/**
+ * @brief Colas por copia: una cola por (tópico, observador)
+ */
+static double run_copy(uint32_t events, int observers, uint64_t *copied) {
+    static copy_queue_t queues[EB_MAX_TOPICS][MAX_OBSERVERS];
+    uint8_t item[SIZE_DISPLAY];
+    uint8_t out[SIZE_DISPLAY];
+
+    memset(queues, 0, sizeof(queues));
+    for (size_t i = 0; i < MIX_LEN; i++) {
+        for (int o = 0; o < observers; o++) {
+            queues[mix[i].topic][o].item_size = mix[i].size;
+        }
+    }
+
+    bytes_copied = 0;
+    double start = now_s();
+    for (uint32_t n = 0; n < events; n++) {
+        const bench_event_t *ev = &mix[n % MIX_LEN];
+
+        // El productor arma el evento en su pila y lo envía a cada cola
+        fill_event(item, ev->size, n);
+        for (int o = 0; o < observers; o++) {
+            queue_send(&queues[ev->topic][o], item);
+        }
+        // Cada observador lo recibe en su propia copia
+        for (int o = 0; o < observers; o++) {
+            if (queue_receive(&queues[ev->topic][o], out)) {
+                read_event(out, ev->size);
+            }
+        }
+    }
+    *copied = bytes_copied;
+    return now_s() - start;
+}
+
+/**
+ * @brief Bus sin copias: un suscriptor por observador, todos los tópicos
+ */
+static double run_bus(uint32_t events, int observers, uint64_t *copied, eb_bus_t *bus) {
+    int subs[MAX_OBSERVERS];
+
+    eb_init(bus);
+    for (int o = 0; o < observers; o++) {
+        subs[o] = eb_subscribe(bus, "obs", (1u << 4) - 1, 0);
+    }
+
+    double start = now_s();
+    for (uint32_t n = 0; n < events; n++) {
+        const bench_event_t *ev = &mix[n % MIX_LEN];
+
+        // El productor escribe directamente en la ranura
+        eb_msg_t *msg = eb_alloc(bus, ev->topic);
+        if (msg == NULL) {
+            continue;
+        }
+        fill_event((uint8_t *)msg->data, ev->size, n);
+        eb_publish(bus, msg);
+
+        // Cada observador lee la misma ranura y suelta su referencia
+        for (int o = 0; o < observers; o++) {
+            const eb_msg_t *m = eb_pop(bus, subs[o]);
+            if (m != NULL) {
+                read_event((const uint8_t *)m->data, ev->size);
+                eb_release(bus, m);
+            }
+        }
+    }
+    *copied = 0;
+    return now_s() - start;
+}
+
+/**
+ * @brief Un tópico que retiene ranuras no deja sin lugar al reservado
+ */
+static bool check_reserve(eb_bus_t *bus) {
+    eb_init(bus);
+    eb_subscribe(bus, "lento", (1u << 4) - 1, 0);
+    eb_reserve(bus, 1u << 0);
+
+    // Ranuras tomadas y nunca publicadas ni soltadas: quedan retenidas
+    int held = 0;
+    while (eb_alloc(bus, 3) != NULL) {
+        held++;
+    }
+    int reserved = 0;
+    while (eb_alloc(bus, 0) != NULL) {
+        reserved++;
+    }
+
+    bool ok = held == EB_POOL_SLOTS - EB_RESERVED_SLOTS && reserved == EB_RESERVED_SLOTS &&
+              bus->stats[3].no_slot == 1 && bus->stats[0].no_slot == 1;
+    printf("Reserva: %d ranuras para otros tópicos, %d para el reservado - %s\n\n",
+           held, reserved, ok ? "OK" : "ERROR");
+    return ok;
+}
+
+int main(int argc, char **argv) {
+    uint32_t events = 10000000;
+    int max_observers = 3;
+    static eb_bus_t bus;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+            events = (uint32_t)strtoul(argv[++i], NULL, 0);
+        } else if (strcmp(argv[i], "-o") == 0 && i + 1 < argc) {
+            max_observers = atoi(argv[++i]);
+        } else {
+            fprintf(stderr, "uso: %s [-n eventos] [-o observadores_max]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (max_observers < 1 || max_observers > MAX_OBSERVERS) {
+        fprintf(stderr, "observadores entre 1 y %d\n", MAX_OBSERVERS);
+        return 1;
+    }
+
+    uint32_t mix_bytes = 0;
+    for (size_t i = 0; i < MIX_LEN; i++) {
+        mix_bytes += mix[i].size;
+    }
+
+    printf("Eventos: %u (mezcla de %u, %.1f bytes promedio)\n",
+           events, (unsigned)MIX_LEN, (double)mix_bytes / MIX_LEN);
+    printf("Ranura del bus: %u bytes, pool de %d\n\n", (unsigned)sizeof(eb_msg_t), EB_POOL_SLOTS);
+    if (!check_reserve(&bus)) {
+        return 1;
+    }
+    printf("%-4s %14s %14s %10s %14s\n", "Obs", "Colas ns/ev", "Bus ns/ev", "Acel.", "Copias B/ev");
+
+    for (int obs = 1; obs <= max_observers; obs++) {
+        uint64_t copied_q, copied_b;
+        double t_q = run_copy(events, obs, &copied_q);
+        double t_b = run_bus(events, obs, &copied_b, &bus);
+
+        printf("%-4d %14.1f %14.1f %9.2fx %6.1f -> %.1f\n", obs,
+               t_q * 1e9 / events, t_b * 1e9 / events, t_q / t_b,
+               (double)copied_q / events, (double)copied_b / events);
+    }
+
+    // RAM: colas actuales (largo x tamaño + bloque de control) contra el pool
+    uint32_t queue_ram = 10 * SIZE_KEY + 5 * SIZE_ACCESS + 10 * SIZE_LED + 5 * SIZE_DISPLAY
+                       + 4 * STATIC_QUEUE_BYTES
+                       + 15 * 4 + STATIC_QUEUE_BYTES;   // conjunto de colas del control de acceso
+    uint32_t bus_ram = (uint32_t)sizeof(eb_bus_t) + 3 * STATIC_QUEUE_BYTES; // + semáforos
+    printf("\nRAM estática: colas %u bytes, bus %u bytes (pool, anillos y semáforos)\n",
+           queue_ram, bus_ram);
+    printf("Agregar un observador: colas +%u bytes por tópico, bus +%u bytes para todos\n",
+           QUEUE_LENGTH * SIZE_DISPLAY + STATIC_QUEUE_BYTES,
+           (unsigned)sizeof(eb_sub_t) + STATIC_QUEUE_BYTES);
+    return 0;
+}
@@ -0,0 +1,369 @@
+/**
+ * @file flash_btree_bench.c
+ * @brief Benchmark en el host del índice de usuarios en flash sobre una imagen en archivo
+ * @author Sistema de Control de Acceso
+ * @date 2025
+ *
+ * Enlaza el mismo flash_btree.c del firmware sobre un archivo que imita una
+ * flash NOR: el borrado deja 0xFF y programar sobre bytes no borrados es un
+ * error, así que cualquier escritura fuera de la copia en escritura se
+ * detecta. Carga N usuarios, vuelve a montar la imagen y mide:
+ *
+ * - búsquedas por segundo y tasa de aciertos de la caché, con IDs al azar
+ *   uniformes y con un 90 % de los accesos sobre el 1 % de los IDs;
+ * - lecturas de flash por búsqueda (promedio y máximo);
+ * - actualizaciones de clave y bloqueo, inserciones con divisiones y
+ *   bajas, con los borrados de sector que cuestan;
+ * - recorridos por rango;
+ * - el montaje y una verificación completa contra una copia en RAM.
+ *
+ * Compilar y ejecutar desde la raíz del proyecto:
+ *
+ *     cc -std=c11 -O2 -I. tools/flash_btree_bench.c flash_btree.c -o bt_bench
+ *     ./bt_bench [-n usuarios] [-l busquedas] [-u actualizaciones] [-i inserciones]
+ *                [-m region_kb] [-f imagen] [-s semilla]
+ *
+ * Para otro tamaño de caché: -DBT_CACHE_PAGES=8 (y lo mismo en el
+ * firmware). Los tiempos son del host; el costo de las escrituras en el
+ * dispositivo se estima con los tiempos típicos de una W25Q16JV (borrado de
+ * sector 45 ms, programación 0,4 ms por página de 256 bytes).
+ */
+
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include "flash_btree.h"
+
+/** @brief Tiempos típicos de la flash para la estimación (ms) */
+#define NOR_ERASE_MS            45.0
+#define NOR_PROGRAM_256_MS      0.4
+
+/**
+ * @brief Imagen de flash en un archivo
+ */
+typedef struct {
+    int fd;
+    uint32_t size;
+    uint32_t *erase_count;      /**< Borrados por sector (desgaste) */
+    uint64_t bytes_read;
+} nor_file_t;
+
+static bool nor_read(void *ctx, uint32_t addr, void *buf, uint32_t len) {
+    nor_file_t *f = ctx;
+    f->bytes_read += len;
+    return addr + len <= f->size && pread(f->fd, buf, len, addr) == (ssize_t)len;
+}
+
+static bool nor_erase(void *ctx, uint32_t addr) {
+    nor_file_t *f = ctx;
+    static uint8_t ones[BT_PAGE_SIZE];
+    if (ones[0] != 0xFF) {
+        memset(ones, 0xFF, sizeof(ones));
+    }
+    if (addr % BT_PAGE_SIZE != 0 || addr + BT_PAGE_SIZE > f->size) {
+        return false;
+    }
+    f->erase_count[addr / BT_PAGE_SIZE]++;
+    return pwrite(f->fd, ones, BT_PAGE_SIZE, addr) == BT_PAGE_SIZE;
+}
+
+static bool nor_program(void *ctx, uint32_t addr, const void *buf, uint32_t len) {
+    nor_file_t *f = ctx;
+    static uint8_t current[BT_PAGE_SIZE];
+    if (addr % BT_PROGRAM_SIZE != 0 || len % BT_PROGRAM_SIZE != 0 || len > BT_PAGE_SIZE ||
+        addr + len > f->size || pread(f->fd, current, len, addr) != (ssize_t)len) {
+        return false;
+    }
+    for (uint32_t i = 0; i < len; i++) {
+        if (current[i] != 0xFF) {
+            fprintf(stderr, "bt_bench: programación sobre flash no borrada en 0x%06lx\n",
+                    (unsigned long)(addr + i));
+            exit(1);
+        }
+    }
+    return pwrite(f->fd, buf, len, addr) == (ssize_t)len;
+}
+
+static uint32_t rng_state = 1;
+
+static uint32_t rng(void) {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return rng_state;
+}
+
+static double now_s(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/** @brief Copia en RAM: IDs ordenados y su valor */
+static uint32_t *ids;
+static uint32_t *values;
+static uint32_t id_count;
+
+/** @brief Registro de usuario como lo empaqueta database.c: clave BCD, intentos, bloqueo */
+static uint32_t make_value(uint32_t i) {
+    return (i * 2654435761u) & 0x0100FFFFu;
+}
+
+static bool next_user(uint32_t *key, uint32_t *value, void *ctx) {
+    uint32_t *i = ctx;
+    if (*i >= id_count) {
+        return false;
+    }
+    *key = ids[*i];
+    *value = values[*i];
+    (*i)++;
+    return true;
+}
+
+/**
+ * @brief Reinicia los contadores de la caché para medir una fase
+ */
+static void stats_reset(bt_tree_t *t) {
+    memset(&t->stats, 0, sizeof(t->stats));
+}
+
+static void report_lookups(const char *name, bt_tree_t *t, uint32_t n, double elapsed) {
+    uint32_t pages = t->stats.cache_hits + t->stats.cache_misses;
+    printf("%-22s %9.0f búsquedas/s  caché %5.1f %%  lecturas/búsqueda %.2f (máx %lu)\n",
+           name, n / elapsed, pages ? 100.0 * t->stats.cache_hits / pages : 0.0,
+           (double)t->stats.cache_misses / n, (unsigned long)t->stats.max_lookup_reads);
+}
+
+static void report_writes(const char *name, bt_tree_t *t, uint32_t n, double elapsed) {
+    double erases = (double)t->stats.erases / n;
+    double programs = (double)t->stats.page_writes * (BT_PAGE_SIZE / BT_PROGRAM_SIZE) +
+                      t->stats.commits;
+    printf("%-22s %9.0f op/s (host)  borrados/op %.2f  ~%.0f ms/op en el RP2040\n",
+           name, n / elapsed, erases,
+           erases * NOR_ERASE_MS + programs / n * NOR_PROGRAM_256_MS);
+}
+
+static bool count_key(uint32_t key, uint32_t value, void *ctx) {
+    uint32_t *state = ctx;      // {cantidad, última clave}
+    (void)value;
+    if (state[0] > 0 && key <= state[1]) {
+        fprintf(stderr, "bt_bench: recorrido fuera de orden en %lu\n", (unsigned long)key);
+        exit(1);
+    }
+    state[0]++;
+    state[1] = key;
+    return true;
+}
+
+int main(int argc, char **argv) {
+    uint32_t users = 100000;
+    uint32_t lookups = 200000;
+    uint32_t updates = 2000;
+    uint32_t inserts = 2000;
+    uint32_t region_kb = 2048;
+    const char *image = "flash_btree.img";
+
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (strcmp(argv[i], "-n") == 0) {
+            users = (uint32_t)strtoul(argv[i + 1], NULL, 0);
+        } else if (strcmp(argv[i], "-l") == 0) {
+            lookups = (uint32_t)strtoul(argv[i + 1], NULL, 0);
+        } else if (strcmp(argv[i], "-u") == 0) {
+            updates = (uint32_t)strtoul(argv[i + 1], NULL, 0);
+        } else if (strcmp(argv[i], "-i") == 0) {
+            inserts = (uint32_t)strtoul(argv[i + 1], NULL, 0);
+        } else if (strcmp(argv[i], "-m") == 0) {
+            region_kb = (uint32_t)strtoul(argv[i + 1], NULL, 0);
+        } else if (strcmp(argv[i], "-f") == 0) {
+            image = argv[i + 1];
+        } else if (strcmp(argv[i], "-s") == 0) {
+            rng_state = (uint32_t)strtoul(argv[i + 1], NULL, 0) | 1u;
+        } else {
+            fprintf(stderr, "uso: %s [-n usuarios] [-l busquedas] [-u actualizaciones] "
+                            "[-i inserciones] [-m region_kb] [-f imagen] [-s semilla]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (users == 0 || lookups == 0 || updates == 0 || inserts == 0) {
+        fprintf(stderr, "bt_bench: las cantidades deben ser mayores que 0\n");
+        return 1;
+    }
+
+    nor_file_t nor = { .size = region_kb * 1024u };
+    nor.fd = open(image, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    nor.erase_count = calloc(nor.size / BT_PAGE_SIZE, sizeof(uint32_t));
+    if (nor.fd < 0 || ftruncate(nor.fd, nor.size) != 0 || nor.erase_count == NULL) {
+        perror(image);
+        return 1;
+    }
+    bt_flash_t flash = { nor_read, nor_erase, nor_program, &nor, nor.size };
+
+    // IDs ascendentes y distintos repartidos en el espacio de 6 dígitos
+    ids = malloc(users * sizeof(uint32_t));
+    values = malloc(users * sizeof(uint32_t));
+    uint32_t stride = (users < 500000) ? 1000000 / users : 2;
+    for (uint32_t i = 0; i < users; i++) {
+        ids[i] = i * stride + rng() % (stride - 1);
+        values[i] = make_value(i);
+    }
+    id_count = users;
+
+    static bt_tree_t tree;
+    printf("Región %lu KB (%lu páginas), caché %d páginas (%lu KB de RAM en total)\n",
+           (unsigned long)region_kb, (unsigned long)(nor.size / BT_PAGE_SIZE), BT_CACHE_PAGES,
+           (unsigned long)(sizeof(bt_tree_t) / 1024));
+
+    double t0 = now_s();
+    uint32_t cursor = 0;
+    if (!bt_format(&tree, &flash) || !bt_bulk_load(&tree, next_user, &cursor)) {
+        fprintf(stderr, "bt_bench: la carga de %lu usuarios falló (¿región chica?)\n",
+                (unsigned long)users);
+        return 1;
+    }
+    printf("Carga masiva: %lu usuarios, %u niveles, %lu páginas libres, %.1f ms\n",
+           (unsigned long)tree.count, tree.height, (unsigned long)tree.free_pages,
+           (now_s() - t0) * 1e3);
+
+    t0 = now_s();
+    nor.bytes_read = 0;
+    if (!bt_mount(&tree, &flash)) {
+        fprintf(stderr, "bt_bench: no se pudo montar la imagen\n");
+        return 1;
+    }
+    printf("Montaje: %.2f ms, %lu páginas leídas\n\n", (now_s() - t0) * 1e3,
+           (unsigned long)(nor.bytes_read / BT_PAGE_SIZE));
+
+    // Búsquedas uniformes: 90 % IDs existentes, 10 % inexistentes
+    stats_reset(&tree);
+    t0 = now_s();
+    uint32_t found = 0;
+    for (uint32_t n = 0; n < lookups; n++) {
+        uint32_t key = (n % 10 == 9) ? rng() % 1000000 : ids[rng() % id_count];
+        uint32_t value;
+        found += bt_lookup(&tree, key, &value);
+    }
+    report_lookups("Búsqueda uniforme", &tree, lookups, now_s() - t0);
+
+    // 90 % de los accesos sobre el 1 % de los IDs (un turno con pocos usuarios)
+    uint32_t hot = (id_count / 100 > 0) ? id_count / 100 : 1;
+    uint32_t hot_base = rng() % (id_count - hot + 1);
+    stats_reset(&tree);
+    t0 = now_s();
+    for (uint32_t n = 0; n < lookups; n++) {
+        uint32_t i = (rng() % 10 < 9) ? hot_base + rng() % hot : rng() % id_count;
+        uint32_t value;
+        if (!bt_lookup(&tree, ids[i], &value) || value != values[i]) {
+            fprintf(stderr, "bt_bench: valor incorrecto para %lu\n", (unsigned long)ids[i]);
+            return 1;
+        }
+    }
+    report_lookups("Búsqueda concentrada", &tree, lookups, now_s() - t0);
+
+    // Cambios de clave y de intentos/bloqueo
+    stats_reset(&tree);
+    t0 = now_s();
+    for (uint32_t n = 0; n < updates; n++) {
+        uint32_t i = rng() % id_count;
+        values[i] ^= 0x00010000u + (n & 0xFFFFu);
+        if (!bt_put(&tree, ids[i], values[i])) {
+            fprintf(stderr, "bt_bench: la actualización %lu falló\n", (unsigned long)n);
+            return 1;
+        }
+    }
+    report_writes("Actualización", &tree, updates, now_s() - t0);
+
+    // Altas de IDs nuevos entre los existentes (divisiones de hojas)
+    stats_reset(&tree);
+    t0 = now_s();
+    uint32_t added = 0;
+    uint32_t *new_ids = malloc(inserts * sizeof(uint32_t));
+    bool *gone = calloc(inserts, sizeof(bool));
+    if (inserts > id_count) {
+        inserts = id_count;
+    }
+    for (uint32_t n = 0; n < inserts; n++) {
+        // El último valor de cada intervalo nunca es un ID cargado
+        uint32_t i = (uint32_t)((uint64_t)n * id_count / inserts);
+        uint32_t key = i * stride + stride - 1;
+        if (!bt_put(&tree, key, make_value(key))) {
+            fprintf(stderr, "bt_bench: el alta %lu falló (región llena)\n", (unsigned long)n);
+            break;
+        }
+        new_ids[added++] = key;
+    }
+    report_writes("Alta", &tree, added ? added : 1, now_s() - t0);
+
+    // Bajas de la mitad de las altas
+    stats_reset(&tree);
+    t0 = now_s();
+    uint32_t removed = 0;
+    for (uint32_t n = 0; n < added; n += 2) {
+        if (bt_delete(&tree, new_ids[n])) {
+            gone[n] = true;
+            removed++;
+        }
+    }
+    report_writes("Baja", &tree, removed ? removed : 1, now_s() - t0);
+
+    // Recorridos por rango
+    stats_reset(&tree);
+    t0 = now_s();
+    uint32_t state[2] = { 0, 0 };
+    uint32_t from = ids[rng() % id_count];
+    uint32_t visited = bt_scan(&tree, from, from + 10000, count_key, state);
+    double range_ms = (now_s() - t0) * 1e3;
+    printf("\nRango de 10000 IDs: %lu usuarios, %lu páginas leídas, %.2f ms\n",
+           (unsigned long)visited, (unsigned long)tree.stats.cache_misses, range_ms);
+
+    stats_reset(&tree);
+    t0 = now_s();
+    state[0] = 0;
+    visited = bt_scan(&tree, 0, 0xFFFFFFFFu, count_key, state);
+    printf("Recorrido completo: %lu usuarios, %lu páginas leídas, %.1f ms\n",
+           (unsigned long)visited, (unsigned long)tree.stats.cache_misses, (now_s() - t0) * 1e3);
+
+    // Volver a montar y comparar todo contra la copia en RAM
+    if (!bt_mount(&tree, &flash)) {
+        fprintf(stderr, "bt_bench: no se pudo volver a montar\n");
+        return 1;
+    }
+    uint32_t errors = 0, expected = id_count;
+    for (uint32_t i = 0; i < id_count; i++) {
+        uint32_t value;
+        errors += !bt_lookup(&tree, ids[i], &value) || value != values[i];
+    }
+    for (uint32_t n = 0; n < added; n++) {
+        uint32_t value;
+        bool present = bt_lookup(&tree, new_ids[n], &value);
+        if (gone[n]) {
+            errors += present;
+        } else {
+            expected++;
+            errors += !present || value != make_value(new_ids[n]);
+        }
+    }
+    errors += (tree.count != expected) || (visited != expected);
+
+    uint32_t max_erase = 0;
+    uint64_t total_erase = 0;
+    for (uint32_t p = BT_SUPER_PAGES; p < nor.size / BT_PAGE_SIZE; p++) {
+        total_erase += nor.erase_count[p];
+        if (nor.erase_count[p] > max_erase) {
+            max_erase = nor.erase_count[p];
+        }
+    }
+    printf("Desgaste de páginas de nodos: máximo %lu borrados, promedio %.1f\n",
+           (unsigned long)max_erase,
+           (double)total_erase / (nor.size / BT_PAGE_SIZE - BT_SUPER_PAGES));
+    printf("Verificación tras el montaje: %lu claves, %s\n", (unsigned long)expected,
+           errors ? "ERRORES" : "OK");
+
+    close(nor.fd);
+    return errors ? 1 : 0;
+}
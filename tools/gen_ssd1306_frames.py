@@ -0,0 +1,99 @@
+#!/usr/bin/env python3
+"""
+Generador de cuadros pre-renderizados para el display SSD1306.
+
+Lee la tabla de glifos de ssd1306_font.h y produce ssd1306_frames.h con una
+imagen completa de 4 páginas x 128 columnas para cada pantalla estática. El
+resultado es idéntico byte a byte a lo que produce write_string() en
+ssd1306_display.c, pero queda en flash y se muestra con una sola copia.
+
+Uso: gen_ssd1306_frames.py <ssd1306_font.h> <salida.h>
+"""
+
+import re
+import sys
+
+WIDTH = 128
+HEIGHT = 32
+PAGE_HEIGHT = 8
+BUF_LEN = (HEIGHT // PAGE_HEIGHT) * WIDTH
+
+# Pantallas estáticas: (x, y, texto) con la misma semántica que write_string().
+# DISPLAY_MSG_STANDBY solo contiene el fondo; la fecha y hora se escriben encima.
+SCREENS = [
+    ("DISPLAY_MSG_STANDBY", [(20, 0, "SISTEMA LISTO")]),
+    ("DISPLAY_MSG_ENTER_ID", [(20, 8, "INGRESE SU ID")]),
+    ("DISPLAY_MSG_ENTER_PASSWORD", [(8, 4, "INGRESE SU"),
+                                    (20, 16, "CONTRASENA")]),
+    ("DISPLAY_MSG_WELCOME", [(30, 8, "BIENVENIDO")]),
+    ("DISPLAY_MSG_INVALID", [(8, 0, "USUARIO O"),
+                             (8, 8, "CONTRASENA"),
+                             (20, 16, "INVALIDOS")]),
+    ("DISPLAY_MSG_CHANGE_USER", [(16, 0, "CAMBIAR USUARIO"),
+                                 (8, 16, "NUEVA CONTRASENA")]),
+]
+
+GLYPH_RE = re.compile(r"^\s*((?:0x[0-9a-fA-F]{2},\s*){8})//\s?(.*)$")
+
+
+def load_font(path):
+    """Retorna (lista de glifos, mapa carácter -> índice)."""
+    glyphs = []
+    index = {}
+    with open(path, encoding="utf-8") as f:
+        for line in f:
+            m = GLYPH_RE.match(line)
+            if not m:
+                continue
+            data = [int(b, 16) for b in re.findall(r"0x[0-9a-fA-F]{2}", m.group(1))]
+            label = m.group(2).strip()
+            if len(label) == 1:
+                index[label] = len(glyphs)
+                if label.isalpha():
+                    index[label.lower()] = len(glyphs)
+            glyphs.append(data)
+    if not glyphs:
+        sys.exit("error: no se encontraron glifos en " + path)
+    return glyphs, index
+
+
+def write_string(buf, glyphs, index, x, y, text):
+    """Réplica exacta de write_string()/write_char() del driver."""
+    if x > WIDTH - 8 or y > HEIGHT - 8:
+        return
+    for ch in text:
+        if x > WIDTH - 8:
+            break
+        glyph = glyphs[index.get(ch, 0)]
+        fb_idx = (y // 8) * WIDTH + x
+        buf[fb_idx:fb_idx + 8] = glyph
+        x += 8
+
+
+def main():
+    if len(sys.argv) != 3:
+        sys.exit(__doc__)
+    glyphs, index = load_font(sys.argv[1])
+
+    out = []
+    out.append("/* Archivo generado por tools/gen_ssd1306_frames.py - NO EDITAR */\n")
+    out.append("#ifndef SSD1306_FRAMES_H\n#define SSD1306_FRAMES_H\n\n")
+    out.append("#include <stdint.h>\n#include \"ssd1306_display.h\"\n\n")
+    out.append("#define SSD1306_FRAME_LEN %d\n\n" % BUF_LEN)
+    out.append("static const uint8_t ssd1306_frames[DISPLAY_MSG_CUSTOM][SSD1306_FRAME_LEN] = {\n")
+    for name, items in SCREENS:
+        buf = [0] * BUF_LEN
+        for x, y, text in items:
+            write_string(buf, glyphs, index, x, y, text)
+        out.append("    [%s] = {\n" % name)
+        for i in range(0, BUF_LEN, 16):
+            out.append("        " + ", ".join("0x%02x" % b for b in buf[i:i + 16]) + ",\n")
+        out.append("    },\n")
+    out.append("};\n\n#endif /* SSD1306_FRAMES_H */\n")
+
+    with open(sys.argv[2], "w", encoding="utf-8") as f:
+        f.write("".join(out))
+
+
+if __name__ == "__main__":
+    main()
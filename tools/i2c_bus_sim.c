@@ -0,0 +1,535 @@
+/**
+ * @file i2c_bus_sim.c
+ * @brief Bus I2C simulado en el host para el gestor de transacciones
+ * @author Sistema de Control de Acceso
+ * @date 2025
+ *
+ * Enlaza el mismo i2c_sched.c del firmware con un bus simulado a
+ * BOARD_I2C_KHZ (9 ciclos de reloj por byte más START, STOP e inicio
+ * repetido) y tres dispositivos con comportamiento propio:
+ *
+ * - SSD1306 (0x3C): ventana de columnas y páginas y escritura horizontal en
+ *   su memoria gráfica. Cada cuadro de 512 bytes llega del cliente "display"
+ *   cada DISPLAY_FRAME_PERIOD_MS y se compara con la memoria del
+ *   dispositivo al terminar, así que una parte perdida o intercalada se
+ *   detecta.
+ * - EEPROM 24C32 (0x50): páginas de 32 bytes y SIM_EEPROM_WRITE_US de
+ *   escritura interna durante los cuales no responde (NACK). El cliente
+ *   escribe una página, sondea hasta que responde y la relee.
+ * - RTC DS3231 (0x68): el cliente "rtc" lee los 7 registros de hora con
+ *   prioridad alta cada SIM_RTC_PERIOD_US.
+ *
+ * Cada cliente espera el resultado de su transacción antes de pedir la
+ * siguiente, como las tareas que usan i2c_bus_transfer. Se comparan tres
+ * configuraciones con la misma semilla: prioridades con cuadros divididos
+ * (el gestor), prioridades sin dividir, y una sola FIFO sin dividir (el bus
+ * tomado por orden de llegada, como antes del gestor).
+ *
+ * Compilar y ejecutar desde la raíz del proyecto:
+ *
+ *     cc -std=c11 -O2 -I. tools/i2c_bus_sim.c i2c_sched.c -o i2c_bus_sim
+ *     ./i2c_bus_sim [-d segundos] [-s semilla]
+ *
+ * No se modelan el estiramiento de reloj ni el tiempo de CPU de las tareas:
+ * solo el bus y el costo fijo SIM_TRANSFER_OVERHEAD_US por transferencia.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "board.h"
+#include "i2c_sched.h"
+#include "ssd1306_display.h"
+
+/** @brief Costo de preparar cada transferencia (TAR, despertar al gestor) */
+#define SIM_TRANSFER_OVERHEAD_US    15
+
+/** @brief Período de lectura del RTC */
+#define SIM_RTC_PERIOD_US           10000
+
+/** @brief Período de escritura de una página de EEPROM */
+#define SIM_EEPROM_PERIOD_US        100000
+
+/** @brief Escritura interna de la EEPROM tras el STOP */
+#define SIM_EEPROM_WRITE_US         5000
+
+/** @brief Espera entre sondeos de la EEPROM ocupada */
+#define SIM_EEPROM_POLL_US          500
+
+/** @brief Duración por defecto */
+#define SIM_DEFAULT_SECONDS         60
+
+/** @brief Muestras de latencia por cliente */
+#define SIM_MAX_SAMPLES             20000
+
+#define OLED_ADDR                   0x3C
+#define OLED_WIDTH                  128
+#define OLED_PAGES                  4
+#define EEPROM_ADDR                 0x50
+#define EEPROM_SIZE                 4096
+#define EEPROM_PAGE                 32
+#define RTC_ADDR                    0x68
+#define RTC_REGS                    19
+
+/**
+ * @brief Configuración comparada
+ */
+typedef struct {
+    const char *name;
+    bool split;                 /**< Cuadros del display con IQ_TXN_SPLIT */
+    bool priorities;            /**< false = todas las transacciones en IQ_PRIO_LOW */
+} sim_mode_t;
+
+/**
+ * @brief Cliente simulado (una transacción a la vez)
+ */
+typedef struct sim_client {
+    const char *name;
+    int id;
+    uint8_t priority;
+    bool busy;                  /**< Transacción en la cola */
+    uint64_t next_us;           /**< Próxima transacción a encolar */
+    int step;                   /**< Paso de la secuencia del cliente */
+    iq_txn_t txn;
+    uint32_t latency[SIM_MAX_SAMPLES];
+    uint32_t samples;
+    uint32_t failures;          /**< Verificaciones fallidas */
+    uint32_t nacks;
+} sim_client_t;
+
+/* ---- Dispositivos ------------------------------------------------------ */
+
+static struct {
+    uint8_t ram[OLED_PAGES * OLED_WIDTH];
+    uint8_t col_start, col_end, page_start, page_end;
+    uint8_t col, page;
+} oled;
+
+static struct {
+    uint8_t mem[EEPROM_SIZE];
+    uint16_t pointer;
+    uint64_t busy_until_us;
+} eeprom;
+
+static struct {
+    uint8_t regs[RTC_REGS];
+    uint8_t pointer;
+} rtc;
+
+static uint64_t now_us;
+static uint32_t rng_state;
+
+/**
+ * @brief Generador xorshift32 (determinista para una semilla)
+ */
+static uint32_t rng_next(void) {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return rng_state;
+}
+
+static int cmp_u32(const void *a, const void *b) {
+    uint32_t x = *(const uint32_t *)a, y = *(const uint32_t *)b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * @brief Comandos y datos para el SSD1306
+ */
+static void oled_write(const uint8_t *buf, uint32_t len) {
+    if (len == 0) {
+        return;
+    }
+
+    if (buf[0] == 0x40) {
+        for (uint32_t i = 1; i < len; i++) {
+            oled.ram[oled.page * OLED_WIDTH + oled.col] = buf[i];
+            if (++oled.col > oled.col_end) {
+                oled.col = oled.col_start;
+                if (++oled.page > oled.page_end) {
+                    oled.page = oled.page_start;
+                }
+            }
+        }
+        return;
+    }
+
+    for (uint32_t i = 1; i < len; i++) {
+        if (buf[i] == 0x21 && i + 2 < len) {
+            oled.col_start = oled.col = buf[i + 1] % OLED_WIDTH;
+            oled.col_end = buf[i + 2] % OLED_WIDTH;
+            i += 2;
+        } else if (buf[i] == 0x22 && i + 2 < len) {
+            oled.page_start = oled.page = buf[i + 1] % OLED_PAGES;
+            oled.page_end = buf[i + 2] % OLED_PAGES;
+            i += 2;
+        }
+    }
+}
+
+/**
+ * @brief Escritura y lectura de la 24C32 (la escritura da la vuelta en la página)
+ */
+static bool eeprom_transfer(const uint8_t *buf, uint32_t len, uint8_t *rbuf, uint16_t rlen) {
+    if (now_us < eeprom.busy_until_us) {
+        return false;
+    }
+
+    if (len >= 2) {
+        eeprom.pointer = (uint16_t)(((buf[0] << 8) | buf[1]) % EEPROM_SIZE);
+    }
+    if (len > 2) {
+        uint16_t page = eeprom.pointer & ~(EEPROM_PAGE - 1);
+        for (uint32_t i = 2; i < len; i++) {
+            eeprom.mem[page | (eeprom.pointer & (EEPROM_PAGE - 1))] = buf[i];
+            eeprom.pointer = page | ((eeprom.pointer + 1) & (EEPROM_PAGE - 1));
+        }
+        eeprom.busy_until_us = now_us + SIM_EEPROM_WRITE_US;
+    }
+    for (uint16_t i = 0; i < rlen; i++) {
+        rbuf[i] = eeprom.mem[eeprom.pointer];
+        eeprom.pointer = (eeprom.pointer + 1) % EEPROM_SIZE;
+    }
+    return true;
+}
+
+/**
+ * @brief Lectura de registros del DS3231
+ */
+static bool rtc_transfer(const uint8_t *buf, uint32_t len, uint8_t *rbuf, uint16_t rlen) {
+    if (len >= 1) {
+        rtc.pointer = buf[0] % RTC_REGS;
+    }
+    for (uint16_t i = 0; i < rlen; i++) {
+        rbuf[i] = rtc.regs[rtc.pointer];
+        rtc.pointer = (rtc.pointer + 1) % RTC_REGS;
+    }
+    return true;
+}
+
+/**
+ * @brief Ejecuta una transferencia en el bus simulado
+ *
+ * @param duration_us Tiempo de bus ocupado
+ */
+static iq_result_t bus_transfer(const iq_chunk_t *chunk, uint32_t *duration_us) {
+    static uint8_t buf[0x10000];
+    uint32_t len = 0;
+
+    for (uint8_t s = 0; s < chunk->seg_count; s++) {
+        memcpy(&buf[len], chunk->seg[s].data, chunk->seg[s].len);
+        len += chunk->seg[s].len;
+    }
+
+    bool ack;
+    switch (chunk->addr) {
+        case OLED_ADDR:
+            oled_write(buf, len);
+            ack = true;
+            break;
+        case EEPROM_ADDR:
+            ack = eeprom_transfer(buf, len, chunk->read_buf, chunk->read_len);
+            break;
+        case RTC_ADDR:
+            ack = rtc_transfer(buf, len, chunk->read_buf, chunk->read_len);
+            break;
+        default:
+            ack = false;
+            break;
+    }
+
+    // START + dirección (9 ciclos) + 9 por byte + STOP; la lectura agrega
+    // el inicio repetido y otra dirección. Un NACK corta tras la dirección
+    uint32_t bits = 1 + 9 + 1;
+    if (ack) {
+        bits += 9 * len;
+        if (chunk->read_len > 0) {
+            bits += (len > 0 ? 1 + 9 : 0) + 9 * chunk->read_len;
+        }
+    }
+    *duration_us = SIM_TRANSFER_OVERHEAD_US + (bits * 1000u + BOARD_I2C_KHZ - 1) / BOARD_I2C_KHZ;
+    return ack ? IQ_OK : IQ_ERR_NACK;
+}
+
+/* ---- Clientes ---------------------------------------------------------- */
+
+static uint8_t frame[OLED_PAGES * OLED_WIDTH];
+static const uint8_t oled_ctrl_cmd = 0x00;
+static const uint8_t oled_ctrl_data = 0x40;
+static const uint8_t oled_window[] = { 0x21, 0, OLED_WIDTH - 1, 0x22, 0, OLED_PAGES - 1 };
+static uint8_t eeprom_tx[2 + EEPROM_PAGE];
+static uint8_t eeprom_rx[EEPROM_PAGE];
+static uint16_t eeprom_page_addr;
+static const uint8_t rtc_reg0 = 0;
+static uint8_t rtc_rx[7];
+
+static sim_client_t clients[3];
+static const sim_mode_t *mode;
+
+/**
+ * @brief Finalización de una transacción: avanza la secuencia del cliente
+ */
+static void sim_done(const iq_txn_t *txn, iq_result_t result) {
+    sim_client_t *c = txn->ctx;
+    uint32_t period = 0;
+
+    c->busy = false;
+    if (result == IQ_ERR_NACK) {
+        c->nacks++;
+    }
+
+    if (c == &clients[0]) {
+        // Ventana -> cuadro -> esperar el próximo período
+        if (c->step == 0) {
+            c->step = 1;
+            c->next_us = now_us;
+            return;
+        }
+        if (memcmp(oled.ram, frame, sizeof(frame)) != 0) {
+            c->failures++;
+        }
+        c->step = 0;
+        period = DISPLAY_FRAME_PERIOD_MS * 1000u;
+    } else if (c == &clients[1]) {
+        // Escribir página -> sondear hasta que responda y releerla
+        if (c->step == 0) {
+            c->step = 1;
+            c->next_us = now_us + SIM_EEPROM_POLL_US;
+            return;
+        }
+        if (result == IQ_ERR_NACK) {
+            c->next_us = now_us + SIM_EEPROM_POLL_US;
+            return;
+        }
+        if (memcmp(eeprom_rx, &eeprom_tx[2], EEPROM_PAGE) != 0) {
+            c->failures++;
+        }
+        c->step = 0;
+        period = SIM_EEPROM_PERIOD_US;
+    } else {
+        if (result != IQ_OK || memcmp(rtc_rx, rtc.regs, sizeof(rtc_rx)) != 0) {
+            c->failures++;
+        }
+        period = SIM_RTC_PERIOD_US;
+    }
+
+    // Próxima activación: período con fase aleatoria de hasta 1 ms
+    c->next_us += period + rng_next() % 1000u;
+    if (c->next_us < now_us) {
+        c->next_us = now_us;
+    }
+}
+
+/**
+ * @brief Arma la transacción del paso actual del cliente
+ */
+static void build_txn(sim_client_t *c) {
+    iq_txn_t *t = &c->txn;
+    memset(t, 0, sizeof(*t));
+    t->client = (uint8_t)c->id;
+    t->priority = mode->priorities ? c->priority : IQ_PRIO_LOW;
+    t->done = sim_done;
+    t->ctx = c;
+
+    if (c == &clients[0]) {
+        t->addr = OLED_ADDR;
+        t->seg_count = 2;
+        if (c->step == 0) {
+            for (size_t i = 0; i < sizeof(frame); i++) {
+                frame[i] = (uint8_t)rng_next();
+            }
+            t->seg[0] = (iq_segment_t){ &oled_ctrl_cmd, 1 };
+            t->seg[1] = (iq_segment_t){ oled_window, sizeof(oled_window) };
+        } else {
+            t->flags = mode->split ? IQ_TXN_SPLIT : 0;
+            t->seg[0] = (iq_segment_t){ &oled_ctrl_data, 1 };
+            t->seg[1] = (iq_segment_t){ frame, sizeof(frame) };
+        }
+    } else if (c == &clients[1]) {
+        t->addr = EEPROM_ADDR;
+        t->seg_count = 1;
+        if (c->step == 0) {
+            eeprom_page_addr = (uint16_t)((rng_next() % (EEPROM_SIZE / EEPROM_PAGE)) * EEPROM_PAGE);
+            eeprom_tx[0] = (uint8_t)(eeprom_page_addr >> 8);
+            eeprom_tx[1] = (uint8_t)eeprom_page_addr;
+            for (int i = 0; i < EEPROM_PAGE; i++) {
+                eeprom_tx[2 + i] = (uint8_t)rng_next();
+            }
+            t->seg[0] = (iq_segment_t){ eeprom_tx, sizeof(eeprom_tx) };
+        } else {
+            t->seg[0] = (iq_segment_t){ eeprom_tx, 2 };
+            t->read_buf = eeprom_rx;
+            t->read_len = EEPROM_PAGE;
+        }
+    } else {
+        t->addr = RTC_ADDR;
+        t->seg_count = 1;
+        t->seg[0] = (iq_segment_t){ &rtc_reg0, 1 };
+        t->read_buf = rtc_rx;
+        t->read_len = sizeof(rtc_rx);
+    }
+}
+
+/**
+ * @brief Resultado de una configuración
+ */
+typedef struct {
+    iq_sched_t sched;
+    uint64_t elapsed_us;
+} sim_result_t;
+
+/**
+ * @brief Simula una configuración
+ */
+static void simulate(const sim_mode_t *m, uint32_t seconds, uint32_t seed, sim_result_t *res) {
+    iq_sched_t *s = &res->sched;
+    uint64_t end_us = (uint64_t)seconds * 1000000u;
+
+    mode = m;
+    rng_state = seed ? seed : 1;
+    now_us = 0;
+    memset(&oled, 0, sizeof(oled));
+    memset(&eeprom, 0xFF, sizeof(eeprom.mem));
+    eeprom.pointer = 0;
+    eeprom.busy_until_us = 0;
+    for (int i = 0; i < RTC_REGS; i++) {
+        rtc.regs[i] = (uint8_t)(0x10 + i);
+    }
+
+    iq_init(s);
+    static const struct { const char *name; uint8_t priority; } defs[] = {
+        { "display", IQ_PRIO_LOW }, { "eeprom", IQ_PRIO_NORMAL }, { "rtc", IQ_PRIO_HIGH },
+    };
+    for (int i = 0; i < 3; i++) {
+        memset(&clients[i], 0, sizeof(clients[i]));
+        clients[i].name = defs[i].name;
+        clients[i].priority = defs[i].priority;
+        clients[i].id = iq_client(s, defs[i].name);
+        clients[i].next_us = rng_next() % 10000u;
+    }
+
+    while (now_us < end_us) {
+        // Encolar en orden de llegada lo que los clientes pidieron hasta ahora
+        for (;;) {
+            sim_client_t *first = NULL;
+            for (int i = 0; i < 3; i++) {
+                sim_client_t *c = &clients[i];
+                if (!c->busy && c->next_us <= now_us &&
+                    (first == NULL || c->next_us < first->next_us)) {
+                    first = c;
+                }
+            }
+            if (first == NULL) {
+                break;
+            }
+            build_txn(first);
+            if (!iq_submit(s, &first->txn, (uint32_t)first->next_us)) {
+                fprintf(stderr, "ERROR: transacción rechazada (%s)\n", first->name);
+                exit(1);
+            }
+            first->busy = true;
+        }
+
+        iq_chunk_t chunk;
+        if (!iq_next(s, &chunk)) {
+            uint64_t next = end_us;
+            for (int i = 0; i < 3; i++) {
+                if (!clients[i].busy && clients[i].next_us < next) {
+                    next = clients[i].next_us;
+                }
+            }
+            now_us = next;
+            continue;
+        }
+
+        uint32_t duration;
+        uint64_t start_us = now_us;
+        iq_result_t result = bus_transfer(&chunk, &duration);
+        now_us += duration;
+
+        iq_txn_t finished;
+        if (iq_complete(s, &chunk, result, (uint32_t)start_us, (uint32_t)now_us, &finished)) {
+            sim_client_t *c = finished.ctx;
+            if (c->samples < SIM_MAX_SAMPLES) {
+                c->latency[c->samples++] = s->clients[c->id].latency_last_us;
+            }
+            finished.done(&finished, result);
+        }
+    }
+    res->elapsed_us = now_us;
+}
+
+/**
+ * @brief Imprime los resultados de una configuración
+ */
+static void print_result(const sim_mode_t *m, const sim_result_t *res) {
+    const iq_sched_t *s = &res->sched;
+
+    printf("\n%s\n", m->name);
+    printf("  bus ocupado %.1f %%, %lu transferencias, %lu partes adelantadas, cola máx. %u/%d\n",
+           100.0 * (double)s->busy_us / (double)res->elapsed_us,
+           (unsigned long)s->transfers, (unsigned long)s->preemptions,
+           s->peak_depth, IQ_QUEUE_LEN);
+    printf("  %-8s %7s %6s %9s %9s %9s %9s %6s\n",
+           "cliente", "transac", "nack", "prom(us)", "p99(us)", "máx(us)", "espera", "error");
+
+    for (int i = 0; i < 3; i++) {
+        sim_client_t *c = &clients[i];
+        const iq_client_t *st = &s->clients[c->id];
+        uint32_t finished = st->completed + st->errors;
+        uint32_t p99 = 0;
+
+        if (c->samples > 0) {
+            qsort(c->latency, c->samples, sizeof(c->latency[0]), cmp_u32);
+            p99 = c->latency[(c->samples * 99u) / 100u];
+        }
+        printf("  %-8s %7lu %6lu %9lu %9lu %9lu %9lu %6lu\n", c->name,
+               (unsigned long)finished, (unsigned long)c->nacks,
+               finished ? (unsigned long)(st->latency_sum_us / finished) : 0ul,
+               (unsigned long)p99, (unsigned long)st->latency_max_us,
+               (unsigned long)st->wait_max_us, (unsigned long)c->failures);
+    }
+}
+
+int main(int argc, char **argv) {
+    uint32_t seconds = SIM_DEFAULT_SECONDS;
+    uint32_t seed = 1;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-d") == 0 && i + 1 < argc) {
+            seconds = (uint32_t)strtoul(argv[++i], NULL, 0);
+        } else if (strcmp(argv[i], "-s") == 0 && i + 1 < argc) {
+            seed = (uint32_t)strtoul(argv[++i], NULL, 0);
+        } else {
+            fprintf(stderr, "Uso: %s [-d segundos] [-s semilla]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    static const sim_mode_t modes[] = {
+        { "Prioridades y cuadros divididos en partes de IQ_CHUNK_BYTES (gestor)", true, true },
+        { "Prioridades, cuadros en una sola transferencia", false, true },
+        { "Una sola FIFO, cuadros en una sola transferencia (bus por orden de llegada)", false, false },
+    };
+
+    printf("Bus I2C simulado a %d kHz, %lu s: display %d ms, EEPROM %d ms, RTC %d ms\n",
+           BOARD_I2C_KHZ, (unsigned long)seconds, DISPLAY_FRAME_PERIOD_MS,
+           SIM_EEPROM_PERIOD_US / 1000, SIM_RTC_PERIOD_US / 1000);
+
+    bool ok = true;
+    static sim_result_t res;
+    for (size_t m = 0; m < sizeof(modes) / sizeof(modes[0]); m++) {
+        simulate(&modes[m], seconds, seed, &res);
+        print_result(&modes[m], &res);
+        for (int i = 0; i < 3; i++) {
+            ok = ok && clients[i].failures == 0;
+        }
+    }
+
+    printf("\n%s\n", ok ? "Verificación de los dispositivos: OK"
+                        : "ERROR: datos distintos en algún dispositivo");
+    return ok ? 0 : 1;
+}
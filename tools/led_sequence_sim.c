@@ -0,0 +1,311 @@
+/**
+ * @file led_sequence_sim.c
+ * @brief Pruebas en el host del intérprete de secuencias de LEDs
+ * @author Sistema de Control de Acceso
+ * @date 2025
+ *
+ * Enlaza el mismo led_sequence.c del firmware y ejecuta casos con tiempos
+ * escritos a mano: cada caso inicia secuencias, llama a
+ * led_engine_service en los plazos que devuelve (como la corrutina de
+ * LEDs) y compara los LEDs encendidos, el brillo, los bits GPIO y el plazo
+ * siguiente con lo esperado en cada instante. Cubre:
+ * - las secuencias predefinidas (acceso, bloqueo, parpadeo, respiración);
+ * - la composición por LED y el traspaso de LEDs entre secuencias;
+ * - el apagado por duration_ms y la liberación de los reproductores;
+ * - un servicio atrasado (se realinea sin recorrer los pasos perdidos);
+ * - una secuencia sin esperas (se corta en LED_SEQ_MAX_ZERO_STEPS);
+ * - el desborde del contador de ms.
+ *
+ * Compilar y ejecutar desde la raíz del proyecto:
+ *
+ *     cc -std=c11 -O2 -I. tools/led_sequence_sim.c led_sequence.c -o led_sequence_sim
+ *     ./led_sequence_sim [-v]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdarg.h>
+#include "led_sequence.h"
+
+#define V   LED_BIT_VERDE
+#define R   LED_BIT_ROJO
+#define A   LED_BIT_AMARILLO
+
+/**
+ * @brief Estado esperado desde un instante (relativo al inicio del caso)
+ */
+typedef struct {
+    uint32_t t_ms;
+    uint8_t gpio;           /**< led_engine_gpio_bits() */
+} expect_t;
+
+static led_engine_t engine;
+static uint32_t base_ms;        /**< Origen de tiempo del caso */
+static uint32_t now_ms;
+static uint32_t wait_ms;
+static bool verbose;
+static int failures;
+static int checks;
+static const char *current_case;
+
+static void fail(const char *fmt, ...) {
+    va_list args;
+
+    printf("ERROR: %s, t=%lu ms: ", current_case, (unsigned long)(now_ms - base_ms));
+    va_start(args, fmt);
+    vprintf(fmt, args);
+    va_end(args);
+    printf("\n");
+    failures++;
+}
+
+static void begin(const char *name, uint32_t origin_ms) {
+    current_case = name;
+    base_ms = origin_ms;
+    now_ms = origin_ms;
+    led_engine_init(&engine);
+    wait_ms = LED_SEQ_NO_DEADLINE;
+}
+
+static void start(const led_step_t *seq, uint32_t duration_ms) {
+    led_engine_start(&engine, seq, duration_ms, now_ms);
+    wait_ms = led_engine_service(&engine, now_ms);
+}
+
+/**
+ * @brief Avanza hasta t (relativo) atendiendo cada plazo como la corrutina
+ */
+static void advance_to(uint32_t t) {
+    uint32_t target = base_ms + t;
+
+    while (wait_ms != LED_SEQ_NO_DEADLINE && (int32_t)(target - (now_ms + wait_ms)) >= 0) {
+        now_ms += wait_ms;
+        wait_ms = led_engine_service(&engine, now_ms);
+        if (wait_ms == 0) {
+            fail("el plazo siguiente es 0 ms");
+            wait_ms = 1;
+        }
+    }
+    now_ms = target;
+    if (wait_ms != LED_SEQ_NO_DEADLINE) {
+        wait_ms = led_engine_service(&engine, now_ms);
+    }
+}
+
+static void expect_gpio(uint8_t gpio) {
+    uint8_t got = led_engine_gpio_bits(&engine);
+    checks++;
+    if (got != gpio) {
+        fail("LEDs 0x%x en lugar de 0x%x", got, gpio);
+    } else if (verbose) {
+        printf("  %s, t=%lu ms: LEDs 0x%x\n", current_case, (unsigned long)(now_ms - base_ms), got);
+    }
+}
+
+static void expect_wait(uint32_t wait) {
+    checks++;
+    if (wait_ms != wait) {
+        fail("plazo siguiente %lu ms en lugar de %lu ms", (unsigned long)wait_ms, (unsigned long)wait);
+    }
+}
+
+static void expect_free(void) {
+    checks++;
+    for (int i = 0; i < LED_SEQ_MAX_PLAYERS; i++) {
+        if (engine.players[i].seq != NULL) {
+            fail("el reproductor %d sigue ocupado (dueño de 0x%x)", i, engine.players[i].owned);
+        }
+    }
+}
+
+/**
+ * @brief Recorre una línea de tiempo comprobando el estado en cada cambio y
+ * justo antes del siguiente
+ */
+static void expect_timeline(const expect_t *steps, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        if (i > 0 && steps[i].t_ms - 1 > steps[i - 1].t_ms) {
+            advance_to(steps[i].t_ms - 1);
+            expect_gpio(steps[i - 1].gpio);
+        }
+        advance_to(steps[i].t_ms);
+        expect_gpio(steps[i].gpio);
+    }
+}
+
+#define TIMELINE(...) do {                                          \
+        static const expect_t tl_[] = { __VA_ARGS__ };              \
+        expect_timeline(tl_, sizeof(tl_) / sizeof(tl_[0]));         \
+    } while (0)
+
+/* ---- Casos ------------------------------------------------------------- */
+
+static void case_acceso_concedido(void) {
+    begin("acceso concedido", 1000);
+    start(led_seq_acceso_concedido, 0);
+    expect_wait(5000);
+    TIMELINE({ 0, V }, { 5000, 0 });
+    expect_wait(LED_SEQ_NO_DEADLINE);
+    expect_free();
+}
+
+static void case_bloqueo(void) {
+    begin("bloqueo", 0);
+    start(led_seq_bloqueo, 0);
+    TIMELINE({ 0, R }, { 150, 0 }, { 300, R }, { 450, 0 }, { 1050, R },
+             { 1200, 0 }, { 1350, R }, { 1500, 0 });
+    expect_wait(LED_SEQ_NO_DEADLINE);
+    expect_free();
+}
+
+static void case_blink_timed(void) {
+    begin("parpadeo con duración", 0);
+    start(led_seq_amarillo_blink, 3500);
+    TIMELINE({ 0, A }, { 1000, 0 }, { 2000, A }, { 3000, 0 }, { 3500, 0 });
+    expect_free();
+
+    // Apagado en medio de un encendido
+    begin("parpadeo cortado encendido", 0);
+    start(led_seq_amarillo_blink, 2500);
+    TIMELINE({ 0, A }, { 1000, 0 }, { 2000, A }, { 2500, 0 });
+    expect_wait(LED_SEQ_NO_DEADLINE);
+    expect_free();
+}
+
+static void case_composition(void) {
+    begin("composición por LED", 0);
+    start(led_seq_amarillo_blink, 0);
+    advance_to(300);
+    start(led_seq_acceso_concedido, 0);         // El verde no toca al parpadeo
+    TIMELINE({ 300, V | A }, { 1000, V }, { 2000, V | A }, { 3000, V }, { 4000, V | A },
+             { 5000, V }, { 5300, 0 }, { 6000, A });
+    advance_to(6200);
+    start(led_seq_rojo_on, 0);
+    TIMELINE({ 6200, A | R }, { 7000, R }, { 8000, A | R });
+    advance_to(8100);
+    start(led_seq_all_off, 0);                  // Se queda con todos los LEDs
+    expect_gpio(0);
+    expect_wait(LED_SEQ_NO_DEADLINE);
+    expect_free();
+}
+
+static void case_takeover(void) {
+    begin("traspaso del rojo", 0);
+    start(led_seq_bloqueo, 0);
+    advance_to(400);
+    expect_gpio(R);
+    start(led_seq_acceso_denegado, 0);          // Reemplaza al doble destello
+    TIMELINE({ 400, R }, { 1049, R }, { 1200, R }, { 2400, 0 });
+    expect_free();
+}
+
+static void case_breathing(void) {
+    static const uint8_t levels[] = { 16, 48, 96, 160, 224, 255, 224, 160, 96, 48, 16 };
+
+    begin("respiración", 0);
+    start(led_seq_respiracion, 0);
+    uint32_t t = 0;
+    for (int cycle = 0; cycle < 2; cycle++) {
+        for (size_t i = 0; i < sizeof(levels); i++) {
+            advance_to(t);
+            checks++;
+            if (!(engine.on & A) || engine.brightness[2] != levels[i]) {
+                fail("brillo %u en lugar de %u", engine.brightness[2], levels[i]);
+            }
+            expect_gpio(levels[i] >= LED_SEQ_GPIO_THRESHOLD ? A : 0);
+            t += (levels[i] == 255) ? 300 : 100;
+        }
+        advance_to(t);
+        expect_gpio(0);
+        checks++;
+        if (engine.on & A) {
+            fail("amarillo encendido en la pausa");
+        }
+        t += 500;
+    }
+}
+
+static void case_late_service(void) {
+    begin("servicio atrasado", 0);
+    start(led_seq_amarillo_blink, 0);
+    expect_wait(1000);
+
+    // La corrutina no corre por 2,5 s: el paso siguiente se toma ahora y
+    // el parpadeo sigue desde aquí, sin recorrer los pasos perdidos
+    now_ms = base_ms + 2500;
+    wait_ms = led_engine_service(&engine, now_ms);
+    expect_gpio(0);
+    expect_wait(1000);
+    TIMELINE({ 3500, A }, { 4500, 0 }, { 5500, A });
+
+    // Un atraso menor que el paso conserva la grilla original
+    begin("servicio poco atrasado", 0);
+    start(led_seq_amarillo_blink, 0);
+    now_ms = base_ms + 1014;
+    wait_ms = led_engine_service(&engine, now_ms);
+    expect_gpio(0);
+    expect_wait(986);
+    TIMELINE({ 2000, A }, { 3000, 0 });
+}
+
+static void case_zero_loop(void) {
+    static const led_step_t spin[] = {
+        { LED_OP_STEP, V, V, 255, 0 },
+        { LED_OP_STEP, V, 0, 255, 0 },
+        { LED_OP_LOOP, 0, 0, 0, 0 },
+    };
+    static const led_step_t nothing[] = {
+        { LED_OP_END, 0, 0, 255, 0 },
+    };
+
+    // Vuelve sin colgarse y la secuencia deja de avanzar
+    begin("secuencia sin esperas", 0);
+    start(spin, 0);
+    expect_wait(LED_SEQ_NO_DEADLINE);
+    checks++;
+    if (engine.players[0].stepping) {
+        fail("la secuencia sigue avanzando");
+    }
+
+    begin("secuencia sin LEDs", 0);
+    start(led_seq_rojo_on, 0);
+    start(nothing, 0);
+    expect_gpio(R);
+}
+
+static void case_wraparound(void) {
+    begin("desborde del contador de ms", UINT32_MAX - 1500);
+    start(led_seq_amarillo_blink, 0);
+    advance_to(300);
+    start(led_seq_acceso_denegado, 0);
+    TIMELINE({ 300, A | R }, { 1000, R }, { 2000, A | R }, { 2300, A }, { 3000, 0 });
+}
+
+int main(int argc, char **argv) {
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-v") == 0) {
+            verbose = true;
+        } else {
+            fprintf(stderr, "uso: %s [-v]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    case_acceso_concedido();
+    case_bloqueo();
+    case_blink_timed();
+    case_composition();
+    case_takeover();
+    case_breathing();
+    case_late_service();
+    case_zero_loop();
+    case_wraparound();
+
+    printf("Comprobaciones: %d, fallas: %d\n", checks, failures);
+    printf("\n%s\n", failures == 0 ? "Verificación del intérprete de secuencias: OK"
+                                   : "ERROR: el intérprete de secuencias no pasó la verificación");
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,438 @@
+/**
+ * @file led_timing_sim.c
+ * @brief Exactitud de los tiempos de los LEDs con comandos durante un patrón
+ * @author Sistema de Control de Acceso
+ * @date 2025
+ *
+ * Enlaza los mismos leds_rtos.c (corrutina led_run), led_sequence.c,
+ * coop.c y event_bus.c del firmware con un reloj simulado de 1 ms y
+ * registra cada escritura de los pines. Los comandos llegan al azar
+ * (separación media SIM_CMD_MEAN_MS), la mayoría en medio de un patrón
+ * activo: parpadeo, bloqueo, respiración o un acceso concedido de 5 s.
+ *
+ * La referencia se calcula aparte, ms a ms y por LED: manda el último
+ * comando que toca ese LED, y su nivel es el del paso de la secuencia que
+ * corresponde al tiempo transcurrido desde que la corrutina lo tomó del
+ * bus (sumando duraciones, con LOOP como período), o apagado si pasó su
+ * duration_ms. Verifica que:
+ * - sin otra carga en el ejecutor cada comando se atiende en el mismo ms
+ *   y los pines coinciden con la referencia en todos los ms (sin atraso ni
+ *   deriva);
+ * - con una corrutina de display que ocupa al ejecutor SIM_FRAME_MS por
+ *   cuadro, ningún comando espera ni ningún flanco se atrasa más de dos
+ *   cuadros (el que estaba en curso y, como mucho, uno más si al display
+ *   le toca primero en la ronda siguiente), y el atraso no se acumula a lo
+ *   largo de un patrón.
+ *
+ * Compilar y ejecutar desde la raíz del proyecto:
+ *
+ *     cc -std=c11 -O2 -Itools/replay/shim -I. tools/led_timing_sim.c \
+ *        leds_rtos.c led_sequence.c coop.c event_bus.c -lm -o led_timing_sim
+ *     ./led_timing_sim [-d segundos] [-s semilla]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <math.h>
+#include "leds.h"
+#include "led_sequence.h"
+#include "system_bus.h"
+#include "event_bus.h"
+#include "task_health.h"
+#include "executor.h"
+#include "task.h"
+
+#define SIM_DEFAULT_SECONDS     300
+
+/** @brief Separación media entre comandos de LEDs (ms) */
+#define SIM_CMD_MEAN_MS         700
+
+/** @brief Cuadro del display y separación media entre cuadros (ms) */
+#define SIM_FRAME_MS            14
+#define SIM_FRAME_MEAN_MS       200
+
+/** @brief Comandos registrados como máximo */
+#define SIM_MAX_CMDS            (1u << 16)
+
+/* ---- Reloj, bus y ejecutor --------------------------------------------- */
+
+static uint32_t now_ms;
+static uint32_t rng_state;
+
+static co_exec_t exec;
+static uint32_t pending_signals;
+static eb_bus_t bus;
+
+/** @brief Corrutina que simula la carga del display en el mismo ejecutor */
+static co_t load_co;
+static int load_id = -1;
+
+/** @brief Nivel de los pines de LED (LED_BIT_*) en cada ms */
+static uint8_t *levels;
+static uint32_t levels_filled;
+static uint8_t gpio_bits;
+
+/** @brief Comandos enviados, en orden */
+static struct {
+    uint32_t sent_ms;
+    uint32_t start_ms;          /**< Instante en que la corrutina lo tomó del bus */
+    led_command_t command;
+    uint32_t duration_ms;
+} cmds[SIM_MAX_CMDS];
+static uint32_t cmd_count;
+
+/** @brief Comando que ocupa cada ranura del bus */
+static uint32_t slot_cmd[EB_POOL_SLOTS];
+
+/** @brief Secuencias de cada comando (misma tabla que leds_rtos.c) */
+static const led_step_t *const sequences[] = {
+    [LED_CMD_VERDE_ON]         = led_seq_verde_on,
+    [LED_CMD_VERDE_OFF]        = led_seq_verde_off,
+    [LED_CMD_ROJO_ON]          = led_seq_rojo_on,
+    [LED_CMD_ROJO_OFF]         = led_seq_rojo_off,
+    [LED_CMD_AMARILLO_ON]      = led_seq_amarillo_on,
+    [LED_CMD_AMARILLO_OFF]     = led_seq_amarillo_off,
+    [LED_CMD_AMARILLO_BLINK]   = led_seq_amarillo_blink,
+    [LED_CMD_ALL_OFF]          = led_seq_all_off,
+    [LED_CMD_ACCESO_CONCEDIDO] = led_seq_acceso_concedido,
+    [LED_CMD_ACCESO_DENEGADO]  = led_seq_acceso_denegado,
+    [LED_CMD_SISTEMA_LISTO]    = led_seq_amarillo_on,
+    [LED_CMD_PROCESO_INICIADO] = led_seq_amarillo_off,
+    [LED_CMD_ESPERANDO_CLAVE]  = led_seq_amarillo_blink,
+    [LED_CMD_BLOQUEO]          = led_seq_bloqueo,
+    [LED_CMD_RESPIRACION]      = led_seq_respiracion,
+};
+
+#define NUM_COMMANDS (sizeof(sequences) / sizeof(sequences[0]))
+
+static uint32_t rng_next(void) {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return rng_state;
+}
+
+static double rng_unit(void) {
+    return (rng_next() >> 8) * (1.0 / 16777216.0);
+}
+
+static uint32_t rng_exp_ms(uint32_t mean_ms) {
+    return 1 + (uint32_t)(-log(1.0 - rng_unit()) * mean_ms);
+}
+
+/**
+ * @brief Registra el nivel de los pines hasta el ms actual (exclusive)
+ */
+static void fill_levels(uint32_t until_ms) {
+    while (levels_filled < until_ms) {
+        levels[levels_filled++] = gpio_bits;
+    }
+}
+
+/* ---- Dependencias de leds_rtos.c --------------------------------------- */
+
+void gpio_init_mask(uint32_t mask) { (void)mask; }
+void gpio_set_dir_out_masked(uint32_t mask) { (void)mask; }
+void gpio_clr_mask(uint32_t mask) { (void)mask; }
+
+void gpio_put_masked(uint32_t mask, uint32_t value) {
+    uint8_t bits = 0;
+
+    for (uint8_t b = 0; b <= LED_BIT_ALL; b++) {
+        if (board_led_gpio[b] == (value & mask)) {
+            bits = b;
+        }
+    }
+    fill_levels(now_ms);
+    gpio_bits = bits;
+}
+
+TickType_t xTaskGetTickCount(void) {
+    return (TickType_t)now_ms;
+}
+
+int executor_add(co_t *co, const char *name, co_fn fn) {
+    return co_add(&exec, co, name, fn);
+}
+
+int executor_subscribe(int id, const char *name, uint32_t topics, uint8_t flags) {
+    (void)id;
+    return eb_subscribe(&bus, name, topics, flags);
+}
+
+eb_msg_t *bus_alloc(bus_topic_t topic) {
+    return eb_alloc(&bus, (uint8_t)topic);
+}
+
+bool bus_publish(eb_msg_t *msg) {
+    slot_cmd[msg->index] = cmd_count - 1;
+    uint32_t delivered = eb_publish(&bus, msg);
+    if (delivered != 0) {
+        // La única suscripta es la corrutina de LEDs (la primera registrada)
+        pending_signals |= 1u << 0;
+    }
+    return delivered != 0;
+}
+
+const eb_msg_t *bus_poll(int sub) {
+    const eb_msg_t *msg = eb_pop(&bus, sub);
+    if (msg != NULL) {
+        cmds[slot_cmd[msg->index]].start_ms = now_ms;
+    }
+    return msg;
+}
+
+void bus_release(const eb_msg_t *msg) {
+    eb_release(&bus, msg);
+}
+
+void task_health_begin(health_task_id_t id) { (void)id; }
+void task_health_end(health_task_id_t id) { (void)id; }
+
+/* ---- Referencia -------------------------------------------------------- */
+
+/**
+ * @brief Nivel de un LED a elapsed_ms de iniciada una secuencia
+ *
+ * Recorre los pasos sumando duraciones; LOOP vuelve al primero con el
+ * período de la secuencia. Sin PWM un LED encendido solo se ve con brillo
+ * de al menos LED_SEQ_GPIO_THRESHOLD.
+ */
+static bool ref_step_level(const led_step_t *seq, uint8_t bit, uint32_t elapsed_ms) {
+    uint32_t period = 0;
+    bool level = false;
+
+    for (const led_step_t *s = seq; s->op == LED_OP_STEP; s++) {
+        period += s->duration_ms;
+    }
+
+    uint32_t t = 0;
+    for (const led_step_t *s = seq; ; s++) {
+        if (s->op == LED_OP_LOOP) {
+            elapsed_ms %= period;
+            t = 0;
+            s = seq - 1;
+            continue;
+        }
+        if (s->mask & bit) {
+            level = (s->on & bit) && s->brightness >= LED_SEQ_GPIO_THRESHOLD;
+        }
+        if (s->op == LED_OP_END || elapsed_ms < t + s->duration_ms) {
+            return level;
+        }
+        t += s->duration_ms;
+    }
+}
+
+static uint8_t seq_mask(const led_step_t *seq) {
+    uint8_t mask = 0;
+    for (const led_step_t *s = seq; ; s++) {
+        mask |= s->mask;
+        if (s->op != LED_OP_STEP) {
+            return mask;
+        }
+    }
+}
+
+/* ---- Simulación -------------------------------------------------------- */
+
+/**
+ * @brief Cuadros del display: ocupan al ejecutor SIM_FRAME_MS
+ */
+static void load_run(co_t *co) {
+    CO_BEGIN(co);
+    while (1) {
+        CO_WAIT(co, CO_FOREVER);
+        now_ms += SIM_FRAME_MS;
+    }
+    CO_END(co);
+}
+
+/**
+ * @brief Comando al azar enviado por otra tarea en sent_ms
+ *
+ * Si el ejecutor estaba ocupado en un cuadro, el comando ya esperaba en el
+ * bus desde sent_ms.
+ */
+static void send_random(uint32_t sent_ms) {
+    led_command_t command = (led_command_t)(rng_next() % NUM_COMMANDS);
+    uint32_t duration_ms = 0;
+
+    // Algunos encendidos y parpadeos con duración, como los del control de acceso
+    if ((rng_next() & 3) == 0 && command != LED_CMD_ALL_OFF) {
+        duration_ms = 100 + rng_next() % 3000;
+    }
+    if (cmd_count == SIM_MAX_CMDS) {
+        return;
+    }
+    cmds[cmd_count].sent_ms = sent_ms;
+    cmds[cmd_count].command = command;
+    cmds[cmd_count].duration_ms = duration_ms;
+    cmd_count++;
+    if (!led_send_command(command, duration_ms)) {
+        printf("ERROR: el bus rechazó un comando\n");
+        exit(1);
+    }
+}
+
+/**
+ * @brief Una corrida completa
+ *
+ * @param with_load true para sumar la corrutina de display al ejecutor
+ * @param max_late_ms Mayor tramo de ms seguidos distinto de la referencia, por LED
+ * @param max_latency_ms Mayor espera de un comando en el bus
+ * @return Flancos de la referencia
+ */
+static uint32_t run(uint32_t duration_ms, bool with_load, uint32_t max_late_ms[LED_SEQ_NUM_LEDS],
+                    uint32_t *max_latency_ms) {
+    co_exec_init(&exec, NULL);
+    eb_init(&bus);
+    now_ms = 0;
+    levels_filled = 0;
+    gpio_bits = 0;
+    cmd_count = 0;
+    pending_signals = 0;
+
+    if (!leds_init()) {
+        printf("ERROR: no se pudieron inicializar los LEDs\n");
+        exit(1);
+    }
+    load_id = with_load ? co_add(&exec, &load_co, "display", load_run) : -1;
+
+    uint32_t next_cmd = rng_exp_ms(SIM_CMD_MEAN_MS);
+    uint32_t next_frame = with_load ? rng_exp_ms(SIM_FRAME_MEAN_MS) : UINT32_MAX;
+    uint32_t wake_ms = 0;
+
+    while (now_ms < duration_ms) {
+        uint32_t signals;
+
+        while (now_ms >= next_cmd) {
+            send_random(next_cmd);
+            next_cmd += rng_exp_ms(SIM_CMD_MEAN_MS);
+        }
+        if (now_ms >= next_frame) {
+            pending_signals |= 1u << load_id;
+            next_frame += rng_exp_ms(SIM_FRAME_MEAN_MS);
+        }
+
+        signals = pending_signals;
+        pending_signals = 0;
+        if (signals != 0 || now_ms >= wake_ms) {
+            uint32_t round_ms = now_ms;
+            uint32_t wait = co_run(&exec, round_ms, signals);
+            wake_ms = (wait == CO_FOREVER) ? UINT32_MAX : round_ms + wait;
+            if (wait == 0 || now_ms != round_ms) {
+                // Ronda que ocupó tiempo o con turnos cedidos: otra ronda ya
+                continue;
+            }
+        }
+        now_ms++;
+    }
+    fill_levels(duration_ms);
+
+    *max_latency_ms = 0;
+    for (uint32_t i = 0; i < cmd_count; i++) {
+        if (cmds[i].start_ms - cmds[i].sent_ms > *max_latency_ms) {
+            *max_latency_ms = cmds[i].start_ms - cmds[i].sent_ms;
+        }
+    }
+
+    // Comparación ms a ms con la referencia, por LED
+    uint32_t edges = 0;
+    for (int led = 0; led < LED_SEQ_NUM_LEDS; led++) {
+        uint8_t bit = (uint8_t)(1u << led);
+        int32_t last = -1;              // Último comando que toca el LED
+        uint32_t next = 0;
+        uint32_t run_ms = 0;
+        bool prev_expected = false;
+
+        max_late_ms[led] = 0;
+        for (uint32_t t = 0; t < duration_ms; t++) {
+            while (next < cmd_count && cmds[next].start_ms <= t) {
+                if (seq_mask(sequences[cmds[next].command]) & bit) {
+                    last = (int32_t)next;
+                }
+                next++;
+            }
+
+            bool expected = false;
+            if (last >= 0) {
+                uint32_t elapsed = t - cmds[last].start_ms;
+                if (cmds[last].duration_ms == 0 || elapsed < cmds[last].duration_ms) {
+                    expected = ref_step_level(sequences[cmds[last].command], bit, elapsed);
+                }
+            }
+            edges += (expected != prev_expected);
+            prev_expected = expected;
+
+            bool got = (levels[t] & bit) != 0;
+            run_ms = (got != expected) ? run_ms + 1 : 0;
+            if (run_ms > max_late_ms[led]) {
+                max_late_ms[led] = run_ms;
+            }
+        }
+    }
+    return edges;
+}
+
+int main(int argc, char **argv) {
+    uint32_t duration_s = SIM_DEFAULT_SECONDS;
+    rng_state = 12345;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-d") == 0 && i + 1 < argc) {
+            duration_s = (uint32_t)strtoul(argv[++i], NULL, 0);
+        } else if (strcmp(argv[i], "-s") == 0 && i + 1 < argc) {
+            rng_state = (uint32_t)strtoul(argv[++i], NULL, 0);
+        } else {
+            fprintf(stderr, "uso: %s [-d segundos] [-s semilla]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (rng_state == 0 || duration_s == 0 || duration_s > 3600) {
+        fprintf(stderr, "la semilla no puede ser 0 y la duración debe estar entre 1 y 3600 s\n");
+        return 1;
+    }
+
+    uint32_t duration_ms = duration_s * 1000;
+    levels = malloc(duration_ms);
+    if (levels == NULL) {
+        return 1;
+    }
+
+    static const char *const names[LED_SEQ_NUM_LEDS] = { "verde", "rojo", "amarillo" };
+    bool ok = true;
+
+    for (int pass = 0; pass < 2; pass++) {
+        bool with_load = (pass == 1);
+        uint32_t bound = with_load ? 2 * SIM_FRAME_MS : 0;
+        uint32_t late[LED_SEQ_NUM_LEDS];
+        uint32_t latency;
+        uint32_t edges = run(duration_ms, with_load, late, &latency);
+
+        printf("%s: %u comandos, %u flancos esperados, espera máxima en el bus %u ms\n",
+               with_load ? "Con cuadros del display" : "Solo LEDs",
+               (unsigned)cmd_count, (unsigned)edges, (unsigned)latency);
+        if (latency > bound) {
+            printf("ERROR: un comando esperó %u ms en el bus\n", (unsigned)latency);
+            ok = false;
+        }
+        for (int led = 0; led < LED_SEQ_NUM_LEDS; led++) {
+            printf("  %-9s atraso máximo %3u ms (cota %u ms)\n",
+                   names[led], (unsigned)late[led], (unsigned)bound);
+            if (late[led] > bound) {
+                printf("ERROR: el LED %s se apartó de la referencia %u ms seguidos\n",
+                       names[led], (unsigned)late[led]);
+                ok = false;
+            }
+        }
+    }
+    free(levels);
+
+    printf("\n%s\n", ok ? "Verificación de los tiempos de los LEDs: OK"
+                        : "ERROR: los LEDs no pasaron la verificación de tiempos");
+    return ok ? 0 : 1;
+}
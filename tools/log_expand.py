@@ -0,0 +1,127 @@
+#!/usr/bin/env python3
+"""
+Expande los registros binarios del log diferido a texto.
+
+El firmware (log.c con LOG_BINARY_OUTPUT = 1) envía cada mensaje como una
+línea "@L <hex>" con la dirección del formato y los argumentos sin formatear.
+Este script lee los formatos (y las cadenas constantes usadas con %s) desde
+el ELF de la misma compilación y reproduce el texto. Las líneas que no son
+registros de log se copian tal cual.
+
+Uso: log_expand.py <firmware.elf> [captura.txt]   (sin captura lee stdin)
+"""
+
+import os
+import re
+import struct
+import sys
+
+LEVELS = ["-", "ERROR", "WARN", "INFO", "DEBUG"]
+
+# log_record_t: timestamp_us, format, level, module, nargs, reserved, args[]
+HEADER = struct.Struct("<IIBBBB")
+
+CONVERSION = re.compile(r"%([-+ #0]*)(\d+)?(?:\.(\d+))?(hh|h|ll|l|z|j|t)?([diouxXcsp%])")
+
+
+def load_modules():
+    """Nombres de módulo en el orden de log_module_t (log.h)."""
+    header = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "log.h")
+    with open(header, encoding="utf-8") as f:
+        text = f.read()
+    names = re.findall(r"^\s*LOG_MOD_(\w+),", text, re.MULTILINE)
+    return [n.lower() for n in names if n != "COUNT"]
+
+
+class Elf:
+    """Acceso mínimo de solo lectura a las secciones cargables de un ELF32."""
+
+    def __init__(self, path):
+        with open(path, "rb") as f:
+            self.data = f.read()
+        if self.data[:4] != b"\x7fELF" or self.data[4] != 1:
+            sys.exit("%s no es un ELF de 32 bits" % path)
+
+        shoff, = struct.unpack_from("<I", self.data, 0x20)
+        shentsize, shnum = struct.unpack_from("<HH", self.data, 0x2E)
+        self.sections = []
+        for i in range(shnum):
+            (_, sh_type, flags, addr, offset, size) = struct.unpack_from(
+                "<IIIIII", self.data, shoff + i * shentsize)
+            # SHF_ALLOC con contenido en el archivo (no SHT_NOBITS)
+            if flags & 0x2 and sh_type != 8 and size > 0:
+                self.sections.append((addr, offset, size))
+
+    def string_at(self, address):
+        for addr, offset, size in self.sections:
+            if addr <= address < addr + size:
+                start = offset + address - addr
+                end = self.data.index(b"\0", start, offset + size)
+                return self.data[start:end].decode("utf-8", errors="replace")
+        return None
+
+
+def format_message(elf, fmt, args):
+    """Aplica un formato printf con argumentos de 32 bits."""
+    values = iter(args)
+
+    def convert(m):
+        flags, width, precision, _, conv = m.groups()
+        if conv == "%":
+            return "%"
+        value = next(values, 0)
+        spec = "%" + (flags or "") + (width or "")
+        if precision is not None:
+            spec += "." + precision
+        if conv in "di":
+            return (spec + "d") % (value - (1 << 32) if value & 0x80000000 else value)
+        if conv == "c":
+            return (spec + "c") % chr(value & 0xFF)
+        if conv == "s":
+            text = elf.string_at(value)
+            return (spec + "s") % (text if text is not None else "<0x%08x>" % value)
+        if conv == "p":
+            return "0x%08x" % value
+        return (spec + conv) % value
+
+    return CONVERSION.sub(convert, fmt)
+
+
+def main():
+    if len(sys.argv) not in (2, 3):
+        sys.exit(__doc__)
+
+    elf = Elf(sys.argv[1])
+    modules = load_modules()
+    source = open(sys.argv[2], encoding="utf-8", errors="replace") if len(sys.argv) == 3 else sys.stdin
+
+    base, last = 0, None
+    for line in source:
+        if not line.startswith("@L "):
+            sys.stdout.write(line)
+            continue
+        try:
+            raw = bytes.fromhex(line[3:].strip())
+            ts, fmt_addr, level, module, nargs, _ = HEADER.unpack_from(raw)
+            args = struct.unpack_from("<%dI" % nargs, raw, HEADER.size)
+        except (ValueError, struct.error):
+            sys.stdout.write(line)
+            continue
+
+        # Tiempos de 32 bits: se desbordan cada ~71 minutos
+        if last is not None and ts < last:
+            base += 1 << 32
+        last = ts
+        ts += base
+
+        fmt = elf.string_at(fmt_addr)
+        text = format_message(elf, fmt, args) if fmt is not None else \
+            "<formato desconocido 0x%08x> %s" % (fmt_addr, " ".join("0x%x" % a for a in args))
+        print("[%6d.%06d] %-5s %-8s %s" % (ts // 1000000, ts % 1000000,
+                                         LEVELS[level] if level < len(LEVELS) else level,
+                                         modules[module] if module < len(modules) else module,
+                                         text))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,518 @@
+/**
+ * @file low_power_sim.c
+ * @brief Despertares del núcleo en reposo, con tick periódico y sin tick
+ * @author Sistema de Control de Acceso
+ * @date 2025
+ *
+ * Simula el sistema en reposo con un reloj de 1 µs y cuenta cuántas veces
+ * por minuto el núcleo sale de WFI, en dos configuraciones:
+ * - antes: tick de 1 kHz (configUSE_TICKLESS_IDLE = 0) con los sondeos de
+ *   las tareas anteriores al modo sin tick (LEDs cada 100 ms, control de
+ *   acceso cada 100 ms más una pausa de 50 ms, reloj del display cada 1 s);
+ *   cada tick despierta al núcleo;
+ * - ahora: el vPortSuppressTicksAndSleep() de low_power.c, enlazado tal
+ *   como está en el árbol, con las esperas periódicas que quedan en el
+ *   firmware (reloj del display, revisión de task_health y la espera de la
+ *   consola a que se abra la terminal USB, que en una puerta nunca llega y
+ *   se espacia de 250 ms a 8 s).
+ *
+ * En ambas llegan teclas al azar (-k por minuto): la IRQ de las filas
+ * despierta al núcleo y la tarea del teclado avanza su FSM cada 5 ms
+ * durante SIM_KEY_ACTIVE_MS. Una de cada cuatro teclas llega justo al
+ * entrar en reposo (la suspensión se cancela) y una de cada ocho entradas
+ * en reposo coincide con un SysTick vencido con las interrupciones
+ * deshabilitadas (PENDSTSET).
+ *
+ * Verifica que sin tick:
+ * - el núcleo solo despierta en un plazo de alguna tarea o por una IRQ;
+ * - el kernel nunca pasa un plazo (vTaskStepTick) y el contador de ticks
+ *   sigue al tiempo real sin deriva: nunca adelantado y con menos de dos
+ *   ticks de atraso (el resto acumulado más el tick en curso);
+ * - low_power_get_stats() coincide con lo que vio la simulación.
+ *
+ * El temporizador de fondo de stdio USB (un alarma por ms mientras está
+ * habilitado) no se cuenta: las unidades a batería no lo compilan.
+ *
+ * Compilar y ejecutar desde la raíz del proyecto:
+ *
+ *     cc -std=c11 -O2 -Itools/replay/shim -I. tools/low_power_sim.c \
+ *        low_power.c -lm -o low_power_sim
+ *     ./low_power_sim [-d segundos] [-k teclas_por_minuto] [-s semilla]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <math.h>
+#include "low_power.h"
+#include "console.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "hardware/timer.h"
+#include "hardware/sync.h"
+#include "hardware/structs/systick.h"
+#include "hardware/structs/scb.h"
+
+#define SIM_US_PER_TICK         (1000000u / configTICK_RATE_HZ)
+#define SIM_CYCLES_PER_US       (configCPU_CLOCK_HZ / 1000000u)
+
+/** @brief CPU de cada activación de una tarea (µs) */
+#define SIM_TASK_WORK_US        37
+
+/** @brief Tiempo que la FSM del teclado sigue activa después de la IRQ */
+#define SIM_KEY_ACTIVE_MS       60
+#define SIM_KEY_STEP_MS         5
+
+#define SIM_NO_DEADLINE         UINT32_MAX
+#define SIM_MAX_SOURCES         4
+
+/**
+ * @brief Espera periódica de una tarea
+ */
+typedef struct {
+    const char *name;
+    uint32_t period_ms;
+    uint32_t offset_ms;         /**< Primera activación */
+    uint32_t max_period_ms;     /**< Si no es 0, el período se duplica hasta este valor */
+} sim_source_t;
+
+/**
+ * @brief Configuración simulada
+ */
+typedef struct {
+    const char *name;
+    bool tickless;
+    sim_source_t sources[SIM_MAX_SOURCES];
+} sim_config_t;
+
+static const sim_config_t configs[] = {
+    { "Antes: tick de 1 kHz y sondeo", false, {
+        { "LEDs (sondeo de la cola)", 100, 100 },
+        { "AccessControl (espera de tecla)", 150, 100 },
+        { "AccessControl (pausa de 50 ms)", 150, 150 },
+        { "Display (reloj)", 1000, 1000 },
+    } },
+    { "Ahora: idle sin tick (low_power.c)", true, {
+        { "Display (reloj)", 1000, 1000 },
+        { "Health (watchdog)", 500, 500 },
+        { "Console (espera del USB)", CONSOLE_USB_POLL_MS * 2, CONSOLE_USB_POLL_MS,
+          CONSOLE_USB_POLL_MAX_MS },
+    } },
+};
+
+#define NUM_CONFIGS (sizeof(configs) / sizeof(configs[0]))
+
+/**
+ * @brief Resultado de una corrida
+ */
+typedef struct {
+    uint32_t core_wakeups;      /**< Salidas de WFI */
+    uint32_t source_wakes[SIM_MAX_SOURCES];
+    uint32_t key_irqs;
+    uint32_t key_steps;
+    uint32_t sleeps;            /**< Suspensiones completas sin tick */
+    uint32_t aborted;
+    uint32_t early;             /**< Suspensiones cortadas por una IRQ */
+    int64_t max_lag_us;         /**< Mayor atraso del tick respecto al tiempo real */
+    int64_t min_lag_us;
+    uint32_t errors;
+} sim_result_t;
+
+/* ---- Hardware y kernel simulados --------------------------------------- */
+
+/* En el firmware la declara el port de FreeRTOS */
+void vPortSuppressTicksAndSleep(TickType_t xExpectedIdleTime);
+
+systick_hw_t sim_systick;
+scb_hw_t sim_scb;
+
+static uint64_t now_us;
+static uint64_t next_tick_us;       /**< Próximo vencimiento del SysTick en marcha */
+static bool systick_stopped;        /**< low_power.c detuvo el SysTick */
+static TickType_t kernel_ticks;
+static TickType_t kernel_deadline;  /**< Próximo desbloqueo de una tarea */
+static bool irq_masked;
+static bool alarm_armed;
+static uint64_t alarm_target_us;
+static uint64_t next_key_us;
+static bool key_racing;             /**< La próxima tecla llega al entrar en reposo */
+static bool key_pending;            /**< IRQ del teclado sin atender por la tarea */
+static sim_result_t *result;
+static uint32_t rng_state;
+
+static uint32_t rng_next(void) {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return rng_state;
+}
+
+static double rng_unit(void) {
+    return (rng_next() >> 8) * (1.0 / 16777216.0);
+}
+
+static uint64_t rng_exp_us(double mean_us) {
+    return 1 + (uint64_t)(-log(1.0 - rng_unit()) * mean_us);
+}
+
+static double key_mean_us;
+
+static void schedule_key(void) {
+    next_key_us = (key_mean_us > 0) ? now_us + rng_exp_us(key_mean_us) : UINT64_MAX;
+    key_racing = ((rng_next() & 3) == 0);
+}
+
+/**
+ * @brief Deja cvr como lo vería la CPU ahora (SysTick en marcha)
+ */
+static void systick_sync(void) {
+    if (!(sim_systick.csr & M0PLUS_SYST_CSR_ENABLE_BITS)) {
+        systick_stopped = true;
+        return;
+    }
+    uint64_t into_us = now_us + SIM_US_PER_TICK - next_tick_us;
+    uint64_t cycles = into_us * SIM_CYCLES_PER_US;
+    sim_systick.cvr = (cycles > sim_systick.rvr) ? 0 : sim_systick.rvr - (uint32_t)cycles;
+}
+
+uint64_t time_us_64(void) {
+    systick_sync();
+    return now_us;
+}
+
+int hardware_alarm_claim_unused(bool required) {
+    (void)required;
+    return 0;
+}
+
+void hardware_alarm_set_callback(uint alarm_num, hardware_alarm_callback_t callback) {
+    (void)alarm_num;
+    (void)callback;
+}
+
+bool hardware_alarm_set_target(uint alarm_num, absolute_time_t target) {
+    (void)alarm_num;
+    if (target <= now_us) {
+        return true;
+    }
+    alarm_armed = true;
+    alarm_target_us = target;
+    return false;
+}
+
+void hardware_alarm_cancel(uint alarm_num) {
+    (void)alarm_num;
+    alarm_armed = false;
+}
+
+uint32_t save_and_disable_interrupts(void) {
+    uint32_t was_masked = irq_masked;
+    irq_masked = true;
+    systick_sync();
+    return was_masked;
+}
+
+void restore_interrupts(uint32_t status) {
+    irq_masked = (status != 0);
+}
+
+/**
+ * @brief Duerme hasta la alarma o la próxima IRQ del teclado
+ */
+void __wfi(void) {
+    systick_sync();
+    result->core_wakeups++;
+    if (next_key_us < UINT64_MAX && (!alarm_armed || next_key_us < alarm_target_us)) {
+        now_us = next_key_us;
+        key_pending = true;
+        result->key_irqs++;
+        schedule_key();
+    } else if (alarm_armed) {
+        now_us = alarm_target_us;
+    } else {
+        printf("ERROR: WFI sin alarma ni IRQ en t=%llu us\n", (unsigned long long)now_us);
+        result->errors++;
+    }
+}
+
+eSleepModeStatus eTaskConfirmSleepModeStatus(void) {
+    return key_pending ? eAbortSleep : eStandardSleep;
+}
+
+void vTaskStepTick(TickType_t ticks) {
+    kernel_ticks += ticks;
+    if (kernel_ticks > kernel_deadline) {
+        printf("ERROR: vTaskStepTick pasó el plazo %lu (tick %lu)\n",
+               (unsigned long)kernel_deadline, (unsigned long)kernel_ticks);
+        result->errors++;
+    }
+}
+
+/* ---- Simulación -------------------------------------------------------- */
+
+/**
+ * @brief Controla que el contador de ticks siga al tiempo real
+ */
+static void check_lag(void) {
+    int64_t lag_us = (int64_t)now_us - (int64_t)kernel_ticks * SIM_US_PER_TICK;
+
+    if (lag_us > result->max_lag_us) {
+        result->max_lag_us = lag_us;
+    }
+    if (lag_us < result->min_lag_us) {
+        result->min_lag_us = lag_us;
+    }
+}
+
+/**
+ * @brief Avanza el tiempo con la CPU despierta y el SysTick en marcha
+ */
+static void run_for(uint64_t us) {
+    uint64_t end_us = now_us + us;
+
+    while (true) {
+        uint64_t next_us = next_tick_us < next_key_us ? next_tick_us : next_key_us;
+        if (next_us > end_us) {
+            break;
+        }
+        now_us = next_us;
+        if (next_us == next_tick_us) {
+            kernel_ticks++;
+            next_tick_us += SIM_US_PER_TICK;
+        } else {
+            key_pending = true;
+            result->key_irqs++;
+            schedule_key();
+        }
+    }
+    now_us = end_us;
+}
+
+static void run(const sim_config_t *config, uint64_t duration_us) {
+    TickType_t next[SIM_MAX_SOURCES];
+    uint32_t period_ms[SIM_MAX_SOURCES];
+    TickType_t key_next = SIM_NO_DEADLINE;
+    TickType_t key_until = 0;
+
+    now_us = 0;
+    next_tick_us = SIM_US_PER_TICK;
+    kernel_ticks = 0;
+    irq_masked = false;
+    alarm_armed = false;
+    key_pending = false;
+    systick_stopped = false;
+    sim_systick.csr = M0PLUS_SYST_CSR_ENABLE_BITS;
+    sim_systick.rvr = SIM_US_PER_TICK * SIM_CYCLES_PER_US - 1;
+    sim_scb.icsr = 0;
+    result->min_lag_us = INT64_MAX;
+    schedule_key();
+    for (int i = 0; i < SIM_MAX_SOURCES; i++) {
+        next[i] = config->sources[i].name ? pdMS_TO_TICKS(config->sources[i].offset_ms) : SIM_NO_DEADLINE;
+        period_ms[i] = config->sources[i].period_ms;
+    }
+
+    while (now_us < duration_us) {
+        // Tareas que se desbloquearon en este tick
+        bool ran = true;
+        while (ran) {
+            ran = false;
+            if (key_pending) {
+                key_pending = false;
+                key_until = kernel_ticks + pdMS_TO_TICKS(SIM_KEY_ACTIVE_MS);
+                key_next = kernel_ticks;
+            }
+            if (key_next <= kernel_ticks) {
+                result->key_steps++;
+                key_next += pdMS_TO_TICKS(SIM_KEY_STEP_MS);
+                if (key_next >= key_until) {
+                    key_next = SIM_NO_DEADLINE;
+                }
+                run_for(SIM_TASK_WORK_US);
+                ran = true;
+            }
+            for (int i = 0; i < SIM_MAX_SOURCES; i++) {
+                if (next[i] <= kernel_ticks) {
+                    result->source_wakes[i]++;
+                    next[i] += pdMS_TO_TICKS(period_ms[i]);
+                    if (period_ms[i] < config->sources[i].max_period_ms) {
+                        period_ms[i] *= 2;
+                    }
+                    run_for(SIM_TASK_WORK_US);
+                    ran = true;
+                }
+            }
+            ran = ran || key_pending;
+        }
+        check_lag();
+
+        // Tarea idle
+        kernel_deadline = key_next;
+        for (int i = 0; i < SIM_MAX_SOURCES; i++) {
+            if (next[i] < kernel_deadline) {
+                kernel_deadline = next[i];
+            }
+        }
+        TickType_t expected = kernel_deadline - kernel_ticks;
+
+        if (config->tickless && expected >= configEXPECTED_IDLE_TIME_BEFORE_SLEEP) {
+            if ((rng_next() & 7) == 0 && next_key_us > next_tick_us) {
+                // El SysTick vence justo con las interrupciones deshabilitadas
+                now_us = next_tick_us;
+                next_tick_us += SIM_US_PER_TICK;
+                sim_scb.icsr = M0PLUS_ICSR_PENDSTSET_BITS;
+            }
+            if (key_racing && next_key_us < UINT64_MAX) {
+                // La IRQ del teclado gana la carrera contra la entrada en reposo
+                key_pending = true;
+                result->key_irqs++;
+                schedule_key();
+            }
+
+            low_power_stats_t before;
+            low_power_get_stats(&before);
+            vPortSuppressTicksAndSleep(expected);
+            low_power_stats_t after;
+            low_power_get_stats(&after);
+
+            if (systick_stopped) {
+                // Se reanudó con cvr = 0: período completo desde ahora
+                systick_stopped = false;
+                next_tick_us = now_us + SIM_US_PER_TICK;
+                result->sleeps++;
+                if (kernel_ticks < kernel_deadline) {
+                    result->early++;
+                }
+            } else {
+                result->aborted++;
+            }
+            if (sim_scb.icsr & M0PLUS_ICSR_PENDSTSET_BITS) {
+                kernel_ticks++;         // El handler del SysTick corre al habilitar
+            }
+            sim_scb.icsr = 0;
+            if (irq_masked || !(sim_systick.csr & M0PLUS_SYST_CSR_ENABLE_BITS)) {
+                printf("ERROR: al volver del reposo quedaron las IRQ o el SysTick deshabilitados\n");
+                result->errors++;
+            }
+            if (after.sleeps - before.sleeps + after.aborted - before.aborted != 1) {
+                printf("ERROR: low_power_get_stats() no contó la suspensión\n");
+                result->errors++;
+            }
+        } else if (config->tickless || key_next == SIM_NO_DEADLINE) {
+            // WFI hasta el próximo SysTick o IRQ (el hook idle original
+            // solo duerme con el teclado en reposo)
+            result->core_wakeups++;
+            if (next_key_us < next_tick_us) {
+                now_us = next_key_us;
+                key_pending = true;
+                result->key_irqs++;
+                schedule_key();
+            } else {
+                now_us = next_tick_us;
+                next_tick_us += SIM_US_PER_TICK;
+                kernel_ticks++;
+            }
+        } else {
+            run_for(next_tick_us - now_us);
+        }
+        check_lag();
+    }
+}
+
+static double per_minute(uint32_t count, uint32_t duration_s) {
+    return count * 60.0 / duration_s;
+}
+
+int main(int argc, char **argv) {
+    uint32_t duration_s = 600;
+    double keys_per_min = 6;
+    bool ok = true;
+    sim_result_t results[NUM_CONFIGS];
+
+    rng_state = 12345;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-d") == 0 && i + 1 < argc) {
+            duration_s = (uint32_t)strtoul(argv[++i], NULL, 0);
+        } else if (strcmp(argv[i], "-k") == 0 && i + 1 < argc) {
+            keys_per_min = strtod(argv[++i], NULL);
+        } else if (strcmp(argv[i], "-s") == 0 && i + 1 < argc) {
+            rng_state = (uint32_t)strtoul(argv[++i], NULL, 0);
+        } else {
+            fprintf(stderr, "uso: %s [-d segundos] [-k teclas_por_minuto] [-s semilla]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (rng_state == 0 || duration_s == 0 || duration_s > 86400 || keys_per_min < 0) {
+        fprintf(stderr, "parámetros inválidos\n");
+        return 1;
+    }
+    key_mean_us = (keys_per_min > 0) ? 60e6 / keys_per_min : 0;
+
+    if (!low_power_init()) {
+        printf("ERROR: low_power_init() falló\n");
+        return 1;
+    }
+
+    printf("Reposo durante %lu s, %.1f teclas por minuto\n", (unsigned long)duration_s, keys_per_min);
+    for (size_t c = 0; c < NUM_CONFIGS; c++) {
+        const sim_config_t *config = &configs[c];
+        sim_result_t *r = &results[c];
+        uint32_t expected_wakes = 0;
+
+        memset(r, 0, sizeof(*r));
+        result = r;
+        run(config, (uint64_t)duration_s * 1000000u);
+
+        printf("\n%s\n", config->name);
+        printf("  %-34s %10s\n", "Activaciones de tareas", "por minuto");
+        for (int i = 0; i < SIM_MAX_SOURCES && config->sources[i].name; i++) {
+            printf("  %-34s %10.1f\n", config->sources[i].name, per_minute(r->source_wakes[i], duration_s));
+            expected_wakes += r->source_wakes[i];
+        }
+        printf("  %-34s %10.1f\n", "Keypad (IRQ de filas)", per_minute(r->key_irqs, duration_s));
+        printf("  %-34s %10.1f\n", "Keypad (pasos de la FSM)", per_minute(r->key_steps, duration_s));
+        printf("  Despertares del núcleo por minuto: %.1f\n", per_minute(r->core_wakeups, duration_s));
+        printf("  Atraso del tick respecto al tiempo real: %lld..%lld us\n",
+               (long long)r->min_lag_us, (long long)r->max_lag_us);
+
+        if (config->tickless) {
+            low_power_stats_t stats;
+            low_power_get_stats(&stats);
+            printf("  low_power: %lu suspensiones, %lu canceladas, %lu cortadas por IRQ, %.1f%% dormido\n",
+                   (unsigned long)stats.sleeps, (unsigned long)stats.aborted,
+                   (unsigned long)stats.early_wakeups, 100.0 * stats.slept_us / (duration_s * 1e6));
+
+            // Cada despertar corresponde a un plazo de una tarea o a una IRQ
+            expected_wakes += r->key_steps + r->key_irqs;
+            if (r->core_wakeups > expected_wakes) {
+                printf("ERROR: %lu despertares para %lu activaciones e IRQ\n",
+                       (unsigned long)r->core_wakeups, (unsigned long)expected_wakes);
+                ok = false;
+            }
+            if (r->min_lag_us < 0 || r->max_lag_us >= 2 * (int64_t)SIM_US_PER_TICK) {
+                printf("ERROR: el contador de ticks se apartó del tiempo real\n");
+                ok = false;
+            }
+            if (stats.sleeps != r->sleeps || stats.aborted != r->aborted || stats.early_wakeups != r->early) {
+                printf("ERROR: low_power_get_stats() no coincide con la simulación "
+                       "(%lu/%lu/%lu en lugar de %lu/%lu/%lu)\n",
+                       (unsigned long)stats.sleeps, (unsigned long)stats.aborted,
+                       (unsigned long)stats.early_wakeups, (unsigned long)r->sleeps,
+                       (unsigned long)r->aborted, (unsigned long)r->early);
+                ok = false;
+            }
+        }
+        if (r->errors > 0) {
+            ok = false;
+        }
+    }
+
+    printf("\nDespertares por minuto: %.1f antes, %.1f ahora (%.0f veces menos)\n",
+           per_minute(results[0].core_wakeups, duration_s), per_minute(results[1].core_wakeups, duration_s),
+           (double)results[0].core_wakeups / (results[1].core_wakeups ? results[1].core_wakeups : 1));
+
+    printf("\n%s\n", ok ? "Verificación del idle sin tick: OK"
+                        : "ERROR: el idle sin tick no pasó la verificación");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,152 @@
+#!/usr/bin/env python3
+"""
+Reporte de uso de RAM por módulo a partir del mapa de enlace.
+
+Lee el archivo .map que genera el enlazador (blink_simple.elf.map) y suma
+el tamaño de las secciones de entrada que terminan en RAM (.data, .bss,
+.uninitialized_data, scratch, etc.) agrupadas por archivo objeto. Con
+RTOS_STATIC_ALLOCATION las pilas y bloques de control de las tareas y colas
+aparecen en el módulo que los declara, por lo que el reporte es el
+presupuesto real de RAM de cada módulo.
+
+Uso: ram_budget.py <archivo.map> [--limit módulo=bytes ...] [--detail módulo]
+"""
+
+import argparse
+import os
+import re
+import sys
+from collections import defaultdict
+
+# Secciones de salida ubicadas en RAM en el script de enlace del RP2040
+RAM_SECTIONS = {
+    ".ram_vector_table", ".data", ".uninitialized_data", ".tdata", ".tbss",
+    ".bss", ".heap", ".scratch_x", ".scratch_y", ".stack_dummy", ".stack1_dummy",
+}
+
+# RAM total del RP2040: 256 KB principales + 2 x 4 KB de scratch
+RAM_TOTAL = 264 * 1024
+
+INPUT_ONE_LINE = re.compile(r"^ (\S+)\s+0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+)\s+(\S.*)$")
+INPUT_NAME_ONLY = re.compile(r"^ (\S+)$")
+INPUT_CONT = re.compile(r"^\s+0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+)\s+(\S.*)$")
+INPUT_FILL = re.compile(r"^ \*fill\*\s+0x[0-9a-fA-F]+\s+0x([0-9a-fA-F]+)")
+OUTPUT_SECTION = re.compile(r"^(\.\S+)")
+
+
+def module_of(path):
+    """Nombre de módulo para un archivo objeto o miembro de biblioteca."""
+    if "FreeRTOS" in path:
+        return "FreeRTOS"
+    if "pico-sdk" in path or "pico_sdk" in path or "/src/rp2" in path:
+        return "pico-sdk"
+    if ".a(" in path:
+        return os.path.basename(path.split("(")[0])
+    name = os.path.basename(path)
+    for suffix in (".c.obj", ".cpp.obj", ".S.obj", ".obj", ".o"):
+        if name.endswith(suffix):
+            return name[: -len(suffix)]
+    return name
+
+
+def parse_map(lines):
+    """Devuelve [(sección de salida, sección de entrada, tamaño, módulo)]."""
+    entries = []
+    current = None
+    pending = None
+    in_memory_map = False
+
+    for line in lines:
+        line = line.rstrip("\n")
+        if line.startswith("Linker script and memory map"):
+            in_memory_map = True
+            continue
+        if not in_memory_map:
+            continue
+
+        m = OUTPUT_SECTION.match(line)
+        if m:
+            current = m.group(1)
+            pending = None
+            continue
+        if current not in RAM_SECTIONS:
+            continue
+
+        if pending is not None:
+            m = INPUT_CONT.match(line)
+            if m:
+                entries.append((current, pending, int(m.group(2), 16), module_of(m.group(3))))
+            pending = None
+            continue
+
+        m = INPUT_FILL.match(line)
+        if m:
+            entries.append((current, "*fill*", int(m.group(1), 16), "(relleno)"))
+            continue
+
+        m = INPUT_ONE_LINE.match(line)
+        if m:
+            entries.append((current, m.group(1), int(m.group(3), 16), module_of(m.group(4))))
+            continue
+
+        m = INPUT_NAME_ONLY.match(line)
+        if m and not m.group(1).startswith("*"):
+            pending = m.group(1)
+
+    return entries
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[1])
+    parser.add_argument("map_file")
+    parser.add_argument("--limit", action="append", default=[], metavar="MÓDULO=BYTES",
+                        help="falla si el módulo supera el límite indicado")
+    parser.add_argument("--detail", action="append", default=[], metavar="MÓDULO",
+                        help="lista las secciones del módulo")
+    args = parser.parse_args()
+
+    with open(args.map_file, encoding="utf-8", errors="replace") as f:
+        entries = parse_map(f)
+    if not entries:
+        sys.exit("No se encontraron secciones de RAM en " + args.map_file)
+
+    per_module = defaultdict(lambda: defaultdict(int))
+    for section, _, size, module in entries:
+        per_module[module][section] += size
+
+    columns = [".data", ".bss", "otras"]
+    rows = []
+    for module, sections in per_module.items():
+        data = sections.get(".data", 0)
+        bss = sections.get(".bss", 0)
+        other = sum(sections.values()) - data - bss
+        rows.append((data + bss + other, module, data, bss, other))
+    rows.sort(reverse=True)
+
+    total = sum(r[0] for r in rows)
+    print("=== RAM por módulo (%s) ===" % os.path.basename(args.map_file))
+    print("%-22s %8s %8s %8s %8s %6s" % ("Módulo", *columns, "Total", "%RAM"))
+    for size, module, data, bss, other in rows:
+        print("%-22s %8d %8d %8d %8d %5.1f%%" % (module, data, bss, other, size,
+                                                 100.0 * size / RAM_TOTAL))
+    print("%-22s %8s %8s %8s %8d %5.1f%%" % ("TOTAL", "", "", "", total,
+                                            100.0 * total / RAM_TOTAL))
+
+    for module in args.detail:
+        print("\n--- %s ---" % module)
+        for section, name, size, owner in sorted(entries, key=lambda e: -e[2]):
+            if owner == module and size > 0:
+                print("  %-40s %-20s %8d" % (name, section, size))
+
+    failed = False
+    for limit in args.limit:
+        module, _, value = limit.partition("=")
+        used = sum(per_module.get(module, {}).values())
+        if used > int(value, 0):
+            print("ERROR: %s usa %d bytes de RAM (límite %s)" % (module, used, value))
+            failed = True
+    return 1 if failed else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,285 @@
+/**
+ * @file rate_limiter_sim.c
+ * @brief Simulación en el host del limitador de intentos con tráfico mixto
+ * @author Sistema de Control de Acceso
+ * @date 2025
+ *
+ * Enlaza el mismo rate_limiter.c del firmware y simula un día de uso:
+ * usuarios legítimos que llegan al teclado con tiempos exponenciales y a
+ * veces se equivocan de clave, y un atacante que prueba IDs y claves al
+ * azar (o un único ID conocido con -t) a ritmo constante.
+ *
+ * Reporta la tasa de éxito y la latencia de los usuarios legítimos (desde
+ * que llegan hasta que entran) y cuántos intentos del atacante llegan a
+ * la base de datos, con y sin limitador.
+ *
+ * Compilar y ejecutar desde la raíz del proyecto:
+ *
+ *     cc -std=c11 -O2 -I. tools/rate_limiter_sim.c rate_limiter.c -lm -o rl_sim
+ *     ./rl_sim [-p periodo_ataque_ms] [-a inicio_ataque_s] [-t] [-s semilla]
+ *
+ * La latencia solo cuenta a quienes entraron; los que se rinden a los
+ * SIM_GIVE_UP_MS se reportan aparte. No se modelan la contención física por
+ * el teclado (ambos flujos se superponen libremente) ni el bloqueo
+ * permanente de database.c tras MAX_FAILED_ATTEMPTS.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <math.h>
+#include "rate_limiter.h"
+
+/** @brief Resolución de la simulación */
+#define SIM_STEP_MS             100
+
+/** @brief Duración simulada (24 h) */
+#define SIM_DURATION_MS         (24u * 3600u * 1000u)
+
+/** @brief Usuarios legítimos */
+#define SIM_USERS               5
+
+/** @brief Tiempo medio entre llegadas de cada usuario */
+#define SIM_USER_MEAN_GAP_MS    (20u * 60u * 1000u)
+
+/** @brief Probabilidad de equivocarse al teclear la clave */
+#define SIM_TYPO_RATE           0.10
+
+/** @brief Tiempo para volver a teclear ID y clave tras un rechazo */
+#define SIM_RETYPE_MS           4000
+
+/** @brief Un usuario que no entra en este tiempo se rinde */
+#define SIM_GIVE_UP_MS          (10u * 60u * 1000u)
+
+/** @brief Máximo de muestras de latencia guardadas */
+#define SIM_MAX_SAMPLES         4096
+
+/**
+ * @brief Usuario legítimo
+ */
+typedef struct {
+    char id[8];
+    bool waiting;               /**< Está frente a la puerta */
+    uint32_t arrival_ms;        /**< Llegada del intento actual */
+    uint32_t next_ms;           /**< Próxima llegada o próximo intento */
+} sim_user_t;
+
+/**
+ * @brief Resultado de una corrida
+ */
+typedef struct {
+    uint32_t legit_arrivals;
+    uint32_t legit_success;
+    uint32_t legit_gave_up;
+    uint32_t legit_limited;     /**< Intentos legítimos rechazados por el limitador */
+    uint32_t latency_ms[SIM_MAX_SAMPLES];
+    uint32_t samples;
+    uint32_t attack_attempts;   /**< Intentos del atacante */
+    uint32_t attack_admitted;   /**< Intentos que llegaron a verificar la clave */
+    uint32_t attack_hits;       /**< Claves adivinadas */
+    rl_stats_t rl;
+} sim_result_t;
+
+/**
+ * @brief Parámetros de la simulación
+ */
+typedef struct {
+    uint32_t attack_period_ms;
+    uint32_t attack_start_ms;
+    bool targeted;
+    uint32_t seed;
+} sim_config_t;
+
+static uint32_t rng_state;
+
+/**
+ * @brief Generador xorshift32 (determinista para una semilla)
+ */
+static uint32_t rng_next(void) {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return rng_state;
+}
+
+static double rng_unit(void) {
+    return (rng_next() >> 8) * (1.0 / 16777216.0);
+}
+
+static uint32_t rng_exp_ms(uint32_t mean_ms) {
+    return (uint32_t)(-log(1.0 - rng_unit()) * mean_ms);
+}
+
+static int cmp_u32(const void *a, const void *b) {
+    uint32_t x = *(const uint32_t *)a, y = *(const uint32_t *)b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * @brief Simula un día con o sin limitador
+ */
+static void simulate(const sim_config_t *cfg, bool limiter_on, sim_result_t *res) {
+    rate_limiter_t rl;
+    sim_user_t users[SIM_USERS];
+    uint32_t next_attack_ms = cfg->attack_start_ms;
+
+    memset(res, 0, sizeof(*res));
+    rng_state = cfg->seed ? cfg->seed : 1;
+    rate_limiter_init(&rl, 0);
+
+    for (int i = 0; i < SIM_USERS; i++) {
+        snprintf(users[i].id, sizeof(users[i].id), "1000%02d", i + 1);
+        users[i].waiting = false;
+        users[i].next_ms = rng_exp_ms(SIM_USER_MEAN_GAP_MS);
+    }
+
+    for (uint32_t now = 0; now < SIM_DURATION_MS; now += SIM_STEP_MS) {
+        for (int i = 0; i < SIM_USERS; i++) {
+            sim_user_t *u = &users[i];
+            if (now < u->next_ms) {
+                continue;
+            }
+
+            if (!u->waiting) {
+                u->waiting = true;
+                u->arrival_ms = now;
+                res->legit_arrivals++;
+            } else if (now - u->arrival_ms > SIM_GIVE_UP_MS) {
+                res->legit_gave_up++;
+                u->waiting = false;
+                u->next_ms = now + rng_exp_ms(SIM_USER_MEAN_GAP_MS);
+                continue;
+            }
+
+            uint32_t wait_ms = 0;
+            if (limiter_on && rate_limiter_check(&rl, u->id, now, &wait_ms) != RL_ALLOW) {
+                // El usuario lee "Espere Ns" y vuelve a intentar
+                res->legit_limited++;
+                u->next_ms = now + wait_ms + SIM_RETYPE_MS;
+                continue;
+            }
+
+            bool ok = rng_unit() >= SIM_TYPO_RATE;
+            if (limiter_on) {
+                rate_limiter_report(&rl, u->id, ok, now);
+            }
+            if (!ok) {
+                u->next_ms = now + SIM_RETYPE_MS;
+                continue;
+            }
+
+            res->legit_success++;
+            if (res->samples < SIM_MAX_SAMPLES) {
+                res->latency_ms[res->samples++] = now - u->arrival_ms;
+            }
+            u->waiting = false;
+            u->next_ms = now + rng_exp_ms(SIM_USER_MEAN_GAP_MS);
+        }
+
+        if (cfg->attack_period_ms > 0 && now >= next_attack_ms) {
+            char id[8];
+            next_attack_ms = now + cfg->attack_period_ms;
+            res->attack_attempts++;
+
+            if (cfg->targeted) {
+                strcpy(id, users[0].id);
+            } else {
+                snprintf(id, sizeof(id), "%06u", (unsigned)(rng_next() % 1000000u));
+            }
+
+            if (limiter_on && rate_limiter_check(&rl, id, now, NULL) != RL_ALLOW) {
+                continue;
+            }
+            res->attack_admitted++;
+
+            // Una de cada 10000 claves es correcta si el ID existe
+            bool hit = (strncmp(id, "1000", 4) == 0 && id[4] == '0' &&
+                        id[5] >= '1' && id[5] < '1' + SIM_USERS &&
+                        rng_next() % 10000u == 0);
+            if (hit) {
+                res->attack_hits++;
+            }
+            if (limiter_on) {
+                rate_limiter_report(&rl, id, hit, now);
+            }
+        }
+    }
+
+    res->rl = rl.stats;
+}
+
+/**
+ * @brief Imprime el resumen de una corrida
+ */
+static void print_result(const char *name, const sim_result_t *res) {
+    uint32_t sorted[SIM_MAX_SAMPLES];
+    uint64_t sum = 0;
+
+    memcpy(sorted, res->latency_ms, res->samples * sizeof(uint32_t));
+    qsort(sorted, res->samples, sizeof(uint32_t), cmp_u32);
+    for (uint32_t i = 0; i < res->samples; i++) {
+        sum += sorted[i];
+    }
+
+    printf("== %s ==\n", name);
+    printf("  Legítimos: %u llegadas, %u entraron (%.1f%%), %u se rindieron, %u intentos limitados\n",
+           res->legit_arrivals, res->legit_success,
+           res->legit_arrivals ? 100.0 * res->legit_success / res->legit_arrivals : 0.0,
+           res->legit_gave_up, res->legit_limited);
+    if (res->samples > 0) {
+        printf("  Latencia: media %.1f s, p50 %.1f s, p95 %.1f s, p99 %.1f s, máx %.1f s\n",
+               sum / 1000.0 / res->samples,
+               sorted[res->samples / 2] / 1000.0,
+               sorted[res->samples * 95 / 100] / 1000.0,
+               sorted[res->samples * 99 / 100] / 1000.0,
+               sorted[res->samples - 1] / 1000.0);
+    }
+    printf("  Atacante: %u intentos, %u verificados (%.1f/h), %u aciertos\n",
+           res->attack_attempts, res->attack_admitted,
+           res->attack_admitted / (SIM_DURATION_MS / 3600000.0), res->attack_hits);
+    printf("  Limitador: %u admitidos, %u por ID, %u globales, %u fallas\n",
+           res->rl.allowed, res->rl.denied_id, res->rl.denied_global, res->rl.failures);
+}
+
+int main(int argc, char **argv) {
+    sim_config_t cfg = {
+        .attack_period_ms = 3000,
+        .attack_start_ms = 3600u * 1000u,
+        .targeted = false,
+        .seed = 12345
+    };
+    static sim_result_t with_rl, without_rl;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-p") == 0 && i + 1 < argc) {
+            cfg.attack_period_ms = (uint32_t)strtoul(argv[++i], NULL, 0);
+        } else if (strcmp(argv[i], "-a") == 0 && i + 1 < argc) {
+            cfg.attack_start_ms = (uint32_t)strtoul(argv[++i], NULL, 0) * 1000u;
+        } else if (strcmp(argv[i], "-s") == 0 && i + 1 < argc) {
+            cfg.seed = (uint32_t)strtoul(argv[++i], NULL, 0);
+        } else if (strcmp(argv[i], "-t") == 0) {
+            cfg.targeted = true;
+        } else {
+            fprintf(stderr, "uso: %s [-p periodo_ataque_ms] [-a inicio_ataque_s] [-t] [-s semilla]\n",
+                    argv[0]);
+            return 1;
+        }
+    }
+
+    printf("Usuarios: %d, llegada media cada %u min, %.0f%% de errores al teclear\n",
+           SIM_USERS, SIM_USER_MEAN_GAP_MS / 60000u, SIM_TYPO_RATE * 100);
+    printf("Ataque %s cada %u ms desde t=%u s (0 = sin ataque)\n",
+           cfg.targeted ? "a un ID conocido" : "con IDs al azar",
+           cfg.attack_period_ms, cfg.attack_start_ms / 1000u);
+    printf("Limitador: bucket global %d fallas, 1 cada %d ms; backoff por ID %d..%d ms, %d entradas\n\n",
+           RL_GLOBAL_CAPACITY, RL_GLOBAL_REFILL_MS, RL_BACKOFF_BASE_MS, RL_BACKOFF_MAX_MS, RL_ID_SLOTS);
+
+    simulate(&cfg, true, &with_rl);
+    simulate(&cfg, false, &without_rl);
+
+    print_result("Con limitador", &with_rl);
+    print_result("Sin limitador", &without_rl);
+    return 0;
+}
@@ -0,0 +1,468 @@
+/**
+ * @file replay.c
+ * @brief Reproducción determinista en el host de una grabación de entradas
+ * @author Sistema de Control de Acceso
+ * @date 2025
+ *
+ * Lee el volcado de "input dump" (input_recorder.c), ejecuta keypad.c y
+ * access_control_rtos.c tal como están en el árbol con el scheduler de
+ * tiempo virtual de sim_rtos.c, les entrega los mismos flancos y niveles
+ * de fila en los mismos ticks y compara la trayectoria obtenida (estados,
+ * teclas, eventos del bus y timeouts) con la grabada. Informa la primera
+ * divergencia: con el mismo firmware no debe haber ninguna, y con otra
+ * versión muestra dónde cambia el comportamiento.
+ *
+ * Los LEDs, el display, el log y el monitor de plazos se reemplazan por
+ * funciones vacías; la base de datos parte de los usuarios de
+ * database_init() y no incluye cambios hechos desde la consola.
+ *
+ * Compilar y ejecutar desde la raíz del proyecto (para otra versión,
+ * reemplazar los .c del firmware por los de esa versión):
+ *
+ *     cc -std=c11 -O2 -pthread -Itools/replay/shim -Itools/replay -I. \
+ *        tools/replay/replay.c tools/replay/sim_rtos.c keypad.c \
+ *        access_control_rtos.c system_bus.c event_bus.c rate_limiter.c database.c \
+ *        merkle_sync.c -o replay
+ *     ./replay [-v] [-s velocidad] [-e espera_ms] [-t tolerancia_ms] [-o trayectoria.txt] captura.txt
+ *
+ * Sin -s la reproducción va tan rápido como puede (los períodos sin
+ * entradas se saltan); -s 1000 la limita a 1000 veces el tiempo real.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <unistd.h>
+#include <time.h>
+#include "sim_rtos.h"
+#include "task.h"
+#include "input_recorder.h"
+#include "keypad.h"
+#include "access_control.h"
+#include "system_bus.h"
+#include "database.h"
+#include "leds.h"
+#include "ssd1306_display.h"
+#include "task_health.h"
+#include "trace_recorder.h"
+#include "boot_profile.h"
+#include "board.h"
+
+/** @brief Prioridades de main_rtos.c (el orden relativo decide la reproducción) */
+#define KEYPAD_TASK_PRIORITY            4
+#define ACCESS_CONTROL_TASK_PRIORITY    3
+
+/** @brief Registros como máximo en una grabación */
+#define MAX_RECORDS     65536
+
+/**
+ * @brief Paso de una trayectoria
+ */
+typedef struct {
+    uint32_t tick;
+    uint8_t event;
+    uint8_t arg;
+} step_t;
+
+/**
+ * @brief Trayectoria (grabada o reproducida)
+ */
+typedef struct {
+    step_t *steps;
+    size_t count;
+    size_t capacity;
+} trajectory_t;
+
+/** @brief Entradas grabadas (flancos y niveles de fila) */
+static input_record_t inputs[MAX_RECORDS];
+static size_t input_count;
+static size_t input_next;
+
+static trajectory_t recorded;
+static trajectory_t replayed;
+
+static bool verbose;
+static FILE *out;
+
+static const char *const keypad_states[] = {
+    "IDLE", "DEBOUNCE", "COLUMN_SCAN", "PRESSED", "RELEASED",
+};
+
+static const char *const access_states[] = {
+    "IDLE", "ENTERING_ID", "ENTERING_PASSWORD", "PROCESSING", "ACCESS_GRANTED",
+    "ACCESS_DENIED", "TIMEOUT", "CHANGE_PASSWORD", "CHANGE_ENTERING_ID",
+    "CHANGE_ENTERING_OLD_PASS", "CHANGE_ENTERING_NEW_PASS", "CHANGE_PROCESSING",
+};
+
+static const char *const access_events[] = {
+    "KEY_PRESSED", "TIMEOUT", "RESET",
+};
+
+#define NAME(table, i)  ((i) < sizeof(table) / sizeof(table[0]) ? table[i] : "?")
+
+static void trajectory_add(trajectory_t *t, uint32_t tick, uint8_t event, uint8_t arg) {
+    if (t->count == t->capacity) {
+        t->capacity = t->capacity ? 2 * t->capacity : 256;
+        t->steps = realloc(t->steps, t->capacity * sizeof(step_t));
+        if (t->steps == NULL) {
+            fprintf(stderr, "replay: sin memoria\n");
+            exit(1);
+        }
+    }
+    t->steps[t->count++] = (step_t){ tick, event, arg };
+}
+
+/**
+ * @brief Texto de un paso: módulo y valor
+ */
+static void describe(const step_t *s, char *buf, size_t size) {
+    switch (s->event) {
+        case INPUT_EV_KEYPAD_STATE:
+            snprintf(buf, size, "teclado  -> %s", NAME(keypad_states, s->arg));
+            break;
+        case INPUT_EV_KEY:
+            snprintf(buf, size, "teclado  tecla '%c'", s->arg);
+            break;
+        case INPUT_EV_ACCESS_KEY:
+            snprintf(buf, size, "acceso   recibe '%c'", s->arg);
+            break;
+        case INPUT_EV_ACCESS_EVENT:
+            snprintf(buf, size, "acceso   evento %s", NAME(access_events, s->arg));
+            break;
+        case INPUT_EV_TIMEOUT:
+            snprintf(buf, size, "acceso   vence timeout (%s)", NAME(access_events, s->arg));
+            break;
+        case INPUT_EV_ACCESS_STATE:
+            snprintf(buf, size, "acceso   -> %s", NAME(access_states, s->arg));
+            break;
+        default:
+            snprintf(buf, size, "evento %u (%u)", s->event, s->arg);
+            break;
+    }
+}
+
+/* ---- Lectura de la grabación ------------------------------------------- */
+
+static int hex_nibble(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+/**
+ * @brief Separa la grabación en entradas y trayectoria grabada
+ *
+ * @return Cantidad de registros leídos, o -1 si no hay un volcado
+ */
+static long load_capture(FILE *f, bool *from_boot, char *version, size_t version_size) {
+    char line[1024];
+    bool inside = false;
+    long total = 0;
+    unsigned long count = 0, lost = 0, size = 0;
+    int boot = 0;
+
+    while (fgets(line, sizeof(line), f)) {
+        if (strncmp(line, "INPUT BEGIN", 11) == 0) {
+            char ver[64] = "?";
+            if (sscanf(line, "INPUT BEGIN 1 %lu %lu %lu %d %63s", &count, &lost, &size, &boot, ver) < 4 ||
+                size != sizeof(input_record_t)) {
+                fprintf(stderr, "replay: encabezado no reconocido: %s", line);
+                return -1;
+            }
+            snprintf(version, version_size, "%s", ver);
+            *from_boot = (boot != 0);
+            inside = true;
+            input_count = 0;
+            recorded.count = 0;
+            total = 0;
+            continue;
+        }
+        if (!inside) {
+            continue;
+        }
+        if (strncmp(line, "INPUT END", 9) == 0) {
+            inside = false;
+            continue;
+        }
+        if (line[0] != 'D' || line[1] != ' ') {
+            continue;
+        }
+
+        // Registros de 8 bytes en hexadecimal, little-endian como en el RP2040
+        for (const char *p = line + 2; hex_nibble(p[0]) >= 0; p += 2 * sizeof(input_record_t)) {
+            uint8_t b[sizeof(input_record_t)];
+            for (size_t j = 0; j < sizeof(b); j++) {
+                int hi = hex_nibble(p[2 * j]), lo = hex_nibble(p[2 * j + 1]);
+                if (hi < 0 || lo < 0) {
+                    fprintf(stderr, "replay: registro truncado\n");
+                    return -1;
+                }
+                b[j] = (uint8_t)(hi << 4 | lo);
+            }
+            input_record_t r = {
+                .tick = (uint32_t)b[0] | (uint32_t)b[1] << 8 | (uint32_t)b[2] << 16 | (uint32_t)b[3] << 24,
+                .time_us = (uint16_t)(b[4] | b[5] << 8),
+                .event = b[6],
+                .arg = b[7],
+            };
+            total++;
+
+            if (r.event == INPUT_EV_EDGE || r.event == INPUT_EV_ROW) {
+                if (input_count < MAX_RECORDS) {
+                    inputs[input_count++] = r;
+                }
+            } else {
+                trajectory_add(&recorded, r.tick, r.event, r.arg);
+            }
+        }
+    }
+    return (count > 0 || total > 0) ? total : -1;
+}
+
+/* ---- Entrega de entradas ------------------------------------------------- */
+
+static TickType_t next_input_tick(void *ctx) {
+    (void)ctx;
+    return (input_next < input_count) ? inputs[input_next].tick : portMAX_DELAY;
+}
+
+static void deliver_inputs(TickType_t now, void *ctx) {
+    (void)ctx;
+    while (input_next < input_count && inputs[input_next].tick <= now) {
+        const input_record_t *r = &inputs[input_next++];
+        if (r->event == INPUT_EV_ROW) {
+            uint8_t row = r->arg & (uint8_t)~INPUT_ROW_HIGH;
+            if (row < BOARD_KEYPAD_ROWS) {
+                sim_gpio_set_input(board_row_pins[row], (r->arg & INPUT_ROW_HIGH) != 0);
+            }
+        } else {
+            sim_gpio_irq(r->arg, GPIO_IRQ_EDGE_FALL);
+        }
+    }
+}
+
+/* ---- Módulos reemplazados ------------------------------------------------ */
+
+void input_record(input_event_t event, uint8_t arg) {
+    // Las entradas las entrega el arnés; solo se guarda la trayectoria
+    if (event != INPUT_EV_EDGE && event != INPUT_EV_ROW) {
+        trajectory_add(&replayed, xTaskGetTickCount(), (uint8_t)event, arg);
+    }
+}
+
+void input_record_from_isr(input_event_t event, uint8_t arg) {
+    input_record(event, arg);
+}
+
+void log_write(uint8_t level, uint8_t module, const char *format, int nargs, ...) {
+    (void)module;
+    (void)nargs;
+    if (!verbose) {
+        return;
+    }
+    va_list ap;
+    va_start(ap, nargs);
+    fprintf(out, "%10lu ms  [log %u] ", (unsigned long)xTaskGetTickCount(), level);
+    vfprintf(out, format, ap);
+    fprintf(out, "\n");
+    va_end(ap);
+}
+
+bool led_send_command(led_command_t command, uint32_t duration_ms) {
+    (void)command;
+    (void)duration_ms;
+    return true;
+}
+
+void signal_acceso_concedido(void) {}
+void signal_acceso_denegado(void) {}
+void signal_sistema_listo(void) {}
+void signal_proceso_iniciado(void) {}
+void signal_esperando_clave(void) {}
+void signal_usuario_bloqueado(void) {}
+
+bool ssd1306_send_command(display_message_type_t type, const char *custom_message, uint32_t display_time_ms) {
+    (void)type;
+    (void)custom_message;
+    (void)display_time_ms;
+    return true;
+}
+
+void task_health_start(health_task_id_t id) { (void)id; }
+void task_health_heartbeat(health_task_id_t id) { (void)id; }
+void task_health_idle(health_task_id_t id) { (void)id; }
+void task_health_begin(health_task_id_t id) { (void)id; }
+void task_health_end(health_task_id_t id) { (void)id; }
+
+void trace_register_queue(void *queue, trace_queue_id_t id, const char *name) {
+    (void)queue;
+    (void)id;
+    (void)name;
+}
+void trace_isr_enter(uint8_t isr_id) { (void)isr_id; }
+void trace_isr_exit(uint8_t isr_id) { (void)isr_id; }
+
+void boot_mark(boot_phase_t phase) { (void)phase; }
+
+/* ---- Comparación --------------------------------------------------------- */
+
+/**
+ * @brief Informa la primera divergencia entre la trayectoria grabada y la reproducida
+ *
+ * @return true si coinciden (ticks dentro de la tolerancia)
+ */
+static bool compare(uint32_t tolerance) {
+    size_t n = (recorded.count < replayed.count) ? recorded.count : replayed.count;
+    char a[64], b[64];
+
+    for (size_t i = 0; i < n; i++) {
+        const step_t *r = &recorded.steps[i];
+        const step_t *p = &replayed.steps[i];
+        uint32_t skew = (r->tick > p->tick) ? r->tick - p->tick : p->tick - r->tick;
+
+        if (r->event == p->event && r->arg == p->arg && skew <= tolerance) {
+            continue;
+        }
+
+        fprintf(out, "\nDIVERGENCIA en el paso %zu:\n", i + 1);
+        size_t from = (i > 3) ? i - 3 : 0;
+        for (size_t k = from; k < i; k++) {
+            describe(&recorded.steps[k], a, sizeof(a));
+            fprintf(out, "  %10lu ms  %s\n", (unsigned long)recorded.steps[k].tick, a);
+        }
+        describe(r, a, sizeof(a));
+        describe(p, b, sizeof(b));
+        fprintf(out, "  grabado:     %10lu ms  %s\n", (unsigned long)r->tick, a);
+        fprintf(out, "  reproducido: %10lu ms  %s\n", (unsigned long)p->tick, b);
+        if (r->event == p->event && r->arg == p->arg) {
+            fprintf(out, "  (mismo paso con %lu ms de diferencia)\n", (unsigned long)skew);
+        }
+        return false;
+    }
+
+    if (recorded.count != replayed.count) {
+        const trajectory_t *longer = (recorded.count > replayed.count) ? &recorded : &replayed;
+        describe(&longer->steps[n], a, sizeof(a));
+        fprintf(out, "\nDIVERGENCIA en el paso %zu: la trayectoria %s sigue con %lu ms  %s\n",
+                n + 1, (longer == &recorded) ? "grabada" : "reproducida",
+                (unsigned long)longer->steps[n].tick, a);
+        return false;
+    }
+    return true;
+}
+
+static double wall_s(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+int main(int argc, char **argv) {
+    double speed = 0;
+    uint32_t settle_ms = 15000;
+    uint32_t tolerance = 0;
+    const char *trace_path = NULL;
+    const char *capture_path = NULL;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-v") == 0) {
+            verbose = true;
+        } else if (strcmp(argv[i], "-s") == 0 && i + 1 < argc) {
+            speed = atof(argv[++i]);
+        } else if (strcmp(argv[i], "-e") == 0 && i + 1 < argc) {
+            settle_ms = (uint32_t)strtoul(argv[++i], NULL, 0);
+        } else if (strcmp(argv[i], "-t") == 0 && i + 1 < argc) {
+            tolerance = (uint32_t)strtoul(argv[++i], NULL, 0);
+        } else if (strcmp(argv[i], "-o") == 0 && i + 1 < argc) {
+            trace_path = argv[++i];
+        } else if (argv[i][0] != '-' && capture_path == NULL) {
+            capture_path = argv[i];
+        } else {
+            fprintf(stderr, "uso: %s [-v] [-s velocidad] [-e espera_ms] [-t tolerancia_ms] "
+                            "[-o trayectoria.txt] captura.txt\n", argv[0]);
+            return 1;
+        }
+    }
+    if (capture_path == NULL) {
+        fprintf(stderr, "replay: falta la captura\n");
+        return 1;
+    }
+
+    // El informe va a la salida original; los printf del firmware se descartan sin -v
+    out = fdopen(dup(STDOUT_FILENO), "w");
+    if (!verbose && freopen("/dev/null", "w", stdout) == NULL) {
+        return 1;
+    }
+
+    FILE *f = fopen(capture_path, "r");
+    if (f == NULL) {
+        perror(capture_path);
+        return 1;
+    }
+    bool from_boot = false;
+    char version[64] = "?";
+    long total = load_capture(f, &from_boot, version, sizeof(version));
+    fclose(f);
+    if (total < 0) {
+        fprintf(stderr, "replay: no se encontró un volcado \"input dump\" en %s\n", capture_path);
+        return 1;
+    }
+
+    fprintf(out, "Grabación de firmware %s: %ld registros, %zu entradas, %zu pasos de trayectoria\n",
+            version, total, input_count, recorded.count);
+    if (!from_boot) {
+        fprintf(out, "ATENCIÓN: la grabación no cubre desde el arranque; se supone el teclado y el "
+                     "control de acceso en reposo y el limitador vacío\n");
+    }
+
+    // Misma secuencia de inicialización que main_rtos.c para estos módulos
+    system_bus_init();
+    database_init();
+    if (!keypad_init() || !access_control_init()) {
+        fprintf(stderr, "replay: falló la inicialización de los módulos\n");
+        return 1;
+    }
+    sim_add_task("Keypad", KEYPAD_TASK_PRIORITY, keypad_task);
+    sim_add_task("AccessControl", ACCESS_CONTROL_TASK_PRIORITY, access_control_task);
+
+    uint32_t last_tick = 0;
+    if (input_count > 0) {
+        last_tick = inputs[input_count - 1].tick;
+    }
+    if (recorded.count > 0 && recorded.steps[recorded.count - 1].tick > last_tick) {
+        last_tick = recorded.steps[recorded.count - 1].tick;
+    }
+
+    sim_input_source_t source = { next_input_tick, deliver_inputs, NULL };
+    double start = wall_s();
+    sim_run(&source, last_tick + settle_ms, speed);
+    double elapsed = wall_s() - start;
+
+    fprintf(out, "Reproducidos %.1f s en %.1f ms (%.0fx tiempo real)\n",
+            last_tick / 1000.0, elapsed * 1e3, (elapsed > 0) ? last_tick / 1000.0 / elapsed : 0.0);
+
+    if (trace_path != NULL) {
+        FILE *t = fopen(trace_path, "w");
+        if (t == NULL) {
+            perror(trace_path);
+            return 1;
+        }
+        char text[64];
+        for (size_t i = 0; i < replayed.count; i++) {
+            describe(&replayed.steps[i], text, sizeof(text));
+            fprintf(t, "%10lu ms  %s\n", (unsigned long)replayed.steps[i].tick, text);
+        }
+        fclose(t);
+    }
+
+    bool same = compare(tolerance);
+    if (same) {
+        fprintf(out, "Trayectorias idénticas (%zu pasos)\n", replayed.count);
+    }
+    fflush(out);
+    // Los hilos de las tareas siguen bloqueados: terminar el proceso
+    _exit(same ? 0 : 2);
+}
@@ -0,0 +1,42 @@
+/**
+ * @file FreeRTOS.h
+ * @brief FreeRTOS mínimo para reproducir el firmware en el host (tools/replay)
+ * @author Sistema de Control de Acceso
+ * @date 2025
+ *
+ * Solo lo que usan keypad.c, access_control_rtos.c y system_bus.c. Las
+ * funciones están en tools/replay/sim_rtos.c, que ejecuta una tarea a la
+ * vez con un tick virtual de 1 ms.
+ */
+
+#ifndef REPLAY_FREERTOS_H
+#define REPLAY_FREERTOS_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+typedef uint32_t TickType_t;
+typedef long BaseType_t;
+typedef unsigned long UBaseType_t;
+
+#define pdTRUE                  ((BaseType_t)1)
+#define pdFALSE                 ((BaseType_t)0)
+#define pdPASS                  pdTRUE
+#define pdFAIL                  pdFALSE
+
+#define portMAX_DELAY           ((TickType_t)0xffffffffu)
+#define configTICK_RATE_HZ      1000
+#define configCPU_CLOCK_HZ      125000000
+#define configEXPECTED_IDLE_TIME_BEFORE_SLEEP   2
+#define portTICK_PERIOD_MS      ((TickType_t)1000 / configTICK_RATE_HZ)
+#define pdMS_TO_TICKS(ms)       ((TickType_t)(((uint64_t)(ms) * configTICK_RATE_HZ) / 1000))
+
+#define configMAX_PRIORITIES    5
+#define tskIDLE_PRIORITY        0
+
+/* Una sola tarea corre a la vez y no hay desalojo dentro de una sección */
+#define taskENTER_CRITICAL()    do { } while (0)
+#define taskEXIT_CRITICAL()     do { } while (0)
+#define portYIELD_FROM_ISR(x)   ((void)(x))
+
+#endif // REPLAY_FREERTOS_H
@@ -0,0 +1,38 @@
+/**
+ * @file gpio.h
+ * @brief GPIO simulado para tools/replay
+ * @author Sistema de Control de Acceso
+ * @date 2025
+ *
+ * Las salidas se ignoran. Las entradas devuelven el nivel que fijó el
+ * arnés a partir de la grabación (sim_gpio_set_input).
+ */
+
+#ifndef REPLAY_HARDWARE_GPIO_H
+#define REPLAY_HARDWARE_GPIO_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifndef REPLAY_PICO_STDLIB_H
+typedef unsigned int uint;
+#endif
+
+#define GPIO_IRQ_LEVEL_LOW      0x1u
+#define GPIO_IRQ_LEVEL_HIGH     0x2u
+#define GPIO_IRQ_EDGE_FALL      0x4u
+#define GPIO_IRQ_EDGE_RISE      0x8u
+
+typedef void (*gpio_irq_callback_t)(uint gpio, uint32_t events);
+
+void gpio_init_mask(uint32_t mask);
+void gpio_set_dir_out_masked(uint32_t mask);
+void gpio_set_dir_in_masked(uint32_t mask);
+void gpio_clr_mask(uint32_t mask);
+void gpio_put_masked(uint32_t mask, uint32_t value);
+void gpio_pull_up(uint gpio);
+void gpio_set_irq_enabled_with_callback(uint gpio, uint32_t events, bool enabled,
+                                        gpio_irq_callback_t callback);
+bool gpio_get(uint gpio);
+
+#endif // REPLAY_HARDWARE_GPIO_H
@@ -0,0 +1,11 @@
+/**
+ * @file irq.h
+ * @brief hardware/irq.h vacío para tools/replay (las IRQ las dispara el arnés)
+ * @author Sistema de Control de Acceso
+ * @date 2025
+ */
+
+#ifndef REPLAY_HARDWARE_IRQ_H
+#define REPLAY_HARDWARE_IRQ_H
+
+#endif // REPLAY_HARDWARE_IRQ_H
@@ -0,0 +1,21 @@
+/**
+ * @file rtc.h
+ * @brief hardware/rtc.h mínimo para compilar el firmware en el host
+ * @author Sistema de Control de Acceso
+ * @date 2025
+ *
+ * Las funciones las define cada simulación con su propio modelo del RTC.
+ */
+
+#ifndef REPLAY_HARDWARE_RTC_H
+#define REPLAY_HARDWARE_RTC_H
+
+#include <stdbool.h>
+#include "pico/util/datetime.h"
+
+void rtc_init(void);
+bool rtc_running(void);
+bool rtc_set_datetime(const datetime_t *t);
+bool rtc_get_datetime(datetime_t *t);
+
+#endif // REPLAY_HARDWARE_RTC_H
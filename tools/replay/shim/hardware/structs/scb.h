@@ -0,0 +1,24 @@
+/**
+ * @file scb.h
+ * @brief Registro ICSR del Cortex-M0+ simulado para el host
+ * @author Sistema de Control de Acceso
+ * @date 2025
+ */
+
+#ifndef REPLAY_HARDWARE_STRUCTS_SCB_H
+#define REPLAY_HARDWARE_STRUCTS_SCB_H
+
+#include <stdint.h>
+
+#define M0PLUS_ICSR_PENDSTCLR_BITS      0x02000000u
+#define M0PLUS_ICSR_PENDSTSET_BITS      0x04000000u
+
+typedef struct {
+    uint32_t icsr;
+} scb_hw_t;
+
+extern scb_hw_t sim_scb;
+
+#define scb_hw (&sim_scb)
+
+#endif // REPLAY_HARDWARE_STRUCTS_SCB_H
@@ -0,0 +1,29 @@
+/**
+ * @file systick.h
+ * @brief Registros del SysTick del Cortex-M0+ simulados para el host
+ * @author Sistema de Control de Acceso
+ * @date 2025
+ *
+ * La simulación es dueña de sim_systick y mantiene cvr al día con su
+ * reloj virtual.
+ */
+
+#ifndef REPLAY_HARDWARE_STRUCTS_SYSTICK_H
+#define REPLAY_HARDWARE_STRUCTS_SYSTICK_H
+
+#include <stdint.h>
+
+#define M0PLUS_SYST_CSR_ENABLE_BITS     0x00000001u
+
+typedef struct {
+    uint32_t csr;
+    uint32_t rvr;
+    uint32_t cvr;
+    uint32_t calib;
+} systick_hw_t;
+
+extern systick_hw_t sim_systick;
+
+#define systick_hw (&sim_systick)
+
+#endif // REPLAY_HARDWARE_STRUCTS_SYSTICK_H
@@ -0,0 +1,26 @@
+/**
+ * @file sync.h
+ * @brief hardware/sync.h simulado para las herramientas del host
+ * @author Sistema de Control de Acceso
+ * @date 2025
+ *
+ * Las barreras no hacen nada (un solo hilo). La máscara de interrupciones
+ * y __wfi() las define la simulación que las necesite.
+ */
+
+#ifndef REPLAY_HARDWARE_SYNC_H
+#define REPLAY_HARDWARE_SYNC_H
+
+#include <stdint.h>
+
+static inline void __dsb(void) {
+}
+
+static inline void __isb(void) {
+}
+
+uint32_t save_and_disable_interrupts(void);
+void restore_interrupts(uint32_t status);
+void __wfi(void);
+
+#endif // REPLAY_HARDWARE_SYNC_H
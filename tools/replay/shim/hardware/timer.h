@@ -0,0 +1,29 @@
+/**
+ * @file timer.h
+ * @brief Temporizador de 1 MHz simulado para las herramientas del host
+ * @author Sistema de Control de Acceso
+ * @date 2025
+ *
+ * Las funciones las define la simulación que las necesite, sobre su
+ * propio reloj virtual.
+ */
+
+#ifndef REPLAY_HARDWARE_TIMER_H
+#define REPLAY_HARDWARE_TIMER_H
+
+#include "pico/stdlib.h"
+
+typedef uint64_t absolute_time_t;
+typedef void (*hardware_alarm_callback_t)(uint alarm_num);
+
+static inline absolute_time_t from_us_since_boot(uint64_t us) {
+    return us;
+}
+
+uint64_t time_us_64(void);
+int hardware_alarm_claim_unused(bool required);
+void hardware_alarm_set_callback(uint alarm_num, hardware_alarm_callback_t callback);
+bool hardware_alarm_set_target(uint alarm_num, absolute_time_t target);
+void hardware_alarm_cancel(uint alarm_num);
+
+#endif // REPLAY_HARDWARE_TIMER_H
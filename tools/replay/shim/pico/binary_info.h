@@ -0,0 +1,13 @@
+/**
+ * @file binary_info.h
+ * @brief pico/binary_info.h vacío para compilar el firmware en el host
+ * @author Sistema de Control de Acceso
+ * @date 2025
+ */
+
+#ifndef REPLAY_PICO_BINARY_INFO_H
+#define REPLAY_PICO_BINARY_INFO_H
+
+#define bi_decl(...)
+
+#endif // REPLAY_PICO_BINARY_INFO_H
@@ -0,0 +1,24 @@
+/**
+ * @file stdlib.h
+ * @brief pico/stdlib.h mínimo para tools/replay
+ * @author Sistema de Control de Acceso
+ * @date 2025
+ */
+
+#ifndef REPLAY_PICO_STDLIB_H
+#define REPLAY_PICO_STDLIB_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+typedef unsigned int uint;
+
+#define count_of(a) (sizeof(a) / sizeof((a)[0]))
+
+/* Definida por la simulación que la necesite */
+void sleep_us(uint64_t us);
+
+#include "hardware/gpio.h"
+
+#endif // REPLAY_PICO_STDLIB_H
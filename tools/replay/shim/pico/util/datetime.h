@@ -0,0 +1,23 @@
+/**
+ * @file datetime.h
+ * @brief pico/util/datetime.h mínimo para compilar el firmware en el host
+ * @author Sistema de Control de Acceso
+ * @date 2025
+ */
+
+#ifndef REPLAY_PICO_UTIL_DATETIME_H
+#define REPLAY_PICO_UTIL_DATETIME_H
+
+#include <stdint.h>
+
+typedef struct {
+    int16_t year;
+    int8_t month;
+    int8_t day;
+    int8_t dotw;                /**< 0 = domingo */
+    int8_t hour;
+    int8_t min;
+    int8_t sec;
+} datetime_t;
+
+#endif // REPLAY_PICO_UTIL_DATETIME_H
@@ -0,0 +1,15 @@
+/**
+ * @file queue.h
+ * @brief Tipos de colas de FreeRTOS para tools/replay (el firmware ya no usa colas)
+ * @author Sistema de Control de Acceso
+ * @date 2025
+ */
+
+#ifndef REPLAY_QUEUE_H
+#define REPLAY_QUEUE_H
+
+#include "FreeRTOS.h"
+
+typedef void *QueueHandle_t;
+
+#endif // REPLAY_QUEUE_H
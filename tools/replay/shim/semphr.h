@@ -0,0 +1,22 @@
+/**
+ * @file semphr.h
+ * @brief Semáforos binarios y mutex de FreeRTOS simulados en tiempo virtual (tools/replay)
+ * @author Sistema de Control de Acceso
+ * @date 2025
+ */
+
+#ifndef REPLAY_SEMPHR_H
+#define REPLAY_SEMPHR_H
+
+#include "FreeRTOS.h"
+#include "queue.h"
+
+typedef struct sim_sem *SemaphoreHandle_t;
+
+SemaphoreHandle_t xSemaphoreCreateBinary(void);
+SemaphoreHandle_t xSemaphoreCreateMutex(void);
+BaseType_t xSemaphoreTake(SemaphoreHandle_t sem, TickType_t wait);
+BaseType_t xSemaphoreGive(SemaphoreHandle_t sem);
+BaseType_t xSemaphoreGiveFromISR(SemaphoreHandle_t sem, BaseType_t *higher_priority_woken);
+
+#endif // REPLAY_SEMPHR_H
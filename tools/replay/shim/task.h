@@ -0,0 +1,33 @@
+/**
+ * @file task.h
+ * @brief API de tareas de FreeRTOS simulada en tiempo virtual (tools/replay)
+ * @author Sistema de Control de Acceso
+ * @date 2025
+ */
+
+#ifndef REPLAY_TASK_H
+#define REPLAY_TASK_H
+
+#include "FreeRTOS.h"
+
+typedef void *TaskHandle_t;
+
+typedef struct {
+    TickType_t start;
+} TimeOut_t;
+
+typedef enum {
+    eAbortSleep = 0,
+    eStandardSleep,
+    eNoTasksWaitingTimeout
+} eSleepModeStatus;
+
+TickType_t xTaskGetTickCount(void);
+TickType_t xTaskGetTickCountFromISR(void);
+void vTaskDelay(TickType_t ticks);
+void vTaskSetTimeOutState(TimeOut_t *timeout);
+BaseType_t xTaskCheckForTimeOut(TimeOut_t *timeout, TickType_t *wait);
+eSleepModeStatus eTaskConfirmSleepModeStatus(void);
+void vTaskStepTick(TickType_t ticks);
+
+#endif // REPLAY_TASK_H
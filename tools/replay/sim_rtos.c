@@ -0,0 +1,368 @@
+/**
+ * @file sim_rtos.c
+ * @brief Implementación del scheduler de tiempo virtual y del GPIO simulado
+ * @author Sistema de Control de Acceso
+ * @date 2025
+ *
+ * Todas las tareas y el scheduler comparten un mutex: la tarea que corre lo
+ * tiene tomado y lo libera solo al bloquearse, así que el resultado es
+ * determinista aunque las tareas sean hilos.
+ */
+
+#define _POSIX_C_SOURCE 199309L
+#include "sim_rtos.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "task.h"
+#include "semphr.h"
+#include "hardware/gpio.h"
+#include "hardware/timer.h"
+
+/** @brief GPIO del banco 0 */
+#define SIM_NUM_GPIOS   30
+
+/**
+ * @brief Tarea simulada
+ */
+typedef struct sim_task {
+    const char *name;
+    int priority;
+    void (*fn)(void *);
+    pthread_t thread;
+    pthread_cond_t run_cv;      /**< Señal para que el hilo retome la ejecución */
+    bool ready;                 /**< Lista para correr */
+    bool timed;                 /**< Bloqueada con plazo en wake */
+    bool timed_out;             /**< El plazo venció antes de recibir el semáforo */
+    TickType_t wake;            /**< Tick de desbloqueo */
+    struct sim_sem *waiting;    /**< Semáforo esperado */
+} sim_task_t;
+
+/**
+ * @brief Semáforo binario con a lo sumo una tarea esperando
+ */
+struct sim_sem {
+    bool available;
+    sim_task_t *waiter;
+};
+
+static pthread_mutex_t sim_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t sched_cv = PTHREAD_COND_INITIALIZER;
+
+static sim_task_t tasks[SIM_MAX_TASKS];
+static int task_count;
+
+/** @brief Tarea en ejecución (NULL = scheduler o contexto de ISR) */
+static sim_task_t *running;
+
+/** @brief Tick virtual */
+static TickType_t now;
+
+static bool gpio_level[SIM_NUM_GPIOS];
+static gpio_irq_callback_t gpio_callback;
+static uint32_t gpio_irq_events[SIM_NUM_GPIOS];
+
+/* ---- Scheduler ----------------------------------------------------------- */
+
+/**
+ * @brief Devuelve el control al scheduler y espera a ser elegida otra vez
+ */
+static void task_block(sim_task_t *t) {
+    running = NULL;
+    pthread_cond_signal(&sched_cv);
+    while (running != t) {
+        pthread_cond_wait(&t->run_cv, &sim_lock);
+    }
+}
+
+static void *task_entry(void *arg) {
+    sim_task_t *t = arg;
+
+    pthread_mutex_lock(&sim_lock);
+    while (running != t) {
+        pthread_cond_wait(&t->run_cv, &sim_lock);
+    }
+    t->fn(NULL);
+    // Las tareas del firmware no retornan
+    fprintf(stderr, "replay: la tarea %s terminó\n", t->name);
+    exit(1);
+}
+
+void sim_add_task(const char *name, int priority, void (*fn)(void *)) {
+    if (task_count >= SIM_MAX_TASKS) {
+        fprintf(stderr, "replay: demasiadas tareas\n");
+        exit(1);
+    }
+    sim_task_t *t = &tasks[task_count++];
+    t->name = name;
+    t->priority = priority;
+    t->fn = fn;
+    t->ready = true;
+    pthread_cond_init(&t->run_cv, NULL);
+}
+
+/**
+ * @brief Tarea lista de mayor prioridad (la primera registrada en empate)
+ */
+static sim_task_t *pick_ready(void) {
+    sim_task_t *best = NULL;
+    for (int i = 0; i < task_count; i++) {
+        if (tasks[i].ready && (best == NULL || tasks[i].priority > best->priority)) {
+            best = &tasks[i];
+        }
+    }
+    return best;
+}
+
+/**
+ * @brief Ejecuta una tarea hasta que se bloquee
+ */
+static void dispatch(sim_task_t *t) {
+    running = t;
+    pthread_cond_signal(&t->run_cv);
+    while (running != NULL) {
+        pthread_cond_wait(&sched_cv, &sim_lock);
+    }
+}
+
+/**
+ * @brief Despierta las tareas cuyo plazo venció
+ */
+static void expire_timers(void) {
+    for (int i = 0; i < task_count; i++) {
+        sim_task_t *t = &tasks[i];
+        if (!t->ready && t->timed && (int32_t)(now - t->wake) >= 0) {
+            t->ready = true;
+            t->timed = false;
+            if (t->waiting != NULL) {
+                t->waiting->waiter = NULL;
+                t->waiting = NULL;
+                t->timed_out = true;
+            }
+        }
+    }
+}
+
+/**
+ * @brief Próximo plazo de una tarea bloqueada
+ */
+static TickType_t next_timer(void) {
+    TickType_t next = portMAX_DELAY;
+    for (int i = 0; i < task_count; i++) {
+        if (!tasks[i].ready && tasks[i].timed && tasks[i].wake < next) {
+            next = tasks[i].wake;
+        }
+    }
+    return next;
+}
+
+static double wall_s(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+void sim_run(const sim_input_source_t *source, TickType_t end_tick, double speed) {
+    pthread_mutex_lock(&sim_lock);
+    for (int i = 0; i < task_count; i++) {
+        pthread_create(&tasks[i].thread, NULL, task_entry, &tasks[i]);
+    }
+
+    double wall_start = wall_s();
+    while (1) {
+        sim_task_t *t = pick_ready();
+        if (t != NULL) {
+            dispatch(t);
+            continue;
+        }
+
+        // Nadie listo: saltar al próximo evento
+        TickType_t next = next_timer();
+        TickType_t input = source->next_tick(source->ctx);
+        if (input < next) {
+            next = input;
+        }
+        if (next == portMAX_DELAY || next > end_tick) {
+            break;
+        }
+        if (next > now) {
+            now = next;
+        }
+
+        if (speed > 0) {
+            double target = wall_start + now / (1000.0 * speed);
+            double delay = target - wall_s();
+            if (delay > 0) {
+                struct timespec ts = { (time_t)delay, (long)((delay - (time_t)delay) * 1e9) };
+                pthread_mutex_unlock(&sim_lock);
+                nanosleep(&ts, NULL);
+                pthread_mutex_lock(&sim_lock);
+            }
+        }
+
+        source->deliver(now, source->ctx);
+        expire_timers();
+    }
+    pthread_mutex_unlock(&sim_lock);
+}
+
+/* ---- API de tareas ------------------------------------------------------- */
+
+TickType_t xTaskGetTickCount(void) {
+    return now;
+}
+
+TickType_t xTaskGetTickCountFromISR(void) {
+    return now;
+}
+
+uint64_t time_us_64(void) {
+    return (uint64_t)now * 1000;
+}
+
+void vTaskDelay(TickType_t ticks) {
+    sim_task_t *t = running;
+    if (ticks > 0) {
+        t->ready = false;
+        t->timed = true;
+        t->wake = now + ticks;
+    }
+    task_block(t);
+}
+
+void vTaskSetTimeOutState(TimeOut_t *timeout) {
+    timeout->start = now;
+}
+
+BaseType_t xTaskCheckForTimeOut(TimeOut_t *timeout, TickType_t *wait) {
+    if (*wait == portMAX_DELAY) {
+        return pdFALSE;
+    }
+
+    TickType_t elapsed = now - timeout->start;
+    if (elapsed >= *wait) {
+        *wait = 0;
+        return pdTRUE;
+    }
+    *wait -= elapsed;
+    timeout->start = now;
+    return pdFALSE;
+}
+
+/* ---- Semáforos ----------------------------------------------------------- */
+
+SemaphoreHandle_t xSemaphoreCreateBinary(void) {
+    return calloc(1, sizeof(struct sim_sem));
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex(void) {
+    // Sin herencia de prioridad: en la reproducción nunca hay contención
+    SemaphoreHandle_t sem = xSemaphoreCreateBinary();
+    if (sem != NULL) {
+        sem->available = true;
+    }
+    return sem;
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t sem, TickType_t wait) {
+    if (sem->available) {
+        sem->available = false;
+        return pdTRUE;
+    }
+    if (wait == 0) {
+        return pdFALSE;
+    }
+
+    sim_task_t *t = running;
+    t->ready = false;
+    t->timed = (wait != portMAX_DELAY);
+    t->wake = now + wait;
+    t->timed_out = false;
+    t->waiting = sem;
+    sem->waiter = t;
+    task_block(t);
+    return t->timed_out ? pdFALSE : pdTRUE;
+}
+
+/**
+ * @brief Entrega el semáforo a la tarea que espera o lo deja disponible
+ *
+ * @return Tarea despertada, o NULL
+ */
+static sim_task_t *sem_give(SemaphoreHandle_t sem, BaseType_t *result) {
+    sim_task_t *w = sem->waiter;
+    *result = pdTRUE;
+
+    if (w != NULL) {
+        sem->waiter = NULL;
+        w->waiting = NULL;
+        w->ready = true;
+        w->timed = false;
+        return w;
+    }
+    if (sem->available) {
+        *result = pdFALSE;
+    }
+    sem->available = true;
+    return NULL;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t sem) {
+    BaseType_t result;
+    sim_task_t *woken = sem_give(sem, &result);
+
+    // Desalojo: la tarea despertada corre antes si tiene más prioridad
+    if (woken != NULL && running != NULL && woken->priority > running->priority) {
+        task_block(running);
+    }
+    return result;
+}
+
+BaseType_t xSemaphoreGiveFromISR(SemaphoreHandle_t sem, BaseType_t *higher_priority_woken) {
+    BaseType_t result;
+    sim_task_t *woken = sem_give(sem, &result);
+
+    if (woken != NULL && higher_priority_woken != NULL) {
+        *higher_priority_woken = pdTRUE;
+    }
+    return result;
+}
+
+/* ---- GPIO ---------------------------------------------------------------- */
+
+void gpio_init_mask(uint32_t mask) { (void)mask; }
+void gpio_set_dir_out_masked(uint32_t mask) { (void)mask; }
+void gpio_set_dir_in_masked(uint32_t mask) { (void)mask; }
+void gpio_clr_mask(uint32_t mask) { (void)mask; }
+void gpio_put_masked(uint32_t mask, uint32_t value) { (void)mask; (void)value; }
+
+void gpio_pull_up(uint gpio) {
+    if (gpio < SIM_NUM_GPIOS) {
+        gpio_level[gpio] = true;
+    }
+}
+
+void gpio_set_irq_enabled_with_callback(uint gpio, uint32_t events, bool enabled,
+                                        gpio_irq_callback_t callback) {
+    if (gpio < SIM_NUM_GPIOS) {
+        gpio_irq_events[gpio] = enabled ? events : 0;
+    }
+    gpio_callback = callback;
+}
+
+bool gpio_get(uint gpio) {
+    return (gpio < SIM_NUM_GPIOS) ? gpio_level[gpio] : false;
+}
+
+void sim_gpio_set_input(unsigned gpio, bool level) {
+    if (gpio < SIM_NUM_GPIOS) {
+        gpio_level[gpio] = level;
+    }
+}
+
+void sim_gpio_irq(unsigned gpio, uint32_t events) {
+    if (gpio < SIM_NUM_GPIOS && (gpio_irq_events[gpio] & events) && gpio_callback != NULL) {
+        gpio_callback(gpio, events);
+    }
+}
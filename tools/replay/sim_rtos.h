@@ -0,0 +1,60 @@
+/**
+ * @file sim_rtos.h
+ * @brief Scheduler de tiempo virtual para reproducir tareas del firmware en el host
+ * @author Sistema de Control de Acceso
+ * @date 2025
+ *
+ * Cada tarea del firmware corre en un hilo, pero solo una a la vez: la de
+ * mayor prioridad lista, como en FreeRTOS. Cuando todas están bloqueadas
+ * el tiempo salta al próximo vencimiento o a la próxima entrada grabada,
+ * sin esperar tiempo real. Dar un semáforo a una tarea de mayor prioridad
+ * la ejecuta de inmediato (desalojo), y las entradas se entregan al inicio
+ * de su tick, antes de las tareas que despiertan en ese mismo tick.
+ */
+
+#ifndef SIM_RTOS_H
+#define SIM_RTOS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "FreeRTOS.h"
+
+/** @brief Tareas simuladas como máximo */
+#define SIM_MAX_TASKS   4
+
+/**
+ * @brief Fuente de entradas del arnés
+ */
+typedef struct {
+    /** Tick de la próxima entrada, o portMAX_DELAY si no quedan */
+    TickType_t (*next_tick)(void *ctx);
+    /** Entrega las entradas del tick actual (contexto de ISR) */
+    void (*deliver)(TickType_t now, void *ctx);
+    void *ctx;
+} sim_input_source_t;
+
+/**
+ * @brief Registra una tarea (antes de sim_run)
+ */
+void sim_add_task(const char *name, int priority, void (*fn)(void *));
+
+/**
+ * @brief Ejecuta las tareas hasta que no queden entradas ni plazos antes de end_tick
+ *
+ * @param source Entradas grabadas
+ * @param end_tick Tick en el que termina la reproducción
+ * @param speed Veces el tiempo real (0 = lo más rápido posible)
+ */
+void sim_run(const sim_input_source_t *source, TickType_t end_tick, double speed);
+
+/**
+ * @brief Fija el nivel que devuelve gpio_get en un pin
+ */
+void sim_gpio_set_input(unsigned gpio, bool level);
+
+/**
+ * @brief Dispara la IRQ registrada para un pin (desde deliver)
+ */
+void sim_gpio_irq(unsigned gpio, uint32_t events);
+
+#endif // SIM_RTOS_H
@@ -0,0 +1,318 @@
+#!/usr/bin/env python3
+"""
+Análisis de planificabilidad del conjunto de tareas (prioridades fijas).
+
+Calcula el peor tiempo de respuesta de cada tarea con el análisis clásico
+de tiempo de respuesta para planificación apropiativa por prioridades fijas:
+
+    R = J + w,   w = C + B + sum_{j en hp} ceil((w + J_j) / T_j) * C_j
+
+donde hp incluye las ISR, las tareas de mayor prioridad y, como FreeRTOS
+reparte el tiempo entre tareas de igual prioridad, también a éstas. Las
+prioridades se leen de main_rtos.c (las mayores o iguales a
+configMAX_PRIORITIES se recortan como lo hace el kernel y se señalan) y los
+tiempos del archivo de tareas (tools/sched_tasks.json). Con --trace (salida
+de "trace dump") o --stats (línea de "stats json") el WCET de cada tarea se
+reemplaza por el medido cuando éste es mayor.
+
+Señala tareas que pueden perder su plazo, cadenas (p. ej. tecla a decisión)
+que exceden su presupuesto y propone una asignación monotónica en tasa con
+los niveles disponibles, verificada con el mismo análisis.
+
+Las escrituras en la flash (flash_erases/flash_programs de cada tarea, con
+los tiempos de "flash") se hacen con las interrupciones deshabilitadas: no
+son tiempo de CPU de quien escribe sino un bloqueo para todo el sistema.
+Solo las tareas de fondo pueden escribir; una tabla aparte muestra los
+tiempos de respuesta con un borrado en curso como término de bloqueo, y se
+verifica que el watchdog sobreviva al tramo más largo sin interrupciones.
+
+Uso: sched_analysis.py [--tasks tools/sched_tasks.json] [--trace volcado.txt]
+                       [--stats stats.txt] [--src .]
+"""
+
+import argparse
+import json
+import math
+import os
+import re
+import sys
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+sys.path.insert(0, HERE)
+from trace_to_chrome import (parse_dump, unwrap, EV_TASK_IN, EV_TASK_OUT,  # noqa: E402
+                             EV_ISR_ENTER, EV_ISR_EXIT)
+
+TASK_CREATE = re.compile(r'RTOS_TASK_CREATE\(\s*\w+\s*,\s*\w+\s*,\s*"([^"]+)"\s*,'
+                         r'\s*\w+\s*,\s*\w+\s*,\s*(\w+)\s*\)')
+DEFINE = re.compile(r'^\s*#define\s+(\w+)\s+\(?\s*(\d+)\s*\)?', re.M)
+
+
+def read_source_priorities(src):
+    """Prioridad de cada tarea según main_rtos.c y configMAX_PRIORITIES."""
+    with open(os.path.join(src, "main_rtos.c"), encoding="utf-8") as f:
+        main = f.read()
+    with open(os.path.join(src, "FreeRTOSConfig.h"), encoding="utf-8") as f:
+        config = f.read()
+
+    defines = {name: int(value) for name, value in DEFINE.findall(config + main)}
+    prios = {}
+    for name, prio in TASK_CREATE.findall(main):
+        prios[name] = int(prio) if prio.isdigit() else defines.get(prio)
+    return prios, defines.get("configMAX_PRIORITIES")
+
+
+def read_health_limits(src):
+    """Período de revisión y timeout del watchdog de task_health.h (ms)."""
+    with open(os.path.join(src, "task_health.h"), encoding="utf-8") as f:
+        defines = {name: int(value) for name, value in DEFINE.findall(f.read())}
+    return defines.get("HEALTH_CHECK_PERIOD_MS"), defines.get("HEALTH_WATCHDOG_TIMEOUT_MS")
+
+
+def flash_time(task, flash):
+    """Tiempo con las interrupciones deshabilitadas por activación (ms)."""
+    return (task.get("flash_erases", 0) * flash["erase_ms"] +
+            task.get("flash_programs", 0) * flash["program_ms"])
+
+
+def check_flash(tasks, flash, src):
+    """Escritores de flash: solo tareas de fondo, y el watchdog debe aguantar.
+
+    Devuelve (errores, tramo más largo sin interrupciones en ms).
+    """
+    writers = [t for t in tasks if flash_time(t, flash) > 0]
+    if not writers:
+        return 0, 0
+    irq_off = max(flash["erase_ms"] if t.get("flash_erases") else flash["program_ms"]
+                  for t in writers)
+    errors = 0
+    print("\nEscrituras en flash (IRQ deshabilitadas; borrado %.0f ms, página %.1f ms):" % (
+        flash["erase_ms"], flash["program_ms"]))
+    for t in writers:
+        print("  %-14s %3d borrados, %3d páginas: %.0f ms por activación" % (
+            t["name"], t.get("flash_erases", 0), t.get("flash_programs", 0), flash_time(t, flash)))
+        if not t.get("background"):
+            print("ERROR: %s escribe la flash en su propio camino; debe delegarlo a una tarea de fondo"
+                  % t["name"])
+            errors += 1
+
+    check_ms, watchdog_ms = read_health_limits(src)
+    if check_ms is None or watchdog_ms is None:
+        sys.exit("No se encontraron HEALTH_CHECK_PERIOD_MS y HEALTH_WATCHDOG_TIMEOUT_MS en task_health.h")
+    ok = irq_off + check_ms < watchdog_ms
+    print("Watchdog: %.0f ms sin interrupciones + revisión cada %d ms contra %d ms - %s" % (
+        irq_off, check_ms, watchdog_ms, "ok" if ok else "SE REINICIA"))
+    return errors + (not ok), irq_off
+
+
+def measured_from_trace(path):
+    """Mayor tramo continuo en ejecución de cada tarea e ISR (en ms)."""
+    with open(path, encoding="utf-8", errors="replace") as f:
+        tasks, _queues, isrs, records = parse_dump(f)
+    longest, started, isr_start = {}, {}, []
+
+    for ts, event, ident, _data in unwrap(records):
+        if event == EV_TASK_IN:
+            started[ident] = ts
+        elif event == EV_TASK_OUT and ident in started:
+            name = tasks.get(ident, str(ident))
+            longest[name] = max(longest.get(name, 0), ts - started.pop(ident))
+        elif event == EV_ISR_ENTER:
+            isr_start.append((ident, ts))
+        elif event == EV_ISR_EXIT and isr_start:
+            ident, t0 = isr_start.pop()
+            name = isrs.get(ident, str(ident))
+            longest[name] = max(longest.get(name, 0), ts - t0)
+    return {name: us / 1000.0 for name, us in longest.items()}
+
+
+def measured_from_stats(path):
+    """Tiempo medio por activación (runtime / cambios de contexto) en ms."""
+    result = {}
+    with open(path, encoding="utf-8", errors="replace") as f:
+        for line in f:
+            line = line.strip()
+            if not line.startswith("{") or '"tasks"' not in line:
+                continue
+            for t in json.loads(line)["tasks"]:
+                if t.get("switches"):
+                    result[t["name"]] = t["runtime_us"] / t["switches"] / 1000.0
+    return result
+
+
+def response_time(task, higher, blocking, limit):
+    """Peor tiempo de respuesta, o None si supera 'limit'."""
+    c, j = task["wcet_ms"], task.get("jitter_ms", 0)
+    w = c + blocking
+    while True:
+        demand = c + blocking + sum(math.ceil((w + h.get("jitter_ms", 0)) / h["period_ms"]) * h["wcet_ms"]
+                                    for h in higher)
+        if demand + j > limit:
+            return None
+        if abs(demand - w) < 1e-9:
+            return w + j
+        w = demand
+
+
+def analyse(tasks, isrs, prio, blocking):
+    """Tiempo de respuesta de cada tarea para una asignación de prioridades."""
+    results = {}
+    for t in tasks:
+        higher = list(isrs) + [h for h in tasks
+                               if h is not t and prio[h["name"]] >= prio[t["name"]]]
+        limit = max(t["deadline_ms"], t["period_ms"]) * 10
+        results[t["name"]] = response_time(t, higher, blocking, limit)
+    return results
+
+
+def rate_monotonic(tasks, levels):
+    """Asigna prioridades por período (desempate por plazo) en 1..levels.
+
+    Las tareas de fondo van al nivel 1. Si hay más grupos de período que
+    niveles, se comparten los niveles más bajos.
+    """
+    rt = sorted((t for t in tasks if not t.get("background")),
+                key=lambda t: (t["period_ms"], t["deadline_ms"]))
+    keys = sorted({(t["period_ms"], t["deadline_ms"]) for t in rt})
+    bg_level = 1 if any(t.get("background") for t in tasks) else 0
+    top, bottom = levels, bg_level + 1 if bg_level else 1
+    available = top - bottom + 1
+
+    prio = {}
+    for t in rt:
+        rank = keys.index((t["period_ms"], t["deadline_ms"]))
+        prio[t["name"]] = max(top - rank, bottom) if available > 0 else top
+    for t in tasks:
+        if t.get("background"):
+            prio[t["name"]] = bg_level or 1
+    return prio, len(keys) > available
+
+
+def print_table(title, tasks, prio, results, requested=None):
+    print("\n== %s ==" % title)
+    print("%-14s %5s %8s %8s %8s %9s  %s" % ("Tarea", "Prio", "T(ms)", "C(ms)", "D(ms)", "R(ms)", "Estado"))
+    misses = 0
+    for t in sorted(tasks, key=lambda t: -prio[t["name"]]):
+        name = t["name"]
+        r = results[name]
+        shown = "%d" % prio[name]
+        if requested and requested.get(name) != prio[name]:
+            shown = "%d->%d" % (requested[name], prio[name])
+        if t.get("background"):
+            state = "fondo"
+        elif r is None or r > t["deadline_ms"]:
+            state = "PIERDE PLAZO"
+            misses += 1
+        else:
+            state = "ok"
+        print("%-14s %5s %8.2f %8.3f %8.2f %9s  %s" % (
+            name, shown, t["period_ms"], t["wcet_ms"], t["deadline_ms"],
+            "inf" if r is None else "%.3f" % r, state))
+    return misses
+
+
+def print_chains(chains, results):
+    over = 0
+    for chain in chains:
+        parts = [results.get(n) for n in chain["tasks"]]
+        if any(p is None for p in parts):
+            total = None
+        else:
+            total = chain.get("fixed_ms", 0) + sum(parts)
+        ok = total is not None and total <= chain["budget_ms"]
+        over += not ok
+        print("Cadena '%s' (%s): %s ms de %s ms presupuestados - %s" % (
+            chain["name"], " -> ".join(chain["tasks"]),
+            "inf" if total is None else "%.2f" % total, chain["budget_ms"],
+            "ok" if ok else "EXCEDE EL PRESUPUESTO"))
+    return over
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[1])
+    parser.add_argument("--tasks", default=os.path.join(HERE, "sched_tasks.json"))
+    parser.add_argument("--src", default=os.path.dirname(HERE),
+                        help="directorio con main_rtos.c y FreeRTOSConfig.h")
+    parser.add_argument("--trace", help="salida de 'trace dump' para medir el WCET")
+    parser.add_argument("--stats", help="salida de 'stats json' (tiempo medio por activación)")
+    args = parser.parse_args()
+
+    with open(args.tasks, encoding="utf-8") as f:
+        spec = json.load(f)
+    source_prio, max_prio = read_source_priorities(args.src)
+    if max_prio is None:
+        sys.exit("No se encontró configMAX_PRIORITIES en FreeRTOSConfig.h")
+
+    tasks, isrs = spec["tasks"], spec.get("isrs", [])
+    blocking = spec.get("blocking_ms", 0)
+    for t in tasks:
+        t.setdefault("deadline_ms", t["period_ms"])
+        t["source"] = "estimado"
+
+    measured = {}
+    if args.stats:
+        measured.update(measured_from_stats(args.stats))
+    if args.trace:
+        measured.update(measured_from_trace(args.trace))
+    for item in tasks + isrs:
+        m = measured.get(item["name"])
+        if m is not None and m > item["wcet_ms"]:
+            item["wcet_ms"] = m
+            item["source"] = "medido"
+
+    warnings = 0
+    requested, effective = {}, {}
+    for t in tasks:
+        name = t["name"]
+        p = t.get("priority", source_prio.get(name))
+        if p is None:
+            sys.exit("La tarea %s no aparece en main_rtos.c ni tiene 'priority'" % name)
+        requested[name] = p
+        effective[name] = min(p, max_prio - 1)
+        if p >= max_prio:
+            print("AVISO: %s usa prioridad %d pero configMAX_PRIORITIES es %d; "
+                  "el kernel la recorta a %d" % (name, p, max_prio, max_prio - 1))
+            warnings += 1
+        elif p == 0:
+            print("AVISO: %s comparte la prioridad de la tarea idle" % name)
+            warnings += 1
+    for name in source_prio:
+        if name not in requested:
+            print("AVISO: la tarea %s de main_rtos.c no está en %s" % (name, args.tasks))
+
+    util = sum(x["wcet_ms"] / x["period_ms"] for x in tasks + isrs)
+    print("Utilización total: %.1f%% (ISR incluidas)" % (util * 100))
+    meas = sorted(x["name"] for x in tasks if x["source"] == "medido")
+    if meas:
+        print("WCET medido para: %s" % ", ".join(meas))
+
+    results = analyse(tasks, isrs, effective, blocking)
+    misses = print_table("Prioridades actuales (main_rtos.c)", tasks, effective, results, requested)
+    misses += print_chains(spec.get("chains", []), results)
+
+    flash = spec.get("flash")
+    if flash:
+        errors, irq_off = check_flash(tasks, flash, args.src)
+        misses += errors
+        if irq_off > 0:
+            # Informativo: un borrado demora a todos, incluidas las ISR
+            flash_results = analyse(tasks, isrs, effective, max(blocking, irq_off))
+            print_table("Con una escritura de flash en curso (bloqueo de %.0f ms, informativo)" % irq_off,
+                        tasks, effective, flash_results, requested)
+            print_chains(spec.get("chains", []), flash_results)
+            print("Nota: por eso las escrituras se postergan hasta que el teclado queda inactivo")
+
+    rm, crowded = rate_monotonic(tasks, max_prio - 1)
+    rm_results = analyse(tasks, isrs, rm, blocking)
+    rm_misses = print_table("Sugerencia monotónica en tasa (niveles 1..%d)" % (max_prio - 1),
+                            tasks, rm, rm_results)
+    rm_misses += print_chains(spec.get("chains", []), rm_results)
+    if crowded:
+        print("Nota: hay más períodos distintos que niveles; las tareas de menor tasa comparten nivel")
+
+    if rm_misses == 0 and misses > 0:
+        print("\nLa asignación sugerida cumple todos los plazos y presupuestos.")
+    sys.exit(1 if misses or warnings else 0)
+
+
+if __name__ == "__main__":
+    main()
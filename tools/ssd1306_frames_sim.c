@@ -0,0 +1,194 @@
+/**
+ * @file ssd1306_frames_sim.c
+ * @brief Verificación en el host de los cuadros pre-renderizados del display
+ * @author Sistema de Control de Acceso
+ * @date 2025
+ *
+ * Las pantallas estáticas se muestran copiando ssd1306_frames.h, generado
+ * por tools/gen_ssd1306_frames.py con su propia réplica de write_string().
+ * Este programa incluye ssd1306_display.c tal como está en el árbol y, para
+ * cada pantalla, compara byte a byte:
+ * - el cuadro generado contra el buffer que arma write_string() del driver
+ *   con los textos y posiciones que usaba ssd1306_show_message() antes de
+ *   los cuadros pre-renderizados;
+ * - los 512 bytes que ssd1306_show_message() envía por I2C contra ese mismo
+ *   buffer (en standby, con la fecha y hora escritas encima).
+ *
+ * Una diferencia indica que la fuente, el mapa de caracteres o el
+ * generador se apartaron del driver. Informa la primera columna y página
+ * distintas de cada pantalla.
+ *
+ * Compilar y ejecutar desde la raíz del proyecto:
+ *
+ *     python3 tools/gen_ssd1306_frames.py ssd1306_font.h /tmp/ssd1306_frames.h
+ *     cc -std=c11 -O2 -Itools/replay/shim -I. -I/tmp tools/ssd1306_frames_sim.c \
+ *        coop.c -o ssd1306_frames_sim
+ *     ./ssd1306_frames_sim
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+// El driver completo, para llegar a write_string() y display_buffer
+#include "ssd1306_display.c"
+
+#define SIM_MAX_LINES       3
+
+/** @brief Fecha y hora que devuelve el servicio de tiempo simulado */
+#define SIM_DATE            "19/10/26"
+#define SIM_TIME            "12:34:56"
+
+/**
+ * @brief Texto de una pantalla estática, con la semántica de write_string()
+ */
+typedef struct {
+    int16_t x;
+    int16_t y;
+    const char *text;
+} sim_line_t;
+
+/**
+ * @brief Pantallas como las dibujaba ssd1306_show_message() carácter por carácter
+ */
+static const struct {
+    display_message_type_t type;
+    const char *name;
+    sim_line_t lines[SIM_MAX_LINES];
+} screens[] = {
+    { DISPLAY_MSG_STANDBY, "STANDBY", { { 20, 0, "SISTEMA LISTO" } } },
+    { DISPLAY_MSG_ENTER_ID, "ENTER_ID", { { 20, 8, "INGRESE SU ID" } } },
+    { DISPLAY_MSG_ENTER_PASSWORD, "ENTER_PASSWORD",
+      { { 8, 4, "INGRESE SU" }, { 20, 16, "CONTRASENA" } } },
+    { DISPLAY_MSG_WELCOME, "WELCOME", { { 30, 8, "BIENVENIDO" } } },
+    { DISPLAY_MSG_INVALID, "INVALID",
+      { { 8, 0, "USUARIO O" }, { 8, 8, "CONTRASENA" }, { 20, 16, "INVALIDOS" } } },
+    { DISPLAY_MSG_CHANGE_USER, "CHANGE_USER",
+      { { 16, 0, "CAMBIAR USUARIO" }, { 8, 16, "NUEVA CONTRASENA" } } },
+};
+
+#define NUM_SCREENS (sizeof(screens) / sizeof(screens[0]))
+
+/** @brief Último bloque de datos de cuadro completo enviado por I2C */
+static uint8_t sent_frame[SSD1306_BUF_LEN];
+static bool frame_sent;
+
+/* ---- Dependencias de ssd1306_display.c --------------------------------- */
+
+int i2c_bus_client(const char *name) {
+    (void)name;
+    return 0;
+}
+
+iq_result_t i2c_bus_transfer(iq_txn_t *txn) {
+    // Byte de control 0x40 seguido del buffer: datos de cuadro
+    if (txn->seg_count == 2 && txn->seg[0].len == 1 && txn->seg[0].data[0] == 0x40 &&
+        txn->seg[1].len == SSD1306_BUF_LEN) {
+        memcpy(sent_frame, txn->seg[1].data, SSD1306_BUF_LEN);
+        frame_sent = true;
+    }
+    return IQ_OK;
+}
+
+TickType_t xTaskGetTickCount(void) { return 0; }
+int executor_add(co_t *co, const char *name, co_fn fn) { return 0; }
+int executor_subscribe(int id, const char *name, uint32_t topics, uint8_t flags) { return 0; }
+eb_msg_t *bus_alloc(bus_topic_t topic) { return NULL; }
+bool bus_publish(eb_msg_t *msg) { return false; }
+const eb_msg_t *bus_poll(int sub) { return NULL; }
+void bus_release(const eb_msg_t *msg) { (void)msg; }
+void bus_get_topic_stats(bus_topic_t topic, eb_topic_stats_t *stats) { memset(stats, 0, sizeof(*stats)); }
+uint32_t time_service_update(void) { return 0; }
+const char *time_service_date_str(void) { return SIM_DATE; }
+const char *time_service_time_str(void) { return SIM_TIME; }
+void task_health_start(health_task_id_t id) { (void)id; }
+void task_health_heartbeat(health_task_id_t id) { (void)id; }
+void task_health_idle(health_task_id_t id) { (void)id; }
+void task_health_begin(health_task_id_t id) { (void)id; }
+void task_health_end(health_task_id_t id) { (void)id; }
+void boot_mark(boot_phase_t phase) { (void)phase; }
+
+/* ---- Verificación ------------------------------------------------------ */
+
+/**
+ * @brief Compara dos cuadros e informa la primera diferencia
+ *
+ * @return Cantidad de bytes distintos
+ */
+static int compare(const char *screen, const char *what, const uint8_t *got, const uint8_t *expected) {
+    int diffs = 0;
+    int first = -1;
+
+    for (int i = 0; i < SSD1306_BUF_LEN; i++) {
+        if (got[i] != expected[i]) {
+            if (first < 0) {
+                first = i;
+            }
+            diffs++;
+        }
+    }
+    if (diffs > 0) {
+        printf("ERROR: %s, %s: %d bytes distintos, el primero en página %d columna %d "
+               "(0x%02x en lugar de 0x%02x)\n", screen, what, diffs,
+               first / SSD1306_WIDTH, first % SSD1306_WIDTH, got[first], expected[first]);
+    }
+    return diffs;
+}
+
+int main(int argc, char **argv) {
+    static uint8_t reference[SSD1306_BUF_LEN];
+    bool ok = true;
+
+    if (argc != 1) {
+        fprintf(stderr, "uso: %s\n", argv[0]);
+        return 1;
+    }
+
+    printf("%-15s %6s %8s %8s %8s\n", "Pantalla", "Chars", "Bytes!=0", "Cuadro", "I2C");
+    for (size_t s = 0; s < NUM_SCREENS; s++) {
+        int chars = 0;
+
+        // Referencia: el buffer que arma write_string() del driver
+        memset(display_buffer, 0, SSD1306_BUF_LEN);
+        for (int l = 0; l < SIM_MAX_LINES && screens[s].lines[l].text; l++) {
+            const sim_line_t *line = &screens[s].lines[l];
+            write_string(line->x, line->y, line->text);
+            chars += (int)strlen(line->text);
+        }
+        memcpy(reference, display_buffer, SSD1306_BUF_LEN);
+
+        int nonzero = 0;
+        for (int i = 0; i < SSD1306_BUF_LEN; i++) {
+            nonzero += (reference[i] != 0);
+        }
+
+        int frame_diffs = compare(screens[s].name, "cuadro pre-renderizado",
+                                  ssd1306_frames[screens[s].type], reference);
+
+        // Lo que llega al display, con la fecha y hora encima del fondo
+        if (screens[s].type == DISPLAY_MSG_STANDBY) {
+            write_string(32, 12, SIM_DATE);
+            write_string(32, 24, SIM_TIME);
+            memcpy(reference, display_buffer, SSD1306_BUF_LEN);
+        }
+        memset(display_buffer, 0xAA, SSD1306_BUF_LEN);
+        frame_sent = false;
+        ssd1306_show_message(screens[s].type, NULL);
+        int sent_diffs = frame_sent ? compare(screens[s].name, "datos enviados", sent_frame, reference) : -1;
+        if (!frame_sent) {
+            printf("ERROR: %s no envió un cuadro completo\n", screens[s].name);
+        }
+
+        printf("%-15s %6d %8d %8s %8s\n", screens[s].name, chars, nonzero,
+               frame_diffs == 0 ? "igual" : "DISTINTO", sent_diffs == 0 ? "igual" : "DISTINTO");
+        if (frame_diffs != 0 || sent_diffs != 0) {
+            ok = false;
+        }
+    }
+
+    printf("\n%s\n", ok ? "Verificación de los cuadros pre-renderizados: OK"
+                        : "ERROR: los cuadros pre-renderizados no coinciden con write_string()");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,538 @@
+/**
+ * @file ssd1306_marquee_sim.c
+ * @brief Verificación en el host de la marquesina del display SSD1306
+ * @author Sistema de Control de Acceso
+ * @date 2025
+ *
+ * Enlaza el mismo ssd1306_display.c del firmware con un i2c_bus_transfer
+ * falso que entrega cada transacción a un modelo del controlador: ventana
+ * de columnas y páginas, escritura horizontal en la memoria gráfica y
+ * desplazamiento horizontal por hardware (0x26/0x27, 0x2E/0x2F) que rota
+ * la memoria de las páginas elegidas una columna cada N cuadros, como el
+ * SSD1306 real. El oscilador del modelo no está sincronizado con el tick y
+ * se prueba con la frecuencia nominal y con ±10 %.
+ *
+ * Se muestra un mensaje largo y se llama a ssd1306_update_marquee cada
+ * DISPLAY_MARQUEE_REFILL_MS (más la latencia de despertar de la tarea).
+ * Después de cada paso del controlador y de cada transacción se decodifica
+ * la columna del mensaje visible en el centro de la línea y se verifica:
+ *
+ * - los bytes exactos del comando de desplazamiento;
+ * - que el texto del centro nunca muestre columnas ajenas al mensaje;
+ * - que avance de a una columna por paso, midiendo los saltos en cada
+ *   recarga (la diferencia entre lo que rotó el controlador y
+ *   DISPLAY_MARQUEE_REFILL_PX);
+ * - que no se escriba la memoria de una página mientras se desplaza y que
+ *   un mensaje nuevo detenga el desplazamiento.
+ *
+ * Al final compara los bytes por segundo en el bus con los de desplazar
+ * el texto por software (un cuadro completo por paso).
+ *
+ * Compilar y ejecutar desde la raíz del proyecto:
+ *
+ *     python3 tools/gen_ssd1306_frames.py ssd1306_font.h /tmp/ssd1306_frames.h
+ *     cc -std=c11 -O2 -Itools/replay/shim -I. -I/tmp \
+ *        tools/ssd1306_marquee_sim.c ssd1306_display.c coop.c -o ssd1306_marquee_sim
+ *     ./ssd1306_marquee_sim [-d segundos] [-s semilla] [mensaje]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "board.h"
+#include "ssd1306_display.h"
+#include "ssd1306_font.h"
+#include "system_bus.h"
+#include "time_service.h"
+#include "task_health.h"
+#include "boot_profile.h"
+#include "i2c_bus.h"
+#include "executor.h"
+#include "task.h"
+
+#define OLED_WIDTH                  128
+#define OLED_PAGES                  4
+#define OLED_TEXT_PAGE              1
+
+/** @brief Frecuencia de cuadro nominal del controlador (ver ssd1306_display.c) */
+#define SIM_FRAME_HZ                175
+
+/**
+ * @brief Columnas del centro de la línea que siempre deben mostrar el mensaje
+ *
+ * Entre recargas el margen en blanco recorre los bordes; con el oscilador
+ * rápido el controlador rota unas columnas de más y el margen entra otro
+ * tanto por la derecha.
+ */
+#define SIM_CHECK_MARGIN            8
+#define SIM_CHECK_FIRST             (DISPLAY_MARQUEE_REFILL_PX + SIM_CHECK_MARGIN)
+#define SIM_CHECK_LAST              (OLED_WIDTH - DISPLAY_MARQUEE_REFILL_PX - SIM_CHECK_MARGIN)
+
+#define SIM_DEFAULT_SECONDS         60
+#define SIM_DEFAULT_MESSAGE         "Usuario bloqueado por 5 minutos"
+
+/** @brief Separación entre vueltas del mensaje (SSD1306_MARQUEE_GAP) */
+#define SIM_GAP_CHARS               3
+
+/** @brief Saltos registrados: -SIM_JUMP_RANGE .. +SIM_JUMP_RANGE columnas */
+#define SIM_JUMP_RANGE              3
+
+/** @brief Cuadros entre pasos para cada código de intervalo del SSD1306 */
+static const uint16_t interval_frames[8] = { 5, 64, 128, 256, 3, 4, 25, 2 };
+
+/* ---- Modelo del SSD1306 ------------------------------------------------ */
+
+static struct {
+    uint8_t ram[OLED_PAGES * OLED_WIDTH];
+    uint8_t col_start, col_end, page_start, page_end;
+    uint8_t col, page;
+    bool scroll_set;            /**< Hubo un 0x26/0x27 válido */
+    bool left;
+    uint8_t scroll_start, scroll_end;
+    uint16_t scroll_frames;
+    bool scrolling;
+    uint64_t next_step_us;
+    uint32_t steps;
+    uint32_t protocol_errors;
+} oled;
+
+static uint64_t now_us;
+static uint64_t frame_us_x1000;     /**< Período de cuadro en ns */
+static uint32_t rng_state;
+
+/* ---- Seguimiento del texto --------------------------------------------- */
+
+static uint8_t stream[(32 + SIM_GAP_CHARS) * 8];
+static uint16_t stream_len;
+static bool tracking;
+static bool have_offset;
+static uint16_t last_offset;
+static uint64_t advanced_px;
+static uint32_t samples;
+static uint32_t garbage;
+static uint32_t jumps[2 * SIM_JUMP_RANGE + 1];
+static uint32_t jumps_other;
+
+/* ---- Bus --------------------------------------------------------------- */
+
+static uint64_t bus_bytes;
+static uint32_t bus_transfers;
+static uint8_t scroll_cmd[16];
+static uint8_t scroll_cmd_len;
+
+/**
+ * @brief Generador xorshift32 (determinista para una semilla)
+ */
+static uint32_t rng_next(void) {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return rng_state;
+}
+
+/**
+ * @brief Columna del mensaje que se ve en el centro de la línea
+ *
+ * @return false si el centro no coincide con ninguna posición del mensaje
+ */
+static bool decode_offset(uint16_t *offset) {
+    const uint8_t *line = &oled.ram[OLED_TEXT_PAGE * OLED_WIDTH];
+
+    for (uint16_t off = 0; off < stream_len; off++) {
+        int x = SIM_CHECK_FIRST;
+        while (x < SIM_CHECK_LAST && line[x] == stream[(off + x) % stream_len]) {
+            x++;
+        }
+        if (x == SIM_CHECK_LAST) {
+            *offset = off;
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Registra el avance del texto desde la muestra anterior
+ */
+static void sample(void) {
+    uint16_t off;
+
+    if (!tracking) {
+        return;
+    }
+    samples++;
+    if (!decode_offset(&off)) {
+        garbage++;
+        have_offset = false;
+        return;
+    }
+    if (have_offset) {
+        int delta = (int)off - (int)last_offset;
+        if (delta > stream_len / 2) {
+            delta -= stream_len;
+        } else if (delta <= -(int)stream_len / 2) {
+            delta += stream_len;
+        }
+        if (delta >= -SIM_JUMP_RANGE && delta <= SIM_JUMP_RANGE) {
+            jumps[delta + SIM_JUMP_RANGE]++;
+        } else {
+            jumps_other++;
+        }
+        advanced_px += (uint64_t)(delta > 0 ? delta : 0);
+    }
+    last_offset = off;
+    have_offset = true;
+}
+
+/**
+ * @brief Un paso de desplazamiento: rota las páginas una columna
+ */
+static void oled_step(void) {
+    for (uint8_t p = oled.scroll_start; p <= oled.scroll_end; p++) {
+        uint8_t *row = &oled.ram[p * OLED_WIDTH];
+        if (oled.left) {
+            uint8_t first = row[0];
+            memmove(row, row + 1, OLED_WIDTH - 1);
+            row[OLED_WIDTH - 1] = first;
+        } else {
+            uint8_t last = row[OLED_WIDTH - 1];
+            memmove(row + 1, row, OLED_WIDTH - 1);
+            row[0] = last;
+        }
+    }
+    oled.steps++;
+}
+
+/**
+ * @brief Avanza el reloj ejecutando los pasos del controlador hasta t_us
+ */
+static void advance(uint64_t t_us) {
+    while (oled.scrolling && oled.next_step_us <= t_us) {
+        now_us = oled.next_step_us;
+        oled_step();
+        sample();
+        oled.next_step_us += oled.scroll_frames * frame_us_x1000 / 1000;
+    }
+    now_us = t_us;
+}
+
+/**
+ * @brief Argumentos de cada comando del SSD1306
+ */
+static uint8_t cmd_args(uint8_t cmd) {
+    switch (cmd) {
+        case 0x20: case 0x81: case 0x8D: case 0xA8: case 0xD3:
+        case 0xD5: case 0xD9: case 0xDA: case 0xDB:
+            return 1;
+        case 0x21: case 0x22:
+            return 2;
+        case 0x26: case 0x27:
+            return 6;
+        default:
+            return 0;
+    }
+}
+
+/**
+ * @brief Ejecuta un comando con sus argumentos
+ */
+static void oled_command(const uint8_t *c) {
+    switch (c[0]) {
+        case 0x21:
+            oled.col_start = oled.col = c[1] % OLED_WIDTH;
+            oled.col_end = c[2] % OLED_WIDTH;
+            break;
+        case 0x22:
+            oled.page_start = oled.page = c[1] % OLED_PAGES;
+            oled.page_end = c[2] % OLED_PAGES;
+            break;
+        case 0x26:
+        case 0x27:
+            // Configurar con el desplazamiento activo no está permitido
+            if (oled.scrolling || c[1] != 0x00 || c[2] > c[4] || c[4] >= OLED_PAGES ||
+                c[5] != 0x00 || c[6] != 0xFF) {
+                oled.protocol_errors++;
+                break;
+            }
+            oled.left = (c[0] == 0x27);
+            oled.scroll_start = c[2];
+            oled.scroll_end = c[4];
+            oled.scroll_frames = interval_frames[c[3] & 0x07];
+            oled.scroll_set = true;
+            break;
+        case 0x2E:
+            oled.scrolling = false;
+            break;
+        case 0x2F:
+            if (!oled.scroll_set) {
+                oled.protocol_errors++;
+                break;
+            }
+            // El primer paso cae en un límite de cuadro que no depende del llamador
+            oled.scrolling = true;
+            oled.next_step_us = now_us + (oled.scroll_frames - 1) * frame_us_x1000 / 1000 +
+                                rng_next() % (frame_us_x1000 / 1000);
+            tracking = true;
+            break;
+        default:
+            break;
+    }
+}
+
+/**
+ * @brief Comandos (control 0x00) y datos (control 0x40) para el SSD1306
+ */
+static void oled_write(const uint8_t *buf, uint32_t len) {
+    if (len == 0) {
+        return;
+    }
+
+    if (buf[0] == 0x40) {
+        for (uint32_t i = 1; i < len; i++) {
+            // Escribir una página que se desplaza queda indefinido
+            if (oled.scrolling && oled.page >= oled.scroll_start && oled.page <= oled.scroll_end) {
+                oled.protocol_errors++;
+            }
+            oled.ram[oled.page * OLED_WIDTH + oled.col] = buf[i];
+            if (++oled.col > oled.col_end) {
+                oled.col = oled.col_start;
+                if (++oled.page > oled.page_end) {
+                    oled.page = oled.page_start;
+                }
+            }
+        }
+        return;
+    }
+
+    for (uint32_t i = 1; i < len; ) {
+        uint8_t n = cmd_args(buf[i]);
+        if (i + n >= len) {
+            oled.protocol_errors++;
+            return;
+        }
+        if ((buf[i] == 0x26 || buf[i] == 0x27) && scroll_cmd_len == 0 && len <= sizeof(scroll_cmd)) {
+            memcpy(scroll_cmd, buf, len);
+            scroll_cmd_len = (uint8_t)len;
+        }
+        oled_command(&buf[i]);
+        i += 1u + n;
+    }
+}
+
+/* ---- Dependencias de ssd1306_display.c --------------------------------- */
+
+int i2c_bus_client(const char *name) {
+    (void)name;
+    return 0;
+}
+
+/**
+ * @brief Transferencia al modelo: el bus está ocupado (START, dirección,
+ * 9 ciclos por byte y STOP) y los datos llegan al terminar
+ */
+iq_result_t i2c_bus_transfer(iq_txn_t *txn) {
+    static uint8_t buf[1024];
+    uint32_t len = 0;
+
+    for (uint8_t s = 0; s < txn->seg_count; s++) {
+        memcpy(&buf[len], txn->seg[s].data, txn->seg[s].len);
+        len += txn->seg[s].len;
+    }
+
+    uint32_t bits = 1 + 9 + 9 * len + 1;
+    advance(now_us + (bits * 1000u + BOARD_I2C_KHZ - 1) / BOARD_I2C_KHZ);
+    oled_write(buf, len);
+    bus_bytes += 1 + len;
+    bus_transfers++;
+    sample();
+    return IQ_OK;
+}
+
+TickType_t xTaskGetTickCount(void) {
+    return (TickType_t)(now_us / 1000);
+}
+
+int executor_add(co_t *co, const char *name, co_fn fn) {
+    (void)co; (void)name; (void)fn;
+    return 0;
+}
+
+int executor_subscribe(int id, const char *name, uint32_t topics, uint8_t flags) {
+    (void)id; (void)name; (void)topics; (void)flags;
+    return 0;
+}
+
+eb_msg_t *bus_alloc(bus_topic_t topic) {
+    (void)topic;
+    return NULL;
+}
+
+bool bus_publish(eb_msg_t *msg) {
+    (void)msg;
+    return false;
+}
+
+const eb_msg_t *bus_poll(int sub) {
+    (void)sub;
+    return NULL;
+}
+
+void bus_release(const eb_msg_t *msg) {
+    (void)msg;
+}
+
+void bus_get_topic_stats(bus_topic_t topic, eb_topic_stats_t *stats) {
+    (void)topic;
+    memset(stats, 0, sizeof(*stats));
+}
+
+uint32_t time_service_update(void) { return 0; }
+const char *time_service_date_str(void) { return "01/01/25"; }
+const char *time_service_time_str(void) { return "00:00:00"; }
+void task_health_start(health_task_id_t id) { (void)id; }
+void task_health_heartbeat(health_task_id_t id) { (void)id; }
+void task_health_idle(health_task_id_t id) { (void)id; }
+void task_health_begin(health_task_id_t id) { (void)id; }
+void task_health_end(health_task_id_t id) { (void)id; }
+void boot_mark(boot_phase_t phase) { (void)phase; }
+
+/* ---- Simulación -------------------------------------------------------- */
+
+/**
+ * @brief Columnas del mensaje más la separación, con la misma fuente
+ */
+static void build_stream(const char *message) {
+    size_t len = strlen(message);
+
+    stream_len = (uint16_t)((len + SIM_GAP_CHARS) * 8);
+    for (uint16_t px = 0; px < stream_len; px++) {
+        uint8_t c = (px / 8 < len) ? (uint8_t)message[px / 8] : ' ';
+        int idx = (c < sizeof(font_index)) ? font_index[c] : 0;
+        stream[px] = font[idx * 8 + px % 8];
+    }
+}
+
+/**
+ * @brief Muestra el mensaje y recarga la marquesina durante seconds
+ *
+ * @param ppm Desvío del oscilador del controlador en partes por millón
+ * @return true si la verificación pasó
+ */
+static bool simulate(const char *message, int32_t ppm, uint32_t seconds, uint32_t seed) {
+    memset(&oled, 0, sizeof(oled));
+    memset(jumps, 0, sizeof(jumps));
+    jumps_other = garbage = samples = 0;
+    advanced_px = 0;
+    tracking = have_offset = false;
+    bus_bytes = 0;
+    bus_transfers = 0;
+    now_us = 0;
+    rng_state = seed;
+    frame_us_x1000 = (uint64_t)(1000000000.0 / (SIM_FRAME_HZ * (1.0 + ppm / 1e6)));
+
+    ssd1306_show_message(DISPLAY_MSG_CUSTOM, message);
+    uint64_t start_us = now_us;
+    uint32_t start_steps = oled.steps;
+    uint64_t end_us = (uint64_t)seconds * 1000000u;
+
+    while (now_us < end_us) {
+        // La tarea despierta en un tick, con hasta 1 ms de latencia
+        advance(now_us + DISPLAY_MARQUEE_REFILL_MS * 1000u + rng_next() % 1000u);
+        if (!ssd1306_update_marquee()) {
+            printf("  ERROR: la marquesina no está activa\n");
+            return false;
+        }
+    }
+
+    uint64_t elapsed_us = now_us - start_us;
+    uint64_t marquee_bytes = bus_bytes;
+    uint32_t steps = oled.steps - start_steps;
+
+    // Un mensaje nuevo debe detener el desplazamiento
+    tracking = false;
+    ssd1306_show_message(DISPLAY_MSG_STANDBY, NULL);
+    bool stopped = !oled.scrolling && !ssd1306_update_marquee();
+
+    double secs = (double)elapsed_us / 1e6;
+    printf("\nOscilador %+.1f %%: %.1f cuadros/s, paso cada %u cuadros\n",
+           ppm / 1e4, 1e9 / (double)frame_us_x1000, oled.scroll_frames);
+    printf("  %lu pasos del controlador (%.1f col/s), texto avanzó %.1f col/s\n",
+           (unsigned long)steps, steps / secs, (double)advanced_px / secs);
+    printf("  bus: %.0f B/s en %.1f transferencias/s (%.2f %% de %d kHz)\n",
+           marquee_bytes / secs, bus_transfers / secs,
+           100.0 * (marquee_bytes * 9.0 / secs) / (BOARD_I2C_KHZ * 1000.0), BOARD_I2C_KHZ);
+    printf("  saltos entre muestras (columnas):");
+    for (int d = -SIM_JUMP_RANGE; d <= SIM_JUMP_RANGE; d++) {
+        printf(" %+d:%lu", d, (unsigned long)jumps[d + SIM_JUMP_RANGE]);
+    }
+    printf(" otros:%lu\n", (unsigned long)jumps_other);
+    printf("  %lu muestras, %lu con el centro ilegible, %lu errores de protocolo, %s\n",
+           (unsigned long)samples, (unsigned long)garbage, (unsigned long)oled.protocol_errors,
+           stopped ? "detenida al cambiar de mensaje" : "ERROR: sigue desplazándose");
+
+    // Tolerancia: un salto de ±2 columnas por recarga con ±10 % de oscilador
+    return garbage == 0 && oled.protocol_errors == 0 && jumps_other == 0 &&
+           jumps[0] == 0 && jumps[2 * SIM_JUMP_RANGE] == 0 && stopped;
+}
+
+int main(int argc, char **argv) {
+    uint32_t seconds = SIM_DEFAULT_SECONDS;
+    uint32_t seed = 1;
+    const char *message = SIM_DEFAULT_MESSAGE;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-d") == 0 && i + 1 < argc) {
+            seconds = (uint32_t)strtoul(argv[++i], NULL, 0);
+        } else if (strcmp(argv[i], "-s") == 0 && i + 1 < argc) {
+            seed = (uint32_t)strtoul(argv[++i], NULL, 0);
+        } else if (argv[i][0] != '-') {
+            message = argv[i];
+        } else {
+            fprintf(stderr, "Uso: %s [-d segundos] [-s semilla] [mensaje]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (strlen(message) <= (OLED_WIDTH - 8) / 8 || strlen(message) > 31) {
+        fprintf(stderr, "El mensaje debe tener entre %d y 31 caracteres\n", (OLED_WIDTH - 8) / 8 + 1);
+        return 2;
+    }
+    if (seed == 0) {
+        seed = 1;
+    }
+
+    ssd1306_init();
+    build_stream(message);
+
+    printf("Marquesina \"%s\" durante %lu s, recarga cada %d ms (%d columnas)\n",
+           message, (unsigned long)seconds, DISPLAY_MARQUEE_REFILL_MS, DISPLAY_MARQUEE_REFILL_PX);
+
+    bool ok = true;
+    static const int32_t ppm[] = { 0, -100000, 100000 };
+    for (size_t i = 0; i < sizeof(ppm) / sizeof(ppm[0]); i++) {
+        ok = simulate(message, ppm[i], seconds, seed) && ok;
+    }
+
+    printf("\nComando de desplazamiento:");
+    for (uint8_t i = 0; i < scroll_cmd_len; i++) {
+        printf(" %02X", scroll_cmd[i]);
+    }
+    static const uint8_t expected[] = { 0x00, 0x27, 0x00, OLED_TEXT_PAGE, 0x04, OLED_TEXT_PAGE, 0x00, 0xFF, 0x2F };
+    bool cmd_ok = scroll_cmd_len == sizeof(expected) && memcmp(scroll_cmd, expected, sizeof(expected)) == 0;
+    printf(" (%s)\n", cmd_ok ? "esperado" : "ERROR: distinto del esperado");
+    ok = ok && cmd_ok;
+
+    // Referencia: desplazar por software reenvía un cuadro completo por paso
+    uint64_t before = bus_bytes;
+    ssd1306_show_message(DISPLAY_MSG_CUSTOM, "Puerta abierta");
+    uint64_t frame_bytes = bus_bytes - before;
+    double step_hz = (double)SIM_FRAME_HZ / 3.0;
+    printf("Por software: %lu bytes por paso, %.0f B/s (%.1f %% del bus)\n",
+           (unsigned long)frame_bytes, frame_bytes * step_hz,
+           100.0 * (frame_bytes * step_hz * 9.0) / (BOARD_I2C_KHZ * 1000.0));
+
+    printf("\n%s\n", ok ? "Verificación de la marquesina: OK"
+                        : "ERROR: la marquesina no pasó la verificación");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,486 @@
+#!/usr/bin/env python3
+"""
+Peor caso de uso de pila por tarea de FreeRTOS.
+
+Arma el grafo de llamadas del firmware y calcula, desde la función de
+entrada de cada tarea creada en main_rtos.c (y la tarea Idle), la cadena de
+llamadas que más pila usa. Lo compara con la pila configurada e indica si
+está excedida, ajustada o sobrada, con el tamaño sugerido.
+
+Fuentes del grafo (objetivo stack_report de CMake, opción STACK_USAGE_REPORT):
+
+- Los .ci que genera GCC con -fcallgraph-info=su por cada archivo compilado
+  (firmware, pico-sdk y FreeRTOS): marco de cada función y llamadas
+  directas e indirectas del código fuente. Sin .ci (GCC < 10) se usan los
+  marcos de los .su de -fstack-usage y las llamadas del desensamblado.
+- El desensamblado del ELF (--elf, con el objdump de la toolchain): agrega
+  las llamadas que inserta el compilador (memcpy, __aeabi_*), resuelve los
+  --wrap del SDK (printf -> __wrap_printf) y da el marco de las funciones de
+  bibliotecas precompiladas (newlib, libgcc) a partir del prólogo Thumb
+  (push y sub sp).
+- tools/stack_calls.json (--calls): destinos posibles de las llamadas por
+  puntero a función (tabla de comandos de la consola, callbacks, drivers
+  de stdio). Las llamadas indirectas sin destinos declarados, los marcos
+  dinámicos, la recursión y las funciones sin marco conocido se informan y
+  el resultado de esa tarea pasa a ser una cota inferior (">=").
+
+A cada tarea se le suman STACK_CONTEXT_BYTES: el marco que apila el
+Cortex-M0+ al entrar a una excepción (8 palabras) más r4-r11 que guarda el
+cambio de contexto de FreeRTOS. Las interrupciones corren en la pila
+principal (MSP) y no cuentan.
+
+Uso: stack_usage.py <dir de compilación> [--elf blink_simple.elf --objdump arm-none-eabi-objdump]
+                    [--tasks main_rtos.c] [--config FreeRTOSConfig.h] [--calls stack_calls.json]
+                    [--task Nombre=función:palabras ...] [--margin %] [--path] [--json] [--check]
+"""
+
+import argparse
+import fnmatch
+import json
+import math
+import os
+import re
+import subprocess
+import sys
+from collections import defaultdict
+
+# Excepción (r0-r3, r12, lr, pc, xPSR) + r4-r11 del cambio de contexto
+STACK_CONTEXT_BYTES = 16 * 4
+
+# StackType_t del port RP2040
+STACK_WORD_BYTES = 4
+
+# Las pilas sugeridas se redondean a este múltiplo de palabras
+STACK_ROUND_WORDS = 32
+
+INDIRECT = "__indirect_call"
+
+CI_NODE = re.compile(r'^node: \{ title: "([^"]+)" label: "([^"]*)"(.*)\}\s*$')
+CI_EDGE = re.compile(r'^edge: \{ sourcename: "([^"]+)" targetname: "([^"]+)" label: "([^"]*)"')
+CI_FRAME = re.compile(r"^(\d+) bytes \(([a-z,]+)\)$")
+SU_LINE = re.compile(r"^(.*):\d+:\d+:(\S+)\t(\d+)\t(\S+)$")
+
+OBJ_FUNC = re.compile(r"^([0-9a-f]+) <([^>]+)>:$")
+OBJ_INSN = re.compile(r"^\s*([0-9a-f]+):\s+(\S+)\s*(.*)$")
+OBJ_PUSH = re.compile(r"^\{([^}]*)\}")
+OBJ_SUB_SP = re.compile(r"^sp,\s*(?:sp,\s*)?#(\d+)")
+OBJ_LDR_PC = re.compile(r"^(r\d+),\s*\[pc,\s*#\d+\]\s*[@;]\s*\(([0-9a-f]+)")
+OBJ_TARGET = re.compile(r"^[0-9a-f]+\s+<([^>+]+)>$")
+
+TASK_CREATE = re.compile(r'RTOS_TASK_CREATE\(\s*\w+\s*,\s*(\w+)\s*,\s*"([^"]+)"\s*,\s*(\w+)')
+DEFINE = re.compile(r"^\s*#\s*define\s+(\w+)\s+\(?\s*(\d+)\s*\)?\s*(?:/[*/].*)?$")
+
+
+class Func:
+    """Nodo del grafo de llamadas."""
+
+    def __init__(self, key):
+        self.key = key
+        self.frame = None           # bytes, None si no se conoce
+        self.dynamic = False        # marco que depende de los datos (alloca, VLA)
+        self.defined = False        # hay un marco del compilador o del desensamblado
+        self.callees = set()
+        self.indirect = 0           # llamadas por puntero sin destinos declarados
+        self.source = None          # "ci", "su" o "elf"
+
+
+def plain_name(key):
+    """Nombre de la función sin el archivo de las funciones static."""
+    return key.rsplit(":", 1)[-1]
+
+
+def static_key(path, name):
+    """Clave de una función static: archivo:nombre (sin directorios)."""
+    return "%s:%s" % (os.path.basename(path), name)
+
+
+class Graph:
+    def __init__(self):
+        self.funcs = {}
+
+    def get(self, key):
+        if key not in self.funcs:
+            self.funcs[key] = Func(key)
+        return self.funcs[key]
+
+    def by_plain_name(self):
+        names = defaultdict(list)
+        for key, f in self.funcs.items():
+            if f.defined:
+                names[plain_name(key)].append(key)
+        return names
+
+
+def normalize_ci_title(title):
+    """Los static aparecen como /ruta/archivo.c:nombre."""
+    if ":" in title:
+        path, name = title.rsplit(":", 1)
+        return static_key(path, name)
+    return title
+
+
+def load_ci(graph, path):
+    with open(path, encoding="utf-8", errors="replace") as f:
+        for line in f:
+            m = CI_NODE.match(line)
+            if m:
+                key = normalize_ci_title(m.group(1))
+                if key == INDIRECT or "ellipse" in m.group(3):
+                    continue
+                parts = m.group(2).split("\\n")
+                fm = CI_FRAME.match(parts[-1]) if len(parts) >= 3 else None
+                if fm:
+                    func = graph.get(key)
+                    func.frame = int(fm.group(1))
+                    func.dynamic = "dynamic" in fm.group(2) and "bounded" not in fm.group(2)
+                    func.defined = True
+                    func.source = "ci"
+                continue
+            m = CI_EDGE.match(line)
+            if m:
+                src = graph.get(normalize_ci_title(m.group(1)))
+                dst = normalize_ci_title(m.group(2))
+                if dst == INDIRECT:
+                    src.indirect += 1
+                else:
+                    src.callees.add(dst)
+
+
+def load_su(graph, path):
+    """Marcos de -fstack-usage para las funciones que no tienen .ci."""
+    with open(path, encoding="utf-8", errors="replace") as f:
+        for line in f:
+            m = SU_LINE.match(line.rstrip("\n"))
+            if not m:
+                continue
+            src, name, size, qualifier = m.groups()
+            # .su no distingue static: se registra con el nombre simple salvo
+            # que ya exista la clave del .ci
+            key = static_key(src, name)
+            if key not in graph.funcs or not graph.funcs[key].defined:
+                key = name
+            func = graph.get(key)
+            if func.defined:
+                continue
+            func.frame = int(size)
+            func.dynamic = "dynamic" in qualifier and "bounded" not in qualifier
+            func.defined = True
+            func.source = "su"
+
+
+def scan_build_dir(graph, build_dir):
+    ci_files, su_files = [], []
+    for root, _, files in os.walk(build_dir):
+        for name in files:
+            if name.endswith(".ci"):
+                ci_files.append(os.path.join(root, name))
+            elif name.endswith(".su"):
+                su_files.append(os.path.join(root, name))
+    for path in sorted(ci_files):
+        load_ci(graph, path)
+    for path in sorted(su_files):
+        load_su(graph, path)
+    return len(ci_files), len(su_files)
+
+
+def parse_objdump(lines):
+    """Devuelve {función: [(dirección, mnemónico, operandos)]} y {dirección: palabra}."""
+    funcs = {}
+    words = {}
+    current = None
+    for line in lines:
+        line = line.rstrip("\n")
+        m = OBJ_FUNC.match(line)
+        if m:
+            current = funcs.setdefault(m.group(2), [])
+            continue
+        m = OBJ_INSN.match(line)
+        if m and current is not None:
+            addr = int(m.group(1), 16)
+            mnemonic, operands = m.group(2), m.group(3).strip()
+            if mnemonic == ".word":
+                try:
+                    words[addr] = int(operands.split()[0], 0)
+                except ValueError:
+                    pass
+            else:
+                current.append((addr, mnemonic, operands))
+    return funcs, words
+
+
+def thumb_frame(insns, words):
+    """Marco en bytes a partir del prólogo; None si no se puede determinar."""
+    frame = 0
+    literals = {}
+    for _, mnemonic, operands in insns[:16]:
+        op = mnemonic.split(".")[0]
+        if op == "push":
+            m = OBJ_PUSH.match(operands)
+            if m:
+                frame += 4 * len([r for r in m.group(1).split(",") if r.strip()])
+        elif op == "sub":
+            m = OBJ_SUB_SP.match(operands)
+            if m:
+                frame += int(m.group(1))
+        elif op == "ldr":
+            m = OBJ_LDR_PC.match(operands)
+            if m and int(m.group(2), 16) in words:
+                literals[m.group(1)] = words[int(m.group(2), 16)]
+        elif op == "add" and operands.startswith("sp,"):
+            reg = operands.split(",")[-1].strip()
+            if reg not in literals:
+                return None
+            value = literals[reg]
+            if value & 0x80000000:
+                value -= 1 << 32
+            frame -= value
+        elif op in ("bl", "blx", "bx", "pop"):
+            break
+    return frame
+
+
+def load_elf(graph, elf, objdump):
+    try:
+        out = subprocess.run([objdump, "-d", "--no-show-raw-insn", elf], check=True,
+                             stdout=subprocess.PIPE, universal_newlines=True).stdout
+    except (OSError, subprocess.CalledProcessError) as e:
+        sys.exit("No se pudo desensamblar %s: %s" % (elf, e))
+    funcs, words = parse_objdump(out.splitlines())
+    names = graph.by_plain_name()
+
+    def resolve(name, caller_key):
+        if ":" in caller_key:
+            local = "%s:%s" % (caller_key.rsplit(":", 1)[0], name)
+            if local in graph.funcs and graph.funcs[local].defined:
+                return local
+        if name in graph.funcs and graph.funcs[name].defined:
+            return name
+        if len(names.get(name, [])) == 1:
+            return names[name][0]
+        return name
+
+    for name, insns in funcs.items():
+        candidates = names.get(name, [])
+        if name in graph.funcs and graph.funcs[name].defined:
+            key = name
+        elif len(candidates) == 1:
+            key = candidates[0]
+        elif candidates:
+            continue            # varios static con el mismo nombre: solo el .ci
+        else:
+            key = name
+        func = graph.get(key)
+        from_elf = not func.defined
+        if from_elf:
+            func.frame = thumb_frame(insns, words)
+            func.defined = func.frame is not None
+            func.source = "elf"
+        for _, mnemonic, operands in insns:
+            op = mnemonic.split(".")[0]
+            if op in ("bl", "b") or (op == "blx" and "<" in operands):
+                m = OBJ_TARGET.match(operands)
+                if m and m.group(1) != name:
+                    func.callees.add(resolve(m.group(1), key))
+            elif op == "blx" and from_elf:
+                func.indirect += 1
+            elif op == "mov" and operands.startswith("sp,") and from_elf:
+                func.dynamic = True
+
+    # --wrap del SDK: las llamadas a X van a __wrap_X
+    for func in graph.funcs.values():
+        func.callees = {"__wrap_" + c if "__wrap_" + c in funcs and not c.startswith("__wrap_")
+                        else c for c in func.callees}
+    return len(funcs)
+
+
+def load_calls(graph, path):
+    """Agrega los destinos de las llamadas indirectas declarados en el JSON."""
+    with open(path, encoding="utf-8") as f:
+        table = json.load(f)
+    missing = []
+    keys = [k for k, f in graph.funcs.items() if f.defined]
+    for caller, targets in table.items():
+        if caller.startswith("_"):
+            continue            # comentarios
+        callers = [k for k in keys if fnmatch.fnmatchcase(k, caller)]
+        if not callers:
+            missing.append(caller)
+            continue
+        resolved = []
+        for pattern in targets:
+            found = [k for k in keys if fnmatch.fnmatchcase(k, pattern)]
+            if not found:
+                missing.append(pattern)
+            resolved.extend(found)
+        for key in callers:
+            func = graph.funcs[key]
+            func.callees.update(resolved)
+            func.indirect = 0
+    return missing
+
+
+def worst_case(graph, entry):
+    """(bytes, camino, problemas) del peor caso desde entry."""
+    memo = {}
+    issues = defaultdict(set)
+
+    def visit(key, stack):
+        if key in memo:
+            return memo[key]
+        if key in stack:
+            issues["recursión"].add(" -> ".join(stack[stack.index(key):] + [key]))
+            return 0, []
+        func = graph.funcs.get(key)
+        if func is None or not func.defined:
+            issues["sin marco conocido"].add(key)
+            return 0, [key]
+        if func.dynamic:
+            issues["marco dinámico"].add(key)
+        if func.indirect:
+            issues["llamada indirecta sin destinos"].add(key)
+        stack.append(key)
+        best, best_path = 0, []
+        for callee in sorted(func.callees):
+            depth, path = visit(callee, stack)
+            if depth > best:
+                best, best_path = depth, path
+        stack.pop()
+        result = (func.frame + best, [key] + best_path)
+        memo[key] = result
+        return result
+
+    sys.setrecursionlimit(max(10000, 4 * len(graph.funcs)))
+    depth, path = visit(entry, [])
+    return depth, path, {k: sorted(v) for k, v in issues.items()}
+
+
+def read_defines(path):
+    defines = {}
+    with open(path, encoding="utf-8", errors="replace") as f:
+        for line in f:
+            m = DEFINE.match(line)
+            if m:
+                defines[m.group(1)] = int(m.group(2))
+    return defines
+
+
+def read_tasks(main_c, config_h):
+    """[(nombre, función, palabras)] de las tareas creadas en main_rtos.c."""
+    defines = read_defines(main_c)
+    with open(main_c, encoding="utf-8", errors="replace") as f:
+        source = f.read()
+    tasks = []
+    for entry, name, stack in TASK_CREATE.findall(source):
+        words = int(stack) if stack.isdigit() else defines.get(stack)
+        if words is None:
+            sys.exit("No se encontró el tamaño de pila %s en %s" % (stack, main_c))
+        tasks.append((name, entry, words))
+    if config_h and os.path.exists(config_h):
+        words = read_defines(config_h).get("configMINIMAL_STACK_SIZE")
+        if words:
+            tasks.append(("IDLE", "prvIdleTask", words))
+    return tasks
+
+
+def resolve_entry(graph, entry):
+    if entry in graph.funcs and graph.funcs[entry].defined:
+        return entry
+    candidates = graph.by_plain_name().get(entry, [])
+    return candidates[0] if len(candidates) == 1 else entry
+
+
+def main():
+    here = os.path.dirname(os.path.abspath(__file__))
+    root = os.path.dirname(here)
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[1])
+    parser.add_argument("build_dir", help="directorio con los .ci/.su (p. ej. build/CMakeFiles/blink_simple.dir)")
+    parser.add_argument("--elf", help="ELF del firmware para llamadas del compilador y bibliotecas")
+    parser.add_argument("--objdump", default="arm-none-eabi-objdump")
+    parser.add_argument("--tasks", default=os.path.join(root, "main_rtos.c"),
+                        help="archivo con los RTOS_TASK_CREATE")
+    parser.add_argument("--config", default=os.path.join(root, "FreeRTOSConfig.h"),
+                        help="FreeRTOSConfig.h (pila de la tarea Idle)")
+    parser.add_argument("--calls", default=os.path.join(here, "stack_calls.json"),
+                        help="destinos de las llamadas por puntero")
+    parser.add_argument("--task", action="append", default=[], metavar="NOMBRE=FUNCIÓN:PALABRAS",
+                        help="analiza solo estas tareas en lugar de las de --tasks")
+    parser.add_argument("--margin", type=float, default=25.0,
+                        help="margen sobre el peor caso para la pila sugerida (%%)")
+    parser.add_argument("--path", action="store_true", help="muestra la cadena del peor caso")
+    parser.add_argument("--json", action="store_true", help="una línea JSON")
+    parser.add_argument("--check", action="store_true", help="falla si alguna pila está excedida")
+    args = parser.parse_args()
+
+    graph = Graph()
+    ci_count, su_count = scan_build_dir(graph, args.build_dir)
+    if ci_count + su_count == 0:
+        sys.exit("No hay .ci ni .su en %s (¿compilado con STACK_USAGE_REPORT=ON?)" % args.build_dir)
+    elf_count = load_elf(graph, args.elf, args.objdump) if args.elf else 0
+    missing = load_calls(graph, args.calls) if args.calls and os.path.exists(args.calls) else []
+
+    if args.task:
+        tasks = []
+        for spec in args.task:
+            name, _, rest = spec.partition("=")
+            entry, _, words = rest.partition(":")
+            tasks.append((name, entry, int(words, 0)))
+    else:
+        tasks = read_tasks(args.tasks, args.config)
+
+    results = []
+    for name, entry, words in tasks:
+        key = resolve_entry(graph, entry)
+        depth, path, issues = worst_case(graph, key)
+        need = depth + STACK_CONTEXT_BYTES
+        suggested = math.ceil(need * (1 + args.margin / 100.0) / STACK_WORD_BYTES)
+        suggested = STACK_ROUND_WORDS * math.ceil(suggested / STACK_ROUND_WORDS)
+        configured = words * STACK_WORD_BYTES
+        if need > configured:
+            status = "EXCEDIDA"
+        elif suggested < words:
+            status = "sobrada"
+        else:
+            status = "ajustada"
+        results.append({
+            "task": name, "entry": key, "stack_words": words, "worst_bytes": need,
+            "lower_bound": bool(issues), "suggested_words": suggested, "status": status,
+            "free_bytes": configured - need, "path": path, "issues": issues,
+        })
+
+    if args.json:
+        print(json.dumps({"tasks": results, "unresolved_calls": missing}, ensure_ascii=False))
+    else:
+        print("=== Peor caso de pila por tarea (%d .ci, %d .su, %d funciones del ELF) ==="
+              % (ci_count, su_count, elf_count))
+        print("%-14s %-24s %8s %9s %9s %10s  %s" % ("Tarea", "Entrada", "Config", "Peor",
+                                                  "Libre", "Sugerida", "Estado"))
+        for r in results:
+            print("%-14s %-24s %6d w %1s%7d B %7d B %8d w  %s" % (
+                r["task"], plain_name(r["entry"])[:24], r["stack_words"],
+                ">=" if r["lower_bound"] else "", r["worst_bytes"], r["free_bytes"],
+                r["suggested_words"], r["status"] + (" (cota)" if r["lower_bound"] else "")))
+        reclaim = sum(STACK_WORD_BYTES * (r["stack_words"] - r["suggested_words"])
+                      for r in results if r["status"] == "sobrada")
+        print("Incluye %d B de cambio de contexto por tarea; margen de la sugerida %.0f %%; "
+              "SRAM recuperable con las sugeridas: %d B" % (STACK_CONTEXT_BYTES, args.margin, reclaim))
+        print("(cota): el peor caso es un mínimo; revisar los problemas listados abajo")
+
+        for r in results:
+            if args.path:
+                print("\n%s: %s" % (r["task"], " -> ".join(
+                    "%s(%s)" % (plain_name(k), graph.funcs[k].frame
+                                if k in graph.funcs and graph.funcs[k].frame is not None else "?")
+                    for k in r["path"])))
+            for kind, items in sorted(r["issues"].items()):
+                print("  %s, %s: %s" % (r["task"], kind, ", ".join(items[:8]) +
+                                        (" (+%d)" % (len(items) - 8) if len(items) > 8 else "")))
+        if missing:
+            print("\nEn %s no se encontraron: %s" % (os.path.basename(args.calls), ", ".join(missing)))
+
+    if args.check and any(r["status"] == "EXCEDIDA" for r in results):
+        return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,405 @@
+/**
+ * @file time_service_sim.c
+ * @brief Verificación en el host del avance de fecha y hora de time_service.c
+ * @author Sistema de Control de Acceso
+ * @date 2025
+ *
+ * Enlaza el mismo time_service.c del firmware con un tick simulado y un
+ * modelo del RTC, y compara cada avance con un calendario de referencia
+ * calculado desde cero (días desde 2000-01-01, sin incrementar dígitos):
+ * campos de now_dt, cadenas "DD/MM/YY" y "HH:MM:SS", día de la semana y la
+ * máscara de campos cambiados. Verifica:
+ * - cada cambio de minuto, hora, día, mes y año (con febrero de años
+ *   bisiestos y no bisiestos), fijando 23:59:59 en cada día de 2000 a 2099;
+ * - time_service_day_of_week contra la referencia en los mismos días;
+ * - que tras time_service_set el próximo avance devuelve TIME_FIELD_ALL
+ *   aunque no haya pasado un segundo, y que los suscriptores lo reciben
+ *   una sola vez;
+ * - un recorrido con avances de 1 ms a 1,5 s entre llamadas y atrasos
+ *   ocasionales de más de TIME_SERVICE_MAX_CATCHUP_S, que resincronizan
+ *   desde el RTC.
+ *
+ * Compilar y ejecutar desde la raíz del proyecto:
+ *
+ *     cc -std=c11 -O2 -Itools/replay/shim -I. tools/time_service_sim.c \
+ *        time_service.c -o time_service_sim
+ *     ./time_service_sim [-d días] [-s semilla]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "time_service.h"
+#include "hardware/rtc.h"
+#include "task.h"
+
+/** @brief Días del 1970-01-01 al 2000-01-01 */
+#define SIM_EPOCH_2000_DAYS     10957
+
+/** @brief Días de 2000-01-01 a 2100-01-01 y segundos por día */
+#define SIM_CENTURY_DAYS        36525
+#define SIM_DAY_S               86400
+
+/** @brief Atraso que se recupera avanzando dígitos (TIME_SERVICE_MAX_CATCHUP_S) */
+#define SIM_CATCHUP_S           60
+
+/** @brief Atraso con el que el recorrido fuerza la resincronización (s) */
+#define SIM_STALL_S             90
+
+static TickType_t now_tick;
+static uint32_t rng_state;
+
+/** @brief RTC: segundos desde 2000-01-01 al fijarlo y tick de ese momento */
+static bool rtc_on;
+static int64_t rtc_base_s;
+static TickType_t rtc_base_tick;
+
+/** @brief Notificaciones recibidas por el suscriptor */
+static uint32_t notified_mask;
+static uint32_t notified_count;
+
+static uint32_t errors;
+
+static uint32_t rng_next(void) {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return rng_state;
+}
+
+/* ---- Calendario de referencia ------------------------------------------ */
+
+/**
+ * @brief Días desde 1970-01-01 de una fecha civil (H. Hinnant)
+ */
+static int64_t days_from_civil(int64_t y, int m, int d) {
+    y -= m <= 2;
+    int64_t era = (y >= 0 ? y : y - 399) / 400;
+    int64_t yoe = y - era * 400;
+    int64_t doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+    int64_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + doe - 719468;
+}
+
+/**
+ * @brief Fecha civil de un número de días desde 1970-01-01 (H. Hinnant)
+ */
+static void civil_from_days(int64_t z, int *y, int *m, int *d) {
+    z += 719468;
+    int64_t era = (z >= 0 ? z : z - 146096) / 146097;
+    int64_t doe = z - era * 146097;
+    int64_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    int64_t doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    int64_t mp = (5 * doy + 2) / 153;
+    *d = (int)(doy - (153 * mp + 2) / 5 + 1);
+    *m = (int)(mp < 10 ? mp + 3 : mp - 9);
+    *y = (int)(yoe + era * 400 + (*m <= 2));
+}
+
+/**
+ * @brief Fecha y hora de referencia de un instante en segundos desde 2000
+ */
+static datetime_t ref_datetime(int64_t s) {
+    int64_t days = s / SIM_DAY_S;
+    int64_t rem = s % SIM_DAY_S;
+    int y, m, d;
+
+    civil_from_days(days + SIM_EPOCH_2000_DAYS, &y, &m, &d);
+    datetime_t dt = {
+        .year = (int16_t)y, .month = (int8_t)m, .day = (int8_t)d,
+        // 2000-01-01 fue sábado
+        .dotw = (int8_t)((days + 6) % 7),
+        .hour = (int8_t)(rem / 3600), .min = (int8_t)(rem / 60 % 60), .sec = (int8_t)(rem % 60),
+    };
+    return dt;
+}
+
+static int64_t ref_seconds(const datetime_t *dt) {
+    int64_t days = days_from_civil(dt->year, dt->month, dt->day) - SIM_EPOCH_2000_DAYS;
+    return days * SIM_DAY_S + dt->hour * 3600 + dt->min * 60 + dt->sec;
+}
+
+/**
+ * @brief Campos que cambian entre dos instantes consecutivos de referencia
+ */
+static uint32_t ref_changed(const datetime_t *a, const datetime_t *b) {
+    uint32_t changed = 0;
+
+    if (a->sec != b->sec) changed |= TIME_FIELD_SEC;
+    if (a->min != b->min) changed |= TIME_FIELD_MIN;
+    if (a->hour != b->hour) changed |= TIME_FIELD_HOUR;
+    if (a->day != b->day) changed |= TIME_FIELD_DAY;
+    if (a->month != b->month) changed |= TIME_FIELD_MONTH;
+    if (a->year != b->year) changed |= TIME_FIELD_YEAR;
+    return changed;
+}
+
+/* ---- Dependencias de time_service.c ------------------------------------ */
+
+TickType_t xTaskGetTickCount(void) {
+    return now_tick;
+}
+
+void sleep_us(uint64_t us) {
+    (void)us;
+}
+
+void rtc_init(void) {
+    rtc_on = true;
+}
+
+bool rtc_running(void) {
+    return rtc_on;
+}
+
+bool rtc_set_datetime(const datetime_t *t) {
+    rtc_base_s = ref_seconds(t);
+    rtc_base_tick = now_tick;
+    return true;
+}
+
+static int64_t rtc_now_s(void) {
+    return rtc_base_s + (now_tick - rtc_base_tick) / 1000;
+}
+
+bool rtc_get_datetime(datetime_t *t) {
+    *t = ref_datetime(rtc_now_s());
+    return true;
+}
+
+static void on_change(uint32_t changed, void *ctx) {
+    (void)ctx;
+    notified_mask |= changed;
+    notified_count++;
+}
+
+/* ---- Verificación ------------------------------------------------------ */
+
+/**
+ * @brief Compara el estado del servicio con la referencia
+ */
+static bool check_state(const char *where, const datetime_t *ref) {
+    datetime_t dt;
+    char date[16], time[16];
+
+    time_service_get(&dt);
+    snprintf(date, sizeof(date), "%02d/%02d/%02d", ref->day, ref->month, ref->year % 100);
+    snprintf(time, sizeof(time), "%02d:%02d:%02d", ref->hour, ref->min, ref->sec);
+
+    if (memcmp(&dt, ref, sizeof(dt)) != 0 ||
+        strcmp(time_service_date_str(), date) != 0 || strcmp(time_service_time_str(), time) != 0) {
+        if (errors++ < 10) {
+            printf("ERROR: %s: %s %s (dotw %d) en lugar de %s %s (dotw %d)\n", where,
+                   time_service_date_str(), time_service_time_str(), dt.dotw, date, time, ref->dotw);
+        }
+        return false;
+    }
+    return true;
+}
+
+static void check_mask(const char *where, const datetime_t *ref, uint32_t got, uint32_t expected) {
+    if (got != expected) {
+        if (errors++ < 10) {
+            printf("ERROR: %s: %04d-%02d-%02d %02d:%02d:%02d, máscara 0x%02x en lugar de 0x%02x\n",
+                   where, ref->year, ref->month, ref->day, ref->hour, ref->min, ref->sec,
+                   (unsigned)got, (unsigned)expected);
+        }
+    }
+}
+
+/**
+ * @brief Fija un instante como lo haría la consola (dotw calculado)
+ */
+static bool set_time(int64_t s) {
+    datetime_t dt = ref_datetime(s);
+    dt.dotw = (int8_t)time_service_day_of_week(dt.year, dt.month, dt.day);
+    return time_service_set(&dt);
+}
+
+/**
+ * @brief Fija 23:59:59 en cada día de 2000 a 2099 y avanza un segundo
+ *
+ * @param months Cambios de mes recorridos
+ * @param years Cambios de año recorridos
+ */
+static void check_every_day(uint32_t *months, uint32_t *years) {
+    for (int64_t day = 0; day < SIM_CENTURY_DAYS - 1; day++) {
+        int64_t s = day * SIM_DAY_S + SIM_DAY_S - 1;
+        datetime_t before = ref_datetime(s);
+        datetime_t after = ref_datetime(s + 1);
+
+        int dotw = time_service_day_of_week(before.year, before.month, before.day);
+        if (dotw != before.dotw && errors++ < 10) {
+            printf("ERROR: día de la semana de %04d-%02d-%02d: %d en lugar de %d\n",
+                   before.year, before.month, before.day, dotw, before.dotw);
+        }
+
+        if (!set_time(s)) {
+            if (errors++ < 10) {
+                printf("ERROR: time_service_set rechazó %04d-%02d-%02d\n",
+                       before.year, before.month, before.day);
+            }
+            continue;
+        }
+        time_service_update();          // Consume TIME_FIELD_ALL del set
+        now_tick += 1000;
+        uint32_t changed = time_service_update();
+        check_mask("cambio de día", &after, changed, ref_changed(&before, &after));
+        check_state("cambio de día", &after);
+        *months += (after.month != before.month);
+        *years += (after.year != before.year);
+    }
+}
+
+/**
+ * @brief Cada frontera de minuto y hora de un día, segundo a segundo
+ */
+static void check_one_day(int64_t start_s) {
+    set_time(start_s);
+    time_service_update();
+
+    datetime_t prev = ref_datetime(start_s);
+    for (int64_t s = start_s + 1; s <= start_s + SIM_DAY_S; s++) {
+        datetime_t ref = ref_datetime(s);
+        now_tick += 1000;
+        uint32_t changed = time_service_update();
+        check_mask("segundo a segundo", &ref, changed, ref_changed(&prev, &ref));
+        if (!check_state("segundo a segundo", &ref)) {
+            return;
+        }
+        prev = ref;
+    }
+}
+
+/**
+ * @brief Tras fijar la hora se informan todos los campos, una sola vez
+ */
+static void check_redraw_after_set(void) {
+    int64_t s = ref_seconds(&(datetime_t){ .year = 2025, .month = 7, .day = 27,
+                                           .hour = 10, .min = 0, .sec = 0 });
+    set_time(s);
+    time_service_update();
+    now_tick += 400;                    // A mitad de un segundo
+
+    notified_mask = 0;
+    notified_count = 0;
+    set_time(s + 3 * SIM_DAY_S + 3600 + 61);
+    datetime_t ref = ref_datetime(s + 3 * SIM_DAY_S + 3600 + 61);
+
+    uint32_t changed = time_service_update();
+    check_mask("avance tras fijar la hora", &ref, changed, TIME_FIELD_ALL);
+    check_state("avance tras fijar la hora", &ref);
+    if (notified_count != 1 || notified_mask != TIME_FIELD_ALL) {
+        errors++;
+        printf("ERROR: tras fijar la hora los suscriptores recibieron %u avisos (máscara 0x%02x)\n",
+               (unsigned)notified_count, (unsigned)notified_mask);
+    }
+
+    changed = time_service_update();
+    check_mask("segundo avance tras fijar la hora", &ref, changed, 0);
+}
+
+/**
+ * @brief Recorrido con intervalos irregulares y atrasos grandes
+ *
+ * @return Resincronizaciones desde el RTC
+ */
+static uint32_t random_walk(uint32_t days) {
+    int64_t s = (int64_t)(rng_next() % (SIM_CENTURY_DAYS - days - 1)) * SIM_DAY_S + rng_next() % SIM_DAY_S;
+    set_time(s);
+    time_service_update();
+
+    TickType_t second_start = now_tick;
+    int64_t end = s + (int64_t)days * SIM_DAY_S;
+    uint32_t resyncs = 0;
+
+    while (s < end) {
+        uint32_t step_ms = (rng_next() % 1000 == 0) ? SIM_STALL_S * 1000 : 1 + rng_next() % 1500;
+        now_tick += step_ms;
+
+        datetime_t before = ref_datetime(s);
+        uint32_t expected = 0;
+        while ((TickType_t)(now_tick - second_start) >= 1000) {
+            datetime_t a = ref_datetime(s);
+            datetime_t b = ref_datetime(++s);
+            expected |= ref_changed(&a, &b);
+            second_start += 1000;
+        }
+
+        uint32_t changed = time_service_update();
+        if (step_ms > SIM_CATCHUP_S * 1000) {
+            // Resincronizado desde el RTC: el segundo vuelve a empezar ahora
+            s = rtc_now_s();
+            expected = TIME_FIELD_ALL;
+            second_start = now_tick;
+            resyncs++;
+        }
+        datetime_t ref = ref_datetime(s);
+        check_mask("recorrido", &before, changed, expected);
+        if (!check_state("recorrido", &ref)) {
+            break;
+        }
+    }
+    return resyncs;
+}
+
+int main(int argc, char **argv) {
+    uint32_t walk_days = 30;
+    rng_state = 12345;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-d") == 0 && i + 1 < argc) {
+            walk_days = (uint32_t)strtoul(argv[++i], NULL, 0);
+        } else if (strcmp(argv[i], "-s") == 0 && i + 1 < argc) {
+            rng_state = (uint32_t)strtoul(argv[++i], NULL, 0);
+        } else {
+            fprintf(stderr, "uso: %s [-d días] [-s semilla]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (rng_state == 0 || walk_days == 0 || walk_days > 3650) {
+        fprintf(stderr, "la semilla no puede ser 0 y los días deben estar entre 1 y 3650\n");
+        return 1;
+    }
+
+    now_tick = 1000;
+    if (!time_service_init() || !time_service_subscribe(on_change, NULL)) {
+        printf("ERROR: no se pudo inicializar el servicio de tiempo\n");
+        return 1;
+    }
+    check_state("fecha por defecto", &(datetime_t){ .year = 2025, .month = 7, .day = 27, .dotw = 0 });
+
+    uint32_t months = 0, years = 0;
+    check_every_day(&months, &years);
+    printf("Cambios de día verificados: %d (%u de mes, %u de año)\n",
+           SIM_CENTURY_DAYS - 1, (unsigned)months, (unsigned)years);
+
+    // Un día común, el 29 de febrero de un bisiesto y fin de año
+    static const datetime_t days[] = {
+        { .year = 2025, .month = 3, .day = 14 },
+        { .year = 2024, .month = 2, .day = 29 },
+        { .year = 2025, .month = 12, .day = 31 },
+    };
+    for (size_t i = 0; i < sizeof(days) / sizeof(days[0]); i++) {
+        check_one_day(ref_seconds(&days[i]));
+    }
+    printf("Segundo a segundo: %u días (%u cambios de minuto y %u de hora)\n",
+           (unsigned)(sizeof(days) / sizeof(days[0])),
+           (unsigned)(sizeof(days) / sizeof(days[0]) * 1440), (unsigned)(sizeof(days) / sizeof(days[0]) * 24));
+
+    uint32_t errors_before = errors;
+    check_redraw_after_set();
+    printf("Avance tras fijar la hora: %s\n",
+           errors == errors_before ? "máscara completa en el próximo avance" : "ERROR");
+
+    uint32_t resyncs = random_walk(walk_days);
+    printf("Recorrido irregular: %u días, %u resincronizaciones desde el RTC\n",
+           (unsigned)walk_days, (unsigned)resyncs);
+
+    bool ok = (errors == 0);
+    printf("\n%s\n", ok ? "Verificación del servicio de tiempo: OK"
+                        : "ERROR: el servicio de tiempo no pasó la verificación");
+    return ok ? 0 : 1;
+}
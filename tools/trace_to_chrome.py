@@ -0,0 +1,147 @@
+#!/usr/bin/env python3
+"""
+Convierte el volcado del registrador de trazas a formato Chrome Trace.
+
+Lee la salida del comando de consola "trace dump" (capturada de la terminal
+USB, puede contener otras líneas) y genera un JSON que se abre en
+chrome://tracing o https://ui.perfetto.dev:
+
+  - una franja por cada intervalo en que una tarea estuvo en ejecución
+  - una franja por cada ejecución de las ISR instrumentadas
+  - eventos instantáneos para envíos y recepciones en colas y semáforos
+  - flechas de flujo que unen el k-ésimo envío con la k-ésima recepción de
+    cada cola (las colas son FIFO)
+
+Uso: trace_to_chrome.py <volcado.txt> <salida.json>
+"""
+
+import json
+import struct
+import sys
+
+EV_TASK_IN = 1
+EV_TASK_OUT = 2
+EV_QUEUE_SEND = 3
+EV_QUEUE_RECEIVE = 4
+EV_SEM_GIVE = 5
+EV_ISR_ENTER = 6
+EV_ISR_EXIT = 7
+
+# trace_record_t: timestamp_us (u32), event (u8), id (u8), data (u16), little endian
+RECORD = struct.Struct("<IBBH")
+
+PID = 1
+ISR_TID = 1000
+
+
+def parse_dump(lines):
+    """Extrae nombres y registros del último bloque TRACE BEGIN/END."""
+    tasks, queues, isrs, raw = {}, {}, {}, b""
+    inside = False
+
+    for line in lines:
+        line = line.strip()
+        if line.startswith("TRACE BEGIN"):
+            fields = line.split()
+            if fields[2] != "1" or int(fields[5]) != RECORD.size:
+                sys.exit("Formato de traza no soportado: " + line)
+            tasks, queues, isrs, raw = {}, {}, {}, b""
+            inside = True
+        elif not inside:
+            continue
+        elif line == "TRACE END":
+            inside = False
+        elif line.startswith("D "):
+            raw += bytes.fromhex(line[2:])
+        else:
+            kind, _, rest = line.partition(" ")
+            num, _, name = rest.partition(" ")
+            table = {"TASK": tasks, "QUEUE": queues, "ISR": isrs}.get(kind)
+            if table is not None:
+                table[int(num)] = name
+
+    records = [RECORD.unpack_from(raw, off)
+               for off in range(0, len(raw) - RECORD.size + 1, RECORD.size)]
+    return tasks, queues, isrs, records
+
+
+def unwrap(records):
+    """Extiende los tiempos de 32 bits (se desbordan cada ~71 minutos)."""
+    out, base, last = [], 0, None
+    for ts, event, ident, data in records:
+        if last is not None and ts < last:
+            base += 1 << 32
+        last = ts
+        out.append((base + ts, event, ident, data))
+    return out
+
+
+def convert(tasks, queues, isrs, records):
+    events = [
+        {"ph": "M", "pid": PID, "name": "process_name",
+         "args": {"name": "RP2040"}},
+        {"ph": "M", "pid": PID, "tid": ISR_TID, "name": "thread_name",
+         "args": {"name": "ISR"}},
+    ]
+    for num, name in tasks.items():
+        events.append({"ph": "M", "pid": PID, "tid": num, "name": "thread_name",
+                       "args": {"name": name}})
+
+    running = None
+    in_isr = 0
+    pending = {}     # cola -> lista de flujos enviados aún no recibidos
+    next_flow = 1
+
+    for ts, event, ident, data in unwrap(records):
+        if event == EV_TASK_IN:
+            running = ident
+            events.append({"ph": "B", "pid": PID, "tid": ident, "ts": ts,
+                           "name": tasks.get(ident, "tarea %d" % ident)})
+        elif event == EV_TASK_OUT:
+            events.append({"ph": "E", "pid": PID, "tid": ident, "ts": ts})
+            running = None
+        elif event == EV_ISR_ENTER:
+            in_isr += 1
+            events.append({"ph": "B", "pid": PID, "tid": ISR_TID, "ts": ts,
+                           "name": isrs.get(ident, "isr %d" % ident)})
+        elif event == EV_ISR_EXIT:
+            in_isr = max(in_isr - 1, 0)
+            events.append({"ph": "E", "pid": PID, "tid": ISR_TID, "ts": ts})
+        elif event in (EV_QUEUE_SEND, EV_SEM_GIVE, EV_QUEUE_RECEIVE):
+            queue = queues.get(ident, "cola %d" % ident)
+            tid = ISR_TID if in_isr or running is None else running
+            receive = event == EV_QUEUE_RECEIVE
+            op = "recv" if receive else ("give" if event == EV_SEM_GIVE else "send")
+            events.append({"ph": "i", "s": "t", "pid": PID, "tid": tid, "ts": ts,
+                           "name": "%s %s" % (op, queue),
+                           "args": {"en_cola": data}})
+
+            if not receive:
+                pending.setdefault(ident, []).append(next_flow)
+                events.append({"ph": "s", "pid": PID, "tid": tid, "ts": ts,
+                               "id": next_flow, "cat": "cola", "name": queue})
+                next_flow += 1
+            elif pending.get(ident):
+                events.append({"ph": "f", "bp": "e", "pid": PID, "tid": tid, "ts": ts,
+                               "id": pending[ident].pop(0), "cat": "cola", "name": queue})
+
+    return {"traceEvents": events, "displayTimeUnit": "ms"}
+
+
+def main():
+    if len(sys.argv) != 3:
+        sys.exit(__doc__)
+
+    with open(sys.argv[1], encoding="utf-8", errors="replace") as f:
+        tasks, queues, isrs, records = parse_dump(f)
+    if not records:
+        sys.exit("No se encontró ningún bloque TRACE BEGIN/END con registros")
+
+    with open(sys.argv[2], "w", encoding="utf-8") as f:
+        json.dump(convert(tasks, queues, isrs, records), f)
+
+    print("%d registros convertidos" % len(records))
+
+
+if __name__ == "__main__":
+    main()
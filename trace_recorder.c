@@ -0,0 +1,157 @@
+/**
+ * @file trace_recorder.c
+ * @brief Implementación del registro binario de eventos del scheduler
+ * @author Sistema de Control de Acceso
+ * @date 2025
+ */
+
+#include "trace_recorder.h"
+#include <stdio.h>
+#include "pico/stdlib.h"
+#include "hardware/sync.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+
+// Los macros de traza de FreeRTOSConfig.h usan estos valores numéricos
+_Static_assert(TRACE_EV_QUEUE_SEND == 3 && TRACE_EV_QUEUE_RECEIVE == 4,
+               "actualizar los macros traceQUEUE_* de FreeRTOSConfig.h");
+
+/** @brief Buffer circular de registros */
+static trace_record_t trace_buffer[TRACE_BUFFER_RECORDS];
+
+/** @brief Total de registros escritos desde el último inicio */
+static uint32_t trace_written;
+
+/** @brief Captura activa */
+static volatile bool trace_enabled = true;
+
+/** @brief Nombres de las colas instrumentadas (índice = trace_queue_id_t) */
+static const char *queue_names[] = {
+    [TRACE_QUEUE_NONE]       = "-",
+    [TRACE_QUEUE_KEYPAD_SEM] = "keypad_sem",
+    [TRACE_QUEUE_EXECUTOR]   = "executor",
+    [TRACE_QUEUE_ACCESS]     = "access_bus",
+};
+
+/** @brief Nombres de las ISR instrumentadas (índice = trace_isr_id_t) */
+static const char *isr_names[] = {
+    [TRACE_ISR_KEYPAD] = "keypad_gpio_isr",
+    [TRACE_ISR_USB_RX] = "usb_rx",
+};
+
+/**
+ * @brief Agrega un registro al buffer circular
+ */
+static inline void trace_write(uint8_t event, uint8_t id, uint16_t data) {
+    if (!trace_enabled) {
+        return;
+    }
+    
+    uint32_t irq_state = save_and_disable_interrupts();
+    trace_record_t *r = &trace_buffer[trace_written % TRACE_BUFFER_RECORDS];
+    r->timestamp_us = time_us_32();
+    r->event = event;
+    r->id = id;
+    r->data = data;
+    trace_written++;
+    restore_interrupts(irq_state);
+}
+
+/**
+ * @brief Asigna un identificador de traza a una cola o semáforo
+ */
+void trace_register_queue(void *queue, trace_queue_id_t id, const char *name) {
+    if (queue == NULL) {
+        return;
+    }
+    
+    vQueueSetQueueNumber((QueueHandle_t)queue, id);
+    vQueueAddToRegistry((QueueHandle_t)queue, name);
+}
+
+/**
+ * @brief Inicia o detiene la captura de eventos
+ */
+void trace_recorder_enable(bool enable) {
+    if (enable && !trace_enabled) {
+        trace_written = 0;
+    }
+    trace_enabled = enable;
+}
+
+void trace_task_switched_in(void) {
+    trace_write(TRACE_EV_TASK_IN, (uint8_t)uxTaskGetTaskNumber(xTaskGetCurrentTaskHandle()), 0);
+}
+
+void trace_task_switched_out(void) {
+    trace_write(TRACE_EV_TASK_OUT, (uint8_t)uxTaskGetTaskNumber(xTaskGetCurrentTaskHandle()), 0);
+}
+
+void trace_queue_event(uint8_t event, void *queue) {
+    UBaseType_t id = uxQueueGetQueueNumber((QueueHandle_t)queue);
+    
+    // Solo las colas instrumentadas; el resto se ignora con costo mínimo
+    if (id == TRACE_QUEUE_NONE) {
+        return;
+    }
+    
+    if (event == TRACE_EV_QUEUE_SEND &&
+        ucQueueGetQueueType((QueueHandle_t)queue) != queueQUEUE_TYPE_BASE) {
+        event = TRACE_EV_SEM_GIVE;
+    }
+    
+    trace_write(event, (uint8_t)id,
+                (uint16_t)uxQueueMessagesWaitingFromISR((QueueHandle_t)queue));
+}
+
+void trace_isr_enter(uint8_t isr_id) {
+    trace_write(TRACE_EV_ISR_ENTER, isr_id, 0);
+}
+
+void trace_isr_exit(uint8_t isr_id) {
+    trace_write(TRACE_EV_ISR_EXIT, isr_id, 0);
+}
+
+/**
+ * @brief Vuelca el buffer por la salida estándar
+ */
+void trace_recorder_dump(void) {
+    static TaskStatus_t tasks[16];
+    
+    trace_enabled = false;
+    
+    uint32_t count = trace_written;
+    uint32_t first = 0;
+    if (count > TRACE_BUFFER_RECORDS) {
+        first = count - TRACE_BUFFER_RECORDS;
+    }
+    
+    printf("TRACE BEGIN 1 %lu %lu %lu\n", (unsigned long)(count - first),
+           (unsigned long)first, (unsigned long)sizeof(trace_record_t));
+    
+    UBaseType_t num_tasks = uxTaskGetSystemState(tasks, count_of(tasks), NULL);
+    for (UBaseType_t i = 0; i < num_tasks; i++) {
+        printf("TASK %u %s\n", (unsigned)uxTaskGetTaskNumber(tasks[i].xHandle), tasks[i].pcTaskName);
+    }
+    for (unsigned i = 1; i < count_of(queue_names); i++) {
+        printf("QUEUE %u %s\n", i, queue_names[i]);
+    }
+    for (unsigned i = 1; i < count_of(isr_names); i++) {
+        printf("ISR %u %s\n", i, isr_names[i]);
+    }
+    
+    // Registros en hexadecimal, 16 por línea, en orden cronológico
+    for (uint32_t n = first; n < count; ) {
+        printf("D ");
+        for (int k = 0; k < 16 && n < count; k++, n++) {
+            const uint8_t *b = (const uint8_t *)&trace_buffer[n % TRACE_BUFFER_RECORDS];
+            for (size_t j = 0; j < sizeof(trace_record_t); j++) {
+                printf("%02x", b[j]);
+            }
+        }
+        printf("\n");
+    }
+    
+    printf("TRACE END\n");
+}
@@ -0,0 +1,96 @@
+/**
+ * @file trace_recorder.h
+ * @brief Registro binario de eventos del scheduler en un buffer circular
+ * @author Sistema de Control de Acceso
+ * @date 2025
+ * 
+ * Registra en RAM, con marca de tiempo de 1 MHz, los cambios de contexto,
+ * las entregas y tomas de los semáforos del teclado y de los suscriptores
+ * del bus de eventos (LEDs, display y control de acceso) y la entrada/salida
+ * de las ISR.
+ * El contenido se vuelca por la consola USB ("trace dump") y se convierte
+ * a formato Chrome trace con tools/trace_to_chrome.py.
+ */
+
+#ifndef TRACE_RECORDER_H
+#define TRACE_RECORDER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/** @brief Número de registros del buffer circular (8 bytes cada uno) */
+#define TRACE_BUFFER_RECORDS 1024
+
+/**
+ * @brief Tipos de evento registrados
+ */
+typedef enum {
+    TRACE_EV_TASK_IN = 1,       /**< Tarea entra en ejecución (id = número de tarea) */
+    TRACE_EV_TASK_OUT,          /**< Tarea sale de ejecución */
+    TRACE_EV_QUEUE_SEND,        /**< Envío a cola (id = trace_queue_id_t, data = mensajes en cola) */
+    TRACE_EV_QUEUE_RECEIVE,     /**< Recepción de cola */
+    TRACE_EV_SEM_GIVE,          /**< Entrega de semáforo */
+    TRACE_EV_ISR_ENTER,         /**< Entrada a ISR (id = trace_isr_id_t) */
+    TRACE_EV_ISR_EXIT           /**< Salida de ISR */
+} trace_event_t;
+
+/**
+ * @brief Identificadores de colas y semáforos instrumentados
+ * 
+ * Se asignan con vQueueSetQueueNumber(); las colas con número 0 no se registran.
+ */
+typedef enum {
+    TRACE_QUEUE_NONE = 0,
+    TRACE_QUEUE_KEYPAD_SEM,     /**< Semáforo ISR -> tarea del teclado */
+    TRACE_QUEUE_EXECUTOR,       /**< Semáforo que despierta al ejecutor de corrutinas (LEDs, display) */
+    TRACE_QUEUE_ACCESS          /**< Suscriptor del control de acceso en el bus de eventos */
+} trace_queue_id_t;
+
+/**
+ * @brief Identificadores de ISR instrumentadas
+ */
+typedef enum {
+    TRACE_ISR_KEYPAD = 1,       /**< IRQ GPIO de las filas del teclado */
+    TRACE_ISR_USB_RX            /**< Caracteres recibidos por USB */
+} trace_isr_id_t;
+
+/**
+ * @brief Registro binario de un evento (8 bytes)
+ */
+typedef struct {
+    uint32_t timestamp_us;      /**< Marca de tiempo (temporizador de 1 MHz) */
+    uint8_t event;              /**< trace_event_t */
+    uint8_t id;                 /**< Tarea, cola o ISR según el evento */
+    uint16_t data;              /**< Dato adicional (p. ej. mensajes en cola) */
+} trace_record_t;
+
+/**
+ * @brief Asigna un identificador de traza a una cola o semáforo
+ * 
+ * @param queue Handle de la cola o semáforo
+ * @param id Identificador de traza
+ * @param name Nombre para el registro de colas de FreeRTOS
+ */
+void trace_register_queue(void *queue, trace_queue_id_t id, const char *name);
+
+/**
+ * @brief Inicia o detiene la captura de eventos
+ */
+void trace_recorder_enable(bool enable);
+
+/**
+ * @brief Vuelca el buffer por la salida estándar (detiene la captura)
+ * 
+ * Formato de texto línea a línea: encabezado, tabla de tareas y colas, y
+ * los registros binarios codificados en hexadecimal.
+ */
+void trace_recorder_dump(void);
+
+/* Hooks llamados desde las macros trace* de FreeRTOSConfig.h y las ISR */
+void trace_task_switched_in(void);
+void trace_task_switched_out(void);
+void trace_queue_event(uint8_t event, void *queue);
+void trace_isr_enter(uint8_t isr_id);
+void trace_isr_exit(uint8_t isr_id);
+
+#endif // TRACE_RECORDER_H
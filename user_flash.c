@@ -0,0 +1,57 @@
+/**
+ * @file user_flash.c
+ * @brief Acceso a la región del índice de usuarios en la flash QSPI
+ * @author Sistema de Control de Acceso
+ * @date 2025
+ */
+
+#include "user_flash.h"
+#include <string.h>
+#include "pico/stdlib.h"
+#include "hardware/flash.h"
+#include "hardware/sync.h"
+
+/** @brief Desplazamiento de la región desde el inicio de la flash */
+#define USER_FLASH_OFFSET   (PICO_FLASH_SIZE_BYTES - USER_FLASH_SIZE)
+
+_Static_assert(USER_FLASH_SIZE % FLASH_SECTOR_SIZE == 0, "USER_FLASH_SIZE debe ser múltiplo del sector");
+_Static_assert(USER_FLASH_SIZE / FLASH_SECTOR_SIZE <= BT_MAX_PAGES, "USER_FLASH_SIZE supera BT_MAX_PAGES");
+_Static_assert(FLASH_SECTOR_SIZE == BT_PAGE_SIZE && FLASH_PAGE_SIZE == BT_PROGRAM_SIZE,
+               "la geometría de la flash no coincide con flash_btree.h");
+
+/** @brief Fin del programa en la flash (del linker script del SDK) */
+extern char __flash_binary_end;
+
+static bool qspi_read(void *ctx, uint32_t addr, void *buf, uint32_t len) {
+    memcpy(buf, (const void *)(uintptr_t)(XIP_BASE + USER_FLASH_OFFSET + addr), len);
+    return true;
+}
+
+static bool qspi_erase(void *ctx, uint32_t addr) {
+    uint32_t irq_state = save_and_disable_interrupts();
+    flash_range_erase(USER_FLASH_OFFSET + addr, FLASH_SECTOR_SIZE);
+    restore_interrupts(irq_state);
+    return true;
+}
+
+static bool qspi_program(void *ctx, uint32_t addr, const void *buf, uint32_t len) {
+    uint32_t irq_state = save_and_disable_interrupts();
+    flash_range_program(USER_FLASH_OFFSET + addr, buf, len);
+    restore_interrupts(irq_state);
+    return true;
+}
+
+static const bt_flash_t user_flash = {
+    .read = qspi_read,
+    .erase = qspi_erase,
+    .program = qspi_program,
+    .ctx = NULL,
+    .size = USER_FLASH_SIZE,
+};
+
+const bt_flash_t *user_flash_region(void) {
+    if ((uintptr_t)&__flash_binary_end > XIP_BASE + USER_FLASH_OFFSET) {
+        return NULL;
+    }
+    return &user_flash;
+}
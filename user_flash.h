@@ -0,0 +1,37 @@
+/**
+ * @file user_flash.h
+ * @brief Región de la flash QSPI interna para el índice de usuarios
+ * @author Sistema de Control de Acceso
+ * @date 2025
+ *
+ * Entrega a flash_btree.c el acceso a los últimos USER_FLASH_SIZE bytes de
+ * la flash del programa. Las lecturas van por el mapa XIP; el borrado y la
+ * programación usan las rutinas del SDK con las interrupciones
+ * deshabilitadas, porque mientras tanto no se puede ejecutar desde la
+ * flash. Un borrado de sector demora hasta 400 ms y en ese tiempo el tick
+ * del kernel se detiene, por lo que la autenticación nunca escribe: deja
+ * los cambios de clave y de intentos pendientes en RAM y database_flush()
+ * los escribe en un lote desde la tarea Stats (ver database.h).
+ *
+ * Para una flash SPI externa basta con otro bt_flash_t con las mismas
+ * operaciones sobre el periférico SPI.
+ */
+
+#ifndef USER_FLASH_H
+#define USER_FLASH_H
+
+#include "flash_btree.h"
+
+/** @brief Bytes reservados al final de la flash (múltiplo de 4 KB) */
+#ifndef USER_FLASH_SIZE
+#define USER_FLASH_SIZE     (1024u * 1024u)
+#endif
+
+/**
+ * @brief Región del índice de usuarios
+ *
+ * @return NULL si la región se superpone con el programa
+ */
+const bt_flash_t *user_flash_region(void);
+
+#endif // USER_FLASH_H